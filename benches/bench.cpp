@@ -10,10 +10,40 @@
 #define _CRT_SECURE_NO_WARNINGS // [LM] Say the line!
 #endif
 
+#include "krarena.h"
+#include "krbase64.h"
+#include "krconv.h"
+#include "krcsv.h"
+#include "krfloat.h"
+#include "krfmt.h"
+#include "krhex.h"
+#include "krini.h"
+#include "krintern.h"
+#include "krjson.h"
+#include "krmatch.h"
 #include "krstr.h"
+#include "krstrbuf.h"
+#include "krutf8.h"
 
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+
+static std::vector<char> MakeString(size_t len)
+{
+    std::vector<char> str(len + 1, 'a');
+    str[len] = '\0';
+    return str;
+}
+
 //------------------------------------------------------------------------------
 
 static void Bench_strcpy(benchmark::State &state)
@@ -64,6 +94,208 @@ static void Bench_kr_strscpy(benchmark::State &state)
 
 BENCHMARK(Bench_kr_strscpy);
 
+static void Bench_strcpy_sweep(benchmark::State &state)
+{
+    const std::vector<char> src = MakeString(size_t(state.range(0)));
+    std::vector<char> dest(src.size());
+    for (auto _ : state)
+    {
+        char *r = strcpy(dest.data(), src.data());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_strcpy_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_strscpy_sweep(benchmark::State &state)
+{
+    const std::vector<char> src = MakeString(size_t(state.range(0)));
+    std::vector<char> dest(src.size());
+    for (auto _ : state)
+    {
+        ptrdiff_t r = kr_strscpy(dest.data(), src.data(), dest.size());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_strscpy_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_strlcpy_sweep(benchmark::State &state)
+{
+    const std::vector<char> src = MakeString(size_t(state.range(0)));
+    std::vector<char> dest(src.size());
+    for (auto _ : state)
+    {
+        size_t r = kr_strlcpy(dest.data(), src.data(), dest.size());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_strlcpy_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_strlcpy_truncate_sweep(benchmark::State &state)
+{
+    // Source twice the destination, so the length of the rest is measured.
+    const std::vector<char> src = MakeString(size_t(state.range(0)) * 2);
+    std::vector<char> dest(size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        size_t r = kr_strlcpy(dest.data(), src.data(), dest.size());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0) * 2);
+}
+
+BENCHMARK(Bench_kr_strlcpy_truncate_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_stpecpy_sweep(benchmark::State &state)
+{
+    const std::vector<char> src = MakeString(size_t(state.range(0)));
+    std::vector<char> dest(src.size());
+    for (auto _ : state)
+    {
+        char *r = kr_stpecpy(dest.data(), dest.data() + dest.size(), src.data());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_stpecpy_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+#define FRAGMENT "0123456789abcdefghij"
+
+static void Bench_kr_strlcat_build(benchmark::State &state)
+{
+    // 500 fragments into a 10 KB message.
+    std::vector<char> buffer(501 * (sizeof(FRAGMENT) - 1));
+    for (auto _ : state)
+    {
+        buffer[0] = '\0';
+        for (int i = 0; i < 500; i++)
+        {
+            size_t r = kr_strlcat(buffer.data(), FRAGMENT, buffer.size());
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * 500 * int64_t(sizeof(FRAGMENT) - 1));
+}
+
+BENCHMARK(Bench_kr_strlcat_build);
+
+static void Bench_kr_strbuf_build(benchmark::State &state)
+{
+    struct kr_strbuf_s buf;
+    kr_strbuf_init(&buf);
+    for (auto _ : state)
+    {
+        kr_strbuf_clear(&buf);
+        for (int i = 0; i < 500; i++)
+        {
+            bool r = kr_strbuf_append(&buf, FRAGMENT);
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    kr_strbuf_destroy(&buf);
+    state.SetBytesProcessed(int64_t(state.iterations()) * 500 * int64_t(sizeof(FRAGMENT) - 1));
+}
+
+BENCHMARK(Bench_kr_strbuf_build);
+
+#undef FRAGMENT
+
+static std::vector<std::string> MakeKeys(size_t count)
+{
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < count; i++)
+    {
+        keys.push_back("config.section" + std::to_string(i % 37) + ".key" + std::to_string(i));
+    }
+    return keys;
+}
+
+static void Bench_kr_strdup_keys(benchmark::State &state)
+{
+    const std::vector<std::string> keys = MakeKeys(size_t(state.range(0)));
+    std::vector<char *> dups(keys.size());
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            dups[i] = kr_strdup(keys[i].c_str());
+        }
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            KR_FREE(dups[i]);
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_strdup_keys)->Arg(4000);
+
+static void Bench_kr_strdup_request(benchmark::State &state)
+{
+    // Hundreds of tiny strings per request, all freed together.
+    const std::vector<std::string> keys = MakeKeys(size_t(state.range(0)));
+    std::vector<char *> dups(keys.size());
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            dups[i] = kr_strndup(keys[i].c_str(), 12);
+        }
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            KR_FREE(dups[i]);
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_strdup_request)->Arg(300);
+
+static void Bench_kr_arena_strdup_request(benchmark::State &state)
+{
+    const std::vector<std::string> keys = MakeKeys(size_t(state.range(0)));
+    struct kr_arena_s arena;
+    kr_arena_init(&arena, 0);
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            char *r = kr_arena_strndup(&arena, keys[i].c_str(), 12);
+            benchmark::DoNotOptimize(r);
+        }
+        kr_arena_reset(&arena);
+    }
+    kr_arena_destroy(&arena);
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_arena_strdup_request)->Arg(300);
+
+static void Bench_kr_intern_keys(benchmark::State &state)
+{
+    const std::vector<std::string> keys = MakeKeys(size_t(state.range(0)));
+    struct kr_intern_s intern;
+    kr_intern_init(&intern);
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            const char *r = kr_internn(&intern, keys[i].data(), keys[i].size());
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    kr_intern_destroy(&intern);
+    state.SetItemsProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_intern_keys)->Arg(4000);
+
 static void Bench_strlen(benchmark::State &state)
 {
     const char buffer[] = "The quick brown fox jumps over the lazy dog.";
@@ -112,4 +344,1972 @@ static void Bench_kr_strnlen(benchmark::State &state)
 
 BENCHMARK(Bench_kr_strnlen);
 
+static void Bench_strlen_sweep(benchmark::State &state)
+{
+    const std::vector<char> buffer = MakeString(size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        size_t r = strlen(buffer.data());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_strlen_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_strlen_sweep(benchmark::State &state)
+{
+    const std::vector<char> buffer = MakeString(size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        size_t r = kr_strlen(buffer.data());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_strlen_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_strlen_swar_sweep(benchmark::State &state)
+{
+    const std::vector<char> buffer = MakeString(size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        size_t r = kr_strlen_swar(buffer.data());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_strlen_swar_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_strnlen_sweep(benchmark::State &state)
+{
+    const std::vector<char> buffer = MakeString(size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        size_t r = kr_strnlen(buffer.data(), buffer.size());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_strnlen_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_strcspn_sweep(benchmark::State &state)
+{
+    const std::vector<char> buffer = MakeString(size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        size_t r = kr_strcspn(buffer.data(), " \t\r\n,;");
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_strcspn_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_strcspn_set_sweep(benchmark::State &state)
+{
+    const std::vector<char> buffer = MakeString(size_t(state.range(0)));
+    struct kr_charset_s set;
+    kr_charset_init(&set, " \t\r\n,;");
+    for (auto _ : state)
+    {
+        size_t r = kr_strcspn_set(buffer.data(), &set);
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_strcspn_set_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_strcmp_sweep(benchmark::State &state)
+{
+    const std::vector<char> lhs = MakeString(size_t(state.range(0)));
+    const std::vector<char> rhs = lhs;
+    for (auto _ : state)
+    {
+        int r = strcmp(lhs.data(), rhs.data());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_strcmp_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_strcmp_sweep(benchmark::State &state)
+{
+    const std::vector<char> lhs = MakeString(size_t(state.range(0)));
+    const std::vector<char> rhs = lhs;
+    for (auto _ : state)
+    {
+        int r = kr_strcmp(lhs.data(), rhs.data());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_strcmp_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_strcmp_swar_sweep(benchmark::State &state)
+{
+    const std::vector<char> lhs = MakeString(size_t(state.range(0)));
+    const std::vector<char> rhs = lhs;
+    for (auto _ : state)
+    {
+        int r = kr_strcmp_swar(lhs.data(), rhs.data());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_strcmp_swar_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_strncmp_sweep(benchmark::State &state)
+{
+    const std::vector<char> lhs = MakeString(size_t(state.range(0)));
+    const std::vector<char> rhs = lhs;
+    for (auto _ : state)
+    {
+        int r = kr_strncmp(lhs.data(), rhs.data(), lhs.size());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_strncmp_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_memcmp_sweep(benchmark::State &state)
+{
+    const std::vector<char> lhs = MakeString(size_t(state.range(0)));
+    const std::vector<char> rhs = lhs;
+    for (auto _ : state)
+    {
+        int r = memcmp(lhs.data(), rhs.data(), lhs.size());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_memcmp_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_memcmp_sweep(benchmark::State &state)
+{
+    const std::vector<char> lhs = MakeString(size_t(state.range(0)));
+    const std::vector<char> rhs = lhs;
+    for (auto _ : state)
+    {
+        int r = kr_memcmp(lhs.data(), rhs.data(), lhs.size());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_memcmp_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_strcasecmp_sweep(benchmark::State &state)
+{
+    const std::vector<char> lhs = MakeString(size_t(state.range(0)));
+    std::vector<char> rhs = lhs;
+    std::fill(rhs.begin(), rhs.end() - 1, 'A');
+    for (auto _ : state)
+    {
+        int r = strcasecmp(lhs.data(), rhs.data());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_strcasecmp_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_strcasecmp_sweep(benchmark::State &state)
+{
+    const std::vector<char> lhs = MakeString(size_t(state.range(0)));
+    std::vector<char> rhs = lhs;
+    std::fill(rhs.begin(), rhs.end() - 1, 'A');
+    for (auto _ : state)
+    {
+        int r = kr_strcasecmp(lhs.data(), rhs.data());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_strcasecmp_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_tolower_loop_sweep(benchmark::State &state)
+{
+    std::vector<char> str = MakeString(size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        for (char *s = str.data(); *s != '\0'; s++)
+        {
+            *s = kr_tolower(*s);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_tolower_loop_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_strlower_sweep(benchmark::State &state)
+{
+    std::vector<char> str = MakeString(size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        char *r = kr_strlower(str.data());
+        benchmark::DoNotOptimize(r);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_strlower_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_memchr_sweep(benchmark::State &state)
+{
+    const std::vector<char> buffer = MakeString(size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        const void *r = memchr(buffer.data(), '\0', buffer.size());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_memchr_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_memchr_sweep(benchmark::State &state)
+{
+    const std::vector<char> buffer = MakeString(size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        const void *r = kr_memchr(buffer.data(), '\0', buffer.size());
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_memchr_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static std::vector<char> MakeHaystack(size_t len, const char *needle)
+{
+    std::vector<char> str = MakeString(len);
+    const size_t needleLen = strlen(needle);
+    memcpy(str.data() + len - needleLen, needle, needleLen);
+    return str;
+}
+
+static void Bench_strstr_sweep(benchmark::State &state)
+{
+    const std::vector<char> buffer = MakeHaystack(size_t(state.range(0)), "xyzzy");
+    for (auto _ : state)
+    {
+        const char *r = strstr(buffer.data(), "xyzzy");
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_strstr_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_strstr_sweep(benchmark::State &state)
+{
+    const std::vector<char> buffer = MakeHaystack(size_t(state.range(0)), "xyzzy");
+    for (auto _ : state)
+    {
+        const char *r = kr_strstr(buffer.data(), "xyzzy");
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_strstr_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+#define WORST_NEEDLE "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab"
+
+static void Bench_strstr_worst(benchmark::State &state)
+{
+    const std::vector<char> buffer = MakeHaystack(16384, WORST_NEEDLE);
+    for (auto _ : state)
+    {
+        const char *r = strstr(buffer.data(), WORST_NEEDLE);
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * 16384);
+}
+
+BENCHMARK(Bench_strstr_worst);
+
+static void Bench_kr_strstr_worst(benchmark::State &state)
+{
+    const std::vector<char> buffer = MakeHaystack(16384, WORST_NEEDLE);
+    for (auto _ : state)
+    {
+        const char *r = kr_strstr(buffer.data(), WORST_NEEDLE);
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * 16384);
+}
+
+BENCHMARK(Bench_kr_strstr_worst);
+
+#undef WORST_NEEDLE
+
+static std::vector<char> MakeText(size_t len)
+{
+    std::vector<char> str(len + 1);
+    uint32_t x = 1993;
+    for (size_t i = 0; i < len; i++)
+    {
+        x = x * 1664525 + 1013904223;
+        str[i] = char('a' + (x >> 24) % 27);
+        str[i] = str[i] == 'a' + 26 ? ' ' : str[i];
+    }
+    str[len] = '\0';
+    return str;
+}
+
+static void Bench_kr_memmem_count(benchmark::State &state)
+{
+    const std::vector<char> text = MakeText(65536);
+    const std::vector<char> needle(text.end() - 1 - state.range(0), text.end() - 1);
+    for (auto _ : state)
+    {
+        size_t count = 0;
+        const char *pos = text.data(), *end = text.data() + 65536;
+        while ((pos = static_cast<const char *>(kr_memmem(pos, size_t(end - pos), needle.data(), needle.size()))))
+        {
+            count++;
+            pos += needle.size();
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * 65536);
+}
+
+BENCHMARK(Bench_kr_memmem_count)->Arg(4)->Arg(16)->Arg(64)->Arg(128)->Arg(255)->Arg(1024);
+
+static void Bench_kr_searcher_count(benchmark::State &state)
+{
+    const std::vector<char> text = MakeText(65536);
+    const std::vector<char> needle(text.end() - 1 - state.range(0), text.end() - 1);
+    struct kr_searcher_s searcher;
+    kr_searcher_init(&searcher, needle.data(), needle.size());
+    for (auto _ : state)
+    {
+        size_t count = kr_searcher_count(&searcher, text.data(), 65536);
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * 65536);
+}
+
+BENCHMARK(Bench_kr_searcher_count)->Arg(4)->Arg(16)->Arg(64)->Arg(128)->Arg(255)->Arg(1024);
+
+static std::vector<std::vector<char>> MakeKeywords(const std::vector<char> &text, size_t count)
+{
+    std::vector<std::vector<char>> keywords;
+    for (size_t i = 0; i < count; i++)
+    {
+        // Mostly misses, with a few hits from the text itself.
+        const size_t len = 4 + i % 8;
+        std::vector<char> keyword(len);
+        for (size_t j = 0; j < len; j++)
+        {
+            keyword[j] = char('a' + (i * 7 + j * 13) % 26);
+        }
+        if (i % 16 == 0)
+        {
+            const size_t pos = (i * 4099) % (text.size() - len - 1);
+            keyword.assign(text.begin() + ptrdiff_t(pos), text.begin() + ptrdiff_t(pos + len));
+        }
+        keywords.push_back(keyword);
+    }
+    return keywords;
+}
+
+static bool CountMatch(void *user, size_t, size_t)
+{
+    ++*static_cast<size_t *>(user);
+    return true;
+}
+
+static void Bench_kr_memmem_keywords(benchmark::State &state)
+{
+    const std::vector<char> text = MakeText(65536);
+    const std::vector<std::vector<char>> keywords = MakeKeywords(text, size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        size_t count = 0;
+        for (const std::vector<char> &keyword : keywords)
+        {
+            const char *pos = text.data(), *end = text.data() + 65536;
+            while ((pos = static_cast<const char *>(kr_memmem(pos, size_t(end - pos), keyword.data(), keyword.size()))))
+            {
+                count++;
+                pos++;
+            }
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * 65536);
+}
+
+BENCHMARK(Bench_kr_memmem_keywords)->Arg(8)->Arg(16)->Arg(32)->Arg(300);
+
+static void Bench_kr_matcher_keywords(benchmark::State &state)
+{
+    const std::vector<char> text = MakeText(65536);
+    const std::vector<std::vector<char>> keywords = MakeKeywords(text, size_t(state.range(0)));
+    std::vector<const char *> patterns;
+    std::vector<size_t> lens;
+    for (const std::vector<char> &keyword : keywords)
+    {
+        patterns.push_back(keyword.data());
+        lens.push_back(keyword.size());
+    }
+
+    struct kr_matcher_s matcher;
+    kr_matcher_init(&matcher, patterns.data(), lens.data(), patterns.size(), 0);
+    for (auto _ : state)
+    {
+        size_t count = 0;
+        kr_matcher_scan(&matcher, text.data(), 65536, CountMatch, &count);
+        benchmark::DoNotOptimize(count);
+    }
+    kr_matcher_destroy(&matcher);
+    state.SetBytesProcessed(int64_t(state.iterations()) * 65536);
+}
+
+BENCHMARK(Bench_kr_matcher_keywords)->Arg(8)->Arg(16)->Arg(32)->Arg(300);
+
+static std::vector<char> MakeWords(size_t len)
+{
+    std::vector<char> str(len + 1, 'a');
+    for (size_t i = 7; i < len; i += 8)
+    {
+        str[i] = ' ';
+    }
+    str[len] = '\0';
+    return str;
+}
+
+static void Bench_kr_strtok_r(benchmark::State &state)
+{
+    const std::vector<char> words = MakeWords(4096);
+    std::vector<char> buffer(words.size());
+    for (auto _ : state)
+    {
+        char *ptr = NULL;
+        buffer = words;
+        for (char *r = kr_strtok_r(buffer.data(), " ", &ptr); r != NULL; r = kr_strtok_r(NULL, " ", &ptr))
+        {
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * 4096);
+}
+
+BENCHMARK(Bench_kr_strtok_r);
+
+static void Bench_kr_tokenize(benchmark::State &state)
+{
+    const std::vector<char> words = MakeWords(4096);
+    struct kr_token_s toks[64];
+    struct kr_charset_s delims;
+    kr_charset_init(&delims, " ");
+    for (auto _ : state)
+    {
+        struct kr_tokenizer_s tok;
+        size_t pos = 0;
+        kr_tokenizer_init(&tok, &delims);
+        while (pos < 4096)
+        {
+            size_t consumed = 0;
+            size_t r = kr_tokenizer_feed(&tok, words.data() + pos, 4096 - pos, toks, 64, &consumed);
+            benchmark::DoNotOptimize(r);
+            pos += consumed;
+        }
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * 4096);
+}
+
+BENCHMARK(Bench_kr_tokenize);
+
+//------------------------------------------------------------------------------
+
+// Comma-separated numbers of the given number of digits.
+static std::string MakeNumbers(size_t count, size_t digits)
+{
+    std::string str;
+    for (size_t i = 0; i < count; i++)
+    {
+        for (size_t j = 0; j < digits; j++)
+        {
+            str += char('1' + (i + j) % 9);
+        }
+        str += ',';
+    }
+    return str;
+}
+
+static void Bench_strtoull(benchmark::State &state)
+{
+    const std::string nums = MakeNumbers(1000, size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        const char *ptr = nums.c_str();
+        while (*ptr != '\0')
+        {
+            char *end = NULL;
+            benchmark::DoNotOptimize(strtoull(ptr, &end, 10));
+            ptr = end + 1;
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 1000);
+}
+
+BENCHMARK(Bench_strtoull)->Arg(4)->Arg(10)->Arg(19);
+
+static void Bench_kr_parse_u64(benchmark::State &state)
+{
+    const std::string nums = MakeNumbers(1000, size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        const char *ptr = nums.c_str();
+        const char *end = ptr + nums.size();
+        while (ptr != end)
+        {
+            uint64_t res = 0;
+            bool overflow = false;
+            ptr += kr_parse_u64(&res, ptr, size_t(end - ptr), &overflow) + 1;
+            benchmark::DoNotOptimize(res);
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 1000);
+}
+
+BENCHMARK(Bench_kr_parse_u64)->Arg(4)->Arg(10)->Arg(19);
+
+// Values spread across every digit count.
+static std::vector<uint64_t> MakeValues(size_t count)
+{
+    std::vector<uint64_t> values;
+    uint64_t value = 1;
+    for (size_t i = 0; i < count; i++)
+    {
+        values.push_back(value + i);
+        value = value > UINT64_MAX / 10 ? 1 : value * 10;
+    }
+    return values;
+}
+
+static void Bench_snprintf_llu(benchmark::State &state)
+{
+    const std::vector<uint64_t> values = MakeValues(1000);
+    char buffer[KR_CONV_64_SIZE];
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            benchmark::DoNotOptimize(snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)values[i]));
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 1000);
+}
+
+BENCHMARK(Bench_snprintf_llu);
+
+static void Bench_kr_u64toa(benchmark::State &state)
+{
+    const std::vector<uint64_t> values = MakeValues(1000);
+    char buffer[KR_CONV_64_SIZE];
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            benchmark::DoNotOptimize(kr_u64toa(buffer, values[i]));
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 1000);
+}
+
+BENCHMARK(Bench_kr_u64toa);
+
+// Comma separated doubles printed with the given number of significant digits.
+static std::string MakeFloats(size_t count, int digits)
+{
+    std::string str;
+    char buffer[64];
+    double value = 1.0 / 3.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        snprintf(buffer, sizeof(buffer), "%.*g,", digits, value);
+        str += buffer;
+        value = value * 7.3 + 0.1;
+        if (value > 1e200)
+        {
+            value = 1e-200 / 3.0;
+        }
+    }
+    return str;
+}
+
+static void Bench_strtod(benchmark::State &state)
+{
+    const std::string nums = MakeFloats(1000, int(state.range(0)));
+    for (auto _ : state)
+    {
+        const char *ptr = nums.c_str();
+        while (*ptr != '\0')
+        {
+            char *end = NULL;
+            benchmark::DoNotOptimize(strtod(ptr, &end));
+            ptr = end + 1;
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 1000);
+}
+
+BENCHMARK(Bench_strtod)->Arg(6)->Arg(17);
+
+static void Bench_kr_parse_f64(benchmark::State &state)
+{
+    const std::string nums = MakeFloats(1000, int(state.range(0)));
+    for (auto _ : state)
+    {
+        const char *ptr = nums.c_str();
+        const char *end = ptr + nums.size();
+        while (ptr != end)
+        {
+            double res = 0;
+            ptr += kr_parse_f64(&res, ptr, size_t(end - ptr)) + 1;
+            benchmark::DoNotOptimize(res);
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 1000);
+}
+
+BENCHMARK(Bench_kr_parse_f64)->Arg(6)->Arg(17);
+
+// Doubles with every kind of digit count and exponent.
+static std::vector<double> MakeDoubles(size_t count)
+{
+    std::vector<double> values;
+    double value = 1.0 / 3.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        values.push_back(i % 2 == 0 ? value : double(i) / 8.0);
+        value = value * 7.3 + 0.1;
+        if (value > 1e200)
+        {
+            value = 1e-200 / 3.0;
+        }
+    }
+    return values;
+}
+
+static void Bench_snprintf_g17(benchmark::State &state)
+{
+    const std::vector<double> values = MakeDoubles(1000);
+    char buffer[32];
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            benchmark::DoNotOptimize(snprintf(buffer, sizeof(buffer), "%.17g", values[i]));
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 1000);
+}
+
+BENCHMARK(Bench_snprintf_g17);
+
+static void Bench_kr_f64toa(benchmark::State &state)
+{
+    const std::vector<double> values = MakeDoubles(1000);
+    char buffer[KR_FLOAT_64_SIZE];
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            benchmark::DoNotOptimize(kr_f64toa(buffer, values[i]));
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 1000);
+}
+
+BENCHMARK(Bench_kr_f64toa);
+
+static void Bench_snprintf_log(benchmark::State &state)
+{
+    char buffer[256];
+    unsigned i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(snprintf(buffer, sizeof(buffer), "%s:%d: request %u from %s took %5.3fms (%08x)",
+                                          "server.c", 1234, i, "127.0.0.1", double(i) / 7.0, i * 2654435761u));
+        i++;
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()));
+}
+
+BENCHMARK(Bench_snprintf_log);
+
+static void Bench_kr_snprintf_log(benchmark::State &state)
+{
+    char buffer[256];
+    unsigned i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kr_snprintf(buffer, sizeof(buffer), "%s:%d: request %u from %s took %5.3fms (%08x)",
+                                             "server.c", 1234, i, "127.0.0.1", double(i) / 7.0, i * 2654435761u));
+        i++;
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()));
+}
+
+BENCHMARK(Bench_kr_snprintf_log);
+
+static void Bench_snprintf_int(benchmark::State &state)
+{
+    char buffer[256];
+    int i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(snprintf(buffer, sizeof(buffer), "%s=%d", "count", i++));
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()));
+}
+
+BENCHMARK(Bench_snprintf_int);
+
+static void Bench_kr_snprintf_int(benchmark::State &state)
+{
+    char buffer[256];
+    int i = 0;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kr_snprintf(buffer, sizeof(buffer), "%s=%d", "count", i++));
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()));
+}
+
+BENCHMARK(Bench_kr_snprintf_int);
+
+static std::vector<unsigned char> MakeBytes(size_t len)
+{
+    std::vector<unsigned char> bytes(len);
+    for (size_t i = 0; i < len; i++)
+    {
+        bytes[i] = (unsigned char)(i * 2654435761u >> 24);
+    }
+    return bytes;
+}
+
+static void Bench_hex_encode_loop_sweep(benchmark::State &state)
+{
+    static const char digits[] = "0123456789abcdef";
+    const std::vector<unsigned char> bytes = MakeBytes(size_t(state.range(0)));
+    std::vector<char> hex(bytes.size() * 2);
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < bytes.size(); i++)
+        {
+            hex[i * 2] = digits[bytes[i] >> 4];
+            hex[i * 2 + 1] = digits[bytes[i] & 0x0F];
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_hex_encode_loop_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_hex_encode_sweep(benchmark::State &state)
+{
+    const std::vector<unsigned char> bytes = MakeBytes(size_t(state.range(0)));
+    std::vector<char> hex(bytes.size() * 2);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kr_hex_encode(hex.data(), bytes.data(), bytes.size(), false));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_hex_encode_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_hex_encode_swar_sweep(benchmark::State &state)
+{
+    const std::vector<unsigned char> bytes = MakeBytes(size_t(state.range(0)));
+    std::vector<char> hex(bytes.size() * 2);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kr_hex_encode_swar(hex.data(), bytes.data(), bytes.size(), false));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_hex_encode_swar_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static int HexDigit(char ch)
+{
+    if (kr_isdigit(ch))
+    {
+        return ch - '0';
+    }
+    return kr_tolower(ch) - 'a' + 10;
+}
+
+// The obvious loop, checking each character with kr_isxdigit.
+static void Bench_hex_decode_loop_sweep(benchmark::State &state)
+{
+    const std::vector<unsigned char> bytes = MakeBytes(size_t(state.range(0)));
+    std::vector<char> hex(bytes.size() * 2);
+    std::vector<unsigned char> out(bytes.size());
+    kr_hex_encode(hex.data(), bytes.data(), bytes.size(), true);
+    for (auto _ : state)
+    {
+        size_t i = 0;
+        for (; i + 1 < hex.size(); i += 2)
+        {
+            if (!kr_isxdigit(hex[i]) || !kr_isxdigit(hex[i + 1]))
+            {
+                break;
+            }
+            out[i / 2] = (unsigned char)(HexDigit(hex[i]) << 4 | HexDigit(hex[i + 1]));
+        }
+        benchmark::DoNotOptimize(i);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0) * 2);
+}
+
+BENCHMARK(Bench_hex_decode_loop_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_hex_decode_sweep(benchmark::State &state)
+{
+    const std::vector<unsigned char> bytes = MakeBytes(size_t(state.range(0)));
+    std::vector<char> hex(bytes.size() * 2);
+    std::vector<unsigned char> out(bytes.size());
+    kr_hex_encode(hex.data(), bytes.data(), bytes.size(), true);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kr_hex_decode(out.data(), hex.data(), hex.size()));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0) * 2);
+}
+
+BENCHMARK(Bench_kr_hex_decode_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_hex_decode_swar_sweep(benchmark::State &state)
+{
+    const std::vector<unsigned char> bytes = MakeBytes(size_t(state.range(0)));
+    std::vector<char> hex(bytes.size() * 2);
+    std::vector<unsigned char> out(bytes.size());
+    kr_hex_encode(hex.data(), bytes.data(), bytes.size(), true);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kr_hex_decode_swar(out.data(), hex.data(), hex.size()));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0) * 2);
+}
+
+BENCHMARK(Bench_kr_hex_decode_swar_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static const char base64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// The usual table-driven loop, one group at a time.
+static void Bench_base64_encode_loop_sweep(benchmark::State &state)
+{
+    const std::vector<unsigned char> bytes = MakeBytes(size_t(state.range(0)));
+    std::vector<char> out(KR_BASE64_ENCODE_SIZE(bytes.size()));
+    for (auto _ : state)
+    {
+        size_t o = 0, i = 0;
+        for (; i + 3 <= bytes.size(); i += 3)
+        {
+            const unsigned bits = unsigned(bytes[i]) << 16 | unsigned(bytes[i + 1]) << 8 | bytes[i + 2];
+            out[o++] = base64Chars[bits >> 18];
+            out[o++] = base64Chars[(bits >> 12) & 0x3F];
+            out[o++] = base64Chars[(bits >> 6) & 0x3F];
+            out[o++] = base64Chars[bits & 0x3F];
+        }
+        benchmark::DoNotOptimize(o);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_base64_encode_loop_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_base64_encode_sweep(benchmark::State &state)
+{
+    const std::vector<unsigned char> bytes = MakeBytes(size_t(state.range(0)));
+    std::vector<char> out(KR_BASE64_ENCODE_SIZE(bytes.size()));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kr_base64_encode(out.data(), bytes.data(), bytes.size(), 0));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_base64_encode_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_base64_encode_scalar_sweep(benchmark::State &state)
+{
+    const std::vector<unsigned char> bytes = MakeBytes(size_t(state.range(0)));
+    std::vector<char> out(KR_BASE64_ENCODE_SIZE(bytes.size()));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kr_base64_encode_scalar(out.data(), bytes.data(), bytes.size(), 0));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+BENCHMARK(Bench_kr_base64_encode_scalar_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_base64_decode_loop_sweep(benchmark::State &state)
+{
+    const std::vector<unsigned char> bytes = MakeBytes(size_t(state.range(0)));
+    std::vector<char> in(KR_BASE64_ENCODE_SIZE(bytes.size()));
+    std::vector<unsigned char> out(bytes.size() + 3);
+    unsigned char values[256];
+    memset(values, 0xFF, sizeof(values));
+    for (unsigned i = 0; i < 64; i++)
+    {
+        values[(unsigned char)base64Chars[i]] = (unsigned char)i;
+    }
+    in.resize(kr_base64_encode(in.data(), bytes.data(), bytes.size(), KR_BASE64_NOPAD) / 4 * 4);
+    for (auto _ : state)
+    {
+        size_t o = 0, i = 0;
+        for (; i + 4 <= in.size(); i += 4)
+        {
+            const unsigned a = values[(unsigned char)in[i]], b = values[(unsigned char)in[i + 1]],
+                           c = values[(unsigned char)in[i + 2]], d = values[(unsigned char)in[i + 3]];
+            if ((a | b | c | d) == 0xFF)
+            {
+                break;
+            }
+            const unsigned bits = a << 18 | b << 12 | c << 6 | d;
+            out[o++] = (unsigned char)(bits >> 16);
+            out[o++] = (unsigned char)(bits >> 8);
+            out[o++] = (unsigned char)bits;
+        }
+        benchmark::DoNotOptimize(o);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(in.size()));
+}
+
+BENCHMARK(Bench_base64_decode_loop_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_base64_decode_sweep(benchmark::State &state)
+{
+    const std::vector<unsigned char> bytes = MakeBytes(size_t(state.range(0)));
+    std::vector<char> in(KR_BASE64_ENCODE_SIZE(bytes.size()));
+    std::vector<unsigned char> out(bytes.size() + 3);
+    in.resize(kr_base64_encode(in.data(), bytes.data(), bytes.size(), KR_BASE64_NOPAD) / 4 * 4);
+    for (auto _ : state)
+    {
+        size_t len = 0;
+        benchmark::DoNotOptimize(kr_base64_decode(out.data(), &len, in.data(), in.size(), 0));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(in.size()));
+}
+
+BENCHMARK(Bench_kr_base64_decode_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+static void Bench_kr_base64_decode_scalar_sweep(benchmark::State &state)
+{
+    const std::vector<unsigned char> bytes = MakeBytes(size_t(state.range(0)));
+    std::vector<char> in(KR_BASE64_ENCODE_SIZE(bytes.size()));
+    std::vector<unsigned char> out(bytes.size() + 3);
+    in.resize(kr_base64_encode(in.data(), bytes.data(), bytes.size(), KR_BASE64_NOPAD) / 4 * 4);
+    for (auto _ : state)
+    {
+        size_t len = 0;
+        benchmark::DoNotOptimize(kr_base64_decode_scalar(out.data(), &len, in.data(), in.size(), 0));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(in.size()));
+}
+
+BENCHMARK(Bench_kr_base64_decode_scalar_sweep)->RangeMultiplier(4)->Range(16, 16384);
+
+// Mostly English, with an accented letter now and then.
+static std::string MakeAsciiText(size_t len)
+{
+    static const char *const words[] = {"the ", "quick ", "brown ", "fox ", "jumps ", "over ", "lazy ", "dogs, ",
+                                        "caf\xC3\xA9 ", "and ", "then ", "sleeps. "};
+    std::string text;
+    for (size_t i = 0; text.size() < len; i++)
+    {
+        text += words[(i * 2654435761u >> 16) % 12];
+    }
+    text.resize(kr_utf8_validate(text.data(), len));
+    return text;
+}
+
+// Mostly CJK, with some ASCII punctuation and spaces.
+static std::string MakeCjkText(size_t len)
+{
+    static const char *const words[] = {
+        "\xE4\xB8\xAD\xE6\x96\x87",
+        "\xE3\x81\xAE",
+        "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E",
+        "\xED\x95\x9C\xEA\xB5\xAD\xEC\x96\xB4",
+        "\xE3\x80\x82",
+        ", ",
+        "\xF0\x9F\x98\x80",
+        "\xE6\x96\x87\xE5\xAD\x97",
+    };
+    std::string text;
+    for (size_t i = 0; text.size() < len; i++)
+    {
+        text += words[(i * 2654435761u >> 16) % 8];
+    }
+    text.resize(kr_utf8_validate(text.data(), len));
+    return text;
+}
+
+// The usual byte-at-a-time state machine, which knows how many continuation
+// bytes are left and what range the next one has to be in.
+static size_t Utf8ValidateLoop(const char *str, size_t len)
+{
+    const unsigned char *s = (const unsigned char *)str;
+    size_t start = 0;
+    unsigned need = 0, lo = 0x80, hi = 0xBF;
+    for (size_t i = 0; i < len; i++)
+    {
+        const unsigned c = s[i];
+        if (need != 0)
+        {
+            if (c < lo || c > hi)
+            {
+                return start;
+            }
+            lo = 0x80;
+            hi = 0xBF;
+            need--;
+            continue;
+        }
+
+        start = i;
+        if (c < 0x80)
+        {
+            continue;
+        }
+        else if (c >= 0xC2 && c <= 0xDF)
+        {
+            need = 1;
+        }
+        else if (c >= 0xE0 && c <= 0xEF)
+        {
+            need = 2;
+            lo = c == 0xE0 ? 0xA0 : 0x80;
+            hi = c == 0xED ? 0x9F : 0xBF;
+        }
+        else if (c >= 0xF0 && c <= 0xF4)
+        {
+            need = 3;
+            lo = c == 0xF0 ? 0x90 : 0x80;
+            hi = c == 0xF4 ? 0x8F : 0xBF;
+        }
+        else
+        {
+            return i;
+        }
+    }
+    return need ? start : len;
+}
+
+static void Bench_utf8_validate_loop_ascii(benchmark::State &state)
+{
+    const std::string text = MakeAsciiText(size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(Utf8ValidateLoop(text.data(), text.size()));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+BENCHMARK(Bench_utf8_validate_loop_ascii)->RangeMultiplier(8)->Range(64, 65536);
+
+static void Bench_kr_utf8_validate_ascii(benchmark::State &state)
+{
+    const std::string text = MakeAsciiText(size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kr_utf8_validate(text.data(), text.size()));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+BENCHMARK(Bench_kr_utf8_validate_ascii)->RangeMultiplier(8)->Range(64, 65536);
+
+static void Bench_kr_utf8_validate_swar_ascii(benchmark::State &state)
+{
+    const std::string text = MakeAsciiText(size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kr_utf8_validate_swar(text.data(), text.size()));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+BENCHMARK(Bench_kr_utf8_validate_swar_ascii)->RangeMultiplier(8)->Range(64, 65536);
+
+static void Bench_utf8_validate_loop_cjk(benchmark::State &state)
+{
+    const std::string text = MakeCjkText(size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(Utf8ValidateLoop(text.data(), text.size()));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+BENCHMARK(Bench_utf8_validate_loop_cjk)->RangeMultiplier(8)->Range(64, 65536);
+
+static void Bench_kr_utf8_validate_cjk(benchmark::State &state)
+{
+    const std::string text = MakeCjkText(size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kr_utf8_validate(text.data(), text.size()));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+BENCHMARK(Bench_kr_utf8_validate_cjk)->RangeMultiplier(8)->Range(64, 65536);
+
+static void Bench_kr_utf8_validate_swar_cjk(benchmark::State &state)
+{
+    const std::string text = MakeCjkText(size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(kr_utf8_validate_swar(text.data(), text.size()));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+BENCHMARK(Bench_kr_utf8_validate_swar_cjk)->RangeMultiplier(8)->Range(64, 65536);
+
+// Decode and re-encode a code point at a time, the usual way.
+static size_t Utf8ToUtf16Loop(uint16_t *dest, const char *str, size_t len)
+{
+    const unsigned char *s = (const unsigned char *)str;
+    size_t o = 0;
+    for (size_t i = 0; i < len;)
+    {
+        uint32_t cp = s[i];
+        size_t n = 1;
+        if (cp >= 0xF0)
+        {
+            cp &= 0x07, n = 4;
+        }
+        else if (cp >= 0xE0)
+        {
+            cp &= 0x0F, n = 3;
+        }
+        else if (cp >= 0xC0)
+        {
+            cp &= 0x1F, n = 2;
+        }
+        if (len - i < n)
+        {
+            break;
+        }
+        for (size_t j = 1; j < n; j++)
+        {
+            cp = cp << 6 | (s[i + j] & 0x3F);
+        }
+        if (cp >= 0x10000)
+        {
+            dest[o++] = uint16_t(0xD800 | (cp - 0x10000) >> 10);
+            cp = 0xDC00 | (cp & 0x3FF);
+        }
+        dest[o++] = uint16_t(cp);
+        i += n;
+    }
+    return o;
+}
+
+static size_t Utf16ToUtf8Loop(char *dest, const uint16_t *src, size_t len)
+{
+    size_t o = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        uint32_t cp = src[i];
+        if (cp >= 0xD800 && cp < 0xDC00 && i + 1 < len)
+        {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (src[++i] - 0xDC00);
+        }
+        if (cp < 0x80)
+        {
+            dest[o++] = char(cp);
+        }
+        else if (cp < 0x800)
+        {
+            dest[o++] = char(0xC0 | cp >> 6);
+            dest[o++] = char(0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x10000)
+        {
+            dest[o++] = char(0xE0 | cp >> 12);
+            dest[o++] = char(0x80 | (cp >> 6 & 0x3F));
+            dest[o++] = char(0x80 | (cp & 0x3F));
+        }
+        else
+        {
+            dest[o++] = char(0xF0 | cp >> 18);
+            dest[o++] = char(0x80 | (cp >> 12 & 0x3F));
+            dest[o++] = char(0x80 | (cp >> 6 & 0x3F));
+            dest[o++] = char(0x80 | (cp & 0x3F));
+        }
+    }
+    return o;
+}
+
+static void Bench_utf8_to_utf16_loop_ascii(benchmark::State &state)
+{
+    const std::string text = MakeAsciiText(size_t(state.range(0)));
+    std::vector<uint16_t> out(text.size());
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(Utf8ToUtf16Loop(out.data(), text.data(), text.size()));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+BENCHMARK(Bench_utf8_to_utf16_loop_ascii)->RangeMultiplier(8)->Range(64, 65536);
+
+static void Bench_kr_utf8_to_utf16_ascii(benchmark::State &state)
+{
+    const std::string text = MakeAsciiText(size_t(state.range(0)));
+    std::vector<uint16_t> out(text.size());
+    for (auto _ : state)
+    {
+        size_t len = 0;
+        benchmark::DoNotOptimize(kr_utf8_to_utf16(out.data(), &len, text.data(), text.size(), KR_UTF_NATIVE));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+BENCHMARK(Bench_kr_utf8_to_utf16_ascii)->RangeMultiplier(8)->Range(64, 65536);
+
+static void Bench_utf8_to_utf16_loop_cjk(benchmark::State &state)
+{
+    const std::string text = MakeCjkText(size_t(state.range(0)));
+    std::vector<uint16_t> out(text.size());
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(Utf8ToUtf16Loop(out.data(), text.data(), text.size()));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+BENCHMARK(Bench_utf8_to_utf16_loop_cjk)->RangeMultiplier(8)->Range(64, 65536);
+
+static void Bench_kr_utf8_to_utf16_cjk(benchmark::State &state)
+{
+    const std::string text = MakeCjkText(size_t(state.range(0)));
+    std::vector<uint16_t> out(text.size());
+    for (auto _ : state)
+    {
+        size_t len = 0;
+        benchmark::DoNotOptimize(kr_utf8_to_utf16(out.data(), &len, text.data(), text.size(), KR_UTF_NATIVE));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+BENCHMARK(Bench_kr_utf8_to_utf16_cjk)->RangeMultiplier(8)->Range(64, 65536);
+
+static void Bench_utf16_to_utf8_loop_ascii(benchmark::State &state)
+{
+    const std::string text = MakeAsciiText(size_t(state.range(0)));
+    std::vector<uint16_t> wide(text.size());
+    std::vector<char> out(text.size());
+    wide.resize(Utf8ToUtf16Loop(wide.data(), text.data(), text.size()));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(Utf16ToUtf8Loop(out.data(), wide.data(), wide.size()));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+BENCHMARK(Bench_utf16_to_utf8_loop_ascii)->RangeMultiplier(8)->Range(64, 65536);
+
+static void Bench_kr_utf16_to_utf8_ascii(benchmark::State &state)
+{
+    const std::string text = MakeAsciiText(size_t(state.range(0)));
+    std::vector<uint16_t> wide(text.size());
+    std::vector<char> out(text.size());
+    wide.resize(Utf8ToUtf16Loop(wide.data(), text.data(), text.size()));
+    for (auto _ : state)
+    {
+        size_t len = 0;
+        benchmark::DoNotOptimize(kr_utf16_to_utf8(out.data(), &len, wide.data(), wide.size(), KR_UTF_NATIVE));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+BENCHMARK(Bench_kr_utf16_to_utf8_ascii)->RangeMultiplier(8)->Range(64, 65536);
+
+static void Bench_utf16_to_utf8_loop_cjk(benchmark::State &state)
+{
+    const std::string text = MakeCjkText(size_t(state.range(0)));
+    std::vector<uint16_t> wide(text.size());
+    std::vector<char> out(text.size());
+    wide.resize(Utf8ToUtf16Loop(wide.data(), text.data(), text.size()));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(Utf16ToUtf8Loop(out.data(), wide.data(), wide.size()));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+BENCHMARK(Bench_utf16_to_utf8_loop_cjk)->RangeMultiplier(8)->Range(64, 65536);
+
+static void Bench_kr_utf16_to_utf8_cjk(benchmark::State &state)
+{
+    const std::string text = MakeCjkText(size_t(state.range(0)));
+    std::vector<uint16_t> wide(text.size());
+    std::vector<char> out(text.size());
+    wide.resize(Utf8ToUtf16Loop(wide.data(), text.data(), text.size()));
+    for (auto _ : state)
+    {
+        size_t len = 0;
+        benchmark::DoNotOptimize(kr_utf16_to_utf8(out.data(), &len, wide.data(), wide.size(), KR_UTF_NATIVE));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+BENCHMARK(Bench_kr_utf16_to_utf8_cjk)->RangeMultiplier(8)->Range(64, 65536);
+
+//------------------------------------------------------------------------------
+
+// Rows of plain, numeric and quoted fields, with a quote, delimiter or
+// newline inside some of the quoted ones, ending in CRLF.
+static std::string MakeCsv(size_t len)
+{
+    static const char *const fields[] = {"1024",         "alpha",         "\"Smith, John\"", "3.14159",
+                                         "",             "\"say \"\"hi\"\"\"", "bravo charlie", "-17",
+                                         "\"two\nlines\"", "2024-01-01",    "delta",         "0"};
+    std::string csv;
+    for (size_t i = 0; csv.size() < len; i++)
+    {
+        csv += fields[(i * 2654435761u >> 16) % 12];
+        csv += (i % 6 == 5) ? "\r\n" : ",";
+    }
+    csv.resize(len);
+    return csv;
+}
+
+struct CsvLoopState
+{
+    size_t pos = 0;
+    size_t start = 0;
+    bool inQuotes = false;
+};
+
+// The obvious byte-at-a-time loop, with quotes.
+static size_t CsvLoop(CsvLoopState &csv, const char *chunk, size_t len, struct kr_csv_field_s *fields,
+                      size_t fieldsLen)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        if (chunk[i] == '"')
+        {
+            csv.inQuotes = !csv.inQuotes;
+        }
+        else if (!csv.inQuotes && (chunk[i] == ',' || chunk[i] == '\n'))
+        {
+            fields[count].offset = csv.start;
+            fields[count].length = csv.pos + i - csv.start;
+            fields[count].flags = chunk[i] == '\n' ? KR_CSV_ROWEND : 0;
+            csv.start = csv.pos + i + 1;
+            if (++count == fieldsLen)
+            {
+                count = 0;
+            }
+        }
+    }
+    csv.pos += len;
+    return count;
+}
+
+static void Bench_csv_loop(benchmark::State &state)
+{
+    const std::string csv = MakeCsv(size_t(state.range(0)));
+    struct kr_csv_field_s fields[256];
+    for (auto _ : state)
+    {
+        CsvLoopState loop;
+        benchmark::DoNotOptimize(CsvLoop(loop, csv.data(), csv.size(), fields, 256));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(csv.size()));
+}
+
+BENCHMARK(Bench_csv_loop)->RangeMultiplier(8)->Range(64, 65536);
+
+static void Bench_kr_csv_feed(benchmark::State &state)
+{
+    const std::string csv = MakeCsv(size_t(state.range(0)));
+    struct kr_csv_field_s fields[256];
+    for (auto _ : state)
+    {
+        struct kr_csv_s parser;
+        size_t pos = 0;
+        kr_csv_init(&parser, ',');
+        while (pos < csv.size())
+        {
+            size_t consumed = 0;
+            benchmark::DoNotOptimize(kr_csv_feed(&parser, csv.data() + pos, csv.size() - pos, fields, 256, &consumed));
+            benchmark::ClobberMemory();
+            pos += consumed;
+        }
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(csv.size()));
+}
+
+BENCHMARK(Bench_kr_csv_feed)->RangeMultiplier(8)->Range(64, 65536);
+
+// A 1 GiB file, written once and read back in 1 MiB chunks each time.
+static FILE *CsvFile()
+{
+    static FILE *file = NULL;
+    if (file == NULL)
+    {
+        const std::string csv = MakeCsv(size_t(1) << 20);
+        file = std::tmpfile();
+        for (size_t i = 0; i < 1024; i++)
+        {
+            std::fwrite(csv.data(), 1, csv.size(), file);
+        }
+    }
+    std::rewind(file);
+    return file;
+}
+
+static void Bench_csv_loop_1g(benchmark::State &state)
+{
+    std::vector<char> chunk(size_t(1) << 20);
+    struct kr_csv_field_s fields[256];
+    for (auto _ : state)
+    {
+        FILE *file = CsvFile();
+        CsvLoopState loop;
+        for (size_t len; (len = std::fread(chunk.data(), 1, chunk.size(), file)) != 0;)
+        {
+            benchmark::DoNotOptimize(CsvLoop(loop, chunk.data(), len, fields, 256));
+            benchmark::ClobberMemory();
+        }
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) << 30);
+}
+
+BENCHMARK(Bench_csv_loop_1g)->Unit(benchmark::kMillisecond);
+
+static void Bench_kr_csv_feed_1g(benchmark::State &state)
+{
+    std::vector<char> chunk(size_t(1) << 20);
+    struct kr_csv_field_s fields[256];
+    for (auto _ : state)
+    {
+        FILE *file = CsvFile();
+        struct kr_csv_s parser;
+        kr_csv_init(&parser, ',');
+        for (size_t len; (len = std::fread(chunk.data(), 1, chunk.size(), file)) != 0;)
+        {
+            size_t pos = 0;
+            while (pos < len)
+            {
+                size_t consumed = 0;
+                benchmark::DoNotOptimize(kr_csv_feed(&parser, chunk.data() + pos, len - pos, fields, 256, &consumed));
+                benchmark::ClobberMemory();
+                pos += consumed;
+            }
+        }
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) << 30);
+}
+
+BENCHMARK(Bench_kr_csv_feed_1g)->Unit(benchmark::kMillisecond);
+
+//------------------------------------------------------------------------------
+
+// Telemetry-like records: an array of objects with numbers, strings and a
+// nested array, some strings escaped.
+static std::string MakeJson(size_t len)
+{
+    static const char *const hosts[] = {"\"web-01\"", "\"web-02\"", "\"db \\\"primary\\\"\"", "\"cache\\u00e9\""};
+    std::string json = "[";
+    char buf[64];
+    for (size_t i = 0; json.size() < len; i++)
+    {
+        std::sprintf(buf, "%s{\"id\": %u, \"ts\": %u.%03u, ", i == 0 ? "" : ",\n ", unsigned(i),
+                     unsigned(1700000000 + i), unsigned(i * 7 % 1000));
+        json += buf;
+        json += "\"host\": ";
+        json += hosts[i % 4];
+        std::sprintf(buf, ", \"ok\": %s, \"lat\": [%u, %u, %u]}", i % 3 ? "true" : "false", unsigned(i % 97),
+                     unsigned(i % 89), unsigned(i % 83));
+        json += buf;
+    }
+    json += "]";
+    return json;
+}
+
+// A typical recursive descent parser, which only counts values.
+struct JsonLoop
+{
+    const char *s;
+    size_t len;
+    size_t i;
+    size_t values;
+};
+
+static void JsonLoopSpace(JsonLoop &p)
+{
+    while (p.i < p.len && (p.s[p.i] == ' ' || p.s[p.i] == '\t' || p.s[p.i] == '\n' || p.s[p.i] == '\r'))
+    {
+        p.i++;
+    }
+}
+
+static bool JsonLoopString(JsonLoop &p)
+{
+    for (p.i++; p.i < p.len; p.i++)
+    {
+        if (p.s[p.i] == '\\')
+        {
+            p.i++;
+        }
+        else if (p.s[p.i] == '"')
+        {
+            p.i++;
+            return true;
+        }
+        else if ((unsigned char)p.s[p.i] < 0x20)
+        {
+            return false;
+        }
+    }
+    return false;
+}
+
+static bool JsonLoopValue(JsonLoop &p)
+{
+    JsonLoopSpace(p);
+    if (p.i == p.len)
+    {
+        return false;
+    }
+    p.values++;
+    switch (p.s[p.i])
+    {
+    case '[':
+    case '{': {
+        const char close = p.s[p.i] == '[' ? ']' : '}';
+        p.i++;
+        JsonLoopSpace(p);
+        if (p.i < p.len && p.s[p.i] == close)
+        {
+            p.i++;
+            return true;
+        }
+        for (;;)
+        {
+            if (close == '}')
+            {
+                JsonLoopSpace(p);
+                if (p.i == p.len || p.s[p.i] != '"' || !JsonLoopString(p))
+                {
+                    return false;
+                }
+                JsonLoopSpace(p);
+                if (p.i == p.len || p.s[p.i++] != ':')
+                {
+                    return false;
+                }
+            }
+            if (!JsonLoopValue(p))
+            {
+                return false;
+            }
+            JsonLoopSpace(p);
+            if (p.i == p.len)
+            {
+                return false;
+            }
+            else if (p.s[p.i] == close)
+            {
+                p.i++;
+                return true;
+            }
+            else if (p.s[p.i++] != ',')
+            {
+                return false;
+            }
+        }
+    }
+    case '"':
+        return JsonLoopString(p);
+    default: {
+        const size_t start = p.i;
+        while (p.i < p.len && (std::isalnum((unsigned char)p.s[p.i]) || p.s[p.i] == '-' || p.s[p.i] == '+' ||
+                               p.s[p.i] == '.'))
+        {
+            p.i++;
+        }
+        return p.i != start;
+    }
+    }
+}
+
+static void Bench_json_recursive(benchmark::State &state)
+{
+    const std::string json = MakeJson(size_t(state.range(0)));
+    for (auto _ : state)
+    {
+        JsonLoop p = {json.data(), json.size(), 0, 0};
+        benchmark::DoNotOptimize(JsonLoopValue(p));
+        benchmark::DoNotOptimize(p.values);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(json.size()));
+}
+
+BENCHMARK(Bench_json_recursive)->RangeMultiplier(8)->Range(64, 65536 * 8);
+
+static void Bench_kr_json_index(benchmark::State &state)
+{
+    const std::string json = MakeJson(size_t(state.range(0)));
+    std::vector<size_t> index(json.size());
+    for (auto _ : state)
+    {
+        size_t count = 0;
+        benchmark::DoNotOptimize(kr_json_index(index.data(), &count, index.size(), json.data(), json.size()));
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(json.size()));
+}
+
+BENCHMARK(Bench_kr_json_index)->RangeMultiplier(8)->Range(64, 65536 * 8);
+
+static void Bench_kr_json_parse(benchmark::State &state)
+{
+    const std::string json = MakeJson(size_t(state.range(0)));
+    std::vector<size_t> index(json.size());
+    std::vector<kr_json_token_s> tape(json.size());
+    for (auto _ : state)
+    {
+        size_t count = 0;
+        benchmark::DoNotOptimize(kr_json_parse(tape.data(), &count, tape.size(), index.data(), index.size(),
+                                               json.data(), json.size()));
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(json.size()));
+}
+
+BENCHMARK(Bench_kr_json_parse)->RangeMultiplier(8)->Range(64, 65536 * 8);
+
+// Byte-at-a-time escaping, the way it usually gets written.
+static char *JsonEscapeLoop(char *dest, const char *src, size_t len)
+{
+    *dest++ = '"';
+    for (size_t i = 0; i < len; i++)
+    {
+        const unsigned char ch = (unsigned char)src[i];
+        if (ch == '"' || ch == '\\')
+        {
+            *dest++ = '\\';
+            *dest++ = (char)ch;
+        }
+        else if (ch < 0x20)
+        {
+            dest += std::sprintf(dest, "\\u%04x", ch);
+        }
+        else
+        {
+            *dest++ = (char)ch;
+        }
+    }
+    *dest++ = '"';
+    return dest;
+}
+
+static const char *const g_jsonMessages[] = {
+    "GET /api/v1/users/12345/preferences?include=notifications,theme HTTP/1.1 200 OK",
+    "connection reset by peer while reading response header from upstream",
+    "user said \"hello\" and left\n",
+    "C:\\Program Files\\Service\\logs\\service.log rotated",
+};
+
+static void Bench_json_write_snprintf(benchmark::State &state)
+{
+    std::vector<char> buf(1 << 20);
+    for (auto _ : state)
+    {
+        char *p = buf.data();
+        *p++ = '[';
+        for (int i = 0; i < 1000; i++)
+        {
+            const char *msg = g_jsonMessages[i % 4];
+            p += std::snprintf(p, 64, "%s{\"id\":%d,\"ts\":%.17g,\"msg\":", i ? "," : "", i, 1700000000.25 + i);
+            p = JsonEscapeLoop(p, msg, std::strlen(msg));
+            *p++ = '}';
+        }
+        *p++ = ']';
+        benchmark::DoNotOptimize(p);
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK(Bench_json_write_snprintf);
+
+static void Bench_kr_json_writer(benchmark::State &state)
+{
+    struct kr_json_writer_s w;
+    kr_json_writer_init(&w);
+    for (auto _ : state)
+    {
+        w.buf.len = 0;
+        w.comma = false;
+        kr_json_write_begin_array(&w);
+        for (int i = 0; i < 1000; i++)
+        {
+            const char *msg = g_jsonMessages[i % 4];
+            kr_json_write_begin_object(&w);
+            kr_json_write_key(&w, "id", 2);
+            kr_json_write_i64(&w, i);
+            kr_json_write_key(&w, "ts", 2);
+            kr_json_write_f64(&w, 1700000000.25 + i);
+            kr_json_write_key(&w, "msg", 3);
+            kr_json_write_string(&w, msg, std::strlen(msg));
+            kr_json_write_end_object(&w);
+        }
+        kr_json_write_end_array(&w);
+        benchmark::DoNotOptimize(w.buf.data);
+        benchmark::ClobberMemory();
+    }
+    kr_json_writer_destroy(&w);
+}
+
+BENCHMARK(Bench_kr_json_writer);
+
+static void Bench_json_escape_loop(benchmark::State &state)
+{
+    const std::string text = MakeAsciiText(4096);
+    std::vector<char> buf(text.size() * 6 + 2);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(JsonEscapeLoop(buf.data(), text.data(), text.size()));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+BENCHMARK(Bench_json_escape_loop);
+
+static void Bench_kr_json_write_string(benchmark::State &state)
+{
+    const std::string text = MakeAsciiText(4096);
+    std::vector<char> buf(text.size() * 6 + 2);
+    for (auto _ : state)
+    {
+        struct kr_json_writer_s w;
+        kr_json_writer_init_fixed(&w, buf.data(), buf.size());
+        benchmark::DoNotOptimize(kr_json_write_string(&w, text.data(), text.size()));
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+
+BENCHMARK(Bench_kr_json_write_string);
+
+static std::string MakeIni(size_t sections, size_t keys)
+{
+    std::string ini = "; generated\n";
+    char line[96];
+    for (size_t i = 0; i < sections; i++)
+    {
+        std::sprintf(line, "\n[section%zu]\n", i);
+        ini += line;
+        for (size_t j = 0; j < keys; j++)
+        {
+            std::sprintf(line, "%s  key%zu = value %zu of section %zu\r\n", j % 10 == 9 ? "# old\n" : "", j, j, i);
+            ini += line;
+        }
+    }
+    return ini;
+}
+
+struct IniLoopEntry
+{
+    char *section;
+    char *key;
+    char *value;
+};
+
+// Copy the file so it can be cut up with kr_strtok_r, then copy every key
+// and value out of it.
+static void IniLoopLoad(std::vector<IniLoopEntry> &entries, const std::string &ini)
+{
+    char *copy = kr_strdup(ini.c_str());
+    char *section = kr_strdup("");
+    char *save = nullptr;
+    for (char *line = kr_strtok_r(copy, "\r\n", &save); line != nullptr; line = kr_strtok_r(nullptr, "\r\n", &save))
+    {
+        while (std::isspace((unsigned char)*line))
+        {
+            line++;
+        }
+        char *end = line + std::strlen(line);
+        while (end > line && std::isspace((unsigned char)end[-1]))
+        {
+            *--end = '\0';
+        }
+
+        char *eq = std::strchr(line, '=');
+        if (*line == ';' || *line == '#' || *line == '\0')
+        {
+            continue;
+        }
+        else if (*line == '[')
+        {
+            std::free(section);
+            section = kr_strndup(line + 1, size_t(end - line - 2));
+        }
+        else if (eq != nullptr)
+        {
+            char *keyEnd = eq;
+            char *value = eq + 1;
+            while (keyEnd > line && std::isspace((unsigned char)keyEnd[-1]))
+            {
+                keyEnd--;
+            }
+            while (std::isspace((unsigned char)*value))
+            {
+                value++;
+            }
+            entries.push_back({kr_strdup(section), kr_strndup(line, size_t(keyEnd - line)), kr_strdup(value)});
+        }
+    }
+    std::free(section);
+    std::free(copy);
+}
+
+static void IniLoopFree(std::vector<IniLoopEntry> &entries)
+{
+    for (const IniLoopEntry &entry : entries)
+    {
+        std::free(entry.section);
+        std::free(entry.key);
+        std::free(entry.value);
+    }
+    entries.clear();
+}
+
+static void Bench_ini_strtok_load(benchmark::State &state)
+{
+    const std::string ini = MakeIni(size_t(state.range(0)), 50);
+    std::vector<IniLoopEntry> entries;
+    for (auto _ : state)
+    {
+        IniLoopLoad(entries, ini);
+        benchmark::DoNotOptimize(entries.data());
+        IniLoopFree(entries);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(ini.size()));
+}
+
+BENCHMARK(Bench_ini_strtok_load)->RangeMultiplier(4)->Range(1, 256);
+
+static void Bench_kr_ini_parse(benchmark::State &state)
+{
+    const std::string ini = MakeIni(size_t(state.range(0)), 50);
+    for (auto _ : state)
+    {
+        kr_ini_s index;
+        kr_ini_init(&index);
+        benchmark::DoNotOptimize(kr_ini_parse(&index, ini.data(), ini.size(), nullptr));
+        benchmark::DoNotOptimize(index.count);
+        kr_ini_destroy(&index);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(ini.size()));
+}
+
+BENCHMARK(Bench_kr_ini_parse)->RangeMultiplier(4)->Range(1, 256);
+
+static void Bench_ini_strtok_lookup(benchmark::State &state)
+{
+    const size_t sections = size_t(state.range(0));
+    const std::string ini = MakeIni(sections, 50);
+    std::vector<IniLoopEntry> entries;
+    char section[32], key[32];
+    size_t i = 0;
+    IniLoopLoad(entries, ini);
+    for (auto _ : state)
+    {
+        std::sprintf(section, "section%zu", (i * 2654435761u >> 8) % sections);
+        std::sprintf(key, "key%zu", i++ % 50);
+        const IniLoopEntry *found = nullptr;
+        for (const IniLoopEntry &entry : entries)
+        {
+            if (std::strcmp(entry.key, key) == 0 && std::strcmp(entry.section, section) == 0)
+            {
+                found = &entry;
+            }
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    IniLoopFree(entries);
+}
+
+BENCHMARK(Bench_ini_strtok_lookup)->RangeMultiplier(4)->Range(1, 256);
+
+static void Bench_kr_ini_get(benchmark::State &state)
+{
+    const size_t sections = size_t(state.range(0));
+    const std::string ini = MakeIni(sections, 50);
+    kr_ini_s index;
+    char section[32], key[32];
+    size_t i = 0;
+    kr_ini_init(&index);
+    kr_ini_parse(&index, ini.data(), ini.size(), nullptr);
+    for (auto _ : state)
+    {
+        std::sprintf(section, "section%zu", (i * 2654435761u >> 8) % sections);
+        std::sprintf(key, "key%zu", i++ % 50);
+        benchmark::DoNotOptimize(kr_ini_get(&index, section, key, nullptr));
+    }
+    kr_ini_destroy(&index);
+}
+
+BENCHMARK(Bench_kr_ini_get)->RangeMultiplier(4)->Range(1, 256);
+
 BENCHMARK_MAIN();
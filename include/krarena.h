@@ -0,0 +1,349 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * Bump-pointer arena allocator
+ *
+ * Hands out memory from large chunks by bumping a pointer, and frees
+ * everything at once.  Good for lots of small allocations that all have the
+ * same lifetime, such as every string belonging to a single request.
+ *
+ * Chunks are obtained with KR_MALLOC and released with KR_FREE.
+ */
+
+#if !defined(KRARENA_H)
+#define KRARENA_H
+
+#include "./krconfig.h"
+
+#include "./krbool.h"
+#include "./krint.h"
+#include "./krstr.h"
+
+#if (!KR_CONFIG_NOINCLUDE)
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+/**
+ * @brief Default size of arena chunks.
+ */
+#define KR_ARENA_CHUNK_SIZE 4096
+
+/**
+ * @brief An arena allocator.
+ *
+ * @details A zero-initialized arena is a valid empty arena that uses the
+ *          default chunk size.
+ */
+struct kr_arena_s
+{
+    void *chunks;     /* Linked list of chunks, newest first. */
+    void *current;    /* Chunk being bumped from. */
+    char *pos;        /* Next free byte in current chunk. */
+    size_t left;      /* Free bytes in current chunk. */
+    size_t chunkSize; /* Size of new chunks, 0 for KR_ARENA_CHUNK_SIZE. */
+};
+
+/**
+ * @brief Initialize an empty arena.
+ *
+ * @details Does not allocate.
+ *
+ * @param arena Arena to initialize.
+ * @param chunkSize Size of each chunk, or 0 for KR_ARENA_CHUNK_SIZE.
+ *                  Allocations bigger than a quarter of this get a chunk of
+ *                  their own.
+ */
+KR_INLINE void kr_arena_init(struct kr_arena_s *arena, size_t chunkSize);
+
+/**
+ * @brief Free every chunk owned by an arena.
+ *
+ * @param arena Arena to destroy.  It can be used again afterwards.
+ */
+KR_INLINE void kr_arena_destroy(struct kr_arena_s *arena);
+
+/**
+ * @brief Free every allocation made from an arena at once.
+ *
+ * @details Keeps one chunk around so the arena can be reused without going
+ *          back to KR_MALLOC right away.
+ *
+ * @param arena Arena to reset.
+ */
+KR_INLINE void kr_arena_reset(struct kr_arena_s *arena);
+
+/**
+ * @brief Allocate memory from an arena, aligned for any type.
+ *
+ * @param arena Arena to allocate from.
+ * @param size Number of bytes to allocate.
+ * @return Pointer to allocation, or NULL if memory could not be allocated.
+ *         Valid until the arena is reset or destroyed.
+ */
+KR_NODISCARD KR_INLINE void *kr_arena_alloc(struct kr_arena_s *arena, size_t size);
+
+/**
+ * @brief Allocate memory from an arena with no alignment.
+ *
+ * @details Packs strings and other byte data without padding.
+ *
+ * @param arena Arena to allocate from.
+ * @param size Number of bytes to allocate.
+ * @return Pointer to allocation, or NULL if memory could not be allocated.
+ *         Valid until the arena is reset or destroyed.
+ */
+KR_NODISCARD KR_INLINE void *kr_arena_alloc_unaligned(struct kr_arena_s *arena, size_t size);
+
+/**
+ * @brief Duplicate a buffer into an arena.
+ *
+ * @param arena Arena to allocate from.
+ * @param src Buffer to duplicate.
+ * @param len Number of bytes to duplicate.
+ * @return Copy of buffer, aligned for any type, or NULL if memory could not
+ *         be allocated.
+ */
+KR_NODISCARD KR_INLINE void *kr_arena_memdup(struct kr_arena_s *arena, const void *src, size_t len);
+
+/**
+ * @brief Duplicate a string into an arena.
+ *
+ * @param arena Arena to allocate from.
+ * @param str String to duplicate.
+ * @return Copy of string, or NULL if memory could not be allocated.
+ */
+KR_NODISCARD KR_INLINE char *kr_arena_strdup(struct kr_arena_s *arena, const char *str);
+
+/**
+ * @brief Duplicate a string into an arena up to len characters.
+ *
+ * @param arena Arena to allocate from.
+ * @param str String to duplicate.
+ * @param len Maximum number of characters to copy.
+ * @return Copy of string, always terminated, or NULL if memory could not be
+ *         allocated.
+ */
+KR_NODISCARD KR_INLINE char *kr_arena_strndup(struct kr_arena_s *arena, const char *str, size_t len);
+
+/******************************************************************************/
+#if !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION)
+/******************************************************************************/
+
+/* Strictest alignment of any ordinary type. */
+union kr_arena_align_u_
+{
+    long l;
+    double d;
+    long double ld;
+    void *p;
+    void (*fn)(void);
+};
+
+/* Chunk header, data follows it. */
+union kr_arena_chunk_u_
+{
+    struct
+    {
+        void *next;
+        size_t size;
+    } h;
+    union kr_arena_align_u_ align;
+};
+
+#define KR_ARENA_ALIGN_ (sizeof(union kr_arena_align_u_))
+
+KR_INLINE void kr_arena_init(struct kr_arena_s *arena, size_t chunkSize)
+{
+    arena->chunks = NULL;
+    arena->current = NULL;
+    arena->pos = NULL;
+    arena->left = 0;
+    arena->chunkSize = chunkSize;
+}
+
+KR_INLINE void kr_arena_destroy(struct kr_arena_s *arena)
+{
+    union kr_arena_chunk_u_ *chunk = KR_CASTS(union kr_arena_chunk_u_ *, arena->chunks);
+
+    while (chunk != NULL)
+    {
+        union kr_arena_chunk_u_ *next = KR_CASTS(union kr_arena_chunk_u_ *, chunk->h.next);
+        KR_FREE(chunk);
+        chunk = next;
+    }
+
+    kr_arena_init(arena, arena->chunkSize);
+}
+
+KR_INLINE void kr_arena_reset(struct kr_arena_s *arena)
+{
+    union kr_arena_chunk_u_ *current = KR_CASTS(union kr_arena_chunk_u_ *, arena->current);
+    union kr_arena_chunk_u_ *chunk = KR_CASTS(union kr_arena_chunk_u_ *, arena->chunks);
+
+    while (chunk != NULL)
+    {
+        union kr_arena_chunk_u_ *next = KR_CASTS(union kr_arena_chunk_u_ *, chunk->h.next);
+        if (chunk != current)
+        {
+            KR_FREE(chunk);
+        }
+        chunk = next;
+    }
+
+    arena->chunks = current;
+    if (current != NULL)
+    {
+        current->h.next = NULL;
+        arena->pos = KR_CASTR(char *, current + 1);
+        arena->left = current->h.size;
+    }
+}
+
+/* Allocate a fresh chunk with room for at least size bytes. */
+KR_INLINE void *kr_arena_chunk_(struct kr_arena_s *arena, size_t size)
+{
+    const size_t chunkSize = arena->chunkSize != 0 ? arena->chunkSize : KR_ARENA_CHUNK_SIZE;
+    union kr_arena_chunk_u_ *chunk = NULL;
+    bool big = size > chunkSize / 4;
+
+    if (big)
+    {
+        if (size > KR_CASTS(size_t, -1) - sizeof(*chunk))
+        {
+            return NULL;
+        }
+    }
+    else
+    {
+        size = chunkSize;
+    }
+
+    chunk = KR_CASTS(union kr_arena_chunk_u_ *, KR_MALLOC(sizeof(*chunk) + size));
+    if (chunk == NULL)
+    {
+        return NULL;
+    }
+
+    chunk->h.next = arena->chunks;
+    chunk->h.size = size;
+    arena->chunks = chunk;
+
+    /* Big allocations get used up entirely, keep bumping the current chunk
+       since it probably still has room. */
+    if (!big)
+    {
+        arena->current = chunk;
+        arena->pos = KR_CASTR(char *, chunk + 1);
+        arena->left = size;
+    }
+    return chunk + 1;
+}
+
+KR_NODISCARD KR_INLINE void *kr_arena_alloc(struct kr_arena_s *arena, size_t size)
+{
+    const size_t pad = (KR_ARENA_ALIGN_ - KR_CASTR(uintptr_t, arena->pos) % KR_ARENA_ALIGN_) % KR_ARENA_ALIGN_;
+    void *ptr = NULL;
+
+    if (size > KR_CASTS(size_t, -1) - KR_ARENA_ALIGN_)
+    {
+        return NULL;
+    }
+
+    /* Round up so the next aligned allocation needs no padding. */
+    size = (size + KR_ARENA_ALIGN_ - 1) / KR_ARENA_ALIGN_ * KR_ARENA_ALIGN_;
+    if (arena->pos == NULL || size > arena->left || pad > arena->left - size)
+    {
+        /* Chunk data is already aligned. */
+        ptr = kr_arena_chunk_(arena, size);
+        if (ptr == NULL || arena->pos != ptr)
+        {
+            return ptr;
+        }
+    }
+    else
+    {
+        arena->pos += pad;
+        arena->left -= pad;
+    }
+
+    ptr = arena->pos;
+    arena->pos += size;
+    arena->left -= size;
+    return ptr;
+}
+
+KR_NODISCARD KR_INLINE void *kr_arena_alloc_unaligned(struct kr_arena_s *arena, size_t size)
+{
+    void *ptr = NULL;
+
+    if (arena->pos == NULL || size > arena->left)
+    {
+        ptr = kr_arena_chunk_(arena, size);
+        if (ptr == NULL || arena->pos != ptr)
+        {
+            return ptr;
+        }
+    }
+
+    ptr = arena->pos;
+    arena->pos += size;
+    arena->left -= size;
+    return ptr;
+}
+
+KR_NODISCARD KR_INLINE void *kr_arena_memdup(struct kr_arena_s *arena, const void *src, size_t len)
+{
+    void *dup = kr_arena_alloc(arena, len);
+    if (dup == NULL)
+    {
+        return NULL;
+    }
+
+    memcpy(dup, src, len);
+    return dup;
+}
+
+/* Copy exactly len bytes and terminate. */
+KR_INLINE char *kr_arena_strcopy_(struct kr_arena_s *arena, const char *str, size_t len)
+{
+    char *dup = NULL;
+
+    if (len == KR_CASTS(size_t, -1))
+    {
+        return NULL;
+    }
+
+    dup = KR_CASTS(char *, kr_arena_alloc_unaligned(arena, len + 1));
+    if (dup == NULL)
+    {
+        return NULL;
+    }
+
+    memcpy(dup, str, len);
+    dup[len] = '\0';
+    return dup;
+}
+
+KR_NODISCARD KR_INLINE char *kr_arena_strdup(struct kr_arena_s *arena, const char *str)
+{
+    return kr_arena_strcopy_(arena, str, kr_strlen(str));
+}
+
+KR_NODISCARD KR_INLINE char *kr_arena_strndup(struct kr_arena_s *arena, const char *str, size_t len)
+{
+    return kr_arena_strcopy_(arena, str, kr_strnlen(str, len));
+}
+
+#undef KR_ARENA_ALIGN_
+
+#endif /* !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION) */
+
+#endif /* !defined(KRARENA_H) */
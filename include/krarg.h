@@ -15,7 +15,9 @@
 #include <stdarg.h>
 #endif
 
-#if !defined(va_copy)
+#if !defined(va_copy) && defined(__va_copy)
+#define va_copy(dest, src) __va_copy(dest, src)
+#elif !defined(va_copy)
 #define va_copy(dest, src) ((dest) = (src))
 #endif /* !defined(va_copy) */
 
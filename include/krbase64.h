@@ -0,0 +1,938 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * Base64 encoding
+ *
+ * Both the standard alphabet and the URL and filename safe alphabet from
+ * RFC 4648 are supported, with or without padding.  Decoding is strict:
+ * anything outside the alphabet, including whitespace, is an error, padding
+ * has to be exactly where it belongs, and the unused bits of a final group
+ * have to be zero, so every byte string has exactly one valid encoding.
+ *
+ * The scalar code converts a group at a time through lookup tables, and
+ * moves whole words in and out with krserial.h.  The SIMD code translates
+ * between characters and 6-bit values with a handful of compares, and
+ * packs or unpacks the bits with multiplies and a shuffle, using SSSE3 for
+ * 16 characters at a time or AVX2 for 32.
+ *
+ * The streaming functions accept input split at any point, carrying an
+ * incomplete group over to the next call.
+ *
+ * @link https://datatracker.ietf.org/doc/html/rfc4648
+ * @link https://arxiv.org/abs/1704.00605
+ */
+
+#if !defined(KRBASE64_H)
+#define KRBASE64_H
+
+#include "./krconfig.h"
+
+#include "./krbool.h"
+#include "./krint.h"
+#include "./krserial.h"
+
+#if (!KR_CONFIG_NOINCLUDE)
+#include <stddef.h>
+#include <string.h>
+#endif
+
+#if (KR_AVX2)
+#include <immintrin.h>
+#elif (KR_SSSE3)
+#include <tmmintrin.h>
+#elif (KR_SSE2)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief Use the URL and filename safe alphabet, which has '-' and '_' in
+ *        place of '+' and '/'.
+ */
+#define KR_BASE64_URL 0x1
+
+/**
+ * @brief Don't write padding when encoding, and reject it when decoding.
+ *
+ * @details Without this flag, padding is always written, and a final group
+ *          that is missing it is rejected.
+ */
+#define KR_BASE64_NOPAD 0x2
+
+/**
+ * @brief Buffer size that fits len bytes once encoded, not including a
+ *        terminator.
+ */
+#define KR_BASE64_ENCODE_SIZE(len) (((len) + 2) / 3 * 4)
+
+/**
+ * @brief Buffer size that fits len characters once decoded.
+ */
+#define KR_BASE64_DECODE_SIZE(len) (((len) + 3) / 4 * 3)
+
+struct kr_base64_encode_ctx_s
+{
+    unsigned flags;         /* KR_BASE64_* flags. */
+    unsigned count;         /* Number of bytes in carry. */
+    unsigned char carry[3]; /* Start of a group split across chunks. */
+};
+
+struct kr_base64_decode_ctx_s
+{
+    unsigned flags; /* KR_BASE64_* flags. */
+    unsigned count; /* Number of characters in carry. */
+    char carry[4];  /* Start of a group split across chunks. */
+    bool done;      /* Saw a padded group, nothing else can follow. */
+};
+
+/**
+ * @brief Encode bytes as Base64.
+ *
+ * @details Dispatches to the fastest of the variants below that the compiler
+ *          targets.
+ *
+ * @param dest Destination buffer, at least KR_BASE64_ENCODE_SIZE(len) bytes.
+ *             Not terminated.
+ * @param src Bytes to encode.
+ * @param len Number of bytes to encode.
+ * @param flags KR_BASE64_* flags.
+ * @return Number of characters written.
+ */
+KR_INLINE size_t kr_base64_encode(char *dest, const void *src, size_t len, unsigned flags);
+
+/**
+ * @brief Encode bytes as Base64, 6 bytes at a time through a lookup table.
+ */
+KR_INLINE size_t kr_base64_encode_scalar(char *dest, const void *src, size_t len, unsigned flags);
+
+#if (KR_SSSE3)
+
+/**
+ * @brief Encode bytes as Base64, 12 bytes at a time with SSSE3.
+ */
+KR_INLINE size_t kr_base64_encode_ssse3(char *dest, const void *src, size_t len, unsigned flags);
+
+#endif /* (KR_SSSE3) */
+
+#if (KR_AVX2)
+
+/**
+ * @brief Encode bytes as Base64, 24 bytes at a time with AVX2.
+ */
+KR_INLINE size_t kr_base64_encode_avx2(char *dest, const void *src, size_t len, unsigned flags);
+
+#endif /* (KR_AVX2) */
+
+/**
+ * @brief Decode Base64 into bytes.
+ *
+ * @details Dispatches to the fastest of the variants below that the compiler
+ *          targets.  On failure, every whole group before the first invalid
+ *          one is still decoded.
+ *
+ * @param dest Destination buffer, at least KR_BASE64_DECODE_SIZE(len) bytes.
+ *             Bytes past the ones decoded might be overwritten.
+ * @param outLen Output number of bytes decoded.
+ * @param src Characters to decode, which do not need to be terminated.
+ * @param len Number of characters to decode.
+ * @param flags KR_BASE64_* flags.
+ * @return True if src was entirely valid, otherwise false.
+ */
+KR_INLINE bool kr_base64_decode(void *dest, size_t *outLen, const char *src, size_t len, unsigned flags);
+
+/**
+ * @brief Decode Base64 into bytes, 4 characters at a time through a lookup
+ *        table.
+ */
+KR_INLINE bool kr_base64_decode_scalar(void *dest, size_t *outLen, const char *src, size_t len, unsigned flags);
+
+#if (KR_SSSE3)
+
+/**
+ * @brief Decode Base64 into bytes, 16 characters at a time with SSSE3.
+ */
+KR_INLINE bool kr_base64_decode_ssse3(void *dest, size_t *outLen, const char *src, size_t len, unsigned flags);
+
+#endif /* (KR_SSSE3) */
+
+#if (KR_AVX2)
+
+/**
+ * @brief Decode Base64 into bytes, 32 characters at a time with AVX2.
+ */
+KR_INLINE bool kr_base64_decode_avx2(void *dest, size_t *outLen, const char *src, size_t len, unsigned flags);
+
+#endif /* (KR_AVX2) */
+
+/**
+ * @brief Start encoding a stream of chunks.
+ *
+ * @param ctx Context to initialize.
+ * @param flags KR_BASE64_* flags.
+ */
+KR_INLINE void kr_base64_encode_init(struct kr_base64_encode_ctx_s *ctx, unsigned flags);
+
+/**
+ * @brief Encode the next chunk of a stream.
+ *
+ * @details Up to two bytes that don't make up a whole group are held back
+ *          until the next chunk or kr_base64_encode_final.
+ *
+ * @param ctx Context to encode with.
+ * @param dest Destination buffer, at least KR_BASE64_ENCODE_SIZE(len) bytes.
+ * @param src Bytes to encode.
+ * @param len Number of bytes to encode.
+ * @return Number of characters written.
+ */
+KR_INLINE size_t kr_base64_encode_update(struct kr_base64_encode_ctx_s *ctx, char *dest, const void *src, size_t len);
+
+/**
+ * @brief Finish encoding a stream.
+ *
+ * @param ctx Context to finish, which can be reused after calling
+ *            kr_base64_encode_init again.
+ * @param dest Destination buffer, at least 4 bytes.
+ * @return Number of characters written.
+ */
+KR_INLINE size_t kr_base64_encode_final(struct kr_base64_encode_ctx_s *ctx, char *dest);
+
+/**
+ * @brief Start decoding a stream of chunks.
+ *
+ * @param ctx Context to initialize.
+ * @param flags KR_BASE64_* flags.
+ */
+KR_INLINE void kr_base64_decode_init(struct kr_base64_decode_ctx_s *ctx, unsigned flags);
+
+/**
+ * @brief Decode the next chunk of a stream.
+ *
+ * @details Up to three characters that don't make up a whole group are held
+ *          back until the next chunk or kr_base64_decode_final, so an error
+ *          in them is reported by that call.  Once this returns false, the
+ *          rest of the stream can't be decoded.
+ *
+ * @param ctx Context to decode with.
+ * @param dest Destination buffer, at least KR_BASE64_DECODE_SIZE(len) bytes.
+ *             Bytes past the ones decoded might be overwritten.
+ * @param outLen Output number of bytes decoded.
+ * @param src Characters to decode.
+ * @param len Number of characters to decode.
+ * @return True if the chunk was valid so far, otherwise false.
+ */
+KR_INLINE bool kr_base64_decode_update(struct kr_base64_decode_ctx_s *ctx, void *dest, size_t *outLen, const char *src,
+                                       size_t len);
+
+/**
+ * @brief Finish decoding a stream.
+ *
+ * @param ctx Context to finish, which can be reused after calling
+ *            kr_base64_decode_init again.
+ * @param dest Destination buffer, at least 2 bytes.
+ * @param outLen Output number of bytes decoded.
+ * @return True if the stream ended in the right place, otherwise false.
+ */
+KR_INLINE bool kr_base64_decode_final(struct kr_base64_decode_ctx_s *ctx, void *dest, size_t *outLen);
+
+/******************************************************************************/
+#if !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION)
+/******************************************************************************/
+
+KR_INLINE const char *kr_base64_alphabet_(unsigned flags)
+{
+    return (flags & KR_BASE64_URL) != 0 ? "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+                                        : "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+}
+
+/* Value of every character, 0xFF if it isn't in the alphabet. */
+KR_INLINE const unsigned char *kr_base64_values_(unsigned flags)
+{
+    static const unsigned char standard[256] = {
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+        0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+        0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+        0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    };
+    static const unsigned char url[256] = {
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF,
+        0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+        0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0x3F,
+        0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+        0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    };
+    return (flags & KR_BASE64_URL) != 0 ? url : standard;
+}
+
+#define KR_BASE64_VALUE_(ch) KR_CASTS(uint32_t, values[KR_CASTS(unsigned char, ch)])
+
+#define KR_BASE64_CHAR_(word, shift) KR_CASTS(uint64_t, KR_CASTS(unsigned char, alphabet[((word) >> (shift)) & 0x3F]))
+
+/* Encode whole groups from byte i onwards, returns the bytes consumed. */
+KR_INLINE size_t kr_base64_encode_scalar_(char *dest, const unsigned char *src, size_t i, size_t len,
+                                          const char *alphabet)
+{
+    uint32_t bits = 0;
+#if defined(UINT64_MAX)
+    uint64_t word = 0, chars = 0;
+
+    /* Two groups per 8-byte load. */
+    for (; len - i >= 8; i += 6)
+    {
+        word = kr_load_u64be(KR_CASTC(unsigned char *, src + i));
+        chars = KR_BASE64_CHAR_(word, 58) | (KR_BASE64_CHAR_(word, 52) << 8) | (KR_BASE64_CHAR_(word, 46) << 16) |
+                (KR_BASE64_CHAR_(word, 40) << 24) | (KR_BASE64_CHAR_(word, 34) << 32) |
+                (KR_BASE64_CHAR_(word, 28) << 40) | (KR_BASE64_CHAR_(word, 22) << 48) |
+                (KR_BASE64_CHAR_(word, 16) << 56);
+        kr_store_u64le(dest + i / 3 * 4, chars);
+    }
+#endif
+
+    for (; len - i >= 3; i += 3)
+    {
+        bits = (KR_CASTS(uint32_t, src[i]) << 16) | (KR_CASTS(uint32_t, src[i + 1]) << 8) | src[i + 2];
+        dest[i / 3 * 4] = alphabet[bits >> 18];
+        dest[i / 3 * 4 + 1] = alphabet[(bits >> 12) & 0x3F];
+        dest[i / 3 * 4 + 2] = alphabet[(bits >> 6) & 0x3F];
+        dest[i / 3 * 4 + 3] = alphabet[bits & 0x3F];
+    }
+    return i;
+}
+
+/* Encode the last one or two bytes, padded unless told otherwise. */
+KR_INLINE size_t kr_base64_encode_last_(char *dest, const unsigned char *src, size_t len, unsigned flags)
+{
+    const char *alphabet = kr_base64_alphabet_(flags);
+    uint32_t bits = 0;
+
+    if (len == 0)
+    {
+        return 0;
+    }
+
+    bits = (KR_CASTS(uint32_t, src[0]) << 16) | (len > 1 ? KR_CASTS(uint32_t, src[1]) << 8 : 0);
+    dest[0] = alphabet[bits >> 18];
+    dest[1] = alphabet[(bits >> 12) & 0x3F];
+    if (len > 1)
+    {
+        dest[2] = alphabet[(bits >> 6) & 0x3F];
+    }
+    if ((flags & KR_BASE64_NOPAD) != 0)
+    {
+        return len + 1;
+    }
+    if (len == 1)
+    {
+        dest[2] = '=';
+    }
+    dest[3] = '=';
+    return 4;
+}
+
+/* Decode whole groups from character i onwards, returns the characters
+   consumed.  Stops at the first group that isn't four alphabet characters. */
+KR_INLINE size_t kr_base64_decode_scalar_(unsigned char *dest, const char *src, size_t i, size_t len, unsigned flags)
+{
+    const unsigned char *values = kr_base64_values_(flags);
+    uint32_t a = 0, b = 0, c = 0, d = 0, bits = 0;
+#if defined(UINT64_MAX)
+    uint32_t first = 0;
+
+    /* Two groups per 8-byte store, which has room for two spare bytes as
+       long as another group follows. */
+    for (; len - i >= 12; i += 8)
+    {
+        a = KR_BASE64_VALUE_(src[i]);
+        b = KR_BASE64_VALUE_(src[i + 1]);
+        c = KR_BASE64_VALUE_(src[i + 2]);
+        d = KR_BASE64_VALUE_(src[i + 3]);
+        first = (a << 18) | (b << 12) | (c << 6) | d;
+        bits = a | b | c | d;
+
+        a = KR_BASE64_VALUE_(src[i + 4]);
+        b = KR_BASE64_VALUE_(src[i + 5]);
+        c = KR_BASE64_VALUE_(src[i + 6]);
+        d = KR_BASE64_VALUE_(src[i + 7]);
+        if (((bits | a | b | c | d) & 0x80) != 0)
+        {
+            break;
+        }
+
+        bits = (a << 18) | (b << 12) | (c << 6) | d;
+        kr_store_u64be(dest + i / 4 * 3, (KR_CASTS(uint64_t, first) << 40) | (KR_CASTS(uint64_t, bits) << 16));
+    }
+#endif
+
+    for (; len - i >= 4; i += 4)
+    {
+        a = KR_BASE64_VALUE_(src[i]);
+        b = KR_BASE64_VALUE_(src[i + 1]);
+        c = KR_BASE64_VALUE_(src[i + 2]);
+        d = KR_BASE64_VALUE_(src[i + 3]);
+        if (((a | b | c | d) & 0x80) != 0)
+        {
+            break;
+        }
+
+        bits = (a << 18) | (b << 12) | (c << 6) | d;
+        if (len - i >= 8)
+        {
+            /* The buffer has room for a spare byte while more groups follow. */
+            kr_store_u32be(dest + i / 4 * 3, bits << 8);
+        }
+        else
+        {
+            dest[i / 4 * 3] = KR_CASTS(unsigned char, bits >> 16);
+            dest[i / 4 * 3 + 1] = KR_CASTS(unsigned char, bits >> 8);
+            dest[i / 4 * 3 + 2] = KR_CASTS(unsigned char, bits);
+        }
+    }
+    return i;
+}
+
+/*
+ * Decode a final group of up to four characters, which is short or padded
+ * depending on the flags.  The bits past the last whole byte must be zero.
+ */
+KR_INLINE bool kr_base64_decode_last_(unsigned char *dest, size_t *outCount, const char *src, size_t len,
+                                      unsigned flags)
+{
+    const unsigned char *values = kr_base64_values_(flags);
+    uint32_t bits = 0, value = 0;
+    size_t i = 0, spare = 0;
+
+    *outCount = 0;
+    if (len == 0)
+    {
+        return true;
+    }
+
+    if ((flags & KR_BASE64_NOPAD) == 0)
+    {
+        if (len != 4)
+        {
+            return false;
+        }
+        if (src[3] == '=')
+        {
+            len = src[2] == '=' ? 2 : 3;
+        }
+    }
+    if (len < 2)
+    {
+        return false;
+    }
+
+    for (i = 0; i < len; i++)
+    {
+        value = KR_BASE64_VALUE_(src[i]);
+        if ((value & 0x80) != 0)
+        {
+            return false;
+        }
+        bits = (bits << 6) | value;
+    }
+
+    spare = len * 6 % 8;
+    if ((bits & ((KR_CASTS(uint32_t, 1) << spare) - 1)) != 0)
+    {
+        return false;
+    }
+
+    bits >>= spare;
+    for (i = len - 1; i > 0; i--)
+    {
+        dest[i - 1] = KR_CASTS(unsigned char, bits);
+        bits >>= 8;
+    }
+    *outCount = len - 1;
+    return true;
+}
+
+/* Decode the end of a buffer after its whole groups.  A valid group here is
+   padded or short, so it has to be the last one. */
+KR_INLINE bool kr_base64_decode_end_(unsigned char *dest, size_t *outLen, const char *src, size_t i, size_t len,
+                                     unsigned flags)
+{
+    size_t count = 0;
+    const bool ok = kr_base64_decode_last_(dest + i / 4 * 3, &count, src + i, len - i < 4 ? len - i : 4, flags);
+
+    *outLen = i / 4 * 3 + count;
+    return ok && len - i <= 4;
+}
+
+#if (KR_SSSE3)
+
+/*
+ * Offsets added to 0-25, 26-51, 52-61 and the last two values to turn them
+ * into characters, indexed by the values squeezed down to 0 through 13.
+ */
+KR_INLINE __m128i kr_base64_shift16_(const char *alphabet)
+{
+    return _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                         '0' - 52, '0' - 52, KR_CASTS(char, alphabet[62] - 62), KR_CASTS(char, alphabet[63] - 63),
+                         'A', 0, 0);
+}
+
+/*
+ * Encode the 12 bytes at the bottom of a register.  Each group of 3 bytes
+ * is shuffled into a 32-bit lane, then multiplies shift each 6-bit value
+ * into a byte of its own.
+ */
+KR_INLINE __m128i kr_base64_encode16_(__m128i v, __m128i shift)
+{
+    const __m128i bytes = _mm_shuffle_epi8(v, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+    const __m128i ac = _mm_mulhi_epu16(_mm_and_si128(bytes, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+    const __m128i bd = _mm_mullo_epi16(_mm_and_si128(bytes, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+    const __m128i indices = _mm_or_si128(ac, bd);
+
+    /* 0-25 become 13, 26-51 become 0, and 52-63 become 1-12. */
+    const __m128i reduced = _mm_or_si128(_mm_subs_epu8(indices, _mm_set1_epi8(51)),
+                                         _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+    return _mm_add_epi8(indices, _mm_shuffle_epi8(shift, reduced));
+}
+
+KR_INLINE size_t kr_base64_encode_ssse3_(char *dest, const unsigned char *src, size_t i, size_t len,
+                                         const char *alphabet)
+{
+    const __m128i shift = kr_base64_shift16_(alphabet);
+
+    /* Loads are 16 bytes wide for 12 bytes of input. */
+    for (; len - i >= 16; i += 12)
+    {
+        _mm_storeu_si128(KR_CASTR(__m128i *, dest + i / 3 * 4),
+                         kr_base64_encode16_(_mm_loadu_si128(KR_CASTR(const __m128i *, src + i)), shift));
+    }
+
+    return kr_base64_encode_scalar_(dest, src, i, len, alphabet);
+}
+
+/* All ones in every byte between lo and hi inclusive, as in krstr.h. */
+KR_INLINE __m128i kr_base64_range16_(__m128i v, char lo, char hi)
+{
+    return _mm_cmpgt_epi8(_mm_set1_epi8(KR_CASTS(char, hi - lo - 0x7F)),
+                          _mm_sub_epi8(v, _mm_set1_epi8(KR_CASTS(char, lo + 0x80))));
+}
+
+/*
+ * Convert 16 characters to their 6-bit values, or return false if any of
+ * them isn't in the alphabet.  Every range has a nonzero offset, so a zero
+ * offset is a character that wasn't in any of them.
+ */
+KR_INLINE bool kr_base64_values16_(__m128i v, __m128i c62, __m128i c63, __m128i *outValues)
+{
+    __m128i offset = _mm_and_si128(kr_base64_range16_(v, 'A', 'Z'), _mm_set1_epi8(-'A'));
+    offset = _mm_or_si128(offset, _mm_and_si128(kr_base64_range16_(v, 'a', 'z'), _mm_set1_epi8(26 - 'a')));
+    offset = _mm_or_si128(offset, _mm_and_si128(kr_base64_range16_(v, '0', '9'), _mm_set1_epi8(52 - '0')));
+    offset = _mm_or_si128(offset, _mm_and_si128(_mm_cmpeq_epi8(v, c62), _mm_sub_epi8(_mm_set1_epi8(62), c62)));
+    offset = _mm_or_si128(offset, _mm_and_si128(_mm_cmpeq_epi8(v, c63), _mm_sub_epi8(_mm_set1_epi8(63), c63)));
+
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(offset, _mm_setzero_si128())) != 0)
+    {
+        return false;
+    }
+
+    *outValues = _mm_add_epi8(v, offset);
+    return true;
+}
+
+/*
+ * Pack 16 6-bit values into 12 bytes at the bottom of the register.  The
+ * multiplies combine pairs of values and then pairs of pairs, leaving each
+ * group of 3 bytes in a 32-bit lane in the wrong order.
+ */
+KR_INLINE __m128i kr_base64_pack16_(__m128i values)
+{
+    const __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    const __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    return _mm_shuffle_epi8(groups, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+}
+
+KR_INLINE size_t kr_base64_decode_ssse3_(unsigned char *dest, const char *src, size_t i, size_t len, unsigned flags)
+{
+    const char *alphabet = kr_base64_alphabet_(flags);
+    const __m128i c62 = _mm_set1_epi8(alphabet[62]);
+    const __m128i c63 = _mm_set1_epi8(alphabet[63]);
+    __m128i values, bytes;
+    int last = 0;
+
+    for (; len - i >= 16; i += 16)
+    {
+        if (!kr_base64_values16_(_mm_loadu_si128(KR_CASTR(const __m128i *, src + i)), c62, c63, &values))
+        {
+            break;
+        }
+
+        /* Exactly 12 bytes, the buffer might not have room for more. */
+        bytes = kr_base64_pack16_(values);
+        last = _mm_cvtsi128_si32(_mm_srli_si128(bytes, 8));
+        _mm_storel_epi64(KR_CASTR(__m128i *, dest + i / 4 * 3), bytes);
+        memcpy(dest + i / 4 * 3 + 8, &last, 4);
+    }
+
+    return kr_base64_decode_scalar_(dest, src, i, len, flags);
+}
+
+#endif /* (KR_SSSE3) */
+
+#if (KR_AVX2)
+
+KR_INLINE __m256i kr_base64_encode32_(__m256i v, __m256i shift)
+{
+    const __m256i bytes = _mm256_shuffle_epi8(v, _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1,
+                                                                  0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+    const __m256i ac =
+        _mm256_mulhi_epu16(_mm256_and_si256(bytes, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+    const __m256i bd =
+        _mm256_mullo_epi16(_mm256_and_si256(bytes, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+    const __m256i indices = _mm256_or_si256(ac, bd);
+    const __m256i reduced =
+        _mm256_or_si256(_mm256_subs_epu8(indices, _mm256_set1_epi8(51)),
+                        _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+    return _mm256_add_epi8(indices, _mm256_shuffle_epi8(shift, reduced));
+}
+
+KR_INLINE size_t kr_base64_encode_avx2_(char *dest, const unsigned char *src, size_t i, size_t len,
+                                        const char *alphabet)
+{
+    const __m256i shift = _mm256_broadcastsi128_si256(kr_base64_shift16_(alphabet));
+    __m256i v;
+
+    /* Each lane takes 12 bytes, the upper load reads 16 bytes from 12. */
+    for (; len - i >= 28; i += 24)
+    {
+        v = _mm256_castsi128_si256(_mm_loadu_si128(KR_CASTR(const __m128i *, src + i)));
+        v = _mm256_inserti128_si256(v, _mm_loadu_si128(KR_CASTR(const __m128i *, src + i + 12)), 1);
+        _mm256_storeu_si256(KR_CASTR(__m256i *, dest + i / 3 * 4), kr_base64_encode32_(v, shift));
+    }
+
+    return kr_base64_encode_ssse3_(dest, src, i, len, alphabet);
+}
+
+KR_INLINE __m256i kr_base64_range32_(__m256i v, char lo, char hi)
+{
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8(KR_CASTS(char, hi - lo - 0x7F)),
+                             _mm256_sub_epi8(v, _mm256_set1_epi8(KR_CASTS(char, lo + 0x80))));
+}
+
+KR_INLINE bool kr_base64_values32_(__m256i v, __m256i c62, __m256i c63, __m256i *outValues)
+{
+    __m256i offset = _mm256_and_si256(kr_base64_range32_(v, 'A', 'Z'), _mm256_set1_epi8(-'A'));
+    offset = _mm256_or_si256(offset, _mm256_and_si256(kr_base64_range32_(v, 'a', 'z'), _mm256_set1_epi8(26 - 'a')));
+    offset = _mm256_or_si256(offset, _mm256_and_si256(kr_base64_range32_(v, '0', '9'), _mm256_set1_epi8(52 - '0')));
+    offset = _mm256_or_si256(offset,
+                             _mm256_and_si256(_mm256_cmpeq_epi8(v, c62), _mm256_sub_epi8(_mm256_set1_epi8(62), c62)));
+    offset = _mm256_or_si256(offset,
+                             _mm256_and_si256(_mm256_cmpeq_epi8(v, c63), _mm256_sub_epi8(_mm256_set1_epi8(63), c63)));
+
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(offset, _mm256_setzero_si256())) != 0)
+    {
+        return false;
+    }
+
+    *outValues = _mm256_add_epi8(v, offset);
+    return true;
+}
+
+/* Pack 32 6-bit values into 24 bytes at the bottom of the register. */
+KR_INLINE __m256i kr_base64_pack32_(__m256i values)
+{
+    const __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+    const __m256i groups = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+    const __m256i bytes = _mm256_shuffle_epi8(groups, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1,
+                                                                       -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                                                       -1, -1, -1, -1));
+
+    /* Shuffles work within each 128-bit lane, close the gap between them. */
+    return _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+}
+
+KR_INLINE size_t kr_base64_decode_avx2_(unsigned char *dest, const char *src, size_t i, size_t len, unsigned flags)
+{
+    const char *alphabet = kr_base64_alphabet_(flags);
+    const __m256i c62 = _mm256_set1_epi8(alphabet[62]);
+    const __m256i c63 = _mm256_set1_epi8(alphabet[63]);
+    __m256i values, bytes;
+
+    for (; len - i >= 32; i += 32)
+    {
+        if (!kr_base64_values32_(_mm256_loadu_si256(KR_CASTR(const __m256i *, src + i)), c62, c63, &values))
+        {
+            break;
+        }
+
+        bytes = kr_base64_pack32_(values);
+        _mm_storeu_si128(KR_CASTR(__m128i *, dest + i / 4 * 3), _mm256_castsi256_si128(bytes));
+        _mm_storel_epi64(KR_CASTR(__m128i *, dest + i / 4 * 3 + 16), _mm256_extracti128_si256(bytes, 1));
+    }
+
+    return kr_base64_decode_ssse3_(dest, src, i, len, flags);
+}
+
+#endif /* (KR_AVX2) */
+
+/* Whole groups, with the fastest code available. */
+#if (KR_AVX2)
+#define KR_BASE64_ENCODE_BLOCKS_ kr_base64_encode_avx2_
+#define KR_BASE64_DECODE_BLOCKS_ kr_base64_decode_avx2_
+#elif (KR_SSSE3)
+#define KR_BASE64_ENCODE_BLOCKS_ kr_base64_encode_ssse3_
+#define KR_BASE64_DECODE_BLOCKS_ kr_base64_decode_ssse3_
+#else
+#define KR_BASE64_ENCODE_BLOCKS_ kr_base64_encode_scalar_
+#define KR_BASE64_DECODE_BLOCKS_ kr_base64_decode_scalar_
+#endif
+
+/******************************************************************************/
+
+KR_INLINE size_t kr_base64_encode(char *dest, const void *src, size_t len, unsigned flags)
+{
+#if (KR_AVX2)
+    return kr_base64_encode_avx2(dest, src, len, flags);
+#elif (KR_SSSE3)
+    return kr_base64_encode_ssse3(dest, src, len, flags);
+#else
+    return kr_base64_encode_scalar(dest, src, len, flags);
+#endif
+}
+
+KR_INLINE size_t kr_base64_encode_scalar(char *dest, const void *src, size_t len, unsigned flags)
+{
+    const unsigned char *s = KR_CASTS(const unsigned char *, src);
+    const size_t i = kr_base64_encode_scalar_(dest, s, 0, len, kr_base64_alphabet_(flags));
+    return i / 3 * 4 + kr_base64_encode_last_(dest + i / 3 * 4, s + i, len - i, flags);
+}
+
+#if (KR_SSSE3)
+
+KR_INLINE size_t kr_base64_encode_ssse3(char *dest, const void *src, size_t len, unsigned flags)
+{
+    const unsigned char *s = KR_CASTS(const unsigned char *, src);
+    const size_t i = kr_base64_encode_ssse3_(dest, s, 0, len, kr_base64_alphabet_(flags));
+    return i / 3 * 4 + kr_base64_encode_last_(dest + i / 3 * 4, s + i, len - i, flags);
+}
+
+#endif /* (KR_SSSE3) */
+
+#if (KR_AVX2)
+
+KR_INLINE size_t kr_base64_encode_avx2(char *dest, const void *src, size_t len, unsigned flags)
+{
+    const unsigned char *s = KR_CASTS(const unsigned char *, src);
+    const size_t i = kr_base64_encode_avx2_(dest, s, 0, len, kr_base64_alphabet_(flags));
+    return i / 3 * 4 + kr_base64_encode_last_(dest + i / 3 * 4, s + i, len - i, flags);
+}
+
+#endif /* (KR_AVX2) */
+
+/******************************************************************************/
+
+KR_INLINE bool kr_base64_decode(void *dest, size_t *outLen, const char *src, size_t len, unsigned flags)
+{
+#if (KR_AVX2)
+    return kr_base64_decode_avx2(dest, outLen, src, len, flags);
+#elif (KR_SSSE3)
+    return kr_base64_decode_ssse3(dest, outLen, src, len, flags);
+#else
+    return kr_base64_decode_scalar(dest, outLen, src, len, flags);
+#endif
+}
+
+KR_INLINE bool kr_base64_decode_scalar(void *dest, size_t *outLen, const char *src, size_t len, unsigned flags)
+{
+    unsigned char *d = KR_CASTS(unsigned char *, dest);
+    return kr_base64_decode_end_(d, outLen, src, kr_base64_decode_scalar_(d, src, 0, len, flags), len, flags);
+}
+
+#if (KR_SSSE3)
+
+KR_INLINE bool kr_base64_decode_ssse3(void *dest, size_t *outLen, const char *src, size_t len, unsigned flags)
+{
+    unsigned char *d = KR_CASTS(unsigned char *, dest);
+    return kr_base64_decode_end_(d, outLen, src, kr_base64_decode_ssse3_(d, src, 0, len, flags), len, flags);
+}
+
+#endif /* (KR_SSSE3) */
+
+#if (KR_AVX2)
+
+KR_INLINE bool kr_base64_decode_avx2(void *dest, size_t *outLen, const char *src, size_t len, unsigned flags)
+{
+    unsigned char *d = KR_CASTS(unsigned char *, dest);
+    return kr_base64_decode_end_(d, outLen, src, kr_base64_decode_avx2_(d, src, 0, len, flags), len, flags);
+}
+
+#endif /* (KR_AVX2) */
+
+/******************************************************************************/
+
+KR_INLINE void kr_base64_encode_init(struct kr_base64_encode_ctx_s *ctx, unsigned flags)
+{
+    ctx->flags = flags;
+    ctx->count = 0;
+}
+
+KR_INLINE size_t kr_base64_encode_update(struct kr_base64_encode_ctx_s *ctx, char *dest, const void *src, size_t len)
+{
+    const unsigned char *s = KR_CASTS(const unsigned char *, src);
+    const char *alphabet = kr_base64_alphabet_(ctx->flags);
+    size_t i = 0, j = 0, out = 0;
+
+    /* Finish the group left over from the last chunk. */
+    if (ctx->count > 0)
+    {
+        for (; ctx->count < 3 && i < len; i++)
+        {
+            ctx->carry[ctx->count++] = s[i];
+        }
+        if (ctx->count < 3)
+        {
+            return 0;
+        }
+        kr_base64_encode_scalar_(dest, ctx->carry, 0, 3, alphabet);
+        ctx->count = 0;
+        out = 4;
+    }
+
+    j = KR_BASE64_ENCODE_BLOCKS_(dest + out, s + i, 0, len - i, alphabet);
+    out += j / 3 * 4;
+    i += j;
+
+    ctx->count = KR_CASTS(unsigned, len - i);
+    memcpy(ctx->carry, s + i, len - i);
+    return out;
+}
+
+KR_INLINE size_t kr_base64_encode_final(struct kr_base64_encode_ctx_s *ctx, char *dest)
+{
+    const unsigned count = ctx->count;
+    ctx->count = 0;
+    return kr_base64_encode_last_(dest, ctx->carry, count, ctx->flags);
+}
+
+/******************************************************************************/
+
+KR_INLINE void kr_base64_decode_init(struct kr_base64_decode_ctx_s *ctx, unsigned flags)
+{
+    ctx->flags = flags;
+    ctx->count = 0;
+    ctx->done = false;
+}
+
+/* Decode a group that the fast paths stopped at, which can only be valid if
+   it's padded, and then it has to be the last one. */
+KR_INLINE bool kr_base64_decode_group_(struct kr_base64_decode_ctx_s *ctx, unsigned char *dest, size_t *outLen,
+                                       const char *group)
+{
+    size_t count = 0;
+
+    if (!kr_base64_decode_last_(dest + *outLen, &count, group, 4, ctx->flags))
+    {
+        return false;
+    }
+    *outLen += count;
+    ctx->done = count < 3;
+    return true;
+}
+
+KR_INLINE bool kr_base64_decode_update(struct kr_base64_decode_ctx_s *ctx, void *dest, size_t *outLen, const char *src,
+                                       size_t len)
+{
+    unsigned char *d = KR_CASTS(unsigned char *, dest);
+    size_t i = 0, j = 0;
+
+    *outLen = 0;
+
+    /* Finish the group left over from the last chunk. */
+    if (ctx->count > 0)
+    {
+        for (; ctx->count < 4 && i < len; i++)
+        {
+            ctx->carry[ctx->count++] = src[i];
+        }
+        if (ctx->count < 4)
+        {
+            return true;
+        }
+        ctx->count = 0;
+        if (!kr_base64_decode_group_(ctx, d, outLen, ctx->carry))
+        {
+            return false;
+        }
+    }
+
+    for (;;)
+    {
+        if (i == len)
+        {
+            return true;
+        }
+        if (ctx->done)
+        {
+            return false;
+        }
+
+        j = KR_BASE64_DECODE_BLOCKS_(d + *outLen, src + i, 0, len - i, ctx->flags);
+        *outLen += j / 4 * 3;
+        i += j;
+        if (len - i < 4)
+        {
+            break;
+        }
+
+        if (!kr_base64_decode_group_(ctx, d, outLen, src + i))
+        {
+            return false;
+        }
+        i += 4;
+    }
+
+    ctx->count = KR_CASTS(unsigned, len - i);
+    memcpy(ctx->carry, src + i, len - i);
+    return true;
+}
+
+KR_INLINE bool kr_base64_decode_final(struct kr_base64_decode_ctx_s *ctx, void *dest, size_t *outLen)
+{
+    const unsigned count = ctx->count;
+    ctx->count = 0;
+    return kr_base64_decode_last_(KR_CASTS(unsigned char *, dest), outLen, ctx->carry, count, ctx->flags);
+}
+
+#undef KR_BASE64_CHAR_
+#undef KR_BASE64_VALUE_
+#undef KR_BASE64_ENCODE_BLOCKS_
+#undef KR_BASE64_DECODE_BLOCKS_
+
+/******************************************************************************/
+#endif /* !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION) */
+/******************************************************************************/
+
+#endif /* !defined(KRBASE64_H) */
@@ -14,6 +14,11 @@
  *  KRUFT_IMPLEMENTATION before including.
  * KR_CONFIG_NOINCLUDE:
  *	If defined, does not include any libc header automatically.
+ * KR_CONFIG_NOSIMD:
+ *	If defined, don't use SIMD instructions even if the compiler targets them.
+ * KR_CONFIG_NOFLOAT:
+ *	If defined, kr_snprintf doesn't support floating point, which leaves out
+ *  the float conversion code and tables.
  */
 
 #if !defined(KRCONFIG_H)
@@ -29,6 +34,14 @@
 #define KR_CONFIG_NOINCLUDE (0)
 #endif
 
+#if !defined(KR_CONFIG_NOSIMD)
+#define KR_CONFIG_NOSIMD (0)
+#endif
+
+#if !defined(KR_CONFIG_NOFLOAT)
+#define KR_CONFIG_NOFLOAT (0)
+#endif
+
 #if !defined(KR_MALLOC)
 #define KR_MALLOC(sz) (malloc((sz)))
 #endif
@@ -130,6 +143,32 @@
 #define KR_SIZEOF_SIZE_T (INT_WIDTH / CHAR_BIT)
 #endif /* (KR_GNUC || KR_CLANG) */
 
+/*
+ * SIMD instruction sets.
+ *
+ * Detection is done at compile-time only, based on what the compiler has
+ * been told it can target.  If you want AVX2 code paths, you must build
+ * with -mavx2 or /arch:AVX2.
+ */
+
+#if (!KR_CONFIG_NOSIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define KR_SSE2 (1)
+#else
+#define KR_SSE2 (0)
+#endif
+
+#if (KR_SSE2) && (defined(__SSSE3__) || defined(__AVX__))
+#define KR_SSSE3 (1)
+#else
+#define KR_SSSE3 (0)
+#endif
+
+#if (KR_SSSE3) && defined(__AVX2__)
+#define KR_AVX2 (1)
+#else
+#define KR_AVX2 (0)
+#endif
+
 /* Language and compiler feature shims. */
 
 #if (KR_CPLUSPLUS >= 199711)
@@ -200,6 +239,23 @@
 #define KR_RESTRICT
 #endif
 
+#if (KR_GNUC || KR_CLANG)
+#define KR_MAY_ALIAS __attribute__((__may_alias__))
+#else
+#define KR_MAY_ALIAS
+#endif
+
+/*
+ * Word-at-a-time and SIMD functions may read past the end of a buffer, but
+ * never past the aligned block containing its last byte.  This is safe in
+ * practice, but address sanitizers can't tell.
+ */
+#if (KR_CLANG) || (KR_GNUC >= 5)
+#define KR_NOSANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+#define KR_NOSANITIZE_ADDRESS
+#endif
+
 #if (KR_MSC_VER)
 #define KR_THREAD __declspec(thread)
 #elif (KR_GNUC || KR_CLANG)
@@ -208,6 +264,19 @@
 #define KR_THREAD
 #endif
 
+/*
+ * True if we're being evaluated inside a constant expression, which lets
+ * constexpr functions take a faster runtime-only path when they're not.
+ * If we can't tell, assume we are, since the constexpr path is always safe.
+ */
+#if (KR_CPLUSPLUS < 201402)
+#define KR_IS_CONSTANT_EVALUATED() (0)
+#elif (KR_GNUC >= 9 && !KR_CLANG) || (KR_CLANG && __clang_major__ >= 9) || (KR_MSC_VER >= 1925)
+#define KR_IS_CONSTANT_EVALUATED() (__builtin_is_constant_evaluated())
+#else
+#define KR_IS_CONSTANT_EVALUATED() (1)
+#endif
+
 #if (KR_MSC_VER)
 #define KR_UNREACHABLE() (__assume(0))
 #elif (KR_GNUC || KR_CLANG)
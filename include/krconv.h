@@ -0,0 +1,686 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * Integer conversion
+ *
+ * strtoul and friends look at the C locale, skip whitespace, guess the base
+ * from a prefix and report errors through errno, and all of that makes them
+ * slow and awkward to use on data that isn't null terminated.  These parse
+ * exactly the digits at the start of a buffer and nothing else.
+ *
+ * Overflow is reported the same way as krckdint.h, with a bool that is true
+ * if the value didn't fit, and the result wrapped to the width of the type.
+ *
+ * Going the other way, sprintf has to parse its format string every time
+ * it's called.  The formatting functions here count the digits up front and
+ * write them two at a time from the back.
+ */
+
+#if !defined(KRCONV_H)
+#define KRCONV_H
+
+#include "./krconfig.h"
+
+#include "./krbit.h"
+#include "./krbool.h"
+#include "./krctype.h"
+#include "./krint.h"
+#include "./krserial.h"
+
+#if (!KR_CONFIG_NOINCLUDE)
+#include <stddef.h>
+#endif
+
+/**
+ * @brief Buffer size that fits any formatted 32-bit value, including the
+ *        terminator.
+ */
+#define KR_CONV_32_SIZE 12
+
+/**
+ * @brief Buffer size that fits any formatted 64-bit value, including the
+ *        terminator.
+ */
+#define KR_CONV_64_SIZE 21
+
+/**
+ * @brief Parse an unsigned decimal integer.
+ *
+ * @details Only digits are accepted, there is no sign, whitespace or prefix.
+ *
+ * @param res Output value, set to 0 if there are no digits.
+ * @param str Buffer to parse, which does not need to be terminated.
+ * @param len Length of buffer.
+ * @param outOverflow Output true if the value did not fit, in which case res
+ *                    holds the value wrapped to 32 bits.  Can be NULL.
+ * @return Number of bytes consumed, 0 if str does not start with a digit.
+ */
+KR_INLINE size_t kr_parse_u32(uint32_t *res, const char *str, size_t len, bool *outOverflow);
+
+/**
+ * @brief Parse a signed decimal integer.
+ *
+ * @details Accepts a single leading '+' or '-', followed by digits.
+ *
+ * @param res Output value, set to 0 if there are no digits.
+ * @param str Buffer to parse, which does not need to be terminated.
+ * @param len Length of buffer.
+ * @param outOverflow Output true if the value did not fit, in which case res
+ *                    holds the value wrapped to 32 bits.  Can be NULL.
+ * @return Number of bytes consumed including the sign, 0 if there are no
+ *         digits.
+ */
+KR_INLINE size_t kr_parse_i32(int32_t *res, const char *str, size_t len, bool *outOverflow);
+
+/**
+ * @brief Parse an unsigned hexadecimal integer.
+ *
+ * @details Digits are anything kr_isxdigit accepts.  There is no "0x"
+ *          prefix.
+ *
+ * @param res Output value, set to 0 if there are no digits.
+ * @param str Buffer to parse, which does not need to be terminated.
+ * @param len Length of buffer.
+ * @param outOverflow Output true if the value did not fit, in which case res
+ *                    holds the low 32 bits.  Can be NULL.
+ * @return Number of bytes consumed, 0 if str does not start with a digit.
+ */
+KR_INLINE size_t kr_parse_hex_u32(uint32_t *res, const char *str, size_t len, bool *outOverflow);
+
+/**
+ * @brief Parse an unsigned octal integer.
+ *
+ * @details Digits are '0' through '7'.  There is no leading "0" required.
+ *
+ * @param res Output value, set to 0 if there are no digits.
+ * @param str Buffer to parse, which does not need to be terminated.
+ * @param len Length of buffer.
+ * @param outOverflow Output true if the value did not fit, in which case res
+ *                    holds the low 32 bits.  Can be NULL.
+ * @return Number of bytes consumed, 0 if str does not start with a digit.
+ */
+KR_INLINE size_t kr_parse_oct_u32(uint32_t *res, const char *str, size_t len, bool *outOverflow);
+
+/**
+ * @brief Format an unsigned integer as decimal.
+ *
+ * @param dest Destination buffer, at least KR_CONV_32_SIZE bytes.
+ * @param value Value to format.
+ * @return Number of digits written, not including the terminator.
+ */
+KR_INLINE size_t kr_u32toa(char *dest, uint32_t value);
+
+/**
+ * @brief Format a signed integer as decimal.
+ *
+ * @param dest Destination buffer, at least KR_CONV_32_SIZE bytes.
+ * @param value Value to format.
+ * @return Number of characters written, not including the terminator.
+ */
+KR_INLINE size_t kr_i32toa(char *dest, int32_t value);
+
+/**
+ * @brief Format an unsigned integer as lowercase hexadecimal.
+ *
+ * @details No "0x" prefix is written.
+ *
+ * @param dest Destination buffer, at least KR_CONV_32_SIZE bytes.
+ * @param value Value to format.
+ * @return Number of digits written, not including the terminator.
+ */
+KR_INLINE size_t kr_u32toa_hex(char *dest, uint32_t value);
+
+/**
+ * @brief Format an unsigned integer as decimal, padded with leading zeroes.
+ *
+ * @param dest Destination buffer, big enough for width digits or
+ *             KR_CONV_32_SIZE bytes, whichever is larger, plus terminator.
+ * @param value Value to format.
+ * @param width Minimum number of digits.  Values that need more digits are
+ *              not truncated.
+ * @return Number of digits written, not including the terminator.
+ */
+KR_INLINE size_t kr_u32toa_pad(char *dest, uint32_t value, size_t width);
+
+#if defined(UINT64_MAX)
+
+/**
+ * @brief Parse an unsigned decimal integer.
+ *
+ * @details Only digits are accepted, there is no sign, whitespace or prefix.
+ *
+ * @param res Output value, set to 0 if there are no digits.
+ * @param str Buffer to parse, which does not need to be terminated.
+ * @param len Length of buffer.
+ * @param outOverflow Output true if the value did not fit, in which case res
+ *                    holds the value wrapped to 64 bits.  Can be NULL.
+ * @return Number of bytes consumed, 0 if str does not start with a digit.
+ */
+KR_INLINE size_t kr_parse_u64(uint64_t *res, const char *str, size_t len, bool *outOverflow);
+
+/**
+ * @brief Parse a signed decimal integer.
+ *
+ * @details Accepts a single leading '+' or '-', followed by digits.
+ *
+ * @param res Output value, set to 0 if there are no digits.
+ * @param str Buffer to parse, which does not need to be terminated.
+ * @param len Length of buffer.
+ * @param outOverflow Output true if the value did not fit, in which case res
+ *                    holds the value wrapped to 64 bits.  Can be NULL.
+ * @return Number of bytes consumed including the sign, 0 if there are no
+ *         digits.
+ */
+KR_INLINE size_t kr_parse_i64(int64_t *res, const char *str, size_t len, bool *outOverflow);
+
+/**
+ * @brief Parse an unsigned hexadecimal integer.
+ *
+ * @details Digits are anything kr_isxdigit accepts.  There is no "0x"
+ *          prefix.
+ *
+ * @param res Output value, set to 0 if there are no digits.
+ * @param str Buffer to parse, which does not need to be terminated.
+ * @param len Length of buffer.
+ * @param outOverflow Output true if the value did not fit, in which case res
+ *                    holds the low 64 bits.  Can be NULL.
+ * @return Number of bytes consumed, 0 if str does not start with a digit.
+ */
+KR_INLINE size_t kr_parse_hex_u64(uint64_t *res, const char *str, size_t len, bool *outOverflow);
+
+/**
+ * @brief Parse an unsigned octal integer.
+ *
+ * @details Digits are '0' through '7'.  There is no leading "0" required.
+ *
+ * @param res Output value, set to 0 if there are no digits.
+ * @param str Buffer to parse, which does not need to be terminated.
+ * @param len Length of buffer.
+ * @param outOverflow Output true if the value did not fit, in which case res
+ *                    holds the low 64 bits.  Can be NULL.
+ * @return Number of bytes consumed, 0 if str does not start with a digit.
+ */
+KR_INLINE size_t kr_parse_oct_u64(uint64_t *res, const char *str, size_t len, bool *outOverflow);
+
+/**
+ * @brief Format an unsigned integer as decimal.
+ *
+ * @param dest Destination buffer, at least KR_CONV_64_SIZE bytes.
+ * @param value Value to format.
+ * @return Number of digits written, not including the terminator.
+ */
+KR_INLINE size_t kr_u64toa(char *dest, uint64_t value);
+
+/**
+ * @brief Format a signed integer as decimal.
+ *
+ * @param dest Destination buffer, at least KR_CONV_64_SIZE bytes.
+ * @param value Value to format.
+ * @return Number of characters written, not including the terminator.
+ */
+KR_INLINE size_t kr_i64toa(char *dest, int64_t value);
+
+/**
+ * @brief Format an unsigned integer as lowercase hexadecimal.
+ *
+ * @details No "0x" prefix is written.
+ *
+ * @param dest Destination buffer, at least KR_CONV_64_SIZE bytes.
+ * @param value Value to format.
+ * @return Number of digits written, not including the terminator.
+ */
+KR_INLINE size_t kr_u64toa_hex(char *dest, uint64_t value);
+
+/**
+ * @brief Format an unsigned integer as decimal, padded with leading zeroes.
+ *
+ * @param dest Destination buffer, big enough for width digits or
+ *             KR_CONV_64_SIZE bytes, whichever is larger, plus terminator.
+ * @param value Value to format.
+ * @param width Minimum number of digits.  Values that need more digits are
+ *              not truncated.
+ * @return Number of digits written, not including the terminator.
+ */
+KR_INLINE size_t kr_u64toa_pad(char *dest, uint64_t value, size_t width);
+
+#endif /* defined(UINT64_MAX) */
+
+/******************************************************************************/
+#if !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION)
+/******************************************************************************/
+
+/* Widest type we parse into, narrower results are checked afterwards. */
+#if defined(UINT64_MAX)
+typedef uint64_t kr_conv_uint_t_;
+#define KR_CONV_UINT_MAX_ UINT64_MAX
+#else
+typedef uint32_t kr_conv_uint_t_;
+#define KR_CONV_UINT_MAX_ UINT32_MAX
+#endif
+
+#if defined(UINT64_MAX)
+
+/*
+ * Count the decimal digits at the start of 8 bytes loaded little-endian, and
+ * convert them.  Digits are found with the same range trick as krstr.h, then
+ * the digits are shifted up so missing ones become leading zeroes, and
+ * combined pairwise with three multiplies.
+ *
+ * @link https://lemire.me/blog/2022/01/21/swar-explained-parsing-eight-digits/
+ */
+KR_INLINE unsigned kr_conv_digits8_(uint64_t word, uint32_t *outValue)
+{
+    const uint64_t ones = UINT64_C(0x0101010101010101);
+    const uint64_t highs = ones * 0x80;
+    const uint64_t low = word & ~highs;
+    const uint64_t digits = (low + ones * (0x80 - '0')) & ~(low + ones * (0x7F - '9')) & ~word & highs;
+    const uint64_t stop = ~digits & highs;
+    const unsigned count = stop != 0 ? kr_trailing_zeros64(stop) / 8 : 8;
+
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    /* Bytes past the first non-digit can borrow, but get shifted out. */
+    word = (word - ones * '0') << (8 * (8 - count));
+    word = (word * 10 + (word >> 8)) & UINT64_C(0x00FF00FF00FF00FF);
+    word = (word * 100 + (word >> 16)) & UINT64_C(0x0000FFFF0000FFFF);
+    word = (word * 10000 + (word >> 32)) & UINT64_C(0x00000000FFFFFFFF);
+    *outValue = KR_CASTS(uint32_t, word);
+    return count;
+}
+
+#endif /* defined(UINT64_MAX) */
+
+/* Parse decimal digits into the widest type, wrapping on overflow. */
+KR_INLINE size_t kr_parse_dec_(kr_conv_uint_t_ *res, const char *str, size_t len, bool *overflow)
+{
+#if defined(UINT64_MAX)
+    static const uint32_t pow10[9] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+#endif
+    kr_conv_uint_t_ value = 0;
+    size_t i = 0;
+
+    *overflow = false;
+
+#if defined(UINT64_MAX)
+    while (len - i >= 8)
+    {
+        uint32_t chunk = 0;
+        const unsigned count = kr_conv_digits8_(kr_load_u64le(KR_CASTC(char *, str + i)), &chunk);
+        if (count == 0)
+        {
+            break;
+        }
+
+        /* Small values can't overflow, skip the division. */
+        if (value >= UINT64_MAX / 100000000 && value > (UINT64_MAX - chunk) / pow10[count])
+        {
+            *overflow = true;
+        }
+        value = value * pow10[count] + chunk;
+        i += count;
+
+        if (count != 8)
+        {
+            *res = value;
+            return i;
+        }
+    }
+#endif
+
+    for (; i < len && kr_isdigit(str[i]); i++)
+    {
+        const unsigned digit = KR_CASTS(unsigned, str[i] - '0');
+        if (value >= KR_CONV_UINT_MAX_ / 10 && value > (KR_CONV_UINT_MAX_ - digit) / 10)
+        {
+            *overflow = true;
+        }
+        value = value * 10 + digit;
+    }
+
+    *res = value;
+    return i;
+}
+
+/* Parse a sign and decimal digits, returning the magnitude. */
+KR_INLINE size_t kr_parse_sdec_(kr_conv_uint_t_ *res, bool *neg, const char *str, size_t len, bool *overflow)
+{
+    size_t sign = 0, count = 0;
+
+    *neg = false;
+    if (len != 0 && (str[0] == '-' || str[0] == '+'))
+    {
+        *neg = str[0] == '-';
+        sign = 1;
+    }
+
+    count = kr_parse_dec_(res, str + sign, len - sign, overflow);
+    return count != 0 ? sign + count : 0;
+}
+
+/* Parse digits of a power of two base, wrapping on overflow. */
+KR_INLINE size_t kr_parse_pow2_(kr_conv_uint_t_ *res, const char *str, size_t len, unsigned shift, bool *overflow)
+{
+    const kr_conv_uint_t_ top = KR_CONV_UINT_MAX_ >> shift;
+    kr_conv_uint_t_ value = 0;
+    size_t i = 0;
+
+    *overflow = false;
+    for (; i < len; i++)
+    {
+        const char ch = str[i];
+        unsigned digit = 0;
+
+        if (shift == 4 && kr_isxdigit(ch))
+        {
+            digit = ch <= '9' ? KR_CASTS(unsigned, ch - '0') : KR_CASTS(unsigned, (ch | 0x20) - 'a' + 10);
+        }
+        else if (shift == 3 && ch >= '0' && ch <= '7')
+        {
+            digit = KR_CASTS(unsigned, ch - '0');
+        }
+        else
+        {
+            break;
+        }
+
+        if (value > top)
+        {
+            *overflow = true;
+        }
+        value = (value << shift) | digit;
+    }
+
+    *res = value;
+    return i;
+}
+
+KR_INLINE size_t kr_parse_u32(uint32_t *res, const char *str, size_t len, bool *outOverflow)
+{
+    kr_conv_uint_t_ value = 0;
+    bool overflow = false;
+    const size_t count = kr_parse_dec_(&value, str, len, &overflow);
+
+    *res = KR_CASTS(uint32_t, value);
+    if (outOverflow != NULL)
+    {
+        *outOverflow = overflow || value > UINT32_MAX;
+    }
+    return count;
+}
+
+KR_INLINE size_t kr_parse_i32(int32_t *res, const char *str, size_t len, bool *outOverflow)
+{
+    kr_conv_uint_t_ value = 0;
+    bool overflow = false, neg = false;
+    const size_t count = kr_parse_sdec_(&value, &neg, str, len, &overflow);
+    const uint32_t mag = KR_CASTS(uint32_t, value);
+
+    /* Negate unsigned so INT32_MIN doesn't overflow. */
+    *res = KR_CASTS(int32_t, neg ? 0 - mag : mag);
+    if (outOverflow != NULL)
+    {
+        *outOverflow = overflow || value > (neg ? KR_CASTS(uint32_t, INT32_MAX) + 1 : INT32_MAX);
+    }
+    return count;
+}
+
+KR_INLINE size_t kr_parse_hex_u32(uint32_t *res, const char *str, size_t len, bool *outOverflow)
+{
+    kr_conv_uint_t_ value = 0;
+    bool overflow = false;
+    const size_t count = kr_parse_pow2_(&value, str, len, 4, &overflow);
+
+    *res = KR_CASTS(uint32_t, value);
+    if (outOverflow != NULL)
+    {
+        *outOverflow = overflow || value > UINT32_MAX;
+    }
+    return count;
+}
+
+KR_INLINE size_t kr_parse_oct_u32(uint32_t *res, const char *str, size_t len, bool *outOverflow)
+{
+    kr_conv_uint_t_ value = 0;
+    bool overflow = false;
+    const size_t count = kr_parse_pow2_(&value, str, len, 3, &overflow);
+
+    *res = KR_CASTS(uint32_t, value);
+    if (outOverflow != NULL)
+    {
+        *outOverflow = overflow || value > UINT32_MAX;
+    }
+    return count;
+}
+
+/*
+ * Number of decimal digits in a value.  1233 / 4096 is a hair under
+ * log10(2), so scaling the bit width by it guesses the digit count or one
+ * less, and a single comparison fixes it up.  Setting the low bit makes 0
+ * count as one digit without changing the count of anything else.
+ *
+ * @link https://graphics.stanford.edu/~seander/bithacks.html#IntegerLog10
+ */
+KR_INLINE size_t kr_conv_count_(kr_conv_uint_t_ value)
+{
+#if defined(UINT64_MAX)
+    static const uint64_t pow10[20] = {UINT64_C(1),
+                                       UINT64_C(10),
+                                       UINT64_C(100),
+                                       UINT64_C(1000),
+                                       UINT64_C(10000),
+                                       UINT64_C(100000),
+                                       UINT64_C(1000000),
+                                       UINT64_C(10000000),
+                                       UINT64_C(100000000),
+                                       UINT64_C(1000000000),
+                                       UINT64_C(10000000000),
+                                       UINT64_C(100000000000),
+                                       UINT64_C(1000000000000),
+                                       UINT64_C(10000000000000),
+                                       UINT64_C(100000000000000),
+                                       UINT64_C(1000000000000000),
+                                       UINT64_C(10000000000000000),
+                                       UINT64_C(100000000000000000),
+                                       UINT64_C(1000000000000000000),
+                                       UINT64_C(10000000000000000000)};
+    const size_t guess = (kr_bit_width64(value | 1) * 1233) >> 12;
+#else
+    static const uint32_t pow10[10] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+    const size_t guess = (kr_bit_width32(value | 1) * 1233) >> 12;
+#endif
+
+    return guess + ((value | 1) >= pow10[guess] ? 1 : 0);
+}
+
+/* Write exactly count decimal digits of value, ending at dest + count. */
+KR_INLINE void kr_conv_dec_(char *dest, kr_conv_uint_t_ value, size_t count)
+{
+    static const char pairs[201] = "00010203040506070809"
+                                   "10111213141516171819"
+                                   "20212223242526272829"
+                                   "30313233343536373839"
+                                   "40414243444546474849"
+                                   "50515253545556575859"
+                                   "60616263646566676869"
+                                   "70717273747576777879"
+                                   "80818283848586878889"
+                                   "90919293949596979899";
+    char *pos = dest + count;
+
+    while (pos - dest >= 2)
+    {
+        const size_t pair = KR_CASTS(size_t, value % 100) * 2;
+        value /= 100;
+        pos -= 2;
+        pos[0] = pairs[pair];
+        pos[1] = pairs[pair + 1];
+    }
+
+    if (pos != dest)
+    {
+        dest[0] = KR_CASTS(char, '0' + value % 10);
+    }
+}
+
+/* Format value as hex, returning number of digits. */
+KR_INLINE size_t kr_conv_hex_(char *dest, kr_conv_uint_t_ value)
+{
+    static const char xdigits[17] = "0123456789abcdef";
+#if defined(UINT64_MAX)
+    const size_t count = (kr_bit_width64(value | 1) + 3) / 4;
+#else
+    const size_t count = (kr_bit_width32(value | 1) + 3) / 4;
+#endif
+    size_t i = count;
+
+    dest[count] = '\0';
+    while (i != 0)
+    {
+        dest[--i] = xdigits[value & 0xF];
+        value >>= 4;
+    }
+    return count;
+}
+
+/* Format value as decimal with at least width digits. */
+KR_INLINE size_t kr_conv_pad_(char *dest, kr_conv_uint_t_ value, size_t width)
+{
+    const size_t count = kr_conv_count_(value);
+    size_t i = 0;
+
+    for (; i + count < width; i++)
+    {
+        dest[i] = '0';
+    }
+    kr_conv_dec_(dest + i, value, count);
+    dest[i + count] = '\0';
+    return i + count;
+}
+
+KR_INLINE size_t kr_u32toa(char *dest, uint32_t value)
+{
+    const size_t count = kr_conv_count_(value);
+    kr_conv_dec_(dest, value, count);
+    dest[count] = '\0';
+    return count;
+}
+
+KR_INLINE size_t kr_i32toa(char *dest, int32_t value)
+{
+    if (value < 0)
+    {
+        /* Negate unsigned so INT32_MIN doesn't overflow. */
+        *dest = '-';
+        return 1 + kr_u32toa(dest + 1, 0 - KR_CASTS(uint32_t, value));
+    }
+    return kr_u32toa(dest, KR_CASTS(uint32_t, value));
+}
+
+KR_INLINE size_t kr_u32toa_hex(char *dest, uint32_t value)
+{
+    return kr_conv_hex_(dest, value);
+}
+
+KR_INLINE size_t kr_u32toa_pad(char *dest, uint32_t value, size_t width)
+{
+    return kr_conv_pad_(dest, value, width);
+}
+
+#if defined(UINT64_MAX)
+
+KR_INLINE size_t kr_parse_u64(uint64_t *res, const char *str, size_t len, bool *outOverflow)
+{
+    bool overflow = false;
+    const size_t count = kr_parse_dec_(res, str, len, &overflow);
+
+    if (outOverflow != NULL)
+    {
+        *outOverflow = overflow;
+    }
+    return count;
+}
+
+KR_INLINE size_t kr_parse_i64(int64_t *res, const char *str, size_t len, bool *outOverflow)
+{
+    uint64_t mag = 0;
+    bool overflow = false, neg = false;
+    const size_t count = kr_parse_sdec_(&mag, &neg, str, len, &overflow);
+
+    /* Negate unsigned so INT64_MIN doesn't overflow. */
+    *res = KR_CASTS(int64_t, neg ? 0 - mag : mag);
+    if (outOverflow != NULL)
+    {
+        *outOverflow = overflow || mag > (neg ? KR_CASTS(uint64_t, INT64_MAX) + 1 : INT64_MAX);
+    }
+    return count;
+}
+
+KR_INLINE size_t kr_parse_hex_u64(uint64_t *res, const char *str, size_t len, bool *outOverflow)
+{
+    bool overflow = false;
+    const size_t count = kr_parse_pow2_(res, str, len, 4, &overflow);
+
+    if (outOverflow != NULL)
+    {
+        *outOverflow = overflow;
+    }
+    return count;
+}
+
+KR_INLINE size_t kr_parse_oct_u64(uint64_t *res, const char *str, size_t len, bool *outOverflow)
+{
+    bool overflow = false;
+    const size_t count = kr_parse_pow2_(res, str, len, 3, &overflow);
+
+    if (outOverflow != NULL)
+    {
+        *outOverflow = overflow;
+    }
+    return count;
+}
+
+KR_INLINE size_t kr_u64toa(char *dest, uint64_t value)
+{
+    const size_t count = kr_conv_count_(value);
+    kr_conv_dec_(dest, value, count);
+    dest[count] = '\0';
+    return count;
+}
+
+KR_INLINE size_t kr_i64toa(char *dest, int64_t value)
+{
+    if (value < 0)
+    {
+        /* Negate unsigned so INT64_MIN doesn't overflow. */
+        *dest = '-';
+        return 1 + kr_u64toa(dest + 1, 0 - KR_CASTS(uint64_t, value));
+    }
+    return kr_u64toa(dest, KR_CASTS(uint64_t, value));
+}
+
+KR_INLINE size_t kr_u64toa_hex(char *dest, uint64_t value)
+{
+    return kr_conv_hex_(dest, value);
+}
+
+KR_INLINE size_t kr_u64toa_pad(char *dest, uint64_t value, size_t width)
+{
+    return kr_conv_pad_(dest, value, width);
+}
+
+#endif /* defined(UINT64_MAX) */
+
+#undef KR_CONV_UINT_MAX_
+
+#endif /* !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION) */
+
+#endif /* !defined(KRCONV_H) */
@@ -0,0 +1,417 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * CSV parsing
+ *
+ * Splitting CSV with kr_strcspn or kr_strtok_r looks at one byte at a time
+ * and has no idea about quoted fields.  This scans 64 bytes at a time
+ * instead, turning quotes, delimiters and newlines into a bitmask each.  A
+ * prefix XOR of the quote mask marks every byte that is inside quotes, so
+ * delimiters and newlines in quoted fields drop out of the mask before any
+ * of them are looked at, and only the real field boundaries are left to
+ * visit.
+ *
+ * Like kr_tokenizer_feed, input can come in chunks of any size, and fields
+ * are reported as offsets into the stream without copying anything.  A
+ * quoted field is reported with its quotes, and kr_csv_unquote turns it
+ * into its contents when they're needed.
+ *
+ * Quoting follows RFC 4180, except that fields are allowed to end in a
+ * bare newline as well as CRLF.
+ *
+ * @link https://www.rfc-editor.org/rfc/rfc4180
+ */
+
+#if !defined(KRCSV_H)
+#define KRCSV_H
+
+#include "./krconfig.h"
+
+#include "./krbltin.h"
+#include "./krbool.h"
+#include "./krint.h"
+#include "./krserial.h"
+#include "./krstr.h"
+#include "./krswar.h"
+
+#if (!KR_CONFIG_NOINCLUDE)
+#include <stddef.h>
+#include <string.h>
+#endif
+
+#if (KR_AVX2)
+#include <immintrin.h>
+#elif (KR_SSE2)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief The field starts with a quote, so use kr_csv_unquote to get its
+ *        contents.
+ */
+#define KR_CSV_QUOTED 0x1
+
+/**
+ * @brief The field is the last one in its row.
+ */
+#define KR_CSV_ROWEND 0x2
+
+/**
+ * @brief A field found by the parser, as a slice of the stream.
+ *
+ * @details A trailing carriage return before a newline is not part of the
+ *          field.
+ */
+struct kr_csv_field_s
+{
+    size_t offset;
+    size_t length;
+    unsigned flags; /* KR_CSV_QUOTED and KR_CSV_ROWEND. */
+};
+
+/**
+ * @brief State for splitting a stream of CSV into fields.
+ */
+struct kr_csv_s
+{
+    size_t pos;        /* Stream offset of the next byte to be fed. */
+    size_t fieldStart; /* Stream offset of the field in progress. */
+    char delim;
+    bool inQuotes;    /* The next byte fed is inside quotes. */
+    bool quoted;      /* The field in progress starts with a quote. */
+    bool atStart;     /* The next byte fed starts a field. */
+    bool atRowStart;  /* The field in progress starts a row. */
+    bool afterReturn; /* The last byte fed was a carriage return. */
+};
+
+/**
+ * @brief Initialize a CSV parser.
+ *
+ * @param csv Parser to initialize.
+ * @param delim Character that separates fields, usually ','.  Can't be a
+ *              quote, carriage return or newline.
+ */
+KR_INLINE void kr_csv_init(struct kr_csv_s *csv, char delim);
+
+/**
+ * @brief Feed the next chunk of a stream to a CSV parser.
+ *
+ * @details A field that straddles two chunks is reported once the chunk
+ *          containing its end is fed.
+ *
+ * @param csv Parser to use.
+ * @param chunk Chunk of data to scan.
+ * @param len Length of chunk.
+ * @param fields Array to write completed fields to.
+ * @param fieldsLen Length of fields array.
+ * @param consumed Set to the number of bytes of chunk that were scanned.
+ *                 This is less than len only if fields filled up, in which
+ *                 case the rest of the chunk should be fed again.
+ * @return Number of fields written to fields.
+ */
+KR_INLINE size_t kr_csv_feed(struct kr_csv_s *csv, const char *chunk, size_t len, struct kr_csv_field_s *fields,
+                             size_t fieldsLen, size_t *consumed);
+
+/**
+ * @brief Finish a stream, returning the field at the very end if it
+ *        wasn't followed by a newline.
+ *
+ * @details If the stream ended inside quotes, the last field runs to the
+ *          end of it.
+ *
+ * @param csv Parser to use.
+ * @param out Field to write.
+ * @return True if a field was written.
+ */
+KR_INLINE bool kr_csv_finish(struct kr_csv_s *csv, struct kr_csv_field_s *out);
+
+/**
+ * @brief Split a buffer of CSV into fields in a single pass.
+ *
+ * @param buf Buffer to scan.
+ * @param len Length of buffer.
+ * @param delim Character that separates fields.
+ * @param fields Array to write fields to, as offsets into buf.
+ * @param fieldsLen Length of fields array.
+ * @return Number of fields written to fields.  If this is fieldsLen, there
+ *         might be more fields after the end of the last one.
+ */
+KR_INLINE size_t kr_csv_parse(const char *buf, size_t len, char delim, struct kr_csv_field_s *fields,
+                              size_t fieldsLen);
+
+/**
+ * @brief Get the contents of a quoted field.
+ *
+ * @details Removes the surrounding quotes, and turns each doubled quote
+ *          inside them into one.  Anything after the closing quote is
+ *          kept as it is, and a field that doesn't start with a quote is
+ *          copied unchanged.
+ *
+ * @param dest Destination buffer, at least len bytes.  Not terminated.  Can
+ *             be the same as src to unquote in place.
+ * @param src Field to unquote.
+ * @param len Length of field.
+ * @return Length of the contents.
+ */
+KR_INLINE size_t kr_csv_unquote(char *dest, const char *src, size_t len);
+
+/******************************************************************************/
+#if !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION)
+/******************************************************************************/
+
+/*
+ * End the field in progress at stream offset pos.  Returns false if there
+ * was no room for it.
+ */
+KR_INLINE bool kr_csv_field_(struct kr_csv_s *csv, size_t pos, bool rowEnd, struct kr_csv_field_s *fields,
+                             size_t fieldsLen, size_t *count)
+{
+    struct kr_csv_field_s *field;
+
+    if (*count == fieldsLen)
+    {
+        return false;
+    }
+
+    field = &fields[*count];
+    field->offset = csv->fieldStart;
+    field->length = pos - csv->fieldStart;
+    field->flags = (csv->quoted ? KR_CSV_QUOTED : 0) | (rowEnd ? KR_CSV_ROWEND : 0);
+    if (rowEnd && csv->afterReturn && field->length != 0)
+    {
+        field->length -= 1;
+    }
+    *count += 1;
+
+    csv->fieldStart = pos + 1;
+    csv->quoted = false;
+    csv->atStart = true;
+    csv->atRowStart = rowEnd;
+    return true;
+}
+
+#if defined(UINT64_MAX)
+
+/*
+ * Masks of the quotes, delimiters and newlines in 64 bytes, with bit n
+ * for byte n.
+ */
+KR_INLINE void kr_csv_classify_(const char *p, char delim, uint64_t *quotes, uint64_t *delims, uint64_t *newlines)
+{
+#if (KR_AVX2)
+    const __m256i a = _mm256_loadu_si256(KR_CASTR(const __m256i *, p));
+    const __m256i b = _mm256_loadu_si256(KR_CASTR(const __m256i *, p + 32));
+    const __m256i q = _mm256_set1_epi8('"'), d = _mm256_set1_epi8(delim), n = _mm256_set1_epi8('\n');
+
+    *quotes = KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, q))) |
+              (KR_CASTS(uint64_t, KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(b, q)))) << 32);
+    *delims = KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, d))) |
+              (KR_CASTS(uint64_t, KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(b, d)))) << 32);
+    *newlines = KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, n))) |
+                (KR_CASTS(uint64_t, KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(b, n)))) << 32);
+#elif (KR_SSE2)
+    const __m128i q = _mm_set1_epi8('"'), d = _mm_set1_epi8(delim), n = _mm_set1_epi8('\n');
+    unsigned i;
+
+    *quotes = 0;
+    *delims = 0;
+    *newlines = 0;
+    for (i = 0; i < 64; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(KR_CASTR(const __m128i *, p + i));
+        *quotes |= KR_CASTS(uint64_t, _mm_movemask_epi8(_mm_cmpeq_epi8(v, q))) << i;
+        *delims |= KR_CASTS(uint64_t, _mm_movemask_epi8(_mm_cmpeq_epi8(v, d))) << i;
+        *newlines |= KR_CASTS(uint64_t, _mm_movemask_epi8(_mm_cmpeq_epi8(v, n))) << i;
+    }
+#else
+    const uint64_t ones = UINT64_C(0x0101010101010101);
+    unsigned i;
+
+    *quotes = 0;
+    *delims = 0;
+    *newlines = 0;
+    for (i = 0; i < 64; i += 8)
+    {
+        const uint64_t word = kr_load_u64le(KR_CASTC(char *, p + i));
+        *quotes |= kr_swar_zeros_(word ^ (ones * '"')) << i;
+        *delims |= kr_swar_zeros_(word ^ (ones * KR_CASTS(unsigned char, delim))) << i;
+        *newlines |= kr_swar_zeros_(word ^ (ones * '\n')) << i;
+    }
+#endif
+}
+
+#endif /* defined(UINT64_MAX) */
+
+/******************************************************************************/
+
+KR_INLINE void kr_csv_init(struct kr_csv_s *csv, char delim)
+{
+    csv->pos = 0;
+    csv->fieldStart = 0;
+    csv->delim = delim;
+    csv->inQuotes = false;
+    csv->quoted = false;
+    csv->atStart = true;
+    csv->atRowStart = true;
+    csv->afterReturn = false;
+}
+
+KR_INLINE size_t kr_csv_feed(struct kr_csv_s *csv, const char *chunk, size_t len, struct kr_csv_field_s *fields,
+                             size_t fieldsLen, size_t *consumed)
+{
+    size_t i = 0, count = 0;
+
+#if defined(UINT64_MAX)
+    for (; len - i >= 64; i += 64)
+    {
+        uint64_t quotes, delims, newlines, inside, seps;
+        kr_csv_classify_(chunk + i, csv->delim, &quotes, &delims, &newlines);
+
+        /* Opening quotes count as inside and closing ones don't, which
+           doesn't matter because neither of them is a separator. */
+        inside = kr_swar_prefix_xor_(quotes) ^ (csv->inQuotes ? ~UINT64_C(0) : 0);
+        seps = (delims | newlines) & ~inside;
+
+        if (csv->atStart)
+        {
+            csv->quoted = (quotes & 1) != 0;
+            csv->atStart = false;
+        }
+        for (; seps != 0; seps &= seps - 1)
+        {
+            const unsigned bit = KR_CASTS(unsigned, kr_ctz64(seps));
+            const bool rowEnd = ((newlines >> bit) & 1) != 0;
+            if (rowEnd && bit != 0)
+            {
+                csv->afterReturn = chunk[i + bit - 1] == '\r';
+            }
+            if (!kr_csv_field_(csv, csv->pos + i + bit, rowEnd, fields, fieldsLen, &count))
+            {
+                /* Separators are never inside quotes. */
+                csv->inQuotes = false;
+                csv->atStart = csv->fieldStart == csv->pos + i + bit;
+                csv->pos += i + bit;
+                *consumed = i + bit;
+                return count;
+            }
+            if (bit != 63)
+            {
+                csv->quoted = ((quotes >> (bit + 1)) & 1) != 0;
+                csv->atStart = false;
+            }
+        }
+
+        csv->inQuotes = (inside >> 63) != 0;
+        csv->afterReturn = chunk[i + 63] == '\r';
+    }
+#endif
+
+    for (; i < len; i++)
+    {
+        const char ch = chunk[i];
+        if (csv->atStart)
+        {
+            csv->quoted = ch == '"';
+            csv->atStart = false;
+        }
+
+        if (ch == '"')
+        {
+            csv->inQuotes = !csv->inQuotes;
+        }
+        else if (!csv->inQuotes && (ch == csv->delim || ch == '\n'))
+        {
+            if (!kr_csv_field_(csv, csv->pos + i, ch == '\n', fields, fieldsLen, &count))
+            {
+                csv->atStart = csv->fieldStart == csv->pos + i;
+                break;
+            }
+        }
+        csv->afterReturn = ch == '\r';
+    }
+
+    csv->pos += i;
+    *consumed = i;
+    return count;
+}
+
+KR_INLINE bool kr_csv_finish(struct kr_csv_s *csv, struct kr_csv_field_s *out)
+{
+    size_t count = 0;
+
+    /* Nothing after the last newline means no more rows. */
+    if (csv->atRowStart && csv->fieldStart == csv->pos)
+    {
+        return false;
+    }
+
+    csv->afterReturn = false;
+    kr_csv_field_(csv, csv->pos, true, out, 1, &count);
+    csv->fieldStart = csv->pos;
+    csv->inQuotes = false;
+    return true;
+}
+
+KR_INLINE size_t kr_csv_parse(const char *buf, size_t len, char delim, struct kr_csv_field_s *fields,
+                              size_t fieldsLen)
+{
+    struct kr_csv_s csv;
+    size_t count = 0, consumed = 0;
+
+    kr_csv_init(&csv, delim);
+    count = kr_csv_feed(&csv, buf, len, fields, fieldsLen, &consumed);
+    if (consumed == len && count < fieldsLen && kr_csv_finish(&csv, &fields[count]))
+    {
+        count += 1;
+    }
+    return count;
+}
+
+KR_INLINE size_t kr_csv_unquote(char *dest, const char *src, size_t len)
+{
+    const char *quote;
+    size_t i = 1, o = 0, run;
+
+    if (len == 0 || src[0] != '"')
+    {
+        memmove(dest, src, len);
+        return len;
+    }
+
+    for (;;)
+    {
+        quote = KR_CASTS(const char *, kr_memchr(src + i, '"', len - i));
+        run = (quote != NULL) ? KR_CASTS(size_t, quote - src) - i : len - i;
+        memmove(dest + o, src + i, run);
+        o += run;
+        i += run;
+        if (quote == NULL)
+        {
+            return o;
+        }
+
+        /* A doubled quote is a literal one, anything else closes them. */
+        if (len - i >= 2 && src[i + 1] == '"')
+        {
+            dest[o++] = '"';
+            i += 2;
+            continue;
+        }
+
+        i += 1;
+        memmove(dest + o, src + i, len - i);
+        return o + len - i;
+    }
+}
+
+/******************************************************************************/
+#endif /* !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION) */
+/******************************************************************************/
+
+#endif /* !defined(KRCSV_H) */
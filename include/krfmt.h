@@ -0,0 +1,731 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * Printf-style formatting
+ *
+ * snprintf is slow on some targets, takes a lock or looks at the locale on
+ * others, and is missing entirely from old DOS and Windows C libraries.
+ * This is a small formatter that writes straight into the caller's buffer,
+ * never allocates, and always returns the length the whole string would
+ * have had.
+ *
+ * Plain %s and %d skip parsing the conversion entirely, and integers are
+ * formatted with krconv.h.  Floating point goes through krfloat.h, so the
+ * digits are always correctly rounded.  Defining KR_CONFIG_NOFLOAT to 1
+ * leaves all of that out.
+ */
+
+#if !defined(KRFMT_H)
+#define KRFMT_H
+
+#include "./krconfig.h"
+
+#include "./krarg.h"
+#include "./krbit.h"
+#include "./krbool.h"
+#include "./krconv.h"
+#include "./krint.h"
+#include "./krlimits.h"
+#include "./krstr.h"
+
+#if !(KR_CONFIG_NOFLOAT)
+#include "./krfloat.h"
+#endif
+
+#if (!KR_CONFIG_NOINCLUDE)
+#include <limits.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+/**
+ * @brief Format a string into a buffer.
+ *
+ * @details Supports the flags "-+ #0", width and precision including '*',
+ *          the length modifiers hh, h, l, ll, z, t and L, and the
+ *          conversions d, i, u, o, x, X, c, s, p, e, E, f, F, g, G and %.
+ *          %n, %a, %A and positional arguments are not supported.  Long
+ *          doubles are formatted at double precision.  Floating point
+ *          conversions fail if KR_CONFIG_NOFLOAT is set.  There is no
+ *          locale, and NULL strings print "(null)".
+ *
+ * @param buf Destination buffer, can be NULL if len is 0.
+ * @param len Size of buffer.  If the string doesn't fit, as much of it as
+ *            fits is written, and it is always terminated unless len is 0.
+ * @param fmt Format string.
+ * @param ... Format arguments.
+ * @return Length the string would have had if len were large enough, not
+ *         including the terminator, or -1 if the format wasn't supported or
+ *         the length doesn't fit in an int.
+ */
+KR_INLINE int kr_snprintf(char *buf, size_t len, const char *fmt, ...);
+
+/**
+ * @brief Format a string into a buffer, using a va_list.
+ *
+ * @param buf Destination buffer, can be NULL if len is 0.
+ * @param len Size of buffer.
+ * @param fmt Format string.
+ * @param args Format arguments.
+ * @return Same as kr_snprintf.
+ */
+KR_INLINE int kr_vsnprintf(char *buf, size_t len, const char *fmt, va_list args);
+
+/******************************************************************************/
+#if !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION)
+/******************************************************************************/
+
+#define KR_FMT_LEFT_ 0x01
+#define KR_FMT_PLUS_ 0x02
+#define KR_FMT_SPACE_ 0x04
+#define KR_FMT_ALT_ 0x08
+#define KR_FMT_ZERO_ 0x10
+
+#if !(KR_CONFIG_NOFLOAT) && defined(UINT64_MAX)
+#define KR_FMT_FLOAT_ (1)
+#else
+#define KR_FMT_FLOAT_ (0)
+#endif
+
+/* Room for the widest integer in octal. */
+#define KR_FMT_INT_SIZE_ 24
+
+#if defined(UINT64_MAX)
+typedef uint64_t kr_fmt_uint_t_;
+typedef int64_t kr_fmt_int_t_;
+#else
+typedef uint32_t kr_fmt_uint_t_;
+typedef int32_t kr_fmt_int_t_;
+#endif
+
+/* Output buffer, anything past the end is counted but not written. */
+struct kr_fmt_out_s_
+{
+    char *buf;  /* Destination buffer. */
+    size_t len; /* Room in buffer, not including terminator. */
+    size_t pos; /* Characters output so far, including dropped ones. */
+};
+
+/* A parsed conversion specification. */
+struct kr_fmt_spec_s_
+{
+    unsigned flags; /* KR_FMT_* flags. */
+    size_t width;   /* Minimum field width. */
+    int precision;  /* Precision, -1 if not given. */
+    char length;    /* Length modifier, 'H' for hh and 'L' for ll or L. */
+    char conv;      /* Conversion character. */
+};
+
+KR_INLINE void kr_fmt_write_(struct kr_fmt_out_s_ *out, const char *str, size_t count)
+{
+    if (out->pos < out->len)
+    {
+        const size_t room = out->len - out->pos;
+        memcpy(out->buf + out->pos, str, count < room ? count : room);
+    }
+    out->pos += count;
+}
+
+KR_INLINE void kr_fmt_fill_(struct kr_fmt_out_s_ *out, char ch, size_t count)
+{
+    if (out->pos < out->len)
+    {
+        const size_t room = out->len - out->pos;
+        memset(out->buf + out->pos, ch, count < room ? count : room);
+    }
+    out->pos += count;
+}
+
+/*
+ * Write the start of a field, which is padding, a prefix like a sign or
+ * "0x", and leading zeroes.  Returns the padding left over for the end of a
+ * left justified field.
+ */
+KR_INLINE size_t kr_fmt_begin_(struct kr_fmt_out_s_ *out, const struct kr_fmt_spec_s_ *spec, const char *prefix,
+                               size_t zeros, size_t bodyLen)
+{
+    const size_t prefixLen = kr_strlen(prefix);
+    const size_t len = prefixLen + zeros + bodyLen;
+    size_t pad = spec->width > len ? spec->width - len : 0;
+
+    if ((spec->flags & (KR_FMT_LEFT_ | KR_FMT_ZERO_)) == 0)
+    {
+        kr_fmt_fill_(out, ' ', pad);
+        pad = 0;
+    }
+    kr_fmt_write_(out, prefix, prefixLen);
+    if ((spec->flags & KR_FMT_LEFT_) == 0)
+    {
+        zeros += pad;
+        pad = 0;
+    }
+    kr_fmt_fill_(out, '0', zeros);
+    return pad;
+}
+
+/* Sign prefix for a signed conversion. */
+KR_INLINE const char *kr_fmt_sign_(const struct kr_fmt_spec_s_ *spec, bool neg)
+{
+    if (neg)
+    {
+        return "-";
+    }
+    if ((spec->flags & KR_FMT_PLUS_) != 0)
+    {
+        return "+";
+    }
+    return (spec->flags & KR_FMT_SPACE_) != 0 ? " " : "";
+}
+
+/* Digits of value for an integer conversion, returning their count. */
+KR_INLINE size_t kr_fmt_digits_(char *dest, kr_fmt_uint_t_ value, char conv)
+{
+    size_t count = 0, i = 0;
+
+    switch (conv)
+    {
+    case 'o':
+#if defined(UINT64_MAX)
+        count = (kr_bit_width64(value | 1) + 2) / 3;
+#else
+        count = (kr_bit_width32(value | 1) + 2) / 3;
+#endif
+        for (i = count; i != 0; value >>= 3)
+        {
+            dest[--i] = KR_CASTS(char, '0' + (value & 7));
+        }
+        return count;
+    case 'x':
+    case 'X':
+    case 'p':
+#if defined(UINT64_MAX)
+        count = kr_u64toa_hex(dest, value);
+#else
+        count = kr_u32toa_hex(dest, value);
+#endif
+        if (conv == 'X')
+        {
+            kr_strupper(dest);
+        }
+        return count;
+    default:
+#if defined(UINT64_MAX)
+        return kr_u64toa(dest, value);
+#else
+        return kr_u32toa(dest, value);
+#endif
+    }
+}
+
+KR_INLINE void kr_fmt_int_(struct kr_fmt_out_s_ *out, struct kr_fmt_spec_s_ *spec, kr_fmt_uint_t_ value, bool neg)
+{
+    char digits[KR_FMT_INT_SIZE_];
+    const char *prefix = "";
+    size_t count = 0, zeros = 0, pad = 0;
+
+    /* A precision of zero means zero has no digits. */
+    if (value != 0 || spec->precision != 0)
+    {
+        count = kr_fmt_digits_(digits, value, spec->conv);
+    }
+    if (spec->precision >= 0)
+    {
+        spec->flags &= ~KR_CASTS(unsigned, KR_FMT_ZERO_);
+        zeros = KR_CASTS(size_t, spec->precision) > count ? KR_CASTS(size_t, spec->precision) - count : 0;
+    }
+
+    switch (spec->conv)
+    {
+    case 'd':
+    case 'i':
+        prefix = kr_fmt_sign_(spec, neg);
+        break;
+    case 'o':
+        /* The alternate form makes sure there's a leading zero. */
+        if ((spec->flags & KR_FMT_ALT_) != 0 && zeros == 0 && (count == 0 || digits[0] != '0'))
+        {
+            zeros = 1;
+        }
+        break;
+    case 'x':
+        prefix = (spec->flags & KR_FMT_ALT_) != 0 && value != 0 ? "0x" : "";
+        break;
+    case 'X':
+        prefix = (spec->flags & KR_FMT_ALT_) != 0 && value != 0 ? "0X" : "";
+        break;
+    case 'p':
+        prefix = "0x";
+        break;
+    default:
+        break;
+    }
+
+    pad = kr_fmt_begin_(out, spec, prefix, zeros, count);
+    kr_fmt_write_(out, digits, count);
+    kr_fmt_fill_(out, ' ', pad);
+}
+
+KR_INLINE void kr_fmt_str_(struct kr_fmt_out_s_ *out, struct kr_fmt_spec_s_ *spec, const char *str, size_t count)
+{
+    size_t pad = 0;
+
+    spec->flags &= ~KR_CASTS(unsigned, KR_FMT_ZERO_);
+    pad = kr_fmt_begin_(out, spec, "", 0, count);
+    kr_fmt_write_(out, str, count);
+    kr_fmt_fill_(out, ' ', pad);
+}
+
+#if (KR_FMT_FLOAT_)
+
+/* Decimal digits laid out without an exponent. */
+KR_INLINE void kr_fmt_fixed_(struct kr_fmt_out_s_ *out, const char *digits, size_t count, long point, size_t fracLen,
+                             bool dot)
+{
+    size_t intLen = 0, zeros = 0, rest = 0;
+
+    if (point <= 0)
+    {
+        kr_fmt_write_(out, "0", 1);
+    }
+    else
+    {
+        intLen = KR_CASTS(size_t, point) < count ? KR_CASTS(size_t, point) : count;
+        kr_fmt_write_(out, digits, intLen);
+        kr_fmt_fill_(out, '0', KR_CASTS(size_t, point) - intLen);
+    }
+
+    if (dot)
+    {
+        kr_fmt_write_(out, ".", 1);
+        zeros = point < 0 ? KR_CASTS(size_t, -point) : 0;
+        zeros = zeros < fracLen ? zeros : fracLen;
+        kr_fmt_fill_(out, '0', zeros);
+
+        rest = count - intLen;
+        rest = rest < fracLen - zeros ? rest : fracLen - zeros;
+        kr_fmt_write_(out, digits + intLen, rest);
+        kr_fmt_fill_(out, '0', fracLen - zeros - rest);
+    }
+}
+
+/* Decimal digits laid out with one digit before the point and an exponent. */
+KR_INLINE void kr_fmt_exp_(struct kr_fmt_out_s_ *out, const char *digits, size_t count, long exp, size_t fracLen,
+                           bool dot, char e)
+{
+    char buf[KR_CONV_32_SIZE + 3];
+    size_t rest = 0, len = 0;
+
+    kr_fmt_write_(out, count != 0 ? digits : "0", 1);
+    if (dot)
+    {
+        kr_fmt_write_(out, ".", 1);
+        rest = count > 1 ? count - 1 : 0;
+        rest = rest < fracLen ? rest : fracLen;
+        kr_fmt_write_(out, digits + 1, rest);
+        kr_fmt_fill_(out, '0', fracLen - rest);
+    }
+
+    /* At least two digits of exponent. */
+    buf[len++] = e;
+    buf[len++] = exp < 0 ? '-' : '+';
+    exp = exp < 0 ? -exp : exp;
+    if (exp < 10)
+    {
+        buf[len++] = '0';
+    }
+    len += kr_u32toa(buf + len, KR_CASTS(uint32_t, exp));
+    kr_fmt_write_(out, buf, len);
+}
+
+KR_INLINE void kr_fmt_float_(struct kr_fmt_out_s_ *out, struct kr_fmt_spec_s_ *spec, double value)
+{
+    char digits[KR_FLOAT_DIGITS_SIZE];
+    const bool upper = spec->conv == 'E' || spec->conv == 'F' || spec->conv == 'G';
+    const bool alt = (spec->flags & KR_FMT_ALT_) != 0;
+    const char *prefix = NULL;
+    size_t count = 0, fracLen = 0, bodyLen = 0, pad = 0;
+    long point = 0, exp = 0, precision = spec->precision >= 0 ? spec->precision : 6;
+    uint64_t bits = 0;
+    bool fixed = spec->conv == 'f' || spec->conv == 'F';
+
+    memcpy(&bits, &value, sizeof(bits));
+    prefix = kr_fmt_sign_(spec, (bits >> 63) != 0);
+    value = value < 0 ? -value : value;
+
+    if (value != value || value - value != 0)
+    {
+        spec->flags &= ~KR_CASTS(unsigned, KR_FMT_ZERO_);
+        pad = kr_fmt_begin_(out, spec, prefix, 0, 3);
+        kr_fmt_write_(out, value != value ? (upper ? "NAN" : "nan") : (upper ? "INF" : "inf"), 3);
+        kr_fmt_fill_(out, ' ', pad);
+        return;
+    }
+
+    if (spec->conv == 'g' || spec->conv == 'G')
+    {
+        /* The exponent after rounding picks the style, and trailing zeroes
+           go unless it's the alternate form. */
+        precision = precision != 0 ? precision : 1;
+        count = kr_f64_digits(digits, value, precision, false, &point);
+        exp = count != 0 ? point - 1 : 0;
+        fixed = exp < precision && exp >= -4;
+        if (fixed)
+        {
+            precision -= exp + 1;
+            fracLen = alt ? KR_CASTS(size_t, precision)
+                          : (KR_CASTS(long, count) > point ? count - KR_CASTS(size_t, point) : 0);
+        }
+        else
+        {
+            precision -= 1;
+            fracLen = alt ? KR_CASTS(size_t, precision) : (count > 1 ? count - 1 : 0);
+        }
+    }
+    else if (fixed)
+    {
+        count = kr_f64_digits(digits, value, precision, true, &point);
+        fracLen = KR_CASTS(size_t, precision);
+    }
+    else
+    {
+        count = kr_f64_digits(digits, value, precision + 1, false, &point);
+        exp = count != 0 ? point - 1 : 0;
+        fracLen = KR_CASTS(size_t, precision);
+    }
+
+    if (fixed)
+    {
+        bodyLen = (point > 0 ? KR_CASTS(size_t, point) : 1) + (fracLen != 0 || alt ? fracLen + 1 : 0);
+    }
+    else
+    {
+        bodyLen = 1 + (fracLen != 0 || alt ? fracLen + 1 : 0) + (exp <= -100 || exp >= 100 ? 5 : 4);
+    }
+
+    pad = kr_fmt_begin_(out, spec, prefix, 0, bodyLen);
+    if (fixed)
+    {
+        kr_fmt_fixed_(out, digits, count, point, fracLen, fracLen != 0 || alt);
+    }
+    else
+    {
+        kr_fmt_exp_(out, digits, count, exp, fracLen, fracLen != 0 || alt, upper ? 'E' : 'e');
+    }
+    kr_fmt_fill_(out, ' ', pad);
+}
+
+#endif /* (KR_FMT_FLOAT_) */
+
+/* Parse flags, width, precision and length of a conversion. */
+KR_INLINE const char *kr_fmt_spec_(struct kr_fmt_spec_s_ *spec, const char *fmt, va_list *ap)
+{
+    int arg = 0;
+
+    spec->flags = 0;
+    spec->width = 0;
+    spec->precision = -1;
+    spec->length = '\0';
+
+    for (;; fmt++)
+    {
+        if (*fmt == '-')
+        {
+            spec->flags |= KR_FMT_LEFT_;
+        }
+        else if (*fmt == '+')
+        {
+            spec->flags |= KR_FMT_PLUS_;
+        }
+        else if (*fmt == ' ')
+        {
+            spec->flags |= KR_FMT_SPACE_;
+        }
+        else if (*fmt == '#')
+        {
+            spec->flags |= KR_FMT_ALT_;
+        }
+        else if (*fmt == '0')
+        {
+            spec->flags |= KR_FMT_ZERO_;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    /* A negative width from an argument means left justify. */
+    if (*fmt == '*')
+    {
+        arg = va_arg(*ap, int);
+        spec->flags |= arg < 0 ? KR_FMT_LEFT_ : 0;
+        spec->width = arg < 0 ? 0 - KR_CASTS(size_t, arg) : KR_CASTS(size_t, arg);
+        fmt++;
+    }
+    for (; kr_isdigit(*fmt); fmt++)
+    {
+        spec->width = spec->width < INT_MAX ? spec->width * 10 + KR_CASTS(size_t, *fmt - '0') : spec->width;
+    }
+
+    /* A negative precision from an argument means no precision. */
+    if (*fmt == '.')
+    {
+        fmt++;
+        spec->precision = 0;
+        if (*fmt == '*')
+        {
+            arg = va_arg(*ap, int);
+            spec->precision = arg < 0 ? -1 : arg;
+            fmt++;
+        }
+        for (; kr_isdigit(*fmt); fmt++)
+        {
+            spec->precision = spec->precision < INT_MAX / 10 ? spec->precision * 10 + (*fmt - '0') : INT_MAX;
+        }
+    }
+
+    switch (*fmt)
+    {
+    case 'h':
+        spec->length = fmt[1] == 'h' ? 'H' : 'h';
+        fmt += fmt[1] == 'h' ? 2 : 1;
+        break;
+    case 'l':
+        spec->length = fmt[1] == 'l' ? 'L' : 'l';
+        fmt += fmt[1] == 'l' ? 2 : 1;
+        break;
+    case 'z':
+    case 't':
+    case 'L':
+        spec->length = *fmt++;
+        break;
+    default:
+        break;
+    }
+
+    spec->conv = *fmt;
+    return fmt;
+}
+
+/* Read a signed integer argument, returning its magnitude. */
+KR_INLINE kr_fmt_uint_t_ kr_fmt_sarg_(const struct kr_fmt_spec_s_ *spec, va_list *ap, bool *outNeg)
+{
+    kr_fmt_int_t_ value = 0;
+
+    switch (spec->length)
+    {
+    case 'H':
+        value = KR_CASTS(signed char, va_arg(*ap, int));
+        break;
+    case 'h':
+        value = KR_CASTS(short, va_arg(*ap, int));
+        break;
+    case 'l':
+        value = va_arg(*ap, long);
+        break;
+#if defined(LLONG_MAX)
+    case 'L':
+        value = va_arg(*ap, long long);
+        break;
+#elif defined(UINT64_MAX)
+    case 'L':
+        value = va_arg(*ap, int64_t);
+        break;
+#endif
+    case 'z':
+    case 't':
+        value = va_arg(*ap, ptrdiff_t);
+        break;
+    default:
+        value = va_arg(*ap, int);
+        break;
+    }
+
+    *outNeg = value < 0;
+    return value < 0 ? 0 - KR_CASTS(kr_fmt_uint_t_, value) : KR_CASTS(kr_fmt_uint_t_, value);
+}
+
+/* Read an unsigned integer argument. */
+KR_INLINE kr_fmt_uint_t_ kr_fmt_uarg_(const struct kr_fmt_spec_s_ *spec, va_list *ap)
+{
+    switch (spec->length)
+    {
+    case 'H':
+        return KR_CASTS(unsigned char, va_arg(*ap, unsigned));
+    case 'h':
+        return KR_CASTS(unsigned short, va_arg(*ap, unsigned));
+    case 'l':
+        return va_arg(*ap, unsigned long);
+#if defined(LLONG_MAX)
+    case 'L':
+        return va_arg(*ap, unsigned long long);
+#elif defined(UINT64_MAX)
+    case 'L':
+        return va_arg(*ap, uint64_t);
+#endif
+    case 'z':
+        return va_arg(*ap, size_t);
+    case 't':
+        return KR_CASTS(kr_fmt_uint_t_, va_arg(*ap, ptrdiff_t));
+    default:
+        return va_arg(*ap, unsigned);
+    }
+}
+
+/*
+ * Format one conversion, fmt points after the '%'.  Returns a pointer past
+ * the conversion, or NULL if it isn't supported.
+ */
+KR_INLINE const char *kr_fmt_conv_(struct kr_fmt_out_s_ *out, const char *fmt, va_list *ap)
+{
+    struct kr_fmt_spec_s_ spec;
+    const char *str = NULL;
+    char ch = '\0';
+    kr_fmt_uint_t_ value = 0;
+    bool neg = false;
+
+    /* Plain %s and %d are most of what gets formatted. */
+    if (*fmt == 's')
+    {
+        str = va_arg(*ap, const char *);
+        str = str != NULL ? str : "(null)";
+        kr_fmt_write_(out, str, kr_strlen(str));
+        return fmt + 1;
+    }
+    if (*fmt == 'd')
+    {
+        char digits[KR_FMT_INT_SIZE_];
+        const int arg = va_arg(*ap, int);
+        size_t count = 0;
+
+        if (arg < 0)
+        {
+            digits[count++] = '-';
+        }
+        count += kr_fmt_digits_(digits + count,
+                                arg < 0 ? 0 - KR_CASTS(kr_fmt_uint_t_, arg) : KR_CASTS(kr_fmt_uint_t_, arg), 'd');
+        kr_fmt_write_(out, digits, count);
+        return fmt + 1;
+    }
+
+    fmt = kr_fmt_spec_(&spec, fmt, ap);
+    switch (spec.conv)
+    {
+    case 'd':
+    case 'i':
+        value = kr_fmt_sarg_(&spec, ap, &neg);
+        kr_fmt_int_(out, &spec, value, neg);
+        break;
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+        value = kr_fmt_uarg_(&spec, ap);
+        kr_fmt_int_(out, &spec, value, false);
+        break;
+    case 'p':
+        value = KR_CASTS(kr_fmt_uint_t_, KR_CASTR(size_t, va_arg(*ap, void *)));
+        kr_fmt_int_(out, &spec, value, false);
+        break;
+    case 'c':
+        ch = KR_CASTS(char, va_arg(*ap, int));
+        kr_fmt_str_(out, &spec, &ch, 1);
+        break;
+    case 's':
+        str = va_arg(*ap, const char *);
+        str = str != NULL ? str : "(null)";
+        kr_fmt_str_(out, &spec, str,
+                    spec.precision >= 0 ? kr_strnlen(str, KR_CASTS(size_t, spec.precision)) : kr_strlen(str));
+        break;
+    case '%':
+        kr_fmt_write_(out, "%", 1);
+        break;
+#if (KR_FMT_FLOAT_)
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+        if (spec.length == 'L')
+        {
+            kr_fmt_float_(out, &spec, KR_CASTS(double, va_arg(*ap, long double)));
+        }
+        else
+        {
+            kr_fmt_float_(out, &spec, va_arg(*ap, double));
+        }
+        break;
+#endif
+    default:
+        return NULL;
+    }
+
+    return fmt + 1;
+}
+
+KR_INLINE int kr_snprintf(char *buf, size_t len, const char *fmt, ...)
+{
+    int count = 0;
+    va_list args;
+
+    va_start(args, fmt);
+    count = kr_vsnprintf(buf, len, fmt, args);
+    va_end(args);
+    return count;
+}
+
+KR_INLINE int kr_vsnprintf(char *buf, size_t len, const char *fmt, va_list args)
+{
+    struct kr_fmt_out_s_ out;
+    const char *lit = NULL;
+    va_list ap;
+
+    out.buf = buf;
+    out.len = len != 0 ? len - 1 : 0;
+    out.pos = 0;
+
+    /* Helpers take a pointer to a copy, since a va_list parameter might be
+       an array that decayed into a pointer. */
+    va_copy(ap, args);
+    while (fmt != NULL && *fmt != '\0')
+    {
+        /* Copy everything up to the next conversion in one go. */
+        lit = fmt;
+        while (*fmt != '\0' && *fmt != '%')
+        {
+            fmt++;
+        }
+        kr_fmt_write_(&out, lit, KR_CASTS(size_t, fmt - lit));
+
+        if (*fmt == '%')
+        {
+            fmt = kr_fmt_conv_(&out, fmt + 1, &ap);
+        }
+    }
+    va_end(ap);
+
+    if (len != 0)
+    {
+        buf[out.pos < out.len ? out.pos : out.len] = '\0';
+    }
+    return fmt != NULL && out.pos <= INT_MAX ? KR_CASTS(int, out.pos) : -1;
+}
+
+#undef KR_FMT_LEFT_
+#undef KR_FMT_PLUS_
+#undef KR_FMT_SPACE_
+#undef KR_FMT_ALT_
+#undef KR_FMT_ZERO_
+#undef KR_FMT_FLOAT_
+#undef KR_FMT_INT_SIZE_
+
+#endif /* !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION) */
+
+#endif /* !defined(KRFMT_H) */
@@ -0,0 +1,454 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * Hexadecimal encoding
+ *
+ * Turning bytes into hex digits and back one nibble at a time spends most of
+ * its time on branches and table lookups.  These convert a machine word or
+ * SIMD register at a time: every nibble becomes a digit with one compare and
+ * add, and decoding checks that a whole block is valid before combining
+ * pairs of digits into bytes.
+ *
+ * Decoding accepts upper and lower case digits mixed together, and reports
+ * how far it got, so a caller can tell exactly which character was bad.
+ */
+
+#if !defined(KRHEX_H)
+#define KRHEX_H
+
+#include "./krconfig.h"
+
+#include "./krbool.h"
+#include "./krint.h"
+#include "./krserial.h"
+
+#if (!KR_CONFIG_NOINCLUDE)
+#include <stddef.h>
+#endif
+
+#if (KR_AVX2)
+#include <immintrin.h>
+#elif (KR_SSSE3)
+#include <tmmintrin.h>
+#elif (KR_SSE2)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief Encode bytes as hexadecimal digits.
+ *
+ * @details Dispatches to the fastest of the variants below that the compiler
+ *          targets.  The most significant nibble of each byte comes first.
+ *
+ * @param dest Destination buffer, at least len * 2 bytes.  Not terminated.
+ * @param src Bytes to encode.
+ * @param len Number of bytes to encode.
+ * @param upper True to use "ABCDEF", false to use "abcdef".
+ * @return Number of characters written, always len * 2.
+ */
+KR_INLINE size_t kr_hex_encode(char *dest, const void *src, size_t len, bool upper);
+
+/**
+ * @brief Encode bytes as hexadecimal digits, 8 bytes at a time in a 64-bit
+ *        word.
+ */
+KR_INLINE size_t kr_hex_encode_swar(char *dest, const void *src, size_t len, bool upper);
+
+#if (KR_SSE2)
+
+/**
+ * @brief Encode bytes as hexadecimal digits, 16 bytes at a time with SSE2.
+ */
+KR_INLINE size_t kr_hex_encode_sse2(char *dest, const void *src, size_t len, bool upper);
+
+#endif /* (KR_SSE2) */
+
+#if (KR_AVX2)
+
+/**
+ * @brief Encode bytes as hexadecimal digits, 32 bytes at a time with AVX2.
+ */
+KR_INLINE size_t kr_hex_encode_avx2(char *dest, const void *src, size_t len, bool upper);
+
+#endif /* (KR_AVX2) */
+
+/**
+ * @brief Decode hexadecimal digits into bytes.
+ *
+ * @details Dispatches to the fastest of the variants below that the compiler
+ *          targets.  Digits can be upper or lower case, and there is no
+ *          prefix or whitespace.  Every pair of digits before the first
+ *          invalid character is decoded, and a final unpaired digit is
+ *          treated as invalid.
+ *
+ * @param dest Destination buffer, at least len / 2 bytes.
+ * @param src Digits to decode, which do not need to be terminated.
+ * @param len Number of characters to decode.
+ * @return len if every character was decoded, otherwise the position of the
+ *         first character that could not be.  In either case, half of the
+ *         return value rounded down is the number of bytes written.
+ */
+KR_INLINE size_t kr_hex_decode(void *dest, const char *src, size_t len);
+
+/**
+ * @brief Decode hexadecimal digits into bytes, 8 characters at a time in a
+ *        64-bit word.
+ */
+KR_INLINE size_t kr_hex_decode_swar(void *dest, const char *src, size_t len);
+
+#if (KR_SSE2)
+
+/**
+ * @brief Decode hexadecimal digits into bytes, 16 characters at a time with
+ *        SSE2.
+ */
+KR_INLINE size_t kr_hex_decode_sse2(void *dest, const char *src, size_t len);
+
+#endif /* (KR_SSE2) */
+
+#if (KR_AVX2)
+
+/**
+ * @brief Decode hexadecimal digits into bytes, 32 characters at a time with
+ *        AVX2.
+ */
+KR_INLINE size_t kr_hex_decode_avx2(void *dest, const char *src, size_t len);
+
+#endif /* (KR_AVX2) */
+
+/******************************************************************************/
+#if !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION)
+/******************************************************************************/
+
+/* Distance from '0' + 10 to the first letter digit. */
+#define KR_HEX_LETTER_(upper) ((upper) ? 'A' - '0' - 10 : 'a' - '0' - 10)
+
+/* Encode from byte i to the end, one byte at a time. */
+KR_INLINE size_t kr_hex_encode_tail_(char *dest, const unsigned char *src, size_t i, size_t len, bool upper)
+{
+    const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char *d = dest + i * 2;
+
+    for (; i < len; i++, d += 2)
+    {
+        d[0] = digits[src[i] >> 4];
+        d[1] = digits[src[i] & 0x0F];
+    }
+    return len * 2;
+}
+
+/* Value of a hex digit, or -1 if it isn't one. */
+KR_INLINE int kr_hex_digit_(char ch)
+{
+    const unsigned c = KR_CASTS(unsigned char, ch);
+
+    if (c - '0' < 10)
+    {
+        return KR_CASTS(int, c - '0');
+    }
+    if ((c | 0x20) - 'a' < 6)
+    {
+        return KR_CASTS(int, (c | 0x20) - 'a' + 10);
+    }
+    return -1;
+}
+
+/* Decode from character i to the end, one pair at a time. */
+KR_INLINE size_t kr_hex_decode_tail_(unsigned char *dest, const char *src, size_t i, size_t len)
+{
+    int hi = 0, lo = 0;
+
+    for (; len - i >= 2; i += 2)
+    {
+        hi = kr_hex_digit_(src[i]);
+        if (hi < 0)
+        {
+            return i;
+        }
+        lo = kr_hex_digit_(src[i + 1]);
+        if (lo < 0)
+        {
+            return i + 1;
+        }
+        dest[i / 2] = KR_CASTS(unsigned char, (hi << 4) | lo);
+    }
+
+    /* Either the end, or an unpaired digit. */
+    return i;
+}
+
+/******************************************************************************/
+
+KR_INLINE size_t kr_hex_encode(char *dest, const void *src, size_t len, bool upper)
+{
+#if (KR_AVX2)
+    return kr_hex_encode_avx2(dest, src, len, upper);
+#elif (KR_SSE2)
+    return kr_hex_encode_sse2(dest, src, len, upper);
+#else
+    return kr_hex_encode_swar(dest, src, len, upper);
+#endif
+}
+
+#if defined(UINT64_MAX)
+
+/*
+ * Spread 4 bytes loaded little-endian into 8 nibbles, one per byte, and turn
+ * each into a digit.  Adding 6 carries into bit 4 exactly for nibbles above
+ * 9, which picks out the ones that need to skip ahead to the letters.
+ */
+KR_INLINE uint64_t kr_hex_encode4_(uint32_t bytes, uint64_t letter)
+{
+    const uint64_t ones = UINT64_C(0x0101010101010101);
+    uint64_t word = bytes;
+
+    word = (word | (word << 16)) & UINT64_C(0x0000FFFF0000FFFF);
+    word = (word | (word << 8)) & UINT64_C(0x00FF00FF00FF00FF);
+    word = ((word >> 4) & UINT64_C(0x000F000F000F000F)) | ((word & UINT64_C(0x000F000F000F000F)) << 8);
+    return word + ones * '0' + (((word + ones * 6) >> 4) & ones) * letter;
+}
+
+#endif /* defined(UINT64_MAX) */
+
+KR_INLINE size_t kr_hex_encode_swar(char *dest, const void *src, size_t len, bool upper)
+{
+    const unsigned char *s = KR_CASTS(const unsigned char *, src);
+    size_t i = 0;
+
+#if defined(UINT64_MAX)
+    const uint64_t letter = KR_HEX_LETTER_(upper);
+
+    for (; len - i >= 8; i += 8)
+    {
+        const uint64_t bytes = kr_load_u64le(KR_CASTC(unsigned char *, s + i));
+        kr_store_u64le(dest + i * 2, kr_hex_encode4_(KR_CASTS(uint32_t, bytes), letter));
+        kr_store_u64le(dest + i * 2 + 8, kr_hex_encode4_(KR_CASTS(uint32_t, bytes >> 32), letter));
+    }
+#endif
+
+    return kr_hex_encode_tail_(dest, s, i, len, upper);
+}
+
+#if (KR_SSE2)
+
+/* Turn nibbles into digits, skipping ahead to the letters past 9. */
+KR_INLINE __m128i kr_hex_digits16_(__m128i nibbles, __m128i letter)
+{
+    const __m128i over = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9));
+    return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), _mm_and_si128(over, letter));
+}
+
+KR_INLINE size_t kr_hex_encode_sse2(char *dest, const void *src, size_t len, bool upper)
+{
+    const unsigned char *s = KR_CASTS(const unsigned char *, src);
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i letter = _mm_set1_epi8(KR_HEX_LETTER_(upper));
+    size_t i = 0;
+
+    for (; len - i >= 16; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(KR_CASTR(const __m128i *, s + i));
+        const __m128i hi = kr_hex_digits16_(_mm_and_si128(_mm_srli_epi16(v, 4), mask), letter);
+        const __m128i lo = kr_hex_digits16_(_mm_and_si128(v, mask), letter);
+
+        /* Interleaving puts the high nibble of each byte first. */
+        _mm_storeu_si128(KR_CASTR(__m128i *, dest + i * 2), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(KR_CASTR(__m128i *, dest + i * 2 + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+
+    return kr_hex_encode_tail_(dest, s, i, len, upper);
+}
+
+#endif /* (KR_SSE2) */
+
+#if (KR_AVX2)
+
+KR_INLINE __m256i kr_hex_digits32_(__m256i nibbles, __m256i letter)
+{
+    const __m256i over = _mm256_cmpgt_epi8(nibbles, _mm256_set1_epi8(9));
+    return _mm256_add_epi8(_mm256_add_epi8(nibbles, _mm256_set1_epi8('0')), _mm256_and_si256(over, letter));
+}
+
+KR_INLINE size_t kr_hex_encode_avx2(char *dest, const void *src, size_t len, bool upper)
+{
+    const unsigned char *s = KR_CASTS(const unsigned char *, src);
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    const __m256i letter = _mm256_set1_epi8(KR_HEX_LETTER_(upper));
+    size_t i = 0;
+
+    for (; i + 32 <= len; i += 32)
+    {
+        const __m256i v = _mm256_loadu_si256(KR_CASTR(const __m256i *, s + i));
+        const __m256i hi = kr_hex_digits32_(_mm256_and_si256(_mm256_srli_epi16(v, 4), mask), letter);
+        const __m256i lo = kr_hex_digits32_(_mm256_and_si256(v, mask), letter);
+
+        /* Unpacking works within each 128-bit lane, so swap the middle. */
+        const __m256i first = _mm256_unpacklo_epi8(hi, lo);
+        const __m256i second = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256(KR_CASTR(__m256i *, dest + i * 2), _mm256_permute2x128_si256(first, second, 0x20));
+        _mm256_storeu_si256(KR_CASTR(__m256i *, dest + i * 2 + 32), _mm256_permute2x128_si256(first, second, 0x31));
+    }
+
+    return kr_hex_encode_tail_(dest, s, i, len, upper);
+}
+
+#endif /* (KR_AVX2) */
+
+/******************************************************************************/
+
+KR_INLINE size_t kr_hex_decode(void *dest, const char *src, size_t len)
+{
+#if (KR_AVX2)
+    return kr_hex_decode_avx2(dest, src, len);
+#elif (KR_SSE2)
+    return kr_hex_decode_sse2(dest, src, len);
+#else
+    return kr_hex_decode_swar(dest, src, len);
+#endif
+}
+
+KR_INLINE size_t kr_hex_decode_swar(void *dest, const char *src, size_t len)
+{
+    unsigned char *d = KR_CASTS(unsigned char *, dest);
+    size_t i = 0;
+
+#if defined(UINT64_MAX)
+    const uint64_t ones = UINT64_C(0x0101010101010101);
+    const uint64_t highs = ones * 0x80;
+
+    for (; len - i >= 8; i += 8)
+    {
+        /* Same range trick as krstr.h, letters are checked folded. */
+        const uint64_t word = kr_load_u64le(KR_CASTC(char *, src + i));
+        const uint64_t low = word & ~highs;
+        const uint64_t folded = low | (ones * 0x20);
+        const uint64_t digit = (low + ones * (0x80 - '0')) & ~(low + ones * (0x7F - '9'));
+        const uint64_t letter = (folded + ones * (0x80 - 'a')) & ~(folded + ones * (0x7F - 'f'));
+        uint64_t value = 0;
+
+        if (((digit | letter) & ~word & highs) != highs)
+        {
+            break;
+        }
+
+        /* 'A' and 'a' both end in 1, so letters need 9 more to reach 10. */
+        value = (word & (ones * 0x0F)) + ((letter & ~word & highs) >> 7) * 9;
+
+        /* Each pair of digits is a 16-bit lane, first digit on the bottom. */
+        value = ((value << 4) | (value >> 8)) & UINT64_C(0x00FF00FF00FF00FF);
+        value = (value | (value >> 8)) & UINT64_C(0x0000FFFF0000FFFF);
+        value = (value | (value >> 16)) & UINT64_C(0x00000000FFFFFFFF);
+        kr_store_u32le(d + i / 2, KR_CASTS(uint32_t, value));
+    }
+#endif
+
+    /* Also finds the exact position of a bad character in a failed block. */
+    return kr_hex_decode_tail_(d, src, i, len);
+}
+
+#if (KR_SSE2)
+
+/*
+ * Convert 16 digits to their values, or return false if any of them isn't
+ * a digit.  Range checks use the same signed compare as krstr.h.
+ */
+KR_INLINE bool kr_hex_values16_(__m128i v, __m128i *outValues)
+{
+    const __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    const __m128i digit = _mm_cmpgt_epi8(_mm_set1_epi8(KR_CASTS(char, '9' - '0' - 0x7F)),
+                                         _mm_sub_epi8(v, _mm_set1_epi8(KR_CASTS(char, '0' + 0x80))));
+    const __m128i letter = _mm_cmpgt_epi8(_mm_set1_epi8(KR_CASTS(char, 'f' - 'a' - 0x7F)),
+                                          _mm_sub_epi8(folded, _mm_set1_epi8(KR_CASTS(char, 'a' + 0x80))));
+
+    if (_mm_movemask_epi8(_mm_or_si128(digit, letter)) != 0xFFFF)
+    {
+        return false;
+    }
+
+    *outValues = _mm_add_epi8(_mm_and_si128(v, _mm_set1_epi8(0x0F)), _mm_and_si128(letter, _mm_set1_epi8(9)));
+    return true;
+}
+
+KR_INLINE size_t kr_hex_decode_sse2(void *dest, const char *src, size_t len)
+{
+    unsigned char *d = KR_CASTS(unsigned char *, dest);
+    __m128i values;
+    size_t i = 0;
+
+    for (; len - i >= 16; i += 16)
+    {
+        if (!kr_hex_values16_(_mm_loadu_si128(KR_CASTR(const __m128i *, src + i)), &values))
+        {
+            break;
+        }
+
+        /* Each pair of digits is a 16-bit lane, first digit on the bottom. */
+        values = _mm_or_si128(_mm_slli_epi16(values, 4), _mm_srli_epi16(values, 8));
+        values = _mm_and_si128(values, _mm_set1_epi16(0x00FF));
+        _mm_storel_epi64(KR_CASTR(__m128i *, d + i / 2), _mm_packus_epi16(values, values));
+    }
+
+    return kr_hex_decode_tail_(d, src, i, len);
+}
+
+#endif /* (KR_SSE2) */
+
+#if (KR_AVX2)
+
+KR_INLINE bool kr_hex_values32_(__m256i v, __m256i *outValues)
+{
+    const __m256i folded = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    const __m256i digit = _mm256_cmpgt_epi8(_mm256_set1_epi8(KR_CASTS(char, '9' - '0' - 0x7F)),
+                                            _mm256_sub_epi8(v, _mm256_set1_epi8(KR_CASTS(char, '0' + 0x80))));
+    const __m256i letter = _mm256_cmpgt_epi8(_mm256_set1_epi8(KR_CASTS(char, 'f' - 'a' - 0x7F)),
+                                             _mm256_sub_epi8(folded, _mm256_set1_epi8(KR_CASTS(char, 'a' + 0x80))));
+
+    if (_mm256_movemask_epi8(_mm256_or_si256(digit, letter)) != -1)
+    {
+        return false;
+    }
+
+    *outValues =
+        _mm256_add_epi8(_mm256_and_si256(v, _mm256_set1_epi8(0x0F)), _mm256_and_si256(letter, _mm256_set1_epi8(9)));
+    return true;
+}
+
+KR_INLINE size_t kr_hex_decode_avx2(void *dest, const char *src, size_t len)
+{
+    unsigned char *d = KR_CASTS(unsigned char *, dest);
+    __m256i values;
+    size_t i = 0;
+
+    for (; len - i >= 32; i += 32)
+    {
+        if (!kr_hex_values32_(_mm256_loadu_si256(KR_CASTR(const __m256i *, src + i)), &values))
+        {
+            break;
+        }
+
+        values = _mm256_or_si256(_mm256_slli_epi16(values, 4), _mm256_srli_epi16(values, 8));
+        values = _mm256_and_si256(values, _mm256_set1_epi16(0x00FF));
+
+        /* Packing works within each 128-bit lane, gather the low halves. */
+        values = _mm256_permute4x64_epi64(_mm256_packus_epi16(values, values), 0x08);
+        _mm_storeu_si128(KR_CASTR(__m128i *, d + i / 2), _mm256_castsi256_si128(values));
+    }
+
+    return kr_hex_decode_tail_(d, src, i, len);
+}
+
+#endif /* (KR_AVX2) */
+
+#undef KR_HEX_LETTER_
+
+/******************************************************************************/
+#endif /* !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION) */
+/******************************************************************************/
+
+#endif /* !defined(KRHEX_H) */
@@ -0,0 +1,371 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * INI file parsing
+ *
+ * Loading an INI file with kr_strtok_r means copying the whole file so it
+ * can be cut up, then copying every key and value out of it again.  This
+ * parses the buffer as it is instead, which can be a file mapped into
+ * memory, and records each section, key and value as a slice of it.  Lines
+ * are found with kr_memchr, so most of the file is only looked at a block
+ * at a time.
+ *
+ * The index is built in an arena, so parsing allocates a handful of times
+ * no matter how big the file is, and destroying it frees everything at
+ * once.  Keys are found through a hash table over section and key, so a
+ * lookup doesn't depend on the size of the file either.
+ *
+ * The syntax is the common subset:
+ *
+ * - "[section]" starts a section.  Keys before the first section are in
+ *   the section "".
+ * - "key = value" sets a key.  Whitespace around keys and values is
+ *   trimmed, and the value runs to the end of the line.
+ * - Lines that start with ';' or '#' are comments.
+ * - Names are case-sensitive, and a key that is set more than once keeps
+ *   its last value.
+ */
+
+#if !defined(KRINI_H)
+#define KRINI_H
+
+#include "./krconfig.h"
+
+#include "./krarena.h"
+#include "./krbool.h"
+#include "./krctype.h"
+#include "./krint.h"
+#include "./krlib.h"
+#include "./krstr.h"
+
+#if (!KR_CONFIG_NOINCLUDE)
+#include <stddef.h>
+#include <string.h>
+#endif
+
+/**
+ * @brief A key and its value, as slices of the parsed buffer.
+ */
+struct kr_ini_entry_s
+{
+    const char *section; /* Name of section the key is in. */
+    size_t sectionLen;
+    const char *key;
+    size_t keyLen;
+    const char *value;
+    size_t valueLen;
+    uint32_t hash; /* Hash of section and key. */
+};
+
+/**
+ * @brief An index of the keys in an INI file.
+ *
+ * @details A zero-initialized index is a valid empty index.
+ */
+struct kr_ini_s
+{
+    struct kr_ini_entry_s *entries; /* Every key, in the order they appear. */
+    size_t count;                   /* Number of entries. */
+    size_t *slots;                  /* Hash table of entry index plus one,
+                                       power of two size. */
+    size_t slotsLen;                /* Number of slots. */
+    struct kr_arena_s arena;        /* Storage for entries and slots. */
+};
+
+/**
+ * @brief Initialize an empty INI index.
+ *
+ * @details Does not allocate.
+ *
+ * @param ini Index to initialize.
+ */
+KR_INLINE void kr_ini_init(struct kr_ini_s *ini);
+
+/**
+ * @brief Free memory owned by an INI index.
+ *
+ * @param ini Index to destroy.  It can be used again afterwards.
+ */
+KR_INLINE void kr_ini_destroy(struct kr_ini_s *ini);
+
+/**
+ * @brief Parse an INI file, replacing anything already in the index.
+ *
+ * @details Nothing is copied out of the buffer, so it has to outlive the
+ *          index.  It does not need to be terminated.
+ *
+ * @param ini Index to fill.
+ * @param src Buffer to parse.
+ * @param len Length of buffer.
+ * @param outError Output offset of the start of the line that could not
+ *                 be parsed, or len if memory could not be allocated.  Can
+ *                 be NULL.
+ * @return True if the whole buffer was parsed.  On failure the index holds
+ *         the keys before the error.
+ */
+KR_INLINE bool kr_ini_parse(struct kr_ini_s *ini, const char *src, size_t len, size_t *outError);
+
+/**
+ * @brief Find a key.
+ *
+ * @param ini Index to search.
+ * @param section Name of section, "" for keys before the first section.
+ * @param sectionLen Length of section name.
+ * @param key Name of key.
+ * @param keyLen Length of key name.
+ * @return Entry with the last value of the key, or NULL if it isn't set.
+ */
+KR_INLINE const struct kr_ini_entry_s *kr_ini_find(const struct kr_ini_s *ini, const char *section,
+                                                   size_t sectionLen, const char *key, size_t keyLen);
+
+/**
+ * @brief Get the value of a key.
+ *
+ * @param ini Index to search.
+ * @param section Name of section, "" for keys before the first section.
+ * @param key Name of key.
+ * @param outLen Output length of value.  Can be NULL.
+ * @return Value of key, not terminated, or NULL if it isn't set.
+ */
+KR_INLINE const char *kr_ini_get(const struct kr_ini_s *ini, const char *section, const char *key, size_t *outLen);
+
+/******************************************************************************/
+#if !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION)
+/******************************************************************************/
+
+#define KR_INI_MINENTRIES_ 16
+
+/* Hashing the key on from the hash of its section gives one hash for both. */
+KR_INLINE uint32_t kr_ini_hash_(const char *section, size_t sectionLen, const char *key, size_t keyLen)
+{
+    return KR_CASTS(uint32_t, kr_hash(kr_hash(0, section, sectionLen), key, keyLen));
+}
+
+/* Slot that holds the key, or the empty slot it would go in. */
+KR_INLINE size_t *kr_ini_probe_(const struct kr_ini_s *ini, const char *section, size_t sectionLen,
+                                const char *key, size_t keyLen, uint32_t hash)
+{
+    const size_t mask = ini->slotsLen - 1;
+    size_t i = hash & mask;
+
+    for (;; i = (i + 1) & mask)
+    {
+        const struct kr_ini_entry_s *entry = NULL;
+        if (ini->slots[i] == 0)
+        {
+            return &ini->slots[i];
+        }
+
+        entry = &ini->entries[ini->slots[i] - 1];
+        if (entry->hash == hash && entry->keyLen == keyLen && entry->sectionLen == sectionLen &&
+            memcmp(entry->key, key, keyLen) == 0 && memcmp(entry->section, section, sectionLen) == 0)
+        {
+            return &ini->slots[i];
+        }
+    }
+}
+
+/* Make room for one more entry, leaving the old array behind in the arena. */
+KR_INLINE bool kr_ini_grow_(struct kr_ini_s *ini, size_t *cap)
+{
+    const size_t newCap = *cap != 0 ? *cap * 2 : KR_INI_MINENTRIES_;
+    struct kr_ini_entry_s *entries = NULL;
+
+    if (newCap > KR_CASTS(size_t, -1) / sizeof(*entries))
+    {
+        return false;
+    }
+    entries = KR_CASTS(struct kr_ini_entry_s *, kr_arena_alloc(&ini->arena, newCap * sizeof(*entries)));
+    if (entries == NULL)
+    {
+        return false;
+    }
+
+    if (ini->count != 0)
+    {
+        memcpy(entries, ini->entries, ini->count * sizeof(*entries));
+    }
+    ini->entries = entries;
+    *cap = newCap;
+    return true;
+}
+
+/* Hash every entry, keeping the last of any duplicates. */
+KR_INLINE bool kr_ini_index_(struct kr_ini_s *ini)
+{
+    size_t i = 0, slotsLen = 1;
+    size_t *slot = NULL;
+
+    /* At least twice as many slots as keys, and one always empty to end a
+       probe for a key that isn't there. */
+    while (slotsLen / 2 < ini->count + 1)
+    {
+        slotsLen *= 2;
+    }
+    if (slotsLen > KR_CASTS(size_t, -1) / sizeof(size_t))
+    {
+        return false;
+    }
+    ini->slots = KR_CASTS(size_t *, kr_arena_alloc(&ini->arena, slotsLen * sizeof(size_t)));
+    if (ini->slots == NULL)
+    {
+        return false;
+    }
+    memset(ini->slots, 0, slotsLen * sizeof(size_t));
+    ini->slotsLen = slotsLen;
+
+    for (i = 0; i < ini->count; i++)
+    {
+        const struct kr_ini_entry_s *entry = &ini->entries[i];
+        slot = kr_ini_probe_(ini, entry->section, entry->sectionLen, entry->key, entry->keyLen, entry->hash);
+        *slot = i + 1;
+    }
+    return true;
+}
+
+/******************************************************************************/
+
+KR_INLINE void kr_ini_init(struct kr_ini_s *ini)
+{
+    ini->entries = NULL;
+    ini->count = 0;
+    ini->slots = NULL;
+    ini->slotsLen = 0;
+    kr_arena_init(&ini->arena, 0);
+}
+
+KR_INLINE void kr_ini_destroy(struct kr_ini_s *ini)
+{
+    kr_arena_destroy(&ini->arena);
+    kr_ini_init(ini);
+}
+
+KR_INLINE bool kr_ini_parse(struct kr_ini_s *ini, const char *src, size_t len, size_t *outError)
+{
+    const char *section = src, *line = NULL, *end = NULL, *eq = NULL, *newline = NULL;
+    size_t sectionLen = 0, cap = 0, pos = 0, error = len;
+    struct kr_ini_entry_s *entry = NULL;
+    bool ok = true;
+
+    kr_ini_destroy(ini);
+    while (pos < len)
+    {
+        /* Trim the line, which takes care of CRLF too. */
+        newline = KR_CASTS(const char *, kr_memchr(src + pos, '\n', len - pos));
+        line = src + pos;
+        end = newline != NULL ? newline : src + len;
+        pos = KR_CASTS(size_t, end - src) + 1;
+        for (; line < end && kr_isspace(*line); line++)
+        {
+        }
+        for (; end > line && kr_isspace(end[-1]); end--)
+        {
+        }
+
+        if (line == end || *line == ';' || *line == '#')
+        {
+            continue;
+        }
+        else if (*line == '[')
+        {
+            if (end[-1] != ']' || end - line < 2)
+            {
+                error = KR_CASTS(size_t, line - src);
+                ok = false;
+                break;
+            }
+            for (section = line + 1; section < end - 1 && kr_isspace(*section); section++)
+            {
+            }
+            for (end -= 1; end > section && kr_isspace(end[-1]); end--)
+            {
+            }
+            sectionLen = KR_CASTS(size_t, end - section);
+            continue;
+        }
+
+        eq = KR_CASTS(const char *, kr_memchr(line, '=', KR_CASTS(size_t, end - line)));
+        if (eq == NULL || eq == line)
+        {
+            error = KR_CASTS(size_t, line - src);
+            ok = false;
+            break;
+        }
+        if (ini->count == cap && !kr_ini_grow_(ini, &cap))
+        {
+            ok = false;
+            break;
+        }
+
+        entry = &ini->entries[ini->count++];
+        entry->section = section;
+        entry->sectionLen = sectionLen;
+        entry->key = line;
+        for (entry->keyLen = KR_CASTS(size_t, eq - line); kr_isspace(line[entry->keyLen - 1]); entry->keyLen--)
+        {
+        }
+        for (entry->value = eq + 1; entry->value < end && kr_isspace(*entry->value); entry->value++)
+        {
+        }
+        entry->valueLen = KR_CASTS(size_t, end - entry->value);
+        entry->hash = kr_ini_hash_(section, sectionLen, entry->key, entry->keyLen);
+    }
+
+    if (!kr_ini_index_(ini))
+    {
+        ini->count = 0;
+        error = len;
+        ok = false;
+    }
+    if (!ok)
+    {
+        if (outError != NULL)
+        {
+            *outError = error;
+        }
+        return false;
+    }
+    return true;
+}
+
+KR_INLINE const struct kr_ini_entry_s *kr_ini_find(const struct kr_ini_s *ini, const char *section,
+                                                   size_t sectionLen, const char *key, size_t keyLen)
+{
+    const size_t *slot = NULL;
+
+    if (ini->slotsLen == 0)
+    {
+        return NULL;
+    }
+    slot = kr_ini_probe_(ini, section, sectionLen, key, keyLen, kr_ini_hash_(section, sectionLen, key, keyLen));
+    return *slot != 0 ? &ini->entries[*slot - 1] : NULL;
+}
+
+KR_INLINE const char *kr_ini_get(const struct kr_ini_s *ini, const char *section, const char *key, size_t *outLen)
+{
+    const struct kr_ini_entry_s *entry = kr_ini_find(ini, section, kr_strlen(section), key, kr_strlen(key));
+
+    if (entry == NULL)
+    {
+        return NULL;
+    }
+    if (outLen != NULL)
+    {
+        *outLen = entry->valueLen;
+    }
+    return entry->value;
+}
+
+#undef KR_INI_MINENTRIES_
+
+/******************************************************************************/
+#endif /* !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION) */
+/******************************************************************************/
+
+#endif /* !defined(KRINI_H) */
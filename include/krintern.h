@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * String interning
+ *
+ * Keeps exactly one copy of each distinct string.  Interning the same
+ * contents twice returns the same pointer, so interned strings can be
+ * compared for equality with == instead of kr_strcmp.
+ *
+ * Strings are copied into an arena and never move or get freed until the
+ * whole table is destroyed, which saves a heap allocation per string.
+ * The table itself is open addressing with linear probing, and keeps each
+ * string's hash so most mismatches never touch the string data.
+ */
+
+#if !defined(KRINTERN_H)
+#define KRINTERN_H
+
+#include "./krconfig.h"
+
+#include "./krarena.h"
+#include "./krbool.h"
+#include "./krint.h"
+#include "./krlib.h"
+#include "./krstr.h"
+
+#if (!KR_CONFIG_NOINCLUDE)
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+/**
+ * @brief One slot of an interning table.
+ */
+struct kr_intern_slot_s
+{
+    const char *str; /* Interned string, NULL if slot is empty. */
+    size_t len;      /* Length of string, not including terminator. */
+    uint32_t hash;   /* Hash of string. */
+};
+
+/**
+ * @brief A table of interned strings.
+ *
+ * @details A zero-initialized table is a valid empty table.
+ */
+struct kr_intern_s
+{
+    struct kr_intern_slot_s *slots; /* Hash table, power of two size. */
+    size_t slotsLen;                /* Number of slots. */
+    size_t count;                   /* Number of interned strings. */
+    struct kr_arena_s arena;        /* String storage. */
+};
+
+/**
+ * @brief Initialize an empty interning table.
+ *
+ * @details Does not allocate.
+ *
+ * @param intern Table to initialize.
+ */
+KR_INLINE void kr_intern_init(struct kr_intern_s *intern);
+
+/**
+ * @brief Free every interned string and the table itself.
+ *
+ * @param intern Table to destroy.
+ */
+KR_INLINE void kr_intern_destroy(struct kr_intern_s *intern);
+
+/**
+ * @brief Intern a string.
+ *
+ * @param intern Table to intern into.
+ * @param str String to intern.
+ * @return Canonical copy of the string, which stays valid until the table
+ *         is destroyed, or NULL if memory could not be allocated.
+ */
+KR_INLINE const char *kr_intern(struct kr_intern_s *intern, const char *str);
+
+/**
+ * @brief Intern a number of bytes as a string.
+ *
+ * @details The canonical copy is null terminated.
+ *
+ * @param intern Table to intern into.
+ * @param str Bytes to intern, which do not need to be terminated.
+ * @param len Number of bytes to intern.
+ * @return Canonical copy of the string, which stays valid until the table
+ *         is destroyed, or NULL if memory could not be allocated.
+ */
+KR_INLINE const char *kr_internn(struct kr_intern_s *intern, const char *str, size_t len);
+
+/**
+ * @brief Find the canonical copy of a string without interning it.
+ *
+ * @param intern Table to search.
+ * @param str Bytes to search for.
+ * @param len Number of bytes to search for.
+ * @return Canonical copy of the string, or NULL if it was never interned.
+ */
+KR_INLINE const char *kr_intern_find(const struct kr_intern_s *intern, const char *str, size_t len);
+
+/******************************************************************************/
+#if !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION)
+/******************************************************************************/
+
+#define KR_INTERN_MINSLOTS_ 64
+
+KR_INLINE void kr_intern_init(struct kr_intern_s *intern)
+{
+    intern->slots = NULL;
+    intern->slotsLen = 0;
+    intern->count = 0;
+    kr_arena_init(&intern->arena, 0);
+}
+
+KR_INLINE void kr_intern_destroy(struct kr_intern_s *intern)
+{
+    kr_arena_destroy(&intern->arena);
+    KR_FREE(intern->slots);
+    kr_intern_init(intern);
+}
+
+KR_INLINE const char *kr_intern(struct kr_intern_s *intern, const char *str)
+{
+    return kr_internn(intern, str, kr_strlen(str));
+}
+
+/* Slot that holds the string, or the empty slot it would go in. */
+KR_INLINE struct kr_intern_slot_s *kr_intern_probe_(const struct kr_intern_s *intern, const char *str, size_t len,
+                                                    uint32_t hash)
+{
+    const size_t mask = intern->slotsLen - 1;
+    size_t i = hash & mask;
+
+    for (;; i = (i + 1) & mask)
+    {
+        struct kr_intern_slot_s *slot = intern->slots + i;
+        if (slot->str == NULL ||
+            (slot->hash == hash && slot->len == len && memcmp(slot->str, str, len) == 0))
+        {
+            return slot;
+        }
+    }
+}
+
+KR_INLINE bool kr_intern_grow_(struct kr_intern_s *intern)
+{
+    struct kr_intern_slot_s *old = intern->slots;
+    const size_t oldLen = intern->slotsLen;
+    const size_t slotsLen = oldLen != 0 ? oldLen * 2 : KR_INTERN_MINSLOTS_;
+    struct kr_intern_slot_s *slots = NULL;
+    size_t i = 0;
+
+    slots = KR_CASTS(struct kr_intern_slot_s *, kr_reallocarray(NULL, slotsLen, sizeof(*slots)));
+    if (slots == NULL)
+    {
+        return false;
+    }
+
+    for (i = 0; i < slotsLen; i++)
+    {
+        slots[i].str = NULL;
+    }
+
+    intern->slots = slots;
+    intern->slotsLen = slotsLen;
+    for (i = 0; i < oldLen; i++)
+    {
+        if (old[i].str != NULL)
+        {
+            *kr_intern_probe_(intern, old[i].str, old[i].len, old[i].hash) = old[i];
+        }
+    }
+
+    KR_FREE(old);
+    return true;
+}
+
+KR_INLINE const char *kr_internn(struct kr_intern_s *intern, const char *str, size_t len)
+{
+    const uint32_t hash = KR_CASTS(uint32_t, kr_hash(0, str, len));
+    struct kr_intern_slot_s *slot = NULL;
+    char *copy = NULL;
+
+    /* Stay at most half full so probe sequences stay short. */
+    if (intern->count >= intern->slotsLen / 2 && !kr_intern_grow_(intern))
+    {
+        return NULL;
+    }
+
+    slot = kr_intern_probe_(intern, str, len, hash);
+    if (slot->str != NULL)
+    {
+        return slot->str;
+    }
+
+    if (len == KR_CASTS(size_t, -1))
+    {
+        return NULL;
+    }
+
+    /* Not kr_arena_strndup, the bytes might contain a null. */
+    copy = KR_CASTS(char *, kr_arena_alloc_unaligned(&intern->arena, len + 1));
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+
+    slot->str = copy;
+    slot->len = len;
+    slot->hash = hash;
+    intern->count++;
+    return copy;
+}
+
+KR_INLINE const char *kr_intern_find(const struct kr_intern_s *intern, const char *str, size_t len)
+{
+    if (intern->slotsLen == 0)
+    {
+        return NULL;
+    }
+    return kr_intern_probe_(intern, str, len, KR_CASTS(uint32_t, kr_hash(0, str, len)))->str;
+}
+
+#undef KR_INTERN_MINSLOTS_
+
+#endif /* !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION) */
+
+#endif /* !defined(KRINTERN_H) */
@@ -0,0 +1,1323 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * JSON parsing and writing
+ *
+ * Parsing happens in two passes, neither of which copies the document.
+ *
+ * The first pass, kr_json_index, finds the offset of every structural
+ * character in 64-byte blocks: brackets, braces, colons and commas outside
+ * of strings, the quotes at both ends of each string, and the first byte of
+ * every number and literal.  Backslashes, quotes, whitespace and operators
+ * each become a bitmask.  Carries through the backslash mask find the
+ * quotes that are escaped, and a prefix XOR of the rest marks every byte
+ * inside a string.
+ *
+ * The second pass, kr_json_tape, walks the index, checks the grammar and
+ * writes a tape of tokens that point back into the document.  Strings are
+ * left as they are until kr_json_get_string is called on them, and numbers
+ * are only converted by kr_json_get_i64 or kr_json_get_f64.
+ *
+ * kr_json_parse runs both, after checking that the document is UTF-8.
+ *
+ * Going the other way, a JSON writer appends values to a growable or fixed
+ * buffer and puts the commas and colons between them.  Strings are checked
+ * for characters that need escaping 16 or 32 bytes at a time, and the runs
+ * between them are copied as they are.  Numbers are formatted with
+ * kr_i64toa and kr_f64toa instead of going through stdio.
+ *
+ * @link https://arxiv.org/abs/1902.08318
+ * @link https://www.rfc-editor.org/rfc/rfc8259
+ */
+
+#if !defined(KRJSON_H)
+#define KRJSON_H
+
+#include "./krconfig.h"
+
+#include "./krbltin.h"
+#include "./krbool.h"
+#include "./krconv.h"
+#include "./krfloat.h"
+#include "./krint.h"
+#include "./krlib.h"
+#include "./krserial.h"
+#include "./krstr.h"
+#include "./krstrbuf.h"
+#include "./krswar.h"
+#include "./krutf8.h"
+
+#if (!KR_CONFIG_NOINCLUDE)
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+#if (KR_AVX2)
+#include <immintrin.h>
+#elif (KR_SSE2)
+#include <emmintrin.h>
+#endif
+
+#define KR_JSON_NULL 0
+#define KR_JSON_FALSE 1
+#define KR_JSON_TRUE 2
+#define KR_JSON_NUMBER 3
+#define KR_JSON_STRING 4
+#define KR_JSON_ARRAY 5
+#define KR_JSON_OBJECT 6
+
+/**
+ * @brief A value on the tape, as a slice of the document.
+ *
+ * @details Members of an object are written as a string token for the key
+ *          followed by the tokens of the value.
+ */
+struct kr_json_token_s
+{
+    size_t offset; /* Offset of the first byte. */
+    size_t length; /* Strings include their quotes, arrays and objects run
+                      to their closing bracket. */
+    size_t next;   /* Tape index just past this value, skipping anything
+                      inside it. */
+    int type;      /* One of KR_JSON_NULL through KR_JSON_OBJECT. */
+};
+
+/**
+ * @brief Output of a JSON writer.
+ *
+ * @details The writer puts commas between values and a colon after each
+ *          key, but doesn't check that keys and values come in the right
+ *          order.  Once something doesn't fit, every write after it fails,
+ *          so it's enough to check the result of the last one.
+ */
+struct kr_json_writer_s
+{
+    struct kr_strbuf_s buf; /* Output in buf.data, not terminated. */
+    bool fixed;             /* buf.data belongs to the caller and can't grow. */
+    bool failed;            /* Something didn't fit, so the output is incomplete. */
+    bool comma;             /* The next value or key needs a comma before it. */
+};
+
+#if defined(UINT64_MAX)
+
+/**
+ * @brief Find the structural characters in a JSON document.
+ *
+ * @details Reports control characters inside strings, and strings that
+ *          are never closed.  Everything else is left for kr_json_tape.
+ *
+ * @param dest Destination for offsets into src, in order.  A buffer of len
+ *             offsets is always big enough.
+ * @param outLen Output number of offsets written.
+ * @param destLen Length of destination buffer, in offsets.
+ * @param src Document to index.
+ * @param len Length of document.
+ * @return len if successful, otherwise the offset of the first byte that
+ *         couldn't be indexed.
+ */
+KR_INLINE size_t kr_json_index(size_t *dest, size_t *outLen, size_t destLen, const char *src, size_t len);
+
+/**
+ * @brief Check the grammar of an indexed JSON document and write its tape.
+ *
+ * @param dest Destination for tokens.  The root value is the first token,
+ *             and a buffer of indexLen tokens is always big enough.
+ * @param outLen Output number of tokens written.
+ * @param destLen Length of destination buffer, in tokens.
+ * @param src Document that was indexed.
+ * @param len Length of document.
+ * @param index Offsets from kr_json_index.
+ * @param indexLen Number of offsets.
+ * @return len if successful, otherwise the offset of the first error.  An
+ *         array or object that is never closed is an error at its opening
+ *         bracket.  A document with no value at all returns len without
+ *         writing any tokens.
+ */
+KR_INLINE size_t kr_json_tape(struct kr_json_token_s *dest, size_t *outLen, size_t destLen, const char *src,
+                              size_t len, const size_t *index, size_t indexLen);
+
+/**
+ * @brief Check that a JSON document is UTF-8, index it and write its tape.
+ *
+ * @param dest Destination for tokens.  A buffer of len tokens is always big
+ *             enough.
+ * @param outLen Output number of tokens written.
+ * @param destLen Length of destination buffer, in tokens.
+ * @param index Scratch space for kr_json_index.  A buffer of len offsets is
+ *              always big enough.
+ * @param indexLen Length of scratch space, in offsets.
+ * @param src Document to parse.
+ * @param len Length of document.
+ * @return len if successful, otherwise the offset of the first error.  A
+ *         document with no value at all returns len without writing any
+ *         tokens.
+ */
+KR_INLINE size_t kr_json_parse(struct kr_json_token_s *dest, size_t *outLen, size_t destLen, size_t *index,
+                               size_t indexLen, const char *src, size_t len);
+
+/**
+ * @brief Decode the escapes in the contents of a JSON string.
+ *
+ * @details Escaped UTF-16 surrogate pairs become a single code point, and
+ *          an unpaired surrogate is an error.
+ *
+ * @param dest Destination buffer, at least len bytes.  Not terminated.  Can
+ *             be the same as src to decode in place.
+ * @param outLen Output number of bytes written.
+ * @param src String contents, without quotes.
+ * @param len Length of string contents.
+ * @return len if successful, otherwise the offset of the first bad escape.
+ */
+KR_INLINE size_t kr_json_unescape(char *dest, size_t *outLen, const char *src, size_t len);
+
+/**
+ * @brief Get the contents of a string token, with escapes decoded.
+ *
+ * @param dest Destination buffer, at least tok->length - 2 bytes.  Not
+ *             terminated.
+ * @param outLen Output number of bytes written.
+ * @param src Document the token came from.
+ * @param tok String token.
+ * @return True if the token is a string with valid escapes.
+ */
+KR_INLINE bool kr_json_get_string(char *dest, size_t *outLen, const char *src, const struct kr_json_token_s *tok);
+
+/**
+ * @brief Get the value of a number token that is an integer.
+ *
+ * @param res Output value.
+ * @param src Document the token came from.
+ * @param tok Number token.
+ * @return True if the token is a number with no fraction or exponent that
+ *         fits in an int64_t.
+ */
+KR_INLINE bool kr_json_get_i64(int64_t *res, const char *src, const struct kr_json_token_s *tok);
+
+/**
+ * @brief Get the value of a number token as a double.
+ *
+ * @param res Output value, correctly rounded.
+ * @param src Document the token came from.
+ * @param tok Number token.
+ * @return True if the token is a number.
+ */
+KR_INLINE bool kr_json_get_f64(double *res, const char *src, const struct kr_json_token_s *tok);
+
+/**
+ * @brief Find the value of an object member by its key.
+ *
+ * @details Keys are compared as they appear in the document, so a key
+ *          written with escapes only matches the same escapes.
+ *
+ * @param tape Tape to search.
+ * @param obj Tape index of the object.
+ * @param src Document the tape came from.
+ * @param key Key to find.
+ * @param keyLen Length of key.
+ * @return Tape index of the value of the first member with that key, or 0
+ *         if there isn't one or obj isn't an object.
+ */
+KR_INLINE size_t kr_json_find(const struct kr_json_token_s *tape, size_t obj, const char *src, const char *key,
+                              size_t keyLen);
+
+/**
+ * @brief Initialize a JSON writer that grows its own buffer.
+ *
+ * @details Does not allocate.  The output grows with kr_strbuf_reserve.
+ *
+ * @param w Writer to initialize.
+ */
+KR_INLINE void kr_json_writer_init(struct kr_json_writer_s *w);
+
+/**
+ * @brief Initialize a JSON writer that writes into a fixed buffer.
+ *
+ * @param w Writer to initialize.
+ * @param dest Buffer to write into.
+ * @param destLen Size of buffer.
+ */
+KR_INLINE void kr_json_writer_init_fixed(struct kr_json_writer_s *w, char *dest, size_t destLen);
+
+/**
+ * @brief Free memory owned by a JSON writer.
+ *
+ * @details The buffer of a fixed writer is left alone.
+ *
+ * @param w Writer to destroy.
+ */
+KR_INLINE void kr_json_writer_destroy(struct kr_json_writer_s *w);
+
+/**
+ * @brief Start an object.
+ *
+ * @param w Writer to use.
+ * @return True if it was written.
+ */
+KR_INLINE bool kr_json_write_begin_object(struct kr_json_writer_s *w);
+
+/**
+ * @brief End an object.
+ *
+ * @param w Writer to use.
+ * @return True if it was written.
+ */
+KR_INLINE bool kr_json_write_end_object(struct kr_json_writer_s *w);
+
+/**
+ * @brief Start an array.
+ *
+ * @param w Writer to use.
+ * @return True if it was written.
+ */
+KR_INLINE bool kr_json_write_begin_array(struct kr_json_writer_s *w);
+
+/**
+ * @brief End an array.
+ *
+ * @param w Writer to use.
+ * @return True if it was written.
+ */
+KR_INLINE bool kr_json_write_end_array(struct kr_json_writer_s *w);
+
+/**
+ * @brief Write the key of an object member, followed by a colon.
+ *
+ * @param w Writer to use.
+ * @param key Key, which is escaped like kr_json_write_string.
+ * @param len Length of key.
+ * @return True if it was written.
+ */
+KR_INLINE bool kr_json_write_key(struct kr_json_writer_s *w, const char *key, size_t len);
+
+/**
+ * @brief Write a string.
+ *
+ * @details Quotes, backslashes and control characters are escaped, and
+ *          everything else is copied as it is, so str should be UTF-8.
+ *
+ * @param w Writer to use.
+ * @param str String to write.
+ * @param len Length of string.
+ * @return True if it was written.
+ */
+KR_INLINE bool kr_json_write_string(struct kr_json_writer_s *w, const char *str, size_t len);
+
+/**
+ * @brief Write a signed integer.
+ *
+ * @param w Writer to use.
+ * @param value Value to write.
+ * @return True if it was written.
+ */
+KR_INLINE bool kr_json_write_i64(struct kr_json_writer_s *w, int64_t value);
+
+/**
+ * @brief Write an unsigned integer.
+ *
+ * @param w Writer to use.
+ * @param value Value to write.
+ * @return True if it was written.
+ */
+KR_INLINE bool kr_json_write_u64(struct kr_json_writer_s *w, uint64_t value);
+
+/**
+ * @brief Write a double as the shortest number that parses back to it.
+ *
+ * @details JSON has no infinity or NaN, so they are written as null.
+ *
+ * @param w Writer to use.
+ * @param value Value to write.
+ * @return True if it was written.
+ */
+KR_INLINE bool kr_json_write_f64(struct kr_json_writer_s *w, double value);
+
+/**
+ * @brief Write true or false.
+ *
+ * @param w Writer to use.
+ * @param value Value to write.
+ * @return True if it was written.
+ */
+KR_INLINE bool kr_json_write_bool(struct kr_json_writer_s *w, bool value);
+
+/**
+ * @brief Write null.
+ *
+ * @param w Writer to use.
+ * @return True if it was written.
+ */
+KR_INLINE bool kr_json_write_null(struct kr_json_writer_s *w);
+
+#endif /* defined(UINT64_MAX) */
+
+/******************************************************************************/
+#if !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION)
+/******************************************************************************/
+
+#if defined(UINT64_MAX)
+
+#define KR_JSON_ODD_BITS_ UINT64_C(0xAAAAAAAAAAAAAAAA)
+
+/*
+ * Masks of 64 bytes with bit n for byte n.
+ */
+struct kr_json_block_s
+{
+    uint64_t backslashes;
+    uint64_t quotes;
+    uint64_t spaces;    /* Whitespace allowed between tokens. */
+    uint64_t operators; /* Brackets, braces, colons and commas. */
+    uint64_t controls;  /* Anything below 0x20. */
+};
+
+KR_INLINE void kr_json_classify_(struct kr_json_block_s *block, const char *p)
+{
+#if (KR_AVX2)
+    unsigned i;
+
+    memset(block, 0, sizeof(*block));
+    for (i = 0; i < 64; i += 32)
+    {
+        const __m256i v = _mm256_loadu_si256(KR_CASTR(const __m256i *, p + i));
+        const __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        const __m256i spaces = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')),
+                            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+        const __m256i operators = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(lower, _mm256_set1_epi8('{')),
+                            _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('}'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))));
+        const __m256i controls = _mm256_cmpeq_epi8(_mm256_max_epu8(v, _mm256_set1_epi8(0x1F)), _mm256_set1_epi8(0x1F));
+
+        block->backslashes |=
+            KR_CASTS(uint64_t, KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')))))
+            << i;
+        block->quotes |=
+            KR_CASTS(uint64_t, KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')))))
+            << i;
+        block->spaces |= KR_CASTS(uint64_t, KR_CASTS(uint32_t, _mm256_movemask_epi8(spaces))) << i;
+        block->operators |= KR_CASTS(uint64_t, KR_CASTS(uint32_t, _mm256_movemask_epi8(operators))) << i;
+        block->controls |= KR_CASTS(uint64_t, KR_CASTS(uint32_t, _mm256_movemask_epi8(controls))) << i;
+    }
+#elif (KR_SSE2)
+    unsigned i;
+
+    memset(block, 0, sizeof(*block));
+    for (i = 0; i < 64; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(KR_CASTR(const __m128i *, p + i));
+        const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        const __m128i spaces =
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+                         _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+        const __m128i operators = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(lower, _mm_set1_epi8('{')), _mm_cmpeq_epi8(lower, _mm_set1_epi8('}'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')), _mm_cmpeq_epi8(v, _mm_set1_epi8(','))));
+        const __m128i controls = _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(0x1F)), _mm_set1_epi8(0x1F));
+
+        block->backslashes |= KR_CASTS(uint64_t, _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\')))) << i;
+        block->quotes |= KR_CASTS(uint64_t, _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')))) << i;
+        block->spaces |= KR_CASTS(uint64_t, _mm_movemask_epi8(spaces)) << i;
+        block->operators |= KR_CASTS(uint64_t, _mm_movemask_epi8(operators)) << i;
+        block->controls |= KR_CASTS(uint64_t, _mm_movemask_epi8(controls)) << i;
+    }
+#else
+    const uint64_t ones = UINT64_C(0x0101010101010101);
+    unsigned i;
+
+    memset(block, 0, sizeof(*block));
+    for (i = 0; i < 64; i += 8)
+    {
+        const uint64_t word = kr_load_u64le(KR_CASTC(char *, p + i));
+        const uint64_t lower = word | (ones * 0x20);
+        uint64_t controls;
+
+        block->backslashes |= kr_swar_zeros_(word ^ (ones * '\\')) << i;
+        block->quotes |= kr_swar_zeros_(word ^ (ones * '"')) << i;
+        block->spaces |= (kr_swar_zeros_(word ^ (ones * ' ')) | kr_swar_zeros_(word ^ (ones * '\t')) |
+                          kr_swar_zeros_(word ^ (ones * '\n')) | kr_swar_zeros_(word ^ (ones * '\r')))
+                         << i;
+        block->operators |= (kr_swar_zeros_(lower ^ (ones * '{')) | kr_swar_zeros_(lower ^ (ones * '}')) |
+                             kr_swar_zeros_(word ^ (ones * ':')) | kr_swar_zeros_(word ^ (ones * ',')))
+                            << i;
+
+        /* High bit of every byte below 0x20, gathered into the top byte. */
+        controls = ~(((word & (ones * 0x7F)) + (ones * 0x60)) | word) & (ones * 0x80);
+        block->controls |= (((controls >> 7) * UINT64_C(0x0102040810204080)) >> 56) << i;
+    }
+#endif
+}
+
+/*
+ * Structural characters in one block.  The carries are the state at the
+ * end of the previous block: whether the first byte is escaped, whether it
+ * is inside a string (as all ones or zero), and whether the byte before it
+ * was part of a number or literal.
+ */
+KR_INLINE uint64_t kr_json_structurals_(const struct kr_json_block_s *block, uint64_t *escapedCarry,
+                                        uint64_t *stringCarry, uint64_t *scalarCarry, uint64_t *outErrors)
+{
+    uint64_t escaped, quotes, strings, tails, scalars, others, starts;
+
+    /*
+     * A backslash that isn't escaped escapes the byte after it.  Adding
+     * each run of backslashes to the start of it carries out of the run,
+     * and comparing how far against alternating bits tells whether it had
+     * an odd length.
+     */
+    if (block->backslashes == 0)
+    {
+        escaped = *escapedCarry;
+        *escapedCarry = 0;
+    }
+    else
+    {
+        const uint64_t potential = block->backslashes & ~*escapedCarry;
+        const uint64_t codes = (((potential << 1) | KR_JSON_ODD_BITS_) - potential) ^ KR_JSON_ODD_BITS_;
+        escaped = codes ^ (block->backslashes | *escapedCarry);
+        *escapedCarry = (codes & block->backslashes) >> 63;
+    }
+
+    quotes = block->quotes & ~escaped;
+    strings = kr_swar_prefix_xor_(quotes) ^ *stringCarry;
+    *stringCarry = KR_CASTS(uint64_t, 0) - (strings >> 63);
+
+    /* Everything in a string except its opening quote. */
+    tails = strings ^ quotes;
+    *outErrors = block->controls & tails;
+
+    /* Numbers, literals and opening quotes that don't follow a number or
+       literal start a new value. */
+    scalars = ~(block->operators | block->spaces);
+    others = scalars & ~quotes;
+    starts = scalars & ~((others << 1) | *scalarCarry);
+    *scalarCarry = others >> 63;
+
+    return ((block->operators | starts) & ~tails) | (quotes & ~strings);
+}
+
+#undef KR_JSON_ODD_BITS_
+
+/* Bytes allowed right after a number or literal. */
+KR_INLINE bool kr_json_delimiter_(const char *src, size_t i, size_t len)
+{
+    if (i == len)
+    {
+        return true;
+    }
+    switch (src[i])
+    {
+    case ' ':
+    case '\t':
+    case '\n':
+    case '\r':
+    case ',':
+    case ':':
+    case ']':
+    case '}':
+    case '[':
+    case '{':
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* End of a number that starts at i, or i if it isn't one. */
+KR_INLINE size_t kr_json_number_(const char *src, size_t i, size_t len)
+{
+    size_t j = i;
+
+    if (j < len && src[j] == '-')
+    {
+        j += 1;
+    }
+    if (j < len && src[j] == '0')
+    {
+        j += 1;
+    }
+    else if (j < len && src[j] >= '1' && src[j] <= '9')
+    {
+        for (j += 1; j < len && src[j] >= '0' && src[j] <= '9'; j++)
+        {
+        }
+    }
+    else
+    {
+        return i;
+    }
+
+    if (j < len && src[j] == '.')
+    {
+        if (j + 1 == len || src[j + 1] < '0' || src[j + 1] > '9')
+        {
+            return i;
+        }
+        for (j += 2; j < len && src[j] >= '0' && src[j] <= '9'; j++)
+        {
+        }
+    }
+
+    if (j < len && (src[j] == 'e' || src[j] == 'E'))
+    {
+        j += 1;
+        if (j < len && (src[j] == '+' || src[j] == '-'))
+        {
+            j += 1;
+        }
+        if (j == len || src[j] < '0' || src[j] > '9')
+        {
+            return i;
+        }
+        for (j += 1; j < len && src[j] >= '0' && src[j] <= '9'; j++)
+        {
+        }
+    }
+    return j;
+}
+
+/* Four hex digits of a \u escape, or a value above 0xFFFF if they aren't. */
+KR_INLINE uint32_t kr_json_hex4_(const char *src, size_t i, size_t len)
+{
+    uint32_t value = 0;
+    bool overflow = false;
+
+    if (len - i < 4 || kr_parse_hex_u32(&value, src + i, 4, &overflow) != 4)
+    {
+        return 0x10000;
+    }
+    return value;
+}
+
+/******************************************************************************/
+
+KR_INLINE size_t kr_json_index(size_t *dest, size_t *outLen, size_t destLen, const char *src, size_t len)
+{
+    struct kr_json_block_s block;
+    uint64_t escapedCarry = 0, stringCarry = 0, scalarCarry = 0, bits, errors;
+    char tail[64];
+    size_t i, count = 0;
+
+    for (i = 0; i < len; i += 64)
+    {
+        /* The last block is padded out with spaces. */
+        if (len - i >= 64)
+        {
+            kr_json_classify_(&block, src + i);
+        }
+        else
+        {
+            memset(tail, ' ', sizeof(tail));
+            memcpy(tail, src + i, len - i);
+            kr_json_classify_(&block, tail);
+        }
+
+        bits = kr_json_structurals_(&block, &escapedCarry, &stringCarry, &scalarCarry, &errors);
+        if (errors != 0)
+        {
+            /* Only structurals before the error count. */
+            bits &= (errors & (0 - errors)) - 1;
+        }
+        if (destLen - count >= 64)
+        {
+            /* Room for the whole block, so no need to check. */
+            for (; bits != 0; bits &= bits - 1)
+            {
+                dest[count++] = i + KR_CASTS(size_t, kr_ctz64(bits));
+            }
+        }
+        for (; bits != 0; bits &= bits - 1)
+        {
+            if (count == destLen)
+            {
+                *outLen = count;
+                return i + KR_CASTS(size_t, kr_ctz64(bits));
+            }
+            dest[count++] = i + KR_CASTS(size_t, kr_ctz64(bits));
+        }
+        if (errors != 0)
+        {
+            *outLen = count;
+            return i + KR_CASTS(size_t, kr_ctz64(errors));
+        }
+    }
+
+    *outLen = count;
+    if (stringCarry != 0)
+    {
+        /* The string that never closed starts at the last quote that isn't
+           escaped. */
+        for (i = len - 1;; i--)
+        {
+            size_t j = i;
+            for (; j != 0 && src[j - 1] == '\\'; j--)
+            {
+            }
+            if (src[i] == '"' && (i - j) % 2 == 0)
+            {
+                return i;
+            }
+        }
+    }
+    return len;
+}
+
+KR_INLINE size_t kr_json_tape(struct kr_json_token_s *dest, size_t *outLen, size_t destLen, const char *src,
+                              size_t len, const size_t *index, size_t indexLen)
+{
+#define KR_JSON_VALUE_ 0       /* A value. */
+#define KR_JSON_FIRST_VALUE_ 1 /* A value or the end of an array. */
+#define KR_JSON_KEY_ 2         /* A key. */
+#define KR_JSON_FIRST_KEY_ 3   /* A key or the end of an object. */
+#define KR_JSON_COLON_ 4       /* The colon after a key. */
+#define KR_JSON_AFTER_ 5       /* A comma or the end of a container. */
+
+    struct kr_json_token_s *tok;
+    size_t i, pos = 0, end, count = 0, parent = 0;
+    int state = KR_JSON_VALUE_;
+
+    /*
+     * An array or object that is still open keeps the tape index of its
+     * parent plus one in next, which is 0 for the root.
+     */
+    for (i = 0; i < indexLen; i++)
+    {
+        pos = index[i];
+        switch (state)
+        {
+        case KR_JSON_FIRST_KEY_:
+            if (src[pos] == '}')
+            {
+                goto close;
+            }
+            /* fall through */
+        case KR_JSON_KEY_:
+            if (src[pos] != '"')
+            {
+                goto error;
+            }
+            state = KR_JSON_COLON_;
+            goto string;
+        case KR_JSON_COLON_:
+            if (src[pos] != ':')
+            {
+                goto error;
+            }
+            state = KR_JSON_VALUE_;
+            continue;
+        case KR_JSON_FIRST_VALUE_:
+            if (src[pos] == ']')
+            {
+                goto close;
+            }
+            /* fall through */
+        case KR_JSON_VALUE_:
+            break;
+        default:
+            if (parent == 0)
+            {
+                goto error;
+            }
+            else if (src[pos] == ',')
+            {
+                state = dest[parent - 1].type == KR_JSON_OBJECT ? KR_JSON_KEY_ : KR_JSON_VALUE_;
+                continue;
+            }
+            else if (src[pos] == (dest[parent - 1].type == KR_JSON_OBJECT ? '}' : ']'))
+            {
+                goto close;
+            }
+            goto error;
+        }
+
+        /* Anything but a string is a value with nothing after it. */
+        if (count == destLen)
+        {
+            goto error;
+        }
+        tok = &dest[count];
+        tok->offset = pos;
+        tok->next = count + 1;
+        state = KR_JSON_AFTER_;
+        switch (src[pos])
+        {
+        case '{':
+        case '[':
+            tok->type = src[pos] == '{' ? KR_JSON_OBJECT : KR_JSON_ARRAY;
+            tok->next = parent;
+            parent = count + 1;
+            state = src[pos] == '{' ? KR_JSON_FIRST_KEY_ : KR_JSON_FIRST_VALUE_;
+            break;
+        case '"':
+            goto string;
+        case 't':
+            tok->type = KR_JSON_TRUE;
+            tok->length = 4;
+            if (len - pos < 4 || memcmp(src + pos, "true", 4) != 0 || !kr_json_delimiter_(src, pos + 4, len))
+            {
+                goto error;
+            }
+            break;
+        case 'f':
+            tok->type = KR_JSON_FALSE;
+            tok->length = 5;
+            if (len - pos < 5 || memcmp(src + pos, "false", 5) != 0 || !kr_json_delimiter_(src, pos + 5, len))
+            {
+                goto error;
+            }
+            break;
+        case 'n':
+            tok->type = KR_JSON_NULL;
+            tok->length = 4;
+            if (len - pos < 4 || memcmp(src + pos, "null", 4) != 0 || !kr_json_delimiter_(src, pos + 4, len))
+            {
+                goto error;
+            }
+            break;
+        default:
+            end = kr_json_number_(src, pos, len);
+            if (end == pos || !kr_json_delimiter_(src, end, len))
+            {
+                goto error;
+            }
+            tok->type = KR_JSON_NUMBER;
+            tok->length = end - pos;
+            break;
+        }
+        count += 1;
+        continue;
+
+    string:
+        /* The closing quote is always the next thing in the index. */
+        if (count == destLen || i + 1 == indexLen || src[index[i + 1]] != '"')
+        {
+            goto error;
+        }
+        tok = &dest[count];
+        tok->offset = pos;
+        tok->length = index[i + 1] + 1 - pos;
+        tok->next = count + 1;
+        tok->type = KR_JSON_STRING;
+        count += 1;
+        i += 1;
+        continue;
+
+    close:
+        tok = &dest[parent - 1];
+        tok->length = pos + 1 - tok->offset;
+        parent = tok->next;
+        tok->next = count;
+        state = KR_JSON_AFTER_;
+    }
+
+    *outLen = count;
+    if (parent != 0)
+    {
+        return dest[parent - 1].offset;
+    }
+    return len;
+
+error:
+    *outLen = count;
+    return pos;
+
+#undef KR_JSON_VALUE_
+#undef KR_JSON_FIRST_VALUE_
+#undef KR_JSON_KEY_
+#undef KR_JSON_FIRST_KEY_
+#undef KR_JSON_COLON_
+#undef KR_JSON_AFTER_
+}
+
+KR_INLINE size_t kr_json_parse(struct kr_json_token_s *dest, size_t *outLen, size_t destLen, size_t *index,
+                               size_t indexLen, const char *src, size_t len)
+{
+    size_t res, count = 0;
+
+    *outLen = 0;
+    res = kr_utf8_validate(src, len);
+    if (res != len)
+    {
+        return res;
+    }
+    res = kr_json_index(index, &count, indexLen, src, len);
+    if (res != len)
+    {
+        return res;
+    }
+    return kr_json_tape(dest, outLen, destLen, src, len, index, count);
+}
+
+KR_INLINE size_t kr_json_unescape(char *dest, size_t *outLen, const char *src, size_t len)
+{
+    const char *backslash;
+    size_t i = 0, o = 0, run;
+    uint32_t cp, low;
+
+    for (;;)
+    {
+        backslash = KR_CASTS(const char *, kr_memchr(src + i, '\\', len - i));
+        run = (backslash != NULL) ? KR_CASTS(size_t, backslash - src) - i : len - i;
+        memmove(dest + o, src + i, run);
+        o += run;
+        i += run;
+        if (backslash == NULL)
+        {
+            *outLen = o;
+            return len;
+        }
+
+        if (i + 1 == len)
+        {
+            break;
+        }
+        switch (src[i + 1])
+        {
+        case '"':
+        case '\\':
+        case '/':
+            dest[o++] = src[i + 1];
+            break;
+        case 'b':
+            dest[o++] = '\b';
+            break;
+        case 'f':
+            dest[o++] = '\f';
+            break;
+        case 'n':
+            dest[o++] = '\n';
+            break;
+        case 'r':
+            dest[o++] = '\r';
+            break;
+        case 't':
+            dest[o++] = '\t';
+            break;
+        case 'u':
+            cp = kr_json_hex4_(src, i + 2, len);
+            if (cp > 0xFFFF || (cp >= 0xDC00 && cp <= 0xDFFF))
+            {
+                goto error;
+            }
+            else if (cp >= 0xD800 && cp <= 0xDBFF)
+            {
+                /* The low half has to come right after. */
+                if (len - i < 12 || src[i + 6] != '\\' || src[i + 7] != 'u')
+                {
+                    goto error;
+                }
+                low = kr_json_hex4_(src, i + 8, len);
+                if (low < 0xDC00 || low > 0xDFFF)
+                {
+                    goto error;
+                }
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                i += 6;
+            }
+            o += kr_utf8_encode_(KR_CASTR(unsigned char *, dest + o), cp);
+            i += 4;
+            break;
+        default:
+            goto error;
+        }
+        i += 2;
+    }
+
+error:
+    *outLen = o;
+    return i;
+}
+
+KR_INLINE bool kr_json_get_string(char *dest, size_t *outLen, const char *src, const struct kr_json_token_s *tok)
+{
+    if (tok->type != KR_JSON_STRING)
+    {
+        *outLen = 0;
+        return false;
+    }
+    return kr_json_unescape(dest, outLen, src + tok->offset + 1, tok->length - 2) == tok->length - 2;
+}
+
+KR_INLINE bool kr_json_get_i64(int64_t *res, const char *src, const struct kr_json_token_s *tok)
+{
+    bool overflow = false;
+
+    if (tok->type != KR_JSON_NUMBER)
+    {
+        *res = 0;
+        return false;
+    }
+    return kr_parse_i64(res, src + tok->offset, tok->length, &overflow) == tok->length && !overflow;
+}
+
+KR_INLINE bool kr_json_get_f64(double *res, const char *src, const struct kr_json_token_s *tok)
+{
+    if (tok->type != KR_JSON_NUMBER)
+    {
+        *res = 0;
+        return false;
+    }
+    return kr_parse_f64(res, src + tok->offset, tok->length) == tok->length;
+}
+
+KR_INLINE size_t kr_json_find(const struct kr_json_token_s *tape, size_t obj, const char *src, const char *key,
+                              size_t keyLen)
+{
+    size_t i;
+
+    if (tape[obj].type != KR_JSON_OBJECT)
+    {
+        return 0;
+    }
+    for (i = obj + 1; i < tape[obj].next; i = tape[i + 1].next)
+    {
+        if (tape[i].length == keyLen + 2 && memcmp(src + tape[i].offset + 1, key, keyLen) == 0)
+        {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+/******************************************************************************/
+
+/* Make room for extra bytes, or fail for good. */
+KR_INLINE bool kr_json_reserve_(struct kr_json_writer_s *w, size_t extra)
+{
+    if (w->failed)
+    {
+        return false;
+    }
+    else if (w->buf.cap - w->buf.len >= extra)
+    {
+        return true;
+    }
+    else if (w->fixed || !kr_strbuf_reserve(&w->buf, extra))
+    {
+        w->failed = true;
+        return false;
+    }
+    return true;
+}
+
+/* Make room for a value and the comma before it. */
+KR_INLINE bool kr_json_value_(struct kr_json_writer_s *w, size_t extra)
+{
+    if (!kr_json_reserve_(w, extra + 1))
+    {
+        return false;
+    }
+    if (w->comma)
+    {
+        w->buf.data[w->buf.len++] = ',';
+    }
+    w->comma = true;
+    return true;
+}
+
+/* Bytes at the start of src that don't need escaping. */
+KR_INLINE size_t kr_json_clean_(const char *src, size_t len)
+{
+    size_t i = 0;
+
+#if (KR_AVX2)
+    for (; len - i >= 32; i += 32)
+    {
+        const __m256i v = _mm256_loadu_si256(KR_CASTR(const __m256i *, src + i));
+        const __m256i dirty = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+            _mm256_cmpeq_epi8(_mm256_max_epu8(v, _mm256_set1_epi8(0x1F)), _mm256_set1_epi8(0x1F)));
+        const uint32_t mask = KR_CASTS(uint32_t, _mm256_movemask_epi8(dirty));
+        if (mask != 0)
+        {
+            return i + KR_CASTS(size_t, kr_ctz32(mask));
+        }
+    }
+#endif
+#if (KR_SSE2)
+    for (; len - i >= 16; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(KR_CASTR(const __m128i *, src + i));
+        const __m128i dirty =
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+                         _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(0x1F)), _mm_set1_epi8(0x1F)));
+        const unsigned mask = KR_CASTS(unsigned, _mm_movemask_epi8(dirty));
+        if (mask != 0)
+        {
+            return i + KR_CASTS(size_t, kr_ctz32(mask));
+        }
+    }
+#else
+    for (; len - i >= 8; i += 8)
+    {
+        const uint64_t ones = UINT64_C(0x0101010101010101), lows = ones * 0x7F;
+        const uint64_t word = kr_load_u64le(KR_CASTC(char *, src + i));
+        const uint64_t quotes = word ^ (ones * '"'), backslashes = word ^ (ones * '\\');
+
+        /* High bit of each quote, backslash and byte below 0x20. */
+        const uint64_t dirty = ~(((quotes & lows) + lows) | quotes | lows) |
+                               ~(((backslashes & lows) + lows) | backslashes | lows) |
+                               (~(((word & lows) + (ones * 0x60)) | word) & (ones * 0x80));
+        if (dirty != 0)
+        {
+            return i + KR_CASTS(size_t, kr_ctz64(dirty)) / 8;
+        }
+    }
+#endif
+
+    for (; i < len; i++)
+    {
+        if (src[i] == '"' || src[i] == '\\' || KR_CASTS(unsigned char, src[i]) < 0x20)
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+/* A quoted, escaped string, after the comma if there is one.  The caller has
+   reserved room for the string unescaped and the trail bytes written after it,
+   the closing quote included. */
+KR_INLINE bool kr_json_quote_(struct kr_json_writer_s *w, const char *str, size_t len, size_t trail)
+{
+    static const char hex[] = "0123456789abcdef";
+    char seq[6];
+    size_t i = 0, run, seqLen;
+
+    w->buf.data[w->buf.len++] = '"';
+    for (;;)
+    {
+        run = kr_json_clean_(str + i, len - i);
+        memcpy(w->buf.data + w->buf.len, str + i, run);
+        w->buf.len += run;
+        i += run;
+        if (i == len)
+        {
+            break;
+        }
+
+        seq[0] = '\\';
+        seqLen = 2;
+        switch (str[i])
+        {
+        case '"':
+        case '\\':
+            seq[1] = str[i];
+            break;
+        case '\b':
+            seq[1] = 'b';
+            break;
+        case '\f':
+            seq[1] = 'f';
+            break;
+        case '\n':
+            seq[1] = 'n';
+            break;
+        case '\r':
+            seq[1] = 'r';
+            break;
+        case '\t':
+            seq[1] = 't';
+            break;
+        default:
+            seq[1] = 'u';
+            seq[2] = '0';
+            seq[3] = '0';
+            seq[4] = hex[(str[i] >> 4) & 0xF];
+            seq[5] = hex[str[i] & 0xF];
+            seqLen = 6;
+            break;
+        }
+
+        /* Room for the escape, the rest and whatever comes after. */
+        if (!kr_json_reserve_(w, seqLen + (len - i - 1) + trail))
+        {
+            return false;
+        }
+        memcpy(w->buf.data + w->buf.len, seq, seqLen);
+        w->buf.len += seqLen;
+        i += 1;
+    }
+    w->buf.data[w->buf.len++] = '"';
+    return true;
+}
+
+/******************************************************************************/
+
+KR_INLINE void kr_json_writer_init(struct kr_json_writer_s *w)
+{
+    kr_strbuf_init(&w->buf);
+    w->fixed = false;
+    w->failed = false;
+    w->comma = false;
+}
+
+KR_INLINE void kr_json_writer_init_fixed(struct kr_json_writer_s *w, char *dest, size_t destLen)
+{
+    kr_json_writer_init(w);
+    w->buf.data = dest;
+    w->buf.cap = destLen;
+    w->fixed = true;
+}
+
+KR_INLINE void kr_json_writer_destroy(struct kr_json_writer_s *w)
+{
+    if (!w->fixed)
+    {
+        kr_strbuf_destroy(&w->buf);
+    }
+    kr_json_writer_init(w);
+}
+
+KR_INLINE bool kr_json_write_begin_object(struct kr_json_writer_s *w)
+{
+    if (!kr_json_value_(w, 1))
+    {
+        return false;
+    }
+    w->buf.data[w->buf.len++] = '{';
+    w->comma = false;
+    return true;
+}
+
+KR_INLINE bool kr_json_write_end_object(struct kr_json_writer_s *w)
+{
+    if (!kr_json_reserve_(w, 1))
+    {
+        return false;
+    }
+    w->buf.data[w->buf.len++] = '}';
+    w->comma = true;
+    return true;
+}
+
+KR_INLINE bool kr_json_write_begin_array(struct kr_json_writer_s *w)
+{
+    if (!kr_json_value_(w, 1))
+    {
+        return false;
+    }
+    w->buf.data[w->buf.len++] = '[';
+    w->comma = false;
+    return true;
+}
+
+KR_INLINE bool kr_json_write_end_array(struct kr_json_writer_s *w)
+{
+    if (!kr_json_reserve_(w, 1))
+    {
+        return false;
+    }
+    w->buf.data[w->buf.len++] = ']';
+    w->comma = true;
+    return true;
+}
+
+KR_INLINE bool kr_json_write_key(struct kr_json_writer_s *w, const char *key, size_t len)
+{
+    if (len > KR_CASTS(size_t, -1) - 3 || !kr_json_value_(w, len + 3) || !kr_json_quote_(w, key, len, 2))
+    {
+        return false;
+    }
+    w->buf.data[w->buf.len++] = ':';
+    w->comma = false;
+    return true;
+}
+
+KR_INLINE bool kr_json_write_string(struct kr_json_writer_s *w, const char *str, size_t len)
+{
+    if (len > KR_CASTS(size_t, -1) - 2 || !kr_json_value_(w, len + 2))
+    {
+        return false;
+    }
+    return kr_json_quote_(w, str, len, 1);
+}
+
+KR_INLINE bool kr_json_write_i64(struct kr_json_writer_s *w, int64_t value)
+{
+    char buf[KR_CONV_64_SIZE];
+    const size_t len = kr_i64toa(buf, value);
+
+    if (!kr_json_value_(w, len))
+    {
+        return false;
+    }
+    memcpy(w->buf.data + w->buf.len, buf, len);
+    w->buf.len += len;
+    return true;
+}
+
+KR_INLINE bool kr_json_write_u64(struct kr_json_writer_s *w, uint64_t value)
+{
+    char buf[KR_CONV_64_SIZE];
+    const size_t len = kr_u64toa(buf, value);
+
+    if (!kr_json_value_(w, len))
+    {
+        return false;
+    }
+    memcpy(w->buf.data + w->buf.len, buf, len);
+    w->buf.len += len;
+    return true;
+}
+
+KR_INLINE bool kr_json_write_f64(struct kr_json_writer_s *w, double value)
+{
+    char buf[KR_FLOAT_64_SIZE];
+    uint64_t bits = 0;
+    size_t len = 0;
+
+    memcpy(&bits, &value, sizeof(bits));
+    if (((bits >> 52) & 0x7FF) == 0x7FF)
+    {
+        return kr_json_write_null(w);
+    }
+
+    len = kr_f64toa(buf, value);
+    if (!kr_json_value_(w, len))
+    {
+        return false;
+    }
+    memcpy(w->buf.data + w->buf.len, buf, len);
+    w->buf.len += len;
+    return true;
+}
+
+KR_INLINE bool kr_json_write_bool(struct kr_json_writer_s *w, bool value)
+{
+    if (!kr_json_value_(w, 5))
+    {
+        return false;
+    }
+    memcpy(w->buf.data + w->buf.len, value ? "true" : "false", value ? 4 : 5);
+    w->buf.len += value ? 4 : 5;
+    return true;
+}
+
+KR_INLINE bool kr_json_write_null(struct kr_json_writer_s *w)
+{
+    if (!kr_json_value_(w, 4))
+    {
+        return false;
+    }
+    memcpy(w->buf.data + w->buf.len, "null", 4);
+    w->buf.len += 4;
+    return true;
+}
+
+#endif /* defined(UINT64_MAX) */
+
+/******************************************************************************/
+#endif /* !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION) */
+/******************************************************************************/
+
+#endif /* !defined(KRJSON_H) */
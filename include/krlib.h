@@ -14,6 +14,7 @@
 #if (!KR_CONFIG_NOINCLUDE)
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 #endif
 
 /**
@@ -34,6 +35,22 @@
  */
 KR_NODISCARD KR_INLINE void *kr_reallocarray(void *ptr, size_t nmemb, size_t size);
 
+/**
+ * @brief Hash a buffer for use in a hash table.
+ *
+ * @details A word-at-a-time multiplicative hash, like FxHash, which is
+ *          considerably faster than hashing a byte at a time.  The result
+ *          is mixed well enough to index a power of two table, but it is
+ *          not meant to stand up to keys chosen by an attacker.
+ *
+ * @param seed Starting value.  Passing the hash of one buffer as the seed of
+ *             the next hashes both together.
+ * @param data Buffer to hash.
+ * @param len Length of buffer.
+ * @return Hash of buffer.  Any part of it can be used as a smaller hash.
+ */
+KR_INLINE size_t kr_hash(size_t seed, const void *data, size_t len);
+
 /******************************************************************************/
 #if !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION)
 /******************************************************************************/
@@ -48,6 +65,43 @@ KR_NODISCARD KR_INLINE void *kr_reallocarray(void *ptr, size_t nmemb, size_t siz
     return KR_REALLOC(ptr, nmemb * size);
 }
 
+KR_INLINE size_t kr_hash(size_t seed, const void *data, size_t len)
+{
+#if (KR_SIZEOF_SIZE_T >= 8)
+    const size_t K = (KR_CASTS(size_t, 0x9E3779B9UL) << 32) | 0x7F4A7C15UL;
+#else
+    const size_t K = KR_CASTS(size_t, 0x9E3779B9UL);
+#endif
+    const char *str = KR_CASTS(const char *, data);
+    size_t hash = seed ^ len;
+    size_t word = 0;
+    size_t i = 0;
+
+    /* Short keys never reach the word loop, but when len isn't a constant
+       -Warray-bounds can't tell and warns about the word read.  Hide where
+       str points, as kr_stropaque_ does in krstr.h. */
+#if (KR_GNUC || KR_CLANG)
+    __asm__("" : "+r"(str));
+#endif
+    for (; i + sizeof(size_t) <= len; i += sizeof(size_t))
+    {
+        memcpy(&word, str + i, sizeof(size_t));
+        hash = ((hash << 5) | (hash >> (sizeof(size_t) * 8 - 5))) ^ word;
+        hash *= K;
+    }
+
+    if (i < len)
+    {
+        word = 0;
+        memcpy(&word, str + i, len - i);
+        hash = ((hash << 5) | (hash >> (sizeof(size_t) * 8 - 5))) ^ word;
+        hash *= K;
+    }
+
+    /* The multiply leaves the high bits best mixed, fold them down. */
+    return hash ^ (hash >> (sizeof(size_t) * 4));
+}
+
 #endif /* !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION) */
 
 #endif /* !defined(KRLIB_H) */
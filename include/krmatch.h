@@ -0,0 +1,492 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * Multi-pattern literal matching
+ *
+ * Finds every occurrence of every pattern in a set in one pass, using an
+ * Aho-Corasick automaton that has been flattened into a DFA.  Bytes that
+ * don't appear in any pattern share a single "byte class", so each DFA row
+ * only needs as many entries as there are distinct pattern bytes, which
+ * keeps the table small enough to stay in cache for large sets.
+ *
+ * For small sets, a Teddy-style SSSE3 prefilter skips over stretches of the
+ * haystack where no pattern can start whenever the automaton is sitting in
+ * its start state.  The prefilter only finds candidates, the DFA still does
+ * all the matching, so the results are identical with or without it.
+ *
+ * <https://github.com/BurntSushi/aho-corasick/blob/master/src/packed/teddy/README.md>
+ */
+
+#if !defined(KRMATCH_H)
+#define KRMATCH_H
+
+#include "./krconfig.h"
+
+#include "./krbltin.h" /* Needed for ctz. */
+#include "./krbool.h"
+#include "./krctype.h"
+#include "./krint.h"
+#include "./krlib.h"
+
+#if (!KR_CONFIG_NOINCLUDE)
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+#if (KR_SSSE3)
+#include <tmmintrin.h>
+#endif
+
+/**
+ * @brief Match patterns without regard to ASCII case.
+ */
+#define KR_MATCHER_NOCASE (1 << 0)
+
+/**
+ * @brief Called for each match found by kr_matcher_scan.
+ *
+ * @param user User pointer passed to kr_matcher_scan.
+ * @param pattern Index of the matching pattern.
+ * @param offset Offset of the start of the match in the haystack.
+ * @return true to keep scanning, false to stop.
+ */
+typedef bool (*kr_matcher_fn)(void *user, size_t pattern, size_t offset);
+
+/**
+ * @brief A set of patterns compiled into an automaton.
+ *
+ * @details Scanning never modifies the matcher, so one matcher can be shared
+ *          between threads.
+ */
+struct kr_matcher_s
+{
+    uint32_t *trans;        /* DFA rows, entries are row offsets. */
+    uint32_t *stateOut;     /* First pattern ending at each state. */
+    uint32_t *dictLink;     /* Next state down the suffix chain with output. */
+    uint32_t *patternNext;  /* Next pattern ending at the same state. */
+    size_t *patternLens;    /* Length of each pattern. */
+    size_t patternsLen;     /* Number of patterns. */
+    size_t statesLen;       /* Number of DFA states. */
+    size_t stride;          /* Number of byte classes, and so DFA row size. */
+    size_t reportRow;       /* Row of the first state with output. */
+    unsigned flags;         /* KR_MATCHER_* flags. */
+    size_t teddyLen;        /* Bytes of each pattern the prefilter checks. */
+    unsigned char classes[256];
+    unsigned char teddyLo[3][16]; /* Buckets by low nibble of each byte. */
+    unsigned char teddyHi[3][16]; /* Buckets by high nibble of each byte. */
+};
+
+/**
+ * @brief Compile a set of patterns into a matcher.
+ *
+ * @param matcher Matcher to initialize.  Must be destroyed with
+ *                kr_matcher_destroy if this function succeeds.
+ * @param patterns Array of patterns.
+ * @param lens Array of pattern lengths, or NULL if the patterns are null
+ *             terminated strings.
+ * @param patternsLen Number of patterns.
+ * @param flags Zero or more KR_MATCHER_* flags.
+ * @return true if the matcher was created, false if memory could not be
+ *         allocated, the automaton would be too large, or a pattern was
+ *         empty.
+ */
+KR_INLINE bool kr_matcher_init(struct kr_matcher_s *matcher, const char *const *patterns, const size_t *lens,
+                               size_t patternsLen, unsigned flags);
+
+/**
+ * @brief Free memory owned by a matcher.
+ *
+ * @param matcher Matcher to destroy.
+ */
+KR_INLINE void kr_matcher_destroy(struct kr_matcher_s *matcher);
+
+/**
+ * @brief Find every occurrence of every pattern in a buffer.
+ *
+ * @details Matches may overlap.  They are reported in order of where they
+ *          end, longest first for matches that end at the same place, and
+ *          by pattern index for identical patterns.
+ *
+ * @param matcher Matcher to use.
+ * @param buf Buffer to scan.
+ * @param len Length of buffer to scan.
+ * @param fn Function to call for each match.
+ * @param user User pointer passed through to fn.
+ * @return Number of matches reported.
+ */
+KR_INLINE size_t kr_matcher_scan(const struct kr_matcher_s *matcher, const char *buf, size_t len, kr_matcher_fn fn,
+                                 void *user);
+
+/******************************************************************************/
+#if !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION)
+/******************************************************************************/
+
+/*
+ * Sets this size or smaller get the Teddy prefilter.  With eight buckets,
+ * bigger sets put enough patterns in each bucket that candidates become
+ * too common to be worth it.
+ */
+#define KR_MATCHER_TEDDY_MAX_ 32
+
+#define KR_MATCHER_NONE_ (KR_CASTS(uint32_t, -1))
+
+KR_INLINE unsigned char kr_matcher_fold_(unsigned flags, unsigned char ch)
+{
+    return (flags & KR_MATCHER_NOCASE) ? KR_CASTS(unsigned char, kr_tolower(KR_CASTS(char, ch))) : ch;
+}
+
+KR_INLINE void kr_matcher_teddy_add_(struct kr_matcher_s *matcher, size_t pos, unsigned char ch, unsigned bucket)
+{
+    matcher->teddyLo[pos][ch & 0x0F] |= KR_CASTS(unsigned char, 1 << bucket);
+    matcher->teddyHi[pos][ch >> 4] |= KR_CASTS(unsigned char, 1 << bucket);
+}
+
+KR_INLINE bool kr_matcher_init(struct kr_matcher_s *matcher, const char *const *patterns, const size_t *lens,
+                               size_t patternsLen, unsigned flags)
+{
+    unsigned char used[256];
+    size_t i = 0, j = 0, c = 0, minLen = KR_CASTS(size_t, -1), totalLen = 1;
+    size_t head = 0, tail = 0;
+    uint32_t *fail = NULL, *queue = NULL, *renumber = NULL, *trans = NULL;
+    uint32_t numbered = 0;
+    int pass = 0;
+
+    memset(matcher, 0x00, sizeof(*matcher));
+    matcher->flags = flags;
+    matcher->patternsLen = patternsLen;
+
+    /* Every byte used in a pattern gets its own class, everything else
+       shares the last one. */
+    memset(used, 0x00, sizeof(used));
+    for (i = 0; i < patternsLen; i++)
+    {
+        const unsigned char *pattern = KR_CASTR(const unsigned char *, patterns[i]);
+        const size_t len = lens != NULL ? lens[i] : strlen(patterns[i]);
+        if (len == 0)
+        {
+            return false;
+        }
+
+        minLen = len < minLen ? len : minLen;
+        totalLen += len;
+        for (j = 0; j < len; j++)
+        {
+            used[kr_matcher_fold_(flags, pattern[j])] = 1;
+        }
+    }
+
+    for (c = 0; c < 256; c++)
+    {
+        matcher->classes[c] = KR_CASTS(unsigned char, matcher->stride);
+        matcher->stride += used[c];
+    }
+    for (c = 0; c < 256; c++)
+    {
+        if (!used[c])
+        {
+            matcher->classes[c] = KR_CASTS(unsigned char, matcher->stride);
+        }
+    }
+    matcher->stride += matcher->stride < 256 ? 1 : 0;
+    for (c = 0; c < 256; c++)
+    {
+        matcher->classes[c] = matcher->classes[kr_matcher_fold_(flags, KR_CASTS(unsigned char, c))];
+    }
+
+    /* There is at most one state per pattern byte plus the root, and
+       entries are stored as row offsets, so those must fit. */
+    if (totalLen > KR_CASTS(uint32_t, -1) / matcher->stride)
+    {
+        return false;
+    }
+
+    matcher->trans = KR_CASTS(uint32_t *, kr_reallocarray(NULL, totalLen * matcher->stride, sizeof(uint32_t)));
+    matcher->stateOut = KR_CASTS(uint32_t *, kr_reallocarray(NULL, totalLen, sizeof(uint32_t)));
+    matcher->dictLink = KR_CASTS(uint32_t *, kr_reallocarray(NULL, totalLen, sizeof(uint32_t)));
+    matcher->patternNext = KR_CASTS(uint32_t *, kr_reallocarray(NULL, patternsLen + 1, sizeof(uint32_t)));
+    matcher->patternLens = KR_CASTS(size_t *, kr_reallocarray(NULL, patternsLen + 1, sizeof(size_t)));
+    fail = KR_CASTS(uint32_t *, kr_reallocarray(NULL, totalLen, sizeof(uint32_t)));
+    queue = KR_CASTS(uint32_t *, kr_reallocarray(NULL, totalLen, sizeof(uint32_t)));
+    if (matcher->trans == NULL || matcher->stateOut == NULL || matcher->dictLink == NULL ||
+        matcher->patternNext == NULL || matcher->patternLens == NULL || fail == NULL || queue == NULL)
+    {
+        KR_FREE(fail);
+        KR_FREE(queue);
+        kr_matcher_destroy(matcher);
+        return false;
+    }
+    memset(matcher->trans, 0x00, totalLen * matcher->stride * sizeof(uint32_t));
+    memset(matcher->stateOut, 0xFF, totalLen * sizeof(uint32_t));
+    memset(matcher->dictLink, 0xFF, totalLen * sizeof(uint32_t));
+
+    /* Build the trie, where zero means no edge.  Patterns go in backwards so
+       the pattern list at each state ends up in index order. */
+    matcher->statesLen = 1;
+    for (i = patternsLen; i-- > 0;)
+    {
+        const unsigned char *pattern = KR_CASTR(const unsigned char *, patterns[i]);
+        const size_t len = lens != NULL ? lens[i] : strlen(patterns[i]);
+        uint32_t state = 0;
+
+        for (j = 0; j < len; j++)
+        {
+            uint32_t *edge = &matcher->trans[state * matcher->stride + matcher->classes[pattern[j]]];
+            if (*edge == 0)
+            {
+                *edge = KR_CASTS(uint32_t, matcher->statesLen++);
+            }
+            state = *edge;
+        }
+
+        matcher->patternLens[i] = len;
+        matcher->patternNext[i] = matcher->stateOut[state];
+        matcher->stateOut[state] = KR_CASTS(uint32_t, i);
+    }
+
+    /* Breadth-first, work out failure links and fill in the missing edges
+       from the failure state's row, which is always complete by then. */
+    for (c = 0; c < matcher->stride; c++)
+    {
+        if (matcher->trans[c] != 0)
+        {
+            fail[matcher->trans[c]] = 0;
+            queue[tail++] = matcher->trans[c];
+        }
+    }
+    while (head < tail)
+    {
+        const uint32_t state = queue[head++];
+        const uint32_t failState = fail[state];
+        uint32_t *row = &matcher->trans[state * matcher->stride];
+        const uint32_t *failRow = &matcher->trans[failState * matcher->stride];
+
+        matcher->dictLink[state] =
+            matcher->stateOut[failState] != KR_MATCHER_NONE_ ? failState : matcher->dictLink[failState];
+        for (c = 0; c < matcher->stride; c++)
+        {
+            if (row[c] != 0)
+            {
+                fail[row[c]] = failRow[c];
+                queue[tail++] = row[c];
+            }
+            else
+            {
+                row[c] = failRow[c];
+            }
+        }
+    }
+
+    /* Renumber the states so the ones with something to report come last,
+       so one compare tells the scanner whether to look closer.  The root
+       never reports, so it stays state zero. */
+    renumber = fail;
+    for (pass = 0; pass < 2; pass++)
+    {
+        for (i = 0; i < matcher->statesLen; i++)
+        {
+            const bool output =
+                matcher->stateOut[i] != KR_MATCHER_NONE_ || matcher->dictLink[i] != KR_MATCHER_NONE_;
+            if (output == (pass == 1))
+            {
+                renumber[i] = numbered++;
+            }
+        }
+        if (pass == 0)
+        {
+            matcher->reportRow = numbered * matcher->stride;
+        }
+    }
+
+    /* Entries are premultiplied row offsets, so scanning doesn't need to. */
+    trans = KR_CASTS(uint32_t *, kr_reallocarray(NULL, matcher->statesLen * matcher->stride, sizeof(uint32_t)));
+    if (trans == NULL)
+    {
+        KR_FREE(fail);
+        KR_FREE(queue);
+        kr_matcher_destroy(matcher);
+        return false;
+    }
+    for (i = 0; i < matcher->statesLen; i++)
+    {
+        for (c = 0; c < matcher->stride; c++)
+        {
+            trans[renumber[i] * matcher->stride + c] =
+                KR_CASTS(uint32_t, renumber[matcher->trans[i * matcher->stride + c]] * matcher->stride);
+        }
+    }
+    KR_FREE(matcher->trans);
+    matcher->trans = trans;
+
+    for (i = 0; i < matcher->statesLen; i++)
+    {
+        queue[renumber[i]] = matcher->stateOut[i];
+    }
+    memcpy(matcher->stateOut, queue, matcher->statesLen * sizeof(uint32_t));
+    for (i = 0; i < matcher->statesLen; i++)
+    {
+        queue[renumber[i]] =
+            matcher->dictLink[i] != KR_MATCHER_NONE_ ? renumber[matcher->dictLink[i]] : KR_MATCHER_NONE_;
+    }
+    memcpy(matcher->dictLink, queue, matcher->statesLen * sizeof(uint32_t));
+
+    KR_FREE(fail);
+    KR_FREE(queue);
+
+    /* Teddy buckets up to three leading bytes of every pattern. */
+    if (patternsLen <= KR_MATCHER_TEDDY_MAX_)
+    {
+        matcher->teddyLen = minLen < 3 ? minLen : 3;
+        for (i = 0; i < patternsLen; i++)
+        {
+            const unsigned char *pattern = KR_CASTR(const unsigned char *, patterns[i]);
+            const unsigned bucket = KR_CASTS(unsigned, i % 8);
+
+            for (j = 0; j < matcher->teddyLen; j++)
+            {
+                const unsigned char ch = pattern[j];
+                kr_matcher_teddy_add_(matcher, j, ch, bucket);
+                if (flags & KR_MATCHER_NOCASE)
+                {
+                    kr_matcher_teddy_add_(matcher, j, KR_CASTS(unsigned char, kr_tolower(KR_CASTS(char, ch))),
+                                          bucket);
+                    kr_matcher_teddy_add_(matcher, j, KR_CASTS(unsigned char, kr_toupper(KR_CASTS(char, ch))),
+                                          bucket);
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+KR_INLINE void kr_matcher_destroy(struct kr_matcher_s *matcher)
+{
+    KR_FREE(matcher->trans);
+    KR_FREE(matcher->stateOut);
+    KR_FREE(matcher->dictLink);
+    KR_FREE(matcher->patternNext);
+    KR_FREE(matcher->patternLens);
+    memset(matcher, 0x00, sizeof(*matcher));
+}
+
+#if (KR_SSSE3)
+
+/*
+ * Find the next position at or after pos where a pattern could start, or
+ * the position where there's no longer room for a full block.
+ */
+KR_INLINE size_t kr_matcher_teddy_(const struct kr_matcher_s *matcher, const unsigned char *buf, size_t len,
+                                   size_t pos)
+{
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i lo0 = _mm_loadu_si128(KR_CASTR(const __m128i *, matcher->teddyLo[0]));
+    const __m128i hi0 = _mm_loadu_si128(KR_CASTR(const __m128i *, matcher->teddyHi[0]));
+    const __m128i lo1 = _mm_loadu_si128(KR_CASTR(const __m128i *, matcher->teddyLo[1]));
+    const __m128i hi1 = _mm_loadu_si128(KR_CASTR(const __m128i *, matcher->teddyHi[1]));
+    const __m128i lo2 = _mm_loadu_si128(KR_CASTR(const __m128i *, matcher->teddyLo[2]));
+    const __m128i hi2 = _mm_loadu_si128(KR_CASTR(const __m128i *, matcher->teddyHi[2]));
+    const size_t extra = matcher->teddyLen - 1;
+    __m128i v, res;
+    unsigned mask = 0;
+
+    for (; len - pos >= 16 + extra; pos += 16)
+    {
+        /* Each byte ends up with the buckets that could start there. */
+        v = _mm_loadu_si128(KR_CASTR(const __m128i *, buf + pos));
+        res = _mm_and_si128(_mm_shuffle_epi8(lo0, _mm_and_si128(v, nibble)),
+                            _mm_shuffle_epi8(hi0, _mm_and_si128(_mm_srli_epi16(v, 4), nibble)));
+        if (extra >= 1)
+        {
+            v = _mm_loadu_si128(KR_CASTR(const __m128i *, buf + pos + 1));
+            res = _mm_and_si128(res, _mm_and_si128(_mm_shuffle_epi8(lo1, _mm_and_si128(v, nibble)),
+                                                   _mm_shuffle_epi8(hi1, _mm_and_si128(_mm_srli_epi16(v, 4), nibble))));
+        }
+        if (extra >= 2)
+        {
+            v = _mm_loadu_si128(KR_CASTR(const __m128i *, buf + pos + 2));
+            res = _mm_and_si128(res, _mm_and_si128(_mm_shuffle_epi8(lo2, _mm_and_si128(v, nibble)),
+                                                   _mm_shuffle_epi8(hi2, _mm_and_si128(_mm_srli_epi16(v, 4), nibble))));
+        }
+
+        mask = KR_CASTS(unsigned, _mm_movemask_epi8(_mm_cmpeq_epi8(res, _mm_setzero_si128()))) ^ 0xFFFF;
+        if (mask != 0)
+        {
+            return pos + KR_CASTS(size_t, kr_ctz32(mask));
+        }
+    }
+
+    return pos;
+}
+
+#endif /* (KR_SSSE3) */
+
+KR_INLINE size_t kr_matcher_scan(const struct kr_matcher_s *matcher, const char *buf, size_t len, kr_matcher_fn fn,
+                                 void *user)
+{
+    const unsigned char *b = KR_CASTR(const unsigned char *, buf);
+    const uint32_t *trans = matcher->trans;
+    const unsigned char *classes = matcher->classes;
+    uint32_t entry = 0; /* Root, which never has output. */
+    size_t i = 0, count = 0;
+
+    if (matcher->statesLen == 0)
+    {
+        return 0;
+    }
+
+    while (i < len)
+    {
+#if (KR_SSSE3)
+        if (entry == 0 && matcher->teddyLen != 0)
+        {
+            /* Nothing in progress, so skip ahead to the next place a pattern
+               could possibly start. */
+            i = kr_matcher_teddy_(matcher, b, len, i);
+            if (i == len)
+            {
+                break;
+            }
+        }
+#endif
+
+        entry = trans[entry + classes[b[i++]]];
+        if (entry >= matcher->reportRow)
+        {
+            uint32_t state = KR_CASTS(uint32_t, entry / matcher->stride);
+            uint32_t pattern = 0;
+
+            if (matcher->stateOut[state] == KR_MATCHER_NONE_)
+            {
+                state = matcher->dictLink[state];
+            }
+            for (; state != KR_MATCHER_NONE_; state = matcher->dictLink[state])
+            {
+                for (pattern = matcher->stateOut[state]; pattern != KR_MATCHER_NONE_;
+                     pattern = matcher->patternNext[pattern])
+                {
+                    count++;
+                    if (!fn(user, pattern, i - matcher->patternLens[pattern]))
+                    {
+                        return count;
+                    }
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
+#undef KR_MATCHER_TEDDY_MAX_
+#undef KR_MATCHER_NONE_
+
+#endif /* !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION) */
+
+#endif /* !defined(KRMATCH_H) */
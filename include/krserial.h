@@ -15,7 +15,7 @@
 
 #include "./krconfig.h"
 
-#include "./krbit.h" /* Needed for bswap. */
+#include "./krbltin.h" /* Needed for bswap. */
 
 #if (!KR_CONFIG_NOINCLUDE)
 #include <string.h>
@@ -11,23 +11,70 @@
 
 #include "./krconfig.h"
 
+#include "./krbltin.h" /* Needed for ctz. */
+#include "./krbool.h"
+#include "./krctype.h"
+#include "./krint.h"
+
 #if (!KR_CONFIG_NOINCLUDE)
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #endif
 
+#if (KR_AVX2)
+#include <immintrin.h>
+#elif (KR_SSSE3)
+#include <tmmintrin.h>
+#elif (KR_SSE2)
+#include <emmintrin.h>
+#endif
+
 /**
  * @brief Get length of string.
  *
+ * @details Outside of constant expressions, this dispatches to the fastest
+ *          of the variants below that the compiler targets.
+ *
  * @param str String to calculate length of.
  * @return Number of characters in string, not including the null terminator.
  */
 KR_CONSTEXPR size_t kr_strlen(const char *str);
 
+/**
+ * @brief Get length of string, checking a machine word at a time.
+ *
+ * @details Reads are aligned, so they might go past the terminator but
+ *          never past the page that contains it.
+ *
+ * @link http://graphics.stanford.edu/~seander/bithacks.html#ZeroInWord
+ */
+KR_INLINE size_t kr_strlen_swar(const char *str);
+
+#if (KR_SSE2)
+
+/**
+ * @brief Get length of string, checking 16 bytes at a time with SSE2.
+ */
+KR_INLINE size_t kr_strlen_sse2(const char *str);
+
+#endif /* (KR_SSE2) */
+
+#if (KR_AVX2)
+
+/**
+ * @brief Get length of string, checking 32 bytes at a time with AVX2.
+ */
+KR_INLINE size_t kr_strlen_avx2(const char *str);
+
+#endif /* (KR_AVX2) */
+
 /**
  * @brief Get length of string up to a certain length.
  *
+ * @details Outside of constant expressions, this dispatches to the fastest
+ *          of the variants below that the compiler targets.
+ *
  * @param str String to calculate length of.
  * @param len Number of bytes to check.
  * @return Number of characters in string, or len if null terminator was
@@ -35,6 +82,35 @@ KR_CONSTEXPR size_t kr_strlen(const char *str);
  */
 KR_CONSTEXPR size_t kr_strnlen(const char *str, size_t len);
 
+/**
+ * @brief Get length of string up to a certain length, checking a machine
+ *        word at a time.
+ *
+ * @details Reads are aligned and stop at str + len, but they might go past
+ *          the terminator to the end of the word that contains it.
+ */
+KR_INLINE size_t kr_strnlen_swar(const char *str, size_t len);
+
+#if (KR_SSE2)
+
+/**
+ * @brief Get length of string up to a certain length, checking 16 bytes at
+ *        a time with SSE2.
+ */
+KR_INLINE size_t kr_strnlen_sse2(const char *str, size_t len);
+
+#endif /* (KR_SSE2) */
+
+#if (KR_AVX2)
+
+/**
+ * @brief Get length of string up to a certain length, checking 32 bytes at
+ *        a time with AVX2.
+ */
+KR_INLINE size_t kr_strnlen_avx2(const char *str, size_t len);
+
+#endif /* (KR_AVX2) */
+
 /**
  * @brief Compare strings lexographically.
  *
@@ -45,6 +121,148 @@ KR_CONSTEXPR size_t kr_strnlen(const char *str, size_t len);
  */
 KR_CONSTEXPR int kr_strcmp(const char *lhs, const char *rhs);
 
+/**
+ * @brief Compare strings lexographically, checking a machine word at a time.
+ *
+ * @details Only compares a word at a time if both strings have the same
+ *          alignment, otherwise compares a byte at a time.
+ */
+KR_INLINE int kr_strcmp_swar(const char *lhs, const char *rhs);
+
+#if (KR_SSE2)
+
+/**
+ * @brief Compare strings lexographically, checking 16 bytes at a time with
+ *        SSE2.
+ */
+KR_INLINE int kr_strcmp_sse2(const char *lhs, const char *rhs);
+
+#endif /* (KR_SSE2) */
+
+#if (KR_AVX2)
+
+/**
+ * @brief Compare strings lexographically, checking 32 bytes at a time with
+ *        AVX2.
+ */
+KR_INLINE int kr_strcmp_avx2(const char *lhs, const char *rhs);
+
+#endif /* (KR_AVX2) */
+
+/**
+ * @brief Compare strings lexographically, up to a certain length.
+ *
+ * @param lhs First string to compare.
+ * @param rhs Second string to compare.
+ * @param len Maximum number of characters to compare.
+ * @return 0 if identical, <0 if lhs comes before rhs, >0 if rhs comes before
+ *         lhs.
+ */
+KR_CONSTEXPR int kr_strncmp(const char *lhs, const char *rhs, size_t len);
+
+/**
+ * @brief Compare strings lexographically up to a certain length, checking a
+ *        machine word at a time.
+ *
+ * @details Reads are aligned and stop at lhs + len and rhs + len, but they
+ *          might go past a terminator to the end of the word that contains
+ *          it.
+ */
+KR_INLINE int kr_strncmp_swar(const char *lhs, const char *rhs, size_t len);
+
+#if (KR_SSE2)
+
+/**
+ * @brief Compare strings lexographically up to a certain length, checking
+ *        16 bytes at a time with SSE2.
+ */
+KR_INLINE int kr_strncmp_sse2(const char *lhs, const char *rhs, size_t len);
+
+#endif /* (KR_SSE2) */
+
+#if (KR_AVX2)
+
+/**
+ * @brief Compare strings lexographically up to a certain length, checking
+ *        32 bytes at a time with AVX2.
+ */
+KR_INLINE int kr_strncmp_avx2(const char *lhs, const char *rhs, size_t len);
+
+#endif /* (KR_AVX2) */
+
+/**
+ * @brief Compare two buffers.
+ *
+ * @details Uses SSE2 or AVX2 if available, otherwise compares a machine word
+ *          at a time when both buffers have the same alignment.
+ *
+ * @param lhs First buffer to compare.
+ * @param rhs Second buffer to compare.
+ * @param len Number of bytes to compare.
+ * @return 0 if identical, otherwise the difference between the first pair of
+ *         bytes that differ, treated as unsigned char.
+ */
+KR_INLINE int kr_memcmp(const void *lhs, const void *rhs, size_t len);
+
+/**
+ * @brief Compare strings lexographically, ignoring ASCII case.
+ *
+ * @details Characters are folded with kr_tolower before comparing.  Uses
+ *          SSE2 or AVX2 if available, otherwise compares a machine word at
+ *          a time when both strings have the same alignment.
+ *
+ * @param lhs First string to compare.
+ * @param rhs Second string to compare.
+ * @return 0 if identical, otherwise the difference between the first pair of
+ *         folded characters that differ, treated as unsigned char.
+ */
+KR_CONSTEXPR int kr_strcasecmp(const char *lhs, const char *rhs);
+
+/**
+ * @brief Compare strings lexographically up to a certain length, ignoring
+ *        ASCII case.
+ *
+ * @param lhs First string to compare.
+ * @param rhs Second string to compare.
+ * @param len Maximum number of characters to compare.
+ * @return 0 if identical, otherwise the difference between the first pair of
+ *         folded characters that differ, treated as unsigned char.
+ */
+KR_CONSTEXPR int kr_strncasecmp(const char *lhs, const char *rhs, size_t len);
+
+/**
+ * @brief Compare two buffers, ignoring ASCII case.
+ *
+ * @param lhs First buffer to compare.
+ * @param rhs Second buffer to compare.
+ * @param len Number of bytes to compare.
+ * @return 0 if identical, otherwise the difference between the first pair of
+ *         folded bytes that differ, treated as unsigned char.
+ */
+KR_INLINE int kr_memcasecmp(const void *lhs, const void *rhs, size_t len);
+
+/**
+ * @brief Convert a string to ASCII lowercase in place.
+ *
+ * @details Identical to calling kr_tolower on every character, but converts
+ *          a machine word or SIMD register at a time.
+ *
+ * @param str String to convert.
+ * @return str.
+ */
+KR_INLINE char *kr_strlower(char *str);
+
+/**
+ * @brief Convert a string to ASCII uppercase in place.
+ *
+ * @details Identical to calling kr_toupper on every character, but converts
+ *          a machine word or SIMD register at a time.
+ *
+ * @param str String to convert.
+ * @return str.
+ */
+KR_INLINE char *kr_strupper(char *str);
+
 /**
  * @brief Copy string from src to dest.
  *
@@ -130,6 +348,170 @@ KR_CONSTEXPR size_t kr_strspn(const char *str, const char *chars);
  */
 KR_CONSTEXPR size_t kr_strcspn(const char *str, const char *chars);
 
+/**
+ * @brief A precompiled set of characters.
+ *
+ * @details Stored both as a 256-bit bitmap and as a pair of tables indexed
+ *          by the low nibble of a byte, which allows SIMD code to look up
+ *          16 or 32 bytes at once with a byte shuffle.
+ *
+ * @link http://0x80.pl/articles/simd-byte-lookup.html
+ */
+struct kr_charset_s
+{
+    unsigned char bitmap[32];
+    unsigned char nibbleLo[16]; /* Bit n is set if 0x{n}{index} is in set. */
+    unsigned char nibbleHi[16]; /* Bit n is set if 0x{n+8}{index} is in set. */
+};
+
+/**
+ * @brief Initialize a character set with the characters in string `chars`.
+ *
+ * @param set Character set to initialize.
+ * @param chars Characters to put in the set.
+ */
+KR_INLINE void kr_charset_init(struct kr_charset_s *set, const char *chars);
+
+/**
+ * @brief Add a single character to a character set.
+ *
+ * @details Unlike kr_charset_init, this can add the null character.
+ */
+KR_INLINE void kr_charset_add(struct kr_charset_s *set, char ch);
+
+/**
+ * @brief Check if a character is in a character set.
+ */
+KR_INLINE bool kr_charset_has(const struct kr_charset_s *set, char ch);
+
+/**
+ * @brief kr_strspn using a precompiled character set.
+ *
+ * @details Avoids rescanning `chars` for every character in `str`.  This
+ *          dispatches to the fastest of the variants below that the compiler
+ *          targets.
+ *
+ * @param str String to check.
+ * @param set Character set to check for.
+ * @return Length of substring that consists only of characters in `set`.
+ */
+KR_INLINE size_t kr_strspn_set(const char *str, const struct kr_charset_s *set);
+
+/**
+ * @brief kr_strcspn using a precompiled character set.
+ *
+ * @details Avoids rescanning `chars` for every character in `str`.  This
+ *          dispatches to the fastest of the variants below that the compiler
+ *          targets.
+ *
+ * @param str String to check.
+ * @param set Character set to check for.
+ * @return Length of substring that consists only of characters not in `set`.
+ */
+KR_INLINE size_t kr_strcspn_set(const char *str, const struct kr_charset_s *set);
+
+#if (KR_SSSE3)
+
+/**
+ * @brief kr_strspn_set, checking 16 bytes at a time with SSSE3.
+ */
+KR_INLINE size_t kr_strspn_set_ssse3(const char *str, const struct kr_charset_s *set);
+
+/**
+ * @brief kr_strcspn_set, checking 16 bytes at a time with SSSE3.
+ */
+KR_INLINE size_t kr_strcspn_set_ssse3(const char *str, const struct kr_charset_s *set);
+
+#endif /* (KR_SSSE3) */
+
+#if (KR_AVX2)
+
+/**
+ * @brief kr_strspn_set, checking 32 bytes at a time with AVX2.
+ */
+KR_INLINE size_t kr_strspn_set_avx2(const char *str, const struct kr_charset_s *set);
+
+/**
+ * @brief kr_strcspn_set, checking 32 bytes at a time with AVX2.
+ */
+KR_INLINE size_t kr_strcspn_set_avx2(const char *str, const struct kr_charset_s *set);
+
+#endif /* (KR_AVX2) */
+
+/**
+ * @brief A token found by the tokenizer, as a slice of the scanned buffer.
+ */
+struct kr_token_s
+{
+    size_t offset;
+    size_t length;
+};
+
+/**
+ * @brief State for splitting a stream of bytes into tokens.
+ *
+ * @details Unlike kr_strtok_r, the input is never modified and doesn't need
+ *          to be terminated, so it can be a read-only or memory-mapped
+ *          buffer.  Tokens are reported as offsets from the start of the
+ *          stream, and a token that straddles two chunks is reported once
+ *          the chunk containing its end is fed.
+ */
+struct kr_tokenizer_s
+{
+    const struct kr_charset_s *delims;
+    size_t pos;      /* Stream offset of the next byte to be fed. */
+    size_t tokStart; /* Stream offset of the token in progress. */
+    bool inToken;
+};
+
+/**
+ * @brief Initialize a tokenizer.
+ *
+ * @param tok Tokenizer to initialize.
+ * @param delims Set of delimiter characters.  Must outlive the tokenizer.
+ */
+KR_INLINE void kr_tokenizer_init(struct kr_tokenizer_s *tok, const struct kr_charset_s *delims);
+
+/**
+ * @brief Feed the next chunk of a stream to a tokenizer.
+ *
+ * @param tok Tokenizer to use.
+ * @param chunk Chunk of data to scan.
+ * @param len Length of chunk.
+ * @param toks Array to write completed tokens to.
+ * @param toksLen Length of toks array.
+ * @param consumed Set to the number of bytes of chunk that were scanned.
+ *                 This is less than len only if toks filled up, in which
+ *                 case the rest of the chunk should be fed again.
+ * @return Number of tokens written to toks.
+ */
+KR_INLINE size_t kr_tokenizer_feed(struct kr_tokenizer_s *tok, const char *chunk, size_t len, struct kr_token_s *toks,
+                                   size_t toksLen, size_t *consumed);
+
+/**
+ * @brief Finish a stream, returning the token at the very end if there is
+ *        one.
+ *
+ * @param tok Tokenizer to use.
+ * @param out Token to write.
+ * @return True if a token was written.
+ */
+KR_INLINE bool kr_tokenizer_finish(struct kr_tokenizer_s *tok, struct kr_token_s *out);
+
+/**
+ * @brief Split a buffer into tokens in a single pass.
+ *
+ * @param buf Buffer to scan.
+ * @param len Length of buffer.
+ * @param delims Set of delimiter characters.
+ * @param toks Array to write tokens to, as offsets into buf.
+ * @param toksLen Length of toks array.
+ * @return Number of tokens written to toks.  If this is toksLen, there might
+ *         be more tokens after the end of the last one.
+ */
+KR_INLINE size_t kr_tokenize(const char *buf, size_t len, const struct kr_charset_s *delims, struct kr_token_s *toks,
+                             size_t toksLen);
+
 /**
  * @brief Scan string for a token that is split by one of the characters
  *        in string `delim`.
@@ -144,6 +526,141 @@ KR_CONSTEXPR size_t kr_strcspn(const char *str, const char *chars);
  */
 KR_CONSTEXPR char *kr_strtok_r(char *KR_RESTRICT str, const char *KR_RESTRICT delim, char **KR_RESTRICT ptr);
 
+/**
+ * @brief Find the first occurrence of a byte in a buffer.
+ *
+ * @param ptr Buffer to search.
+ * @param ch Byte to search for.  Converted to unsigned char.
+ * @param len Length of buffer.
+ * @return Pointer to first matching byte, or NULL if not found.
+ */
+KR_INLINE void *kr_memchr(const void *ptr, int ch, size_t len);
+
+/**
+ * @brief Find the last occurrence of a byte in a buffer.
+ *
+ * @param ptr Buffer to search.
+ * @param ch Byte to search for.  Converted to unsigned char.
+ * @param len Length of buffer.
+ * @return Pointer to last matching byte, or NULL if not found.
+ */
+KR_INLINE void *kr_memrchr(const void *ptr, int ch, size_t len);
+
+/**
+ * @brief Find the first occurrence of a byte sequence inside a buffer.
+ *
+ * @details With SSE2 or AVX2, candidate positions are found by comparing
+ *          the first and last byte of the needle against a whole block of
+ *          the haystack at once.  If too many candidates turn out to be
+ *          false positives, the search switches to the Two-Way algorithm,
+ *          which is always linear in the length of the haystack and uses
+ *          constant space.  Without SIMD, Two-Way is used for everything.
+ *
+ * @link http://0x80.pl/articles/simd-strfind.html
+ * @link https://www-igm.univ-mlv.fr/~mac/Articles-PDF/CP-1991-jacm.pdf
+ *
+ * @param haystack Buffer to search.
+ * @param haystackLen Length of buffer to search.
+ * @param needle Byte sequence to search for.
+ * @param needleLen Length of byte sequence.
+ * @return Pointer to start of first match, or NULL if not found.  An empty
+ *         needle matches the start of the haystack.
+ */
+KR_INLINE void *kr_memmem(const void *haystack, size_t haystackLen, const void *needle, size_t needleLen);
+
+/**
+ * @brief Find the first occurrence of a string inside another string.
+ *
+ * @details Same algorithm as kr_memmem.
+ *
+ * @param haystack String to search.
+ * @param needle String to search for.
+ * @return Pointer to start of first match, or NULL if not found.  An empty
+ *         needle matches the start of the haystack.
+ */
+KR_INLINE char *kr_strstr(const char *haystack, const char *needle);
+
+/**
+ * @brief Precomputed state for Two-Way string matching.
+ *
+ * @details The needle is split at a "critical factorization" into a left
+ *          and right half.  Searching matches the right half left-to-right,
+ *          then the left half right-to-left, and a mismatch in either allows
+ *          a shift that never has to revisit haystack bytes.
+ */
+struct kr_twoway_s
+{
+    size_t suffix; /* Start of the right half. */
+    size_t period; /* Shift after a full match of the right half. */
+    bool periodic; /* Left half repeats inside the right half. */
+};
+
+/**
+ * @brief Algorithms a kr_searcher_s can pick from.
+ */
+enum kr_searcher_algo_e
+{
+    KR_SEARCHER_MEMCHR,   /* Needle is zero or one byte long. */
+    KR_SEARCHER_SIMD,     /* SIMD first/last byte filter, on SSE2 builds. */
+    KR_SEARCHER_HORSPOOL, /* Boyer-Moore-Horspool, for shorter needles without SSE2. */
+    KR_SEARCHER_TWOWAY    /* Two-Way with a bad character table. */
+};
+
+/**
+ * @brief A needle that has been preprocessed for repeated searches.
+ *
+ * @details The algorithm is picked once, when the searcher is
+ *          initialized.  Needles of zero or one byte use kr_memchr.  On
+ *          SSE2 builds every longer needle uses the SIMD filter, and
+ *          otherwise the needle length picks Horspool or Two-Way.  Every
+ *          algorithm falls back to Two-Way if it starts doing too much
+ *          work, so searches are always linear in the length of the
+ *          haystack.  Searching never modifies the searcher, so one
+ *          searcher can be shared between threads.
+ */
+struct kr_searcher_s
+{
+    const unsigned char *needle;
+    size_t needleLen;
+    enum kr_searcher_algo_e algo;
+    struct kr_twoway_s twoway;
+    unsigned char skip[256]; /* Bad character shift for each haystack byte. */
+};
+
+/**
+ * @brief Initialize a searcher.
+ *
+ * @param searcher Searcher to initialize.
+ * @param needle Byte sequence to search for.  Must outlive the searcher.
+ * @param needleLen Length of byte sequence.
+ */
+KR_INLINE void kr_searcher_init(struct kr_searcher_s *searcher, const void *needle, size_t needleLen);
+
+/**
+ * @brief Find the first occurrence of the searcher's needle in a buffer.
+ *
+ * @param searcher Searcher to use.
+ * @param haystack Buffer to search.
+ * @param haystackLen Length of buffer to search.
+ * @return Pointer to start of first match, or NULL if not found.  An empty
+ *         needle matches the start of the haystack.
+ */
+KR_INLINE void *kr_searcher_find(const struct kr_searcher_s *searcher, const void *haystack, size_t haystackLen);
+
+/**
+ * @brief Count the occurrences of the searcher's needle in a buffer.
+ *
+ * @details Matches are not allowed to overlap, so "aa" is found twice in
+ *          "aaaaa".  An empty needle matches between every byte, and at
+ *          both ends.
+ *
+ * @param searcher Searcher to use.
+ * @param haystack Buffer to search.
+ * @param haystackLen Length of buffer to search.
+ * @return Number of matches.
+ */
+KR_INLINE size_t kr_searcher_count(const struct kr_searcher_s *searcher, const void *haystack, size_t haystackLen);
+
 /**
  * @brief Duplicate string with malloc().
  *
@@ -178,10 +695,84 @@ KR_INLINE void *kr_memccpy(void *KR_RESTRICT dest, const void *KR_RESTRICT src,
 #if !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION)
 /******************************************************************************/
 
+/*
+ * Word-at-a-time helpers.  A word is a size_t, which is assumed to be the
+ * natural register size of the target.
+ */
+
+typedef size_t KR_MAY_ALIAS kr_strword_t_;
+
+#define KR_STRWORD_ONES_ (KR_CASTS(size_t, -1) / 0xFF)
+#define KR_STRWORD_HIGHS_ (KR_STRWORD_ONES_ * 0x80)
+#define KR_STRWORD_HASZERO_(x) (((x) - KR_STRWORD_ONES_) & ~(x) & KR_STRWORD_HIGHS_)
+#define KR_STRWORD_ALIGNED_(p) ((KR_CASTR(uintptr_t, (p)) % sizeof(size_t)) == 0)
+
+/*
+ * High bit set in every byte between lo and hi inclusive.  Works on the low
+ * seven bits so the additions never carry into the next byte, then throws
+ * out bytes that had their high bit set to begin with.
+ */
+#define KR_STRWORD_RANGE_(x, lo, hi)                                                                                   \
+    ((((x) & ~KR_STRWORD_HIGHS_) + KR_STRWORD_ONES_ * (0x80 - (lo))) &                                                 \
+     ~(((x) & ~KR_STRWORD_HIGHS_) + KR_STRWORD_ONES_ * (0x7F - (hi))) & ~(x) & KR_STRWORD_HIGHS_)
+
+/* Flip the case bit of every byte in range, 0x80 >> 2 == 0x20. */
+#define KR_STRWORD_LOWER_(x) ((x) ^ (KR_STRWORD_RANGE_((x), 'A', 'Z') >> 2))
+#define KR_STRWORD_UPPER_(x) ((x) ^ (KR_STRWORD_RANGE_((x), 'a', 'z') >> 2))
+
+/*
+ * The same pointer, but the optimizer can no longer tell what it points to.
+ * Reads that run on to the end of an aligned block look out of bounds to
+ * -Warray-bounds once they're inlined into a caller that passes a short
+ * literal, and so does code after them that is never reached.
+ */
+KR_INLINE const char *kr_stropaque_(const char *s)
+{
+#if (KR_GNUC || KR_CLANG)
+    __asm__("" : "+r"(s));
+#endif
+    return s;
+}
+
+#if (KR_SSE2)
+
+/* Mask of zero bytes in 16 bytes of aligned memory. */
+KR_NOSANITIZE_ADDRESS KR_INLINE unsigned kr_strzero16_(const char *s)
+{
+    const __m128i v = _mm_load_si128(KR_CASTR(const __m128i *, kr_stropaque_(s)));
+    return KR_CASTS(unsigned, _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())));
+}
+
+#endif /* (KR_SSE2) */
+
+#if (KR_AVX2)
+
+/* Mask of zero bytes in 32 bytes of aligned memory. */
+KR_NOSANITIZE_ADDRESS KR_INLINE uint32_t kr_strzero32_(const char *s)
+{
+    const __m256i v = _mm256_load_si256(KR_CASTR(const __m256i *, kr_stropaque_(s)));
+    return KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_setzero_si256())));
+}
+
+#endif /* (KR_AVX2) */
+
+/******************************************************************************/
+
 KR_CONSTEXPR size_t kr_strlen(const char *str)
 {
     size_t i = 0;
 
+    if (!KR_IS_CONSTANT_EVALUATED())
+    {
+#if (KR_AVX2)
+        return kr_strlen_avx2(str);
+#elif (KR_SSE2)
+        return kr_strlen_sse2(str);
+#else
+        return kr_strlen_swar(str);
+#endif
+    }
+
     for (i = 0;; i++)
     {
         if (str[i] == '\0')
@@ -191,233 +782,2430 @@ KR_CONSTEXPR size_t kr_strlen(const char *str)
     }
 }
 
-KR_CONSTEXPR size_t kr_strnlen(const char *str, size_t len)
+KR_NOSANITIZE_ADDRESS KR_INLINE size_t kr_strlen_swar(const char *str)
 {
-    size_t i = 0;
+    const char *s = str;
+    const kr_strword_t_ *w = NULL;
 
-    for (i = 0; i < len; i++)
+    /* Go byte by byte until we're aligned, reads can't cross a page after. */
+    for (; !KR_STRWORD_ALIGNED_(s); s++)
     {
-        if (str[i] == '\0')
+        if (*s == '\0')
         {
-            return i;
+            return KR_CASTS(size_t, s - str);
+        }
+    }
+
+    w = KR_CASTR(const kr_strword_t_ *, s);
+    while (!KR_STRWORD_HASZERO_(*w))
+    {
+        w++;
+    }
+
+    /* This word contains the terminator, find out which byte it is. */
+    s = KR_CASTR(const char *, w);
+    while (*s != '\0')
+    {
+        s++;
+    }
+    return KR_CASTS(size_t, s - str);
+}
+
+#if (KR_SSE2)
+
+KR_NOSANITIZE_ADDRESS KR_INLINE size_t kr_strlen_sse2(const char *str)
+{
+    const size_t skip = KR_CASTR(uintptr_t, str) % 16;
+    const char *s = str - skip;
+    unsigned mask = 0;
+
+    /* Aligned loads can't cross a page, mask off bytes before the string. */
+    mask = kr_strzero16_(s) >> skip;
+    if (mask != 0)
+    {
+        return KR_CASTS(size_t, kr_ctz32(mask));
+    }
+
+    /* Go 16 bytes at a time until we're aligned for the unrolled loop. */
+    for (s += 16; KR_CASTR(uintptr_t, s) % 64 != 0; s += 16)
+    {
+        mask = kr_strzero16_(s);
+        if (mask != 0)
+        {
+            return KR_CASTS(size_t, s - str) + KR_CASTS(size_t, kr_ctz32(mask));
+        }
+    }
+
+    /* The smallest byte in a block is zero if any of them are. */
+    for (;; s += 64)
+    {
+        const __m128i *v = KR_CASTR(const __m128i *, kr_stropaque_(s));
+        const __m128i lo = _mm_min_epu8(_mm_load_si128(v), _mm_load_si128(v + 1));
+        const __m128i hi = _mm_min_epu8(_mm_load_si128(v + 2), _mm_load_si128(v + 3));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(lo, hi), _mm_setzero_si128())) != 0)
+        {
+            break;
+        }
+    }
+
+    for (;; s += 16)
+    {
+        mask = kr_strzero16_(s);
+        if (mask != 0)
+        {
+            return KR_CASTS(size_t, s - str) + KR_CASTS(size_t, kr_ctz32(mask));
+        }
+    }
+}
+
+#endif /* (KR_SSE2) */
+
+#if (KR_AVX2)
+
+KR_NOSANITIZE_ADDRESS KR_INLINE size_t kr_strlen_avx2(const char *str)
+{
+    const size_t skip = KR_CASTR(uintptr_t, str) % 32;
+    const char *s = str - skip;
+    uint32_t mask = 0;
+
+    /* Aligned loads can't cross a page, mask off bytes before the string. */
+    mask = kr_strzero32_(s) >> skip;
+    if (mask != 0)
+    {
+        return KR_CASTS(size_t, kr_ctz32(mask));
+    }
+
+    /* Go 32 bytes at a time until we're aligned for the unrolled loop. */
+    for (s += 32; KR_CASTR(uintptr_t, s) % 64 != 0; s += 32)
+    {
+        mask = kr_strzero32_(s);
+        if (mask != 0)
+        {
+            return KR_CASTS(size_t, s - str) + KR_CASTS(size_t, kr_ctz32(mask));
+        }
+    }
+
+    /* The smallest byte in a block is zero if any of them are. */
+    for (;; s += 64)
+    {
+        const __m256i *v = KR_CASTR(const __m256i *, kr_stropaque_(s));
+        const __m256i m = _mm256_min_epu8(_mm256_load_si256(v), _mm256_load_si256(v + 1));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(m, _mm256_setzero_si256())) != 0)
+        {
+            break;
+        }
+    }
+
+    for (;; s += 32)
+    {
+        mask = kr_strzero32_(s);
+        if (mask != 0)
+        {
+            return KR_CASTS(size_t, s - str) + KR_CASTS(size_t, kr_ctz32(mask));
+        }
+    }
+}
+
+#endif /* (KR_AVX2) */
+
+/******************************************************************************/
+
+KR_CONSTEXPR size_t kr_strnlen(const char *str, size_t len)
+{
+    size_t i = 0;
+
+    if (!KR_IS_CONSTANT_EVALUATED())
+    {
+#if (KR_AVX2)
+        return kr_strnlen_avx2(str, len);
+#elif (KR_SSE2)
+        return kr_strnlen_sse2(str, len);
+#else
+        return kr_strnlen_swar(str, len);
+#endif
+    }
+
+    for (i = 0; i < len; i++)
+    {
+        if (str[i] == '\0')
+        {
+            return i;
+        }
+    }
+    return len;
+}
+
+KR_NOSANITIZE_ADDRESS KR_INLINE size_t kr_strnlen_swar(const char *str, size_t len)
+{
+    const char *s = str;
+    const kr_strword_t_ *w = NULL;
+
+    /* Count what's left rather than pointing at str + len, which can be far
+       past the end of a string shorter than len. */
+    for (; KR_CASTS(size_t, s - str) < len && !KR_STRWORD_ALIGNED_(s); s++)
+    {
+        if (*s == '\0')
+        {
+            return KR_CASTS(size_t, s - str);
+        }
+    }
+
+    /* Only read whole words that are inside the buffer. */
+    w = KR_CASTR(const kr_strword_t_ *, s);
+    while (len - KR_CASTS(size_t, KR_CASTR(const char *, w) - str) >= sizeof(size_t) && !KR_STRWORD_HASZERO_(*w))
+    {
+        w++;
+    }
+
+    for (s = KR_CASTR(const char *, w); KR_CASTS(size_t, s - str) < len; s++)
+    {
+        if (*s == '\0')
+        {
+            return KR_CASTS(size_t, s - str);
+        }
+    }
+    return len;
+}
+
+#if (KR_SSE2)
+
+KR_NOSANITIZE_ADDRESS KR_INLINE size_t kr_strnlen_sse2(const char *str, size_t len)
+{
+    const size_t skip = KR_CASTR(uintptr_t, str) % 16;
+    size_t i = 0;
+    unsigned mask = 0;
+
+    if (len == 0)
+    {
+        return 0;
+    }
+
+    /* Aligned loads can't cross a page, mask off bytes before the string. */
+    mask = kr_strzero16_(str - skip) >> skip;
+    if (mask != 0)
+    {
+        i = KR_CASTS(size_t, kr_ctz32(mask));
+        return i < len ? i : len;
+    }
+
+    /* Go 16 bytes at a time until we're aligned for the unrolled loop. */
+    for (i = 16 - skip; i < len && KR_CASTR(uintptr_t, str + i) % 64 != 0; i += 16)
+    {
+        mask = kr_strzero16_(str + i);
+        if (mask != 0)
+        {
+            i += KR_CASTS(size_t, kr_ctz32(mask));
+            return i < len ? i : len;
+        }
+    }
+
+    /* The smallest byte in a block is zero if any of them are. */
+    for (; i < len; i += 64)
+    {
+        const __m128i *v = KR_CASTR(const __m128i *, kr_stropaque_(str + i));
+        const __m128i lo = _mm_min_epu8(_mm_load_si128(v), _mm_load_si128(v + 1));
+        const __m128i hi = _mm_min_epu8(_mm_load_si128(v + 2), _mm_load_si128(v + 3));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(lo, hi), _mm_setzero_si128())) != 0)
+        {
+            break;
+        }
+    }
+
+    for (; i < len; i += 16)
+    {
+        mask = kr_strzero16_(str + i);
+        if (mask != 0)
+        {
+            i += KR_CASTS(size_t, kr_ctz32(mask));
+            return i < len ? i : len;
+        }
+    }
+    return len;
+}
+
+#endif /* (KR_SSE2) */
+
+#if (KR_AVX2)
+
+KR_NOSANITIZE_ADDRESS KR_INLINE size_t kr_strnlen_avx2(const char *str, size_t len)
+{
+    const size_t skip = KR_CASTR(uintptr_t, str) % 32;
+    size_t i = 0;
+    uint32_t mask = 0;
+
+    if (len == 0)
+    {
+        return 0;
+    }
+
+    /* Aligned loads can't cross a page, mask off bytes before the string. */
+    mask = kr_strzero32_(str - skip) >> skip;
+    if (mask != 0)
+    {
+        i = KR_CASTS(size_t, kr_ctz32(mask));
+        return i < len ? i : len;
+    }
+
+    /* Go 32 bytes at a time until we're aligned for the unrolled loop. */
+    for (i = 32 - skip; i < len && KR_CASTR(uintptr_t, str + i) % 64 != 0; i += 32)
+    {
+        mask = kr_strzero32_(str + i);
+        if (mask != 0)
+        {
+            i += KR_CASTS(size_t, kr_ctz32(mask));
+            return i < len ? i : len;
+        }
+    }
+
+    /* The smallest byte in a block is zero if any of them are. */
+    for (; i < len; i += 64)
+    {
+        const __m256i *v = KR_CASTR(const __m256i *, kr_stropaque_(str + i));
+        const __m256i m = _mm256_min_epu8(_mm256_load_si256(v), _mm256_load_si256(v + 1));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(m, _mm256_setzero_si256())) != 0)
+        {
+            break;
+        }
+    }
+
+    for (; i < len; i += 32)
+    {
+        mask = kr_strzero32_(str + i);
+        if (mask != 0)
+        {
+            i += KR_CASTS(size_t, kr_ctz32(mask));
+            return i < len ? i : len;
         }
     }
     return len;
 }
 
+#endif /* (KR_AVX2) */
+
+/******************************************************************************/
+
+KR_CONSTEXPR int kr_strcmp(const char *lhs, const char *rhs)
+{
+    if (!KR_IS_CONSTANT_EVALUATED())
+    {
+#if (KR_AVX2)
+        return kr_strcmp_avx2(lhs, rhs);
+#elif (KR_SSE2)
+        return kr_strcmp_sse2(lhs, rhs);
+#else
+        return kr_strcmp_swar(lhs, rhs);
+#endif
+    }
+
+    for (;; lhs++, rhs++)
+    {
+        if (*lhs != *rhs || *lhs == '\0')
+        {
+            break;
+        }
+    }
+    return KR_CASTS(unsigned char, *lhs) - KR_CASTS(unsigned char, *rhs);
+}
+
+/*
+ * SIMD comparisons read whole blocks from both strings, which can go past
+ * the terminator.  That's fine as long as the read doesn't cross into the
+ * next page, which might not be mapped.
+ */
+#define KR_STRPAGE_SIZE_ 4096
+#define KR_STRPAGE_CROSSES_(p, n) ((KR_CASTR(uintptr_t, (p)) % KR_STRPAGE_SIZE_) > KR_STRPAGE_SIZE_ - (n))
+
+KR_NOSANITIZE_ADDRESS KR_INLINE int kr_strcmp_swar(const char *lhs, const char *rhs)
+{
+    const kr_strword_t_ *l = NULL, *r = NULL;
+
+    if (KR_CASTR(uintptr_t, lhs) % sizeof(size_t) == KR_CASTR(uintptr_t, rhs) % sizeof(size_t))
+    {
+        for (; !KR_STRWORD_ALIGNED_(lhs); lhs++, rhs++)
+        {
+            if (*lhs != *rhs || *lhs == '\0')
+            {
+                return KR_CASTS(unsigned char, *lhs) - KR_CASTS(unsigned char, *rhs);
+            }
+        }
+
+        /* Aligned words never cross a page, so reading past the terminator
+           is harmless. */
+        l = KR_CASTR(const kr_strword_t_ *, lhs);
+        r = KR_CASTR(const kr_strword_t_ *, rhs);
+        while (*l == *r && !KR_STRWORD_HASZERO_(*l))
+        {
+            l++;
+            r++;
+        }
+        lhs = KR_CASTR(const char *, l);
+        rhs = KR_CASTR(const char *, r);
+    }
+
+    for (;; lhs++, rhs++)
+    {
+        if (*lhs != *rhs || *lhs == '\0')
+        {
+            break;
+        }
+    }
+    return KR_CASTS(unsigned char, *lhs) - KR_CASTS(unsigned char, *rhs);
+}
+
+#if (KR_SSE2)
+
+/* Zero where bytes differ or lhs has its terminator. */
+KR_NOSANITIZE_ADDRESS KR_INLINE __m128i kr_strcmpsame16_(const char *lhs, const char *rhs)
+{
+    const __m128i l = _mm_loadu_si128(KR_CASTR(const __m128i *, lhs));
+    const __m128i r = _mm_loadu_si128(KR_CASTR(const __m128i *, rhs));
+    return _mm_min_epu8(l, _mm_cmpeq_epi8(l, r));
+}
+
+/* Mask of bytes that differ or are the terminator of lhs. */
+KR_NOSANITIZE_ADDRESS KR_INLINE unsigned kr_strcmp16_(const char *lhs, const char *rhs)
+{
+    const __m128i same = kr_strcmpsame16_(lhs, rhs);
+    return KR_CASTS(unsigned, _mm_movemask_epi8(_mm_cmpeq_epi8(same, _mm_setzero_si128())));
+}
+
+/* Non-zero if any of the next 64 bytes differ or terminate lhs. */
+KR_NOSANITIZE_ADDRESS KR_INLINE unsigned kr_strcmp64_sse2_(const char *lhs, const char *rhs)
+{
+    const __m128i a = _mm_min_epu8(kr_strcmpsame16_(lhs, rhs), kr_strcmpsame16_(lhs + 16, rhs + 16));
+    const __m128i b = _mm_min_epu8(kr_strcmpsame16_(lhs + 32, rhs + 32), kr_strcmpsame16_(lhs + 48, rhs + 48));
+    return KR_CASTS(unsigned, _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(a, b), _mm_setzero_si128())));
+}
+
+KR_NOSANITIZE_ADDRESS KR_INLINE int kr_strcmp_sse2(const char *lhs, const char *rhs)
+{
+    size_t i = 0, end = 0;
+    unsigned mask = 0;
+
+    for (;;)
+    {
+        if (!KR_STRPAGE_CROSSES_(lhs + i, 64) && !KR_STRPAGE_CROSSES_(rhs + i, 64))
+        {
+            if (kr_strcmp64_sse2_(lhs + i, rhs + i) == 0)
+            {
+                i += 64;
+                continue;
+            }
+
+            /* It's in one of these blocks. */
+            for (;; i += 16)
+            {
+                mask = kr_strcmp16_(lhs + i, rhs + i);
+                if (mask != 0)
+                {
+                    i += KR_CASTS(size_t, kr_ctz32(mask));
+                    return KR_CASTS(unsigned char, lhs[i]) - KR_CASTS(unsigned char, rhs[i]);
+                }
+            }
+        }
+        else if (KR_STRPAGE_CROSSES_(lhs + i, 16) || KR_STRPAGE_CROSSES_(rhs + i, 16))
+        {
+            /* Creep across the page boundary a byte at a time. */
+            for (end = i + 16; i < end; i++)
+            {
+                if (lhs[i] != rhs[i] || lhs[i] == '\0')
+                {
+                    return KR_CASTS(unsigned char, lhs[i]) - KR_CASTS(unsigned char, rhs[i]);
+                }
+            }
+            continue;
+        }
+
+        mask = kr_strcmp16_(lhs + i, rhs + i);
+        if (mask != 0)
+        {
+            i += KR_CASTS(size_t, kr_ctz32(mask));
+            return KR_CASTS(unsigned char, lhs[i]) - KR_CASTS(unsigned char, rhs[i]);
+        }
+        i += 16;
+    }
+}
+
+#endif /* (KR_SSE2) */
+
+#if (KR_AVX2)
+
+/* Zero where bytes differ or lhs has its terminator. */
+KR_NOSANITIZE_ADDRESS KR_INLINE __m256i kr_strcmpsame32_(const char *lhs, const char *rhs)
+{
+    const __m256i l = _mm256_loadu_si256(KR_CASTR(const __m256i *, lhs));
+    const __m256i r = _mm256_loadu_si256(KR_CASTR(const __m256i *, rhs));
+    return _mm256_min_epu8(l, _mm256_cmpeq_epi8(l, r));
+}
+
+/* Mask of bytes that differ or are the terminator of lhs. */
+KR_NOSANITIZE_ADDRESS KR_INLINE uint32_t kr_strcmp32_(const char *lhs, const char *rhs)
+{
+    const __m256i same = kr_strcmpsame32_(lhs, rhs);
+    return KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(same, _mm256_setzero_si256())));
+}
+
+/* Non-zero if any of the next 64 bytes differ or terminate lhs. */
+KR_NOSANITIZE_ADDRESS KR_INLINE uint32_t kr_strcmp64_avx2_(const char *lhs, const char *rhs)
+{
+    const __m256i same = _mm256_min_epu8(kr_strcmpsame32_(lhs, rhs), kr_strcmpsame32_(lhs + 32, rhs + 32));
+    return KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(same, _mm256_setzero_si256())));
+}
+
+KR_NOSANITIZE_ADDRESS KR_INLINE int kr_strcmp_avx2(const char *lhs, const char *rhs)
+{
+    size_t i = 0, end = 0;
+    uint32_t mask = 0;
+
+    for (;;)
+    {
+        if (!KR_STRPAGE_CROSSES_(lhs + i, 64) && !KR_STRPAGE_CROSSES_(rhs + i, 64))
+        {
+            if (kr_strcmp64_avx2_(lhs + i, rhs + i) == 0)
+            {
+                i += 64;
+                continue;
+            }
+
+            /* It's in one of these blocks. */
+            for (;; i += 32)
+            {
+                mask = kr_strcmp32_(lhs + i, rhs + i);
+                if (mask != 0)
+                {
+                    i += KR_CASTS(size_t, kr_ctz32(mask));
+                    return KR_CASTS(unsigned char, lhs[i]) - KR_CASTS(unsigned char, rhs[i]);
+                }
+            }
+        }
+        else if (KR_STRPAGE_CROSSES_(lhs + i, 32) || KR_STRPAGE_CROSSES_(rhs + i, 32))
+        {
+            /* Creep across the page boundary a byte at a time. */
+            for (end = i + 32; i < end; i++)
+            {
+                if (lhs[i] != rhs[i] || lhs[i] == '\0')
+                {
+                    return KR_CASTS(unsigned char, lhs[i]) - KR_CASTS(unsigned char, rhs[i]);
+                }
+            }
+            continue;
+        }
+
+        mask = kr_strcmp32_(lhs + i, rhs + i);
+        if (mask != 0)
+        {
+            i += KR_CASTS(size_t, kr_ctz32(mask));
+            return KR_CASTS(unsigned char, lhs[i]) - KR_CASTS(unsigned char, rhs[i]);
+        }
+        i += 32;
+    }
+}
+
+#endif /* (KR_AVX2) */
+
+/******************************************************************************/
+
+KR_CONSTEXPR int kr_strncmp(const char *lhs, const char *rhs, size_t len)
+{
+    if (!KR_IS_CONSTANT_EVALUATED())
+    {
+#if (KR_AVX2)
+        return kr_strncmp_avx2(lhs, rhs, len);
+#elif (KR_SSE2)
+        return kr_strncmp_sse2(lhs, rhs, len);
+#else
+        return kr_strncmp_swar(lhs, rhs, len);
+#endif
+    }
+
+    for (; len != 0; lhs++, rhs++, len--)
+    {
+        if (*lhs != *rhs || *lhs == '\0')
+        {
+            return KR_CASTS(unsigned char, *lhs) - KR_CASTS(unsigned char, *rhs);
+        }
+    }
+    return 0;
+}
+
+KR_NOSANITIZE_ADDRESS KR_INLINE int kr_strncmp_swar(const char *lhs, const char *rhs, size_t len)
+{
+    const kr_strword_t_ *l = NULL, *r = NULL;
+
+    if (KR_CASTR(uintptr_t, lhs) % sizeof(size_t) == KR_CASTR(uintptr_t, rhs) % sizeof(size_t))
+    {
+        for (; len != 0 && !KR_STRWORD_ALIGNED_(lhs); lhs++, rhs++, len--)
+        {
+            if (*lhs != *rhs || *lhs == '\0')
+            {
+                return KR_CASTS(unsigned char, *lhs) - KR_CASTS(unsigned char, *rhs);
+            }
+        }
+
+        l = KR_CASTR(const kr_strword_t_ *, lhs);
+        r = KR_CASTR(const kr_strword_t_ *, rhs);
+        while (len >= sizeof(size_t) && *l == *r && !KR_STRWORD_HASZERO_(*l))
+        {
+            l++;
+            r++;
+            len -= sizeof(size_t);
+        }
+        lhs = KR_CASTR(const char *, l);
+        rhs = KR_CASTR(const char *, r);
+    }
+
+    for (; len != 0; lhs++, rhs++, len--)
+    {
+        if (*lhs != *rhs || *lhs == '\0')
+        {
+            return KR_CASTS(unsigned char, *lhs) - KR_CASTS(unsigned char, *rhs);
+        }
+    }
+    return 0;
+}
+
+#if (KR_SSE2)
+
+KR_NOSANITIZE_ADDRESS KR_INLINE int kr_strncmp_sse2(const char *lhs, const char *rhs, size_t len)
+{
+    size_t i = 0, end = 0;
+    unsigned mask = 0;
+
+    /* len can be larger than either buffer, so check pages like strcmp. */
+    while (len - i >= 16)
+    {
+        if (len - i >= 64 && !KR_STRPAGE_CROSSES_(lhs + i, 64) && !KR_STRPAGE_CROSSES_(rhs + i, 64))
+        {
+            if (kr_strcmp64_sse2_(lhs + i, rhs + i) == 0)
+            {
+                i += 64;
+                continue;
+            }
+
+            /* It's in one of these blocks. */
+            for (;; i += 16)
+            {
+                mask = kr_strcmp16_(lhs + i, rhs + i);
+                if (mask != 0)
+                {
+                    i += KR_CASTS(size_t, kr_ctz32(mask));
+                    return KR_CASTS(unsigned char, lhs[i]) - KR_CASTS(unsigned char, rhs[i]);
+                }
+            }
+        }
+        else if (KR_STRPAGE_CROSSES_(lhs + i, 16) || KR_STRPAGE_CROSSES_(rhs + i, 16))
+        {
+            for (end = i + 16; i < end; i++)
+            {
+                if (lhs[i] != rhs[i] || lhs[i] == '\0')
+                {
+                    return KR_CASTS(unsigned char, lhs[i]) - KR_CASTS(unsigned char, rhs[i]);
+                }
+            }
+            continue;
+        }
+
+        mask = kr_strcmp16_(lhs + i, rhs + i);
+        if (mask != 0)
+        {
+            i += KR_CASTS(size_t, kr_ctz32(mask));
+            return KR_CASTS(unsigned char, lhs[i]) - KR_CASTS(unsigned char, rhs[i]);
+        }
+        i += 16;
+    }
+
+    for (; i < len; i++)
+    {
+        if (lhs[i] != rhs[i] || lhs[i] == '\0')
+        {
+            return KR_CASTS(unsigned char, lhs[i]) - KR_CASTS(unsigned char, rhs[i]);
+        }
+    }
+    return 0;
+}
+
+#endif /* (KR_SSE2) */
+
+#if (KR_AVX2)
+
+KR_NOSANITIZE_ADDRESS KR_INLINE int kr_strncmp_avx2(const char *lhs, const char *rhs, size_t len)
+{
+    size_t i = 0, end = 0;
+    uint32_t mask = 0;
+
+    /* len can be larger than either buffer, so check pages like strcmp. */
+    while (len - i >= 32)
+    {
+        if (len - i >= 64 && !KR_STRPAGE_CROSSES_(lhs + i, 64) && !KR_STRPAGE_CROSSES_(rhs + i, 64))
+        {
+            if (kr_strcmp64_avx2_(lhs + i, rhs + i) == 0)
+            {
+                i += 64;
+                continue;
+            }
+
+            /* It's in one of these blocks. */
+            for (;; i += 32)
+            {
+                mask = kr_strcmp32_(lhs + i, rhs + i);
+                if (mask != 0)
+                {
+                    i += KR_CASTS(size_t, kr_ctz32(mask));
+                    return KR_CASTS(unsigned char, lhs[i]) - KR_CASTS(unsigned char, rhs[i]);
+                }
+            }
+        }
+        else if (KR_STRPAGE_CROSSES_(lhs + i, 32) || KR_STRPAGE_CROSSES_(rhs + i, 32))
+        {
+            for (end = i + 32; i < end; i++)
+            {
+                if (lhs[i] != rhs[i] || lhs[i] == '\0')
+                {
+                    return KR_CASTS(unsigned char, lhs[i]) - KR_CASTS(unsigned char, rhs[i]);
+                }
+            }
+            continue;
+        }
+
+        mask = kr_strcmp32_(lhs + i, rhs + i);
+        if (mask != 0)
+        {
+            i += KR_CASTS(size_t, kr_ctz32(mask));
+            return KR_CASTS(unsigned char, lhs[i]) - KR_CASTS(unsigned char, rhs[i]);
+        }
+        i += 32;
+    }
+
+    return kr_strncmp_sse2(lhs + i, rhs + i, len - i);
+}
+
+#endif /* (KR_AVX2) */
+
+/******************************************************************************/
+
+KR_INLINE int kr_memcmp(const void *lhs, const void *rhs, size_t len)
+{
+    const unsigned char *l = KR_CASTS(const unsigned char *, lhs);
+    const unsigned char *r = KR_CASTS(const unsigned char *, rhs);
+    size_t i = 0;
+
+#if (KR_SSE2)
+    unsigned mask = 0;
+
+#if (KR_AVX2)
+    for (; len - i >= 64; i += 64)
+    {
+        const __m256i eq0 = _mm256_cmpeq_epi8(_mm256_loadu_si256(KR_CASTR(const __m256i *, l + i)),
+                                              _mm256_loadu_si256(KR_CASTR(const __m256i *, r + i)));
+        const __m256i eq1 = _mm256_cmpeq_epi8(_mm256_loadu_si256(KR_CASTR(const __m256i *, l + i + 32)),
+                                              _mm256_loadu_si256(KR_CASTR(const __m256i *, r + i + 32)));
+        if (_mm256_movemask_epi8(_mm256_and_si256(eq0, eq1)) != -1)
+        {
+            break; /* Narrowed down below. */
+        }
+    }
+    for (; len - i >= 32; i += 32)
+    {
+        const __m256i a = _mm256_loadu_si256(KR_CASTR(const __m256i *, l + i));
+        const __m256i b = _mm256_loadu_si256(KR_CASTR(const __m256i *, r + i));
+        const uint32_t diff = ~KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+        if (diff != 0)
+        {
+            i += KR_CASTS(size_t, kr_ctz32(diff));
+            return l[i] - r[i];
+        }
+    }
+#else
+    for (; len - i >= 64; i += 64)
+    {
+        const __m128i eq0 = _mm_cmpeq_epi8(_mm_loadu_si128(KR_CASTR(const __m128i *, l + i)),
+                                           _mm_loadu_si128(KR_CASTR(const __m128i *, r + i)));
+        const __m128i eq1 = _mm_cmpeq_epi8(_mm_loadu_si128(KR_CASTR(const __m128i *, l + i + 16)),
+                                           _mm_loadu_si128(KR_CASTR(const __m128i *, r + i + 16)));
+        const __m128i eq2 = _mm_cmpeq_epi8(_mm_loadu_si128(KR_CASTR(const __m128i *, l + i + 32)),
+                                           _mm_loadu_si128(KR_CASTR(const __m128i *, r + i + 32)));
+        const __m128i eq3 = _mm_cmpeq_epi8(_mm_loadu_si128(KR_CASTR(const __m128i *, l + i + 48)),
+                                           _mm_loadu_si128(KR_CASTR(const __m128i *, r + i + 48)));
+        if (_mm_movemask_epi8(_mm_and_si128(_mm_and_si128(eq0, eq1), _mm_and_si128(eq2, eq3))) != 0xFFFF)
+        {
+            break; /* Narrowed down below. */
+        }
+    }
+#endif
+    for (; len - i >= 16; i += 16)
+    {
+        const __m128i a = _mm_loadu_si128(KR_CASTR(const __m128i *, l + i));
+        const __m128i b = _mm_loadu_si128(KR_CASTR(const __m128i *, r + i));
+        mask = KR_CASTS(unsigned, _mm_movemask_epi8(_mm_cmpeq_epi8(a, b))) ^ 0xFFFF;
+        if (mask != 0)
+        {
+            i += KR_CASTS(size_t, kr_ctz32(mask));
+            return l[i] - r[i];
+        }
+    }
+#else
+    if (KR_CASTR(uintptr_t, l) % sizeof(size_t) == KR_CASTR(uintptr_t, r) % sizeof(size_t))
+    {
+        for (; i < len && !KR_STRWORD_ALIGNED_(l + i); i++)
+        {
+            if (l[i] != r[i])
+            {
+                return l[i] - r[i];
+            }
+        }
+        for (; len - i >= sizeof(size_t); i += sizeof(size_t))
+        {
+            if (*KR_CASTR(const kr_strword_t_ *, l + i) != *KR_CASTR(const kr_strword_t_ *, r + i))
+            {
+                break;
+            }
+        }
+    }
+#endif
+
+    for (; i < len; i++)
+    {
+        if (l[i] != r[i])
+        {
+            return l[i] - r[i];
+        }
+    }
+    return 0;
+}
+
+/******************************************************************************/
+
+#define KR_STRFOLD_(ch) KR_CASTS(unsigned char, kr_tolower(ch))
+
+#if (KR_SSE2)
+
+/*
+ * Flip the case bit of every byte between lo and hi inclusive.  Shifting lo
+ * down to -128 turns the range check into a single signed compare.
+ */
+KR_INLINE __m128i kr_strfold16_(__m128i v, char lo, char hi)
+{
+    const __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(KR_CASTS(char, lo + 0x80)));
+    const __m128i in = _mm_cmpgt_epi8(_mm_set1_epi8(KR_CASTS(char, hi - lo - 0x7F)), shifted);
+    return _mm_xor_si128(v, _mm_and_si128(in, _mm_set1_epi8(0x20)));
+}
+
+/* Zero where folded bytes differ or lhs has its terminator. */
+KR_NOSANITIZE_ADDRESS KR_INLINE __m128i kr_strcasesame16_(const char *lhs, const char *rhs)
+{
+    const __m128i l = kr_strfold16_(_mm_loadu_si128(KR_CASTR(const __m128i *, kr_stropaque_(lhs))), 'A', 'Z');
+    const __m128i r = kr_strfold16_(_mm_loadu_si128(KR_CASTR(const __m128i *, kr_stropaque_(rhs))), 'A', 'Z');
+    return _mm_min_epu8(l, _mm_cmpeq_epi8(l, r));
+}
+
+/* Mask of folded bytes that differ or are the terminator of lhs. */
+KR_NOSANITIZE_ADDRESS KR_INLINE unsigned kr_strcasecmp16_(const char *lhs, const char *rhs)
+{
+    const __m128i same = kr_strcasesame16_(lhs, rhs);
+    return KR_CASTS(unsigned, _mm_movemask_epi8(_mm_cmpeq_epi8(same, _mm_setzero_si128())));
+}
+
+/* Non-zero if any of the next 64 folded bytes differ or terminate lhs. */
+KR_NOSANITIZE_ADDRESS KR_INLINE unsigned kr_strcasecmp64_sse2_(const char *lhs, const char *rhs)
+{
+    const __m128i a = _mm_min_epu8(kr_strcasesame16_(lhs, rhs), kr_strcasesame16_(lhs + 16, rhs + 16));
+    const __m128i b = _mm_min_epu8(kr_strcasesame16_(lhs + 32, rhs + 32), kr_strcasesame16_(lhs + 48, rhs + 48));
+    return KR_CASTS(unsigned, _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(a, b), _mm_setzero_si128())));
+}
+
+#endif /* (KR_SSE2) */
+
+#if (KR_AVX2)
+
+KR_INLINE __m256i kr_strfold32_(__m256i v, char lo, char hi)
+{
+    const __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8(KR_CASTS(char, lo + 0x80)));
+    const __m256i in = _mm256_cmpgt_epi8(_mm256_set1_epi8(KR_CASTS(char, hi - lo - 0x7F)), shifted);
+    return _mm256_xor_si256(v, _mm256_and_si256(in, _mm256_set1_epi8(0x20)));
+}
+
+KR_NOSANITIZE_ADDRESS KR_INLINE __m256i kr_strcasesame32_(const char *lhs, const char *rhs)
+{
+    const __m256i l = kr_strfold32_(_mm256_loadu_si256(KR_CASTR(const __m256i *, kr_stropaque_(lhs))), 'A', 'Z');
+    const __m256i r = kr_strfold32_(_mm256_loadu_si256(KR_CASTR(const __m256i *, kr_stropaque_(rhs))), 'A', 'Z');
+    return _mm256_min_epu8(l, _mm256_cmpeq_epi8(l, r));
+}
+
+KR_NOSANITIZE_ADDRESS KR_INLINE uint32_t kr_strcasecmp32_(const char *lhs, const char *rhs)
+{
+    const __m256i same = kr_strcasesame32_(lhs, rhs);
+    return KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(same, _mm256_setzero_si256())));
+}
+
+KR_NOSANITIZE_ADDRESS KR_INLINE uint32_t kr_strcasecmp64_avx2_(const char *lhs, const char *rhs)
+{
+    const __m256i same = _mm256_min_epu8(kr_strcasesame32_(lhs, rhs), kr_strcasesame32_(lhs + 32, rhs + 32));
+    return KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(same, _mm256_setzero_si256())));
+}
+
+#endif /* (KR_AVX2) */
+
+/*
+ * Bounded case-insensitive compare shared by kr_strcasecmp and
+ * kr_strncasecmp, len can be larger than either string.
+ */
+KR_NOSANITIZE_ADDRESS KR_INLINE int kr_strncasecmp_(const char *lhs, const char *rhs, size_t len)
+{
+    size_t i = 0;
+
+#if (KR_SSE2)
+#if (KR_AVX2)
+#define KR_STRCASE_WIDTH_ 32
+    uint32_t mask = 0;
+#else
+#define KR_STRCASE_WIDTH_ 16
+    unsigned mask = 0;
+#endif
+
+    while (i < len)
+    {
+        if (len - i >= 64 && !KR_STRPAGE_CROSSES_(lhs + i, 64) && !KR_STRPAGE_CROSSES_(rhs + i, 64))
+        {
+#if (KR_AVX2)
+            if (kr_strcasecmp64_avx2_(lhs + i, rhs + i) == 0)
+#else
+            if (kr_strcasecmp64_sse2_(lhs + i, rhs + i) == 0)
+#endif
+            {
+                i += 64;
+                continue;
+            }
+
+            /* It's in one of these blocks. */
+            for (;; i += KR_STRCASE_WIDTH_)
+            {
+#if (KR_AVX2)
+                mask = kr_strcasecmp32_(lhs + i, rhs + i);
+#else
+                mask = kr_strcasecmp16_(lhs + i, rhs + i);
+#endif
+                if (mask != 0)
+                {
+                    i += KR_CASTS(size_t, kr_ctz32(mask));
+                    return KR_STRFOLD_(lhs[i]) - KR_STRFOLD_(rhs[i]);
+                }
+            }
+        }
+
+        if (len - i >= KR_STRCASE_WIDTH_ && !KR_STRPAGE_CROSSES_(lhs + i, KR_STRCASE_WIDTH_) &&
+            !KR_STRPAGE_CROSSES_(rhs + i, KR_STRCASE_WIDTH_))
+        {
+#if (KR_AVX2)
+            mask = kr_strcasecmp32_(lhs + i, rhs + i);
+#else
+            mask = kr_strcasecmp16_(lhs + i, rhs + i);
+#endif
+            if (mask != 0)
+            {
+                i += KR_CASTS(size_t, kr_ctz32(mask));
+                return KR_STRFOLD_(lhs[i]) - KR_STRFOLD_(rhs[i]);
+            }
+            i += KR_STRCASE_WIDTH_;
+            continue;
+        }
+
+        /* Near a page boundary or the end, one byte at a time. */
+        if (KR_STRFOLD_(lhs[i]) != KR_STRFOLD_(rhs[i]) || lhs[i] == '\0')
+        {
+            return KR_STRFOLD_(lhs[i]) - KR_STRFOLD_(rhs[i]);
+        }
+        i++;
+    }
+    return 0;
+
+#undef KR_STRCASE_WIDTH_
+#else
+    const kr_strword_t_ *l = NULL, *r = NULL;
+
+    if (KR_CASTR(uintptr_t, lhs) % sizeof(size_t) == KR_CASTR(uintptr_t, rhs) % sizeof(size_t))
+    {
+        for (; i < len && !KR_STRWORD_ALIGNED_(lhs + i); i++)
+        {
+            if (KR_STRFOLD_(lhs[i]) != KR_STRFOLD_(rhs[i]) || lhs[i] == '\0')
+            {
+                return KR_STRFOLD_(lhs[i]) - KR_STRFOLD_(rhs[i]);
+            }
+        }
+
+        l = KR_CASTR(const kr_strword_t_ *, lhs + i);
+        r = KR_CASTR(const kr_strword_t_ *, rhs + i);
+        for (; len - i >= sizeof(size_t); i += sizeof(size_t), l++, r++)
+        {
+            if (KR_STRWORD_HASZERO_(*l) || KR_STRWORD_LOWER_(*l) != KR_STRWORD_LOWER_(*r))
+            {
+                break;
+            }
+        }
+    }
+
+    for (; i < len; i++)
+    {
+        if (KR_STRFOLD_(lhs[i]) != KR_STRFOLD_(rhs[i]) || lhs[i] == '\0')
+        {
+            return KR_STRFOLD_(lhs[i]) - KR_STRFOLD_(rhs[i]);
+        }
+    }
+    return 0;
+#endif
+}
+
+KR_CONSTEXPR int kr_strcasecmp(const char *lhs, const char *rhs)
+{
+    if (!KR_IS_CONSTANT_EVALUATED())
+    {
+        return kr_strncasecmp_(lhs, rhs, KR_CASTS(size_t, -1));
+    }
+
+    for (;; lhs++, rhs++)
+    {
+        if (kr_tolower(*lhs) != kr_tolower(*rhs) || *lhs == '\0')
+        {
+            break;
+        }
+    }
+    return KR_CASTS(unsigned char, kr_tolower(*lhs)) - KR_CASTS(unsigned char, kr_tolower(*rhs));
+}
+
+KR_CONSTEXPR int kr_strncasecmp(const char *lhs, const char *rhs, size_t len)
+{
+    if (!KR_IS_CONSTANT_EVALUATED())
+    {
+        return kr_strncasecmp_(lhs, rhs, len);
+    }
+
+    for (; len != 0; lhs++, rhs++, len--)
+    {
+        if (kr_tolower(*lhs) != kr_tolower(*rhs) || *lhs == '\0')
+        {
+            return KR_CASTS(unsigned char, kr_tolower(*lhs)) - KR_CASTS(unsigned char, kr_tolower(*rhs));
+        }
+    }
+    return 0;
+}
+
+KR_INLINE int kr_memcasecmp(const void *lhs, const void *rhs, size_t len)
+{
+    const char *l = KR_CASTS(const char *, lhs);
+    const char *r = KR_CASTS(const char *, rhs);
+    size_t i = 0;
+
+#if (KR_AVX2)
+    for (; len - i >= 32; i += 32)
+    {
+        const __m256i a = kr_strfold32_(_mm256_loadu_si256(KR_CASTR(const __m256i *, l + i)), 'A', 'Z');
+        const __m256i b = kr_strfold32_(_mm256_loadu_si256(KR_CASTR(const __m256i *, r + i)), 'A', 'Z');
+        const uint32_t diff = ~KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+        if (diff != 0)
+        {
+            i += KR_CASTS(size_t, kr_ctz32(diff));
+            return KR_STRFOLD_(l[i]) - KR_STRFOLD_(r[i]);
+        }
+    }
+#elif (KR_SSE2)
+    for (; len - i >= 16; i += 16)
+    {
+        const __m128i a = kr_strfold16_(_mm_loadu_si128(KR_CASTR(const __m128i *, l + i)), 'A', 'Z');
+        const __m128i b = kr_strfold16_(_mm_loadu_si128(KR_CASTR(const __m128i *, r + i)), 'A', 'Z');
+        const unsigned diff = KR_CASTS(unsigned, _mm_movemask_epi8(_mm_cmpeq_epi8(a, b))) ^ 0xFFFF;
+        if (diff != 0)
+        {
+            i += KR_CASTS(size_t, kr_ctz32(diff));
+            return KR_STRFOLD_(l[i]) - KR_STRFOLD_(r[i]);
+        }
+    }
+#else
+    if (KR_CASTR(uintptr_t, l) % sizeof(size_t) == KR_CASTR(uintptr_t, r) % sizeof(size_t))
+    {
+        for (; i < len && !KR_STRWORD_ALIGNED_(l + i); i++)
+        {
+            if (KR_STRFOLD_(l[i]) != KR_STRFOLD_(r[i]))
+            {
+                return KR_STRFOLD_(l[i]) - KR_STRFOLD_(r[i]);
+            }
+        }
+        for (; len - i >= sizeof(size_t); i += sizeof(size_t))
+        {
+            const size_t a = *KR_CASTR(const kr_strword_t_ *, l + i);
+            const size_t b = *KR_CASTR(const kr_strword_t_ *, r + i);
+            if (KR_STRWORD_LOWER_(a) != KR_STRWORD_LOWER_(b))
+            {
+                break;
+            }
+        }
+    }
+#endif
+
+    for (; i < len; i++)
+    {
+        if (KR_STRFOLD_(l[i]) != KR_STRFOLD_(r[i]))
+        {
+            return KR_STRFOLD_(l[i]) - KR_STRFOLD_(r[i]);
+        }
+    }
+    return 0;
+}
+
+/* Flip the case of every character in range in place. */
+KR_NOSANITIZE_ADDRESS KR_INLINE char *kr_strfold_(char *str, char lo, char hi)
+{
+    char *s = str;
+
+#if (KR_SSE2)
+#if (KR_AVX2)
+    __m256i v;
+#define KR_STRCASE_WIDTH_ 32
+#else
+    __m128i v;
+#define KR_STRCASE_WIDTH_ 16
+#endif
+
+    for (;;)
+    {
+        if (!KR_STRPAGE_CROSSES_(s, KR_STRCASE_WIDTH_))
+        {
+#if (KR_AVX2)
+            v = _mm256_loadu_si256(KR_CASTR(const __m256i *, s));
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_setzero_si256())) != 0)
+            {
+                break;
+            }
+            _mm256_storeu_si256(KR_CASTR(__m256i *, s), kr_strfold32_(v, lo, hi));
+#else
+            v = _mm_loadu_si128(KR_CASTR(const __m128i *, s));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) != 0)
+            {
+                break;
+            }
+            _mm_storeu_si128(KR_CASTR(__m128i *, s), kr_strfold16_(v, lo, hi));
+#endif
+            s += KR_STRCASE_WIDTH_;
+            continue;
+        }
+
+        /* Near a page boundary, one byte at a time. */
+        if (*s == '\0')
+        {
+            return str;
+        }
+        if (*s >= lo && *s <= hi)
+        {
+            *s = KR_CASTS(char, *s ^ 0x20);
+        }
+        s++;
+    }
+
+#undef KR_STRCASE_WIDTH_
+#else
+    kr_strword_t_ *w = NULL;
+
+    for (; *s != '\0' && !KR_STRWORD_ALIGNED_(s); s++)
+    {
+        if (*s >= lo && *s <= hi)
+        {
+            *s = KR_CASTS(char, *s ^ 0x20);
+        }
+    }
+    if (*s != '\0')
+    {
+        for (w = KR_CASTR(kr_strword_t_ *, s); !KR_STRWORD_HASZERO_(*w); w++)
+        {
+            *w ^= KR_STRWORD_RANGE_(*w, KR_CASTS(size_t, lo), KR_CASTS(size_t, hi)) >> 2;
+        }
+        s = KR_CASTR(char *, w);
+    }
+#endif
+
+    /* Block with the terminator in it. */
+    for (; *s != '\0'; s++)
+    {
+        if (*s >= lo && *s <= hi)
+        {
+            *s = KR_CASTS(char, *s ^ 0x20);
+        }
+    }
+    return str;
+}
+
+KR_INLINE char *kr_strlower(char *str)
+{
+    return kr_strfold_(str, 'A', 'Z');
+}
+
+KR_INLINE char *kr_strupper(char *str)
+{
+    return kr_strfold_(str, 'a', 'z');
+}
+
+#undef KR_STRFOLD_
+
+#undef KR_STRPAGE_SIZE_
+#undef KR_STRPAGE_CROSSES_
+
+/******************************************************************************/
+
+KR_CONSTEXPR ptrdiff_t kr_strscpy(char *KR_RESTRICT dest, const char *KR_RESTRICT src, size_t destLen)
+{
+    size_t i = 0;
+
+    if (destLen == 0)
+    {
+        return 0;
+    }
+
+    if (!KR_IS_CONSTANT_EVALUATED())
+    {
+        /* Find the terminator first so the copy itself is one block move. */
+        src = kr_stropaque_(src);
+        i = kr_strnlen(src, destLen);
+        if (i < destLen)
+        {
+            memcpy(dest, src, i + 1);
+            return KR_CASTS(ptrdiff_t, i);
+        }
+
+        memcpy(dest, src, destLen - 1);
+        dest[destLen - 1] = '\0';
+        return -1;
+    }
+
+    for (; i < destLen; i++)
+    {
+        dest[i] = src[i];
+        if (src[i] == '\0')
+        {
+            return KR_CASTS(ptrdiff_t, i);
+        }
+    }
+
+    dest[i - 1] = '\0';
+    return -1;
+}
+
+KR_CONSTEXPR ptrdiff_t kr_strscat(char *KR_RESTRICT dest, const char *KR_RESTRICT src, size_t destLen)
+{
+    ptrdiff_t len = 0;
+
+    size_t tail = kr_strnlen(dest, destLen);
+    if (tail == destLen)
+    {
+        return -1;
+    }
+
+    len = kr_strscpy(dest + tail, src, destLen - tail);
+    if (len < 0)
+    {
+        return -1;
+    }
+
+    return KR_CASTS(ptrdiff_t, tail) + len;
+}
+
+/******************************************************************************/
+
+KR_CONSTEXPR size_t kr_strlcpy(char *KR_RESTRICT dest, const char *KR_RESTRICT src, size_t destLen)
+{
+    size_t i = 0;
+
+    if (destLen == 0)
+    {
+        return 0;
+    }
+
+    if (!KR_IS_CONSTANT_EVALUATED())
+    {
+        src = kr_stropaque_(src);
+        i = kr_strnlen(src, destLen);
+        if (i < destLen)
+        {
+            memcpy(dest, src, i + 1);
+            return i;
+        }
+
+        memcpy(dest, src, destLen - 1);
+        dest[destLen - 1] = '\0';
+        return destLen + kr_strlen(src + destLen);
+    }
+
+    for (; i < destLen; i++)
+    {
+        dest[i] = src[i];
+        if (src[i] == '\0')
+        {
+            return i;
+        }
+    }
+
+    dest[i - 1] = '\0';
+    for (;; i++)
+    {
+        if (src[i] == '\0')
+        {
+            return i;
+        }
+    }
+}
+
+KR_CONSTEXPR size_t kr_strlcat(char *KR_RESTRICT dest, const char *KR_RESTRICT src, size_t destLen)
+{
+    size_t tail = kr_strnlen(dest, destLen);
+    if (tail == destLen)
+    {
+        return destLen;
+    }
+
+    return kr_strlcpy(dest + tail, src, destLen - tail) + tail;
+}
+
+/******************************************************************************/
+
+KR_CONSTEXPR char *kr_stpecpy(char *dest, char *destEnd, const char *KR_RESTRICT src)
+{
+    ptrdiff_t len = 0;
+
+    if (dest == NULL)
+    {
+        return NULL;
+    }
+
+    len = kr_strscpy(dest, src, KR_CASTS(size_t, destEnd - dest));
+    if (len == -1)
+    {
+        return NULL;
+    }
+
+    return dest + len;
+}
+
+/******************************************************************************/
+
+KR_CONSTEXPR size_t kr_strspn(const char *str, const char *chars)
+{
+    const char *s = str;
+    const char *ch = NULL;
+
+    for (; *s != '\0'; s++)
+    {
+        bool found = false;
+        for (ch = chars; *ch != '\0'; ch++)
+        {
+            if (*s == *ch)
+            {
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+        {
+            return KR_CASTS(size_t, s - str);
+        }
+    }
+
+    return KR_CASTS(size_t, s - str);
+}
+
+KR_CONSTEXPR size_t kr_strcspn(const char *str, const char *chars)
+{
+    const char *s = str;
+    const char *ch = NULL;
+
+    for (; *s != '\0'; s++)
+    {
+        bool found = false;
+        for (ch = chars; *ch != '\0'; ch++)
+        {
+            if (*s == *ch)
+            {
+                found = true;
+                break;
+            }
+        }
+        if (found)
+        {
+            return KR_CASTS(size_t, s - str);
+        }
+    }
+
+    return KR_CASTS(size_t, s - str);
+}
+
+/******************************************************************************/
+
+KR_INLINE void kr_charset_init(struct kr_charset_s *set, const char *chars)
+{
+    memset(set, 0, sizeof(*set));
+    for (; *chars != '\0'; chars++)
+    {
+        kr_charset_add(set, *chars);
+    }
+}
+
+KR_INLINE void kr_charset_add(struct kr_charset_s *set, char ch)
+{
+    const unsigned char uch = KR_CASTS(unsigned char, ch);
+    const unsigned lo = uch & 0x0Fu;
+    const unsigned hi = uch >> 4u;
+
+    set->bitmap[uch >> 3u] |= KR_CASTS(unsigned char, 1u << (uch & 7u));
+    if (hi < 8)
+    {
+        set->nibbleLo[lo] |= KR_CASTS(unsigned char, 1u << hi);
+    }
+    else
+    {
+        set->nibbleHi[lo] |= KR_CASTS(unsigned char, 1u << (hi - 8));
+    }
+}
+
+KR_INLINE bool kr_charset_has(const struct kr_charset_s *set, char ch)
+{
+    const unsigned char uch = KR_CASTS(unsigned char, ch);
+    return (set->bitmap[uch >> 3u] & (1u << (uch & 7u))) != 0;
+}
+
+#if (KR_SSSE3)
+
+/* Mask of bytes in v that are in the set with the passed nibble tables. */
+KR_INLINE unsigned kr_charset_in16_(__m128i nibbleLo, __m128i nibbleHi, __m128i v)
+{
+    const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m128i lo = _mm_and_si128(v, _mm_set1_epi8(0x0F));
+    const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+    const __m128i useHi = _mm_cmpgt_epi8(hi, _mm_set1_epi8(7));
+    const __m128i row = _mm_or_si128(_mm_andnot_si128(useHi, _mm_shuffle_epi8(nibbleLo, lo)),
+                                     _mm_and_si128(useHi, _mm_shuffle_epi8(nibbleHi, lo)));
+    const __m128i bit = _mm_shuffle_epi8(bits, hi);
+    return KR_CASTS(unsigned, _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(row, bit), bit)));
+}
+
+#endif /* (KR_SSSE3) */
+
+#if (KR_AVX2)
+
+/* Mask of bytes in v that are in the set with the passed nibble tables. */
+KR_INLINE uint32_t kr_charset_in32_(__m256i nibbleLo, __m256i nibbleHi, __m256i v)
+{
+    const __m256i bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8,
+                                          16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m256i lo = _mm256_and_si256(v, _mm256_set1_epi8(0x0F));
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+    const __m256i useHi = _mm256_cmpgt_epi8(hi, _mm256_set1_epi8(7));
+    const __m256i row = _mm256_blendv_epi8(_mm256_shuffle_epi8(nibbleLo, lo), _mm256_shuffle_epi8(nibbleHi, lo), useHi);
+    const __m256i bit = _mm256_shuffle_epi8(bits, hi);
+    return KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit)));
+}
+
+#endif /* (KR_AVX2) */
+
+KR_INLINE size_t kr_strspn_set(const char *str, const struct kr_charset_s *set)
+{
+#if (KR_AVX2)
+    return kr_strspn_set_avx2(str, set);
+#elif (KR_SSSE3)
+    return kr_strspn_set_ssse3(str, set);
+#else
+    const char *s = str;
+
+    while (*s != '\0' && kr_charset_has(set, *s))
+    {
+        s++;
+    }
+    return KR_CASTS(size_t, s - str);
+#endif
+}
+
+KR_INLINE size_t kr_strcspn_set(const char *str, const struct kr_charset_s *set)
+{
+#if (KR_AVX2)
+    return kr_strcspn_set_avx2(str, set);
+#elif (KR_SSSE3)
+    return kr_strcspn_set_ssse3(str, set);
+#else
+    const char *s = str;
+
+    while (*s != '\0' && !kr_charset_has(set, *s))
+    {
+        s++;
+    }
+    return KR_CASTS(size_t, s - str);
+#endif
+}
+
+#if (KR_SSSE3)
+
+KR_NOSANITIZE_ADDRESS KR_INLINE size_t kr_strspn_set_ssse3(const char *str, const struct kr_charset_s *set)
+{
+    const __m128i nibbleLo = _mm_loadu_si128(KR_CASTR(const __m128i *, set->nibbleLo));
+    const __m128i nibbleHi = _mm_loadu_si128(KR_CASTR(const __m128i *, set->nibbleHi));
+    const size_t skip = KR_CASTR(uintptr_t, str) % 16;
+    const char *s = str - skip;
+    __m128i v;
+    unsigned mask = 0;
+
+    /* The span stops at the first byte not in the set, or the terminator. */
+    v = _mm_load_si128(KR_CASTR(const __m128i *, s));
+    mask = ~kr_charset_in16_(nibbleLo, nibbleHi, v) | kr_strzero16_(s);
+    mask = (mask & 0xFFFFu) >> skip;
+    if (mask != 0)
+    {
+        return KR_CASTS(size_t, kr_ctz32(mask));
+    }
+
+    for (;;)
+    {
+        s += 16;
+        v = _mm_load_si128(KR_CASTR(const __m128i *, s));
+        mask = (~kr_charset_in16_(nibbleLo, nibbleHi, v) | kr_strzero16_(s)) & 0xFFFFu;
+        if (mask != 0)
+        {
+            return KR_CASTS(size_t, s - str) + KR_CASTS(size_t, kr_ctz32(mask));
+        }
+    }
+}
+
+KR_NOSANITIZE_ADDRESS KR_INLINE size_t kr_strcspn_set_ssse3(const char *str, const struct kr_charset_s *set)
+{
+    const __m128i nibbleLo = _mm_loadu_si128(KR_CASTR(const __m128i *, set->nibbleLo));
+    const __m128i nibbleHi = _mm_loadu_si128(KR_CASTR(const __m128i *, set->nibbleHi));
+    const size_t skip = KR_CASTR(uintptr_t, str) % 16;
+    const char *s = str - skip;
+    __m128i v;
+    unsigned mask = 0;
+
+    /* The span stops at the first byte in the set, or the terminator. */
+    v = _mm_load_si128(KR_CASTR(const __m128i *, s));
+    mask = kr_charset_in16_(nibbleLo, nibbleHi, v) | kr_strzero16_(s);
+    mask >>= skip;
+    if (mask != 0)
+    {
+        return KR_CASTS(size_t, kr_ctz32(mask));
+    }
+
+    for (;;)
+    {
+        s += 16;
+        v = _mm_load_si128(KR_CASTR(const __m128i *, s));
+        mask = kr_charset_in16_(nibbleLo, nibbleHi, v) | kr_strzero16_(s);
+        if (mask != 0)
+        {
+            return KR_CASTS(size_t, s - str) + KR_CASTS(size_t, kr_ctz32(mask));
+        }
+    }
+}
+
+#endif /* (KR_SSSE3) */
+
+#if (KR_AVX2)
+
+KR_NOSANITIZE_ADDRESS KR_INLINE size_t kr_strspn_set_avx2(const char *str, const struct kr_charset_s *set)
+{
+    const __m256i nibbleLo = _mm256_broadcastsi128_si256(_mm_loadu_si128(KR_CASTR(const __m128i *, set->nibbleLo)));
+    const __m256i nibbleHi = _mm256_broadcastsi128_si256(_mm_loadu_si128(KR_CASTR(const __m128i *, set->nibbleHi)));
+    const size_t skip = KR_CASTR(uintptr_t, str) % 32;
+    const char *s = str - skip;
+    __m256i v;
+    uint32_t mask = 0;
+
+    /* The span stops at the first byte not in the set, or the terminator. */
+    v = _mm256_load_si256(KR_CASTR(const __m256i *, s));
+    mask = ~kr_charset_in32_(nibbleLo, nibbleHi, v) | kr_strzero32_(s);
+    mask >>= skip;
+    if (mask != 0)
+    {
+        return KR_CASTS(size_t, kr_ctz32(mask));
+    }
+
+    for (;;)
+    {
+        s += 32;
+        v = _mm256_load_si256(KR_CASTR(const __m256i *, s));
+        mask = ~kr_charset_in32_(nibbleLo, nibbleHi, v) | kr_strzero32_(s);
+        if (mask != 0)
+        {
+            return KR_CASTS(size_t, s - str) + KR_CASTS(size_t, kr_ctz32(mask));
+        }
+    }
+}
+
+KR_NOSANITIZE_ADDRESS KR_INLINE size_t kr_strcspn_set_avx2(const char *str, const struct kr_charset_s *set)
+{
+    const __m256i nibbleLo = _mm256_broadcastsi128_si256(_mm_loadu_si128(KR_CASTR(const __m128i *, set->nibbleLo)));
+    const __m256i nibbleHi = _mm256_broadcastsi128_si256(_mm_loadu_si128(KR_CASTR(const __m128i *, set->nibbleHi)));
+    const size_t skip = KR_CASTR(uintptr_t, str) % 32;
+    const char *s = str - skip;
+    __m256i v;
+    uint32_t mask = 0;
+
+    /* The span stops at the first byte in the set, or the terminator. */
+    v = _mm256_load_si256(KR_CASTR(const __m256i *, s));
+    mask = kr_charset_in32_(nibbleLo, nibbleHi, v) | kr_strzero32_(s);
+    mask >>= skip;
+    if (mask != 0)
+    {
+        return KR_CASTS(size_t, kr_ctz32(mask));
+    }
+
+    for (;;)
+    {
+        s += 32;
+        v = _mm256_load_si256(KR_CASTR(const __m256i *, s));
+        mask = kr_charset_in32_(nibbleLo, nibbleHi, v) | kr_strzero32_(s);
+        if (mask != 0)
+        {
+            return KR_CASTS(size_t, s - str) + KR_CASTS(size_t, kr_ctz32(mask));
+        }
+    }
+}
+
+#endif /* (KR_AVX2) */
+
+/******************************************************************************/
+
+/*
+ * Handle a position where the stream goes from delimiter to token or vice
+ * versa.  Returns false if a token ended but there was no room for it.
+ */
+KR_INLINE bool kr_tokenizer_edge_(struct kr_tokenizer_s *tok, size_t pos, struct kr_token_s *toks, size_t toksLen,
+                                  size_t *count)
+{
+    if (!tok->inToken)
+    {
+        tok->tokStart = pos;
+        tok->inToken = true;
+        return true;
+    }
+
+    if (*count == toksLen)
+    {
+        return false;
+    }
+
+    toks[*count].offset = tok->tokStart;
+    toks[*count].length = pos - tok->tokStart;
+    *count += 1;
+    tok->inToken = false;
+    return true;
+}
+
+KR_INLINE void kr_tokenizer_init(struct kr_tokenizer_s *tok, const struct kr_charset_s *delims)
+{
+    tok->delims = delims;
+    tok->pos = 0;
+    tok->tokStart = 0;
+    tok->inToken = false;
+}
+
+KR_INLINE size_t kr_tokenizer_feed(struct kr_tokenizer_s *tok, const char *chunk, size_t len, struct kr_token_s *toks,
+                                   size_t toksLen, size_t *consumed)
+{
+    size_t i = 0, count = 0;
+
+#if (KR_AVX2)
+    const __m256i nibbleLo =
+        _mm256_broadcastsi128_si256(_mm_loadu_si128(KR_CASTR(const __m128i *, tok->delims->nibbleLo)));
+    const __m256i nibbleHi =
+        _mm256_broadcastsi128_si256(_mm_loadu_si128(KR_CASTR(const __m128i *, tok->delims->nibbleHi)));
+
+    for (; len - i >= 32; i += 32)
+    {
+        const __m256i v = _mm256_loadu_si256(KR_CASTR(const __m256i *, chunk + i));
+        const uint32_t delim = kr_charset_in32_(nibbleLo, nibbleHi, v);
+
+        /* Bits are set where a byte differs from the one before it. */
+        uint32_t edges = delim ^ ((delim << 1) | (tok->inToken ? 0u : 1u));
+        for (; edges != 0; edges &= edges - 1)
+        {
+            const size_t bit = KR_CASTS(size_t, kr_ctz32(edges));
+            if (!kr_tokenizer_edge_(tok, tok->pos + i + bit, toks, toksLen, &count))
+            {
+                tok->pos += i + bit;
+                *consumed = i + bit;
+                return count;
+            }
+        }
+    }
+#elif (KR_SSSE3)
+    const __m128i nibbleLo = _mm_loadu_si128(KR_CASTR(const __m128i *, tok->delims->nibbleLo));
+    const __m128i nibbleHi = _mm_loadu_si128(KR_CASTR(const __m128i *, tok->delims->nibbleHi));
+
+    for (; len - i >= 16; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(KR_CASTR(const __m128i *, chunk + i));
+        const unsigned delim = kr_charset_in16_(nibbleLo, nibbleHi, v);
+
+        /* Bits are set where a byte differs from the one before it. */
+        unsigned edges = (delim ^ ((delim << 1) | (tok->inToken ? 0u : 1u))) & 0xFFFFu;
+        for (; edges != 0; edges &= edges - 1)
+        {
+            const size_t bit = KR_CASTS(size_t, kr_ctz32(edges));
+            if (!kr_tokenizer_edge_(tok, tok->pos + i + bit, toks, toksLen, &count))
+            {
+                tok->pos += i + bit;
+                *consumed = i + bit;
+                return count;
+            }
+        }
+    }
+#endif
+
+    for (; i < len; i++)
+    {
+        if (kr_charset_has(tok->delims, chunk[i]) == tok->inToken)
+        {
+            if (!kr_tokenizer_edge_(tok, tok->pos + i, toks, toksLen, &count))
+            {
+                break;
+            }
+        }
+    }
+
+    tok->pos += i;
+    *consumed = i;
+    return count;
+}
+
+KR_INLINE bool kr_tokenizer_finish(struct kr_tokenizer_s *tok, struct kr_token_s *out)
+{
+    if (!tok->inToken)
+    {
+        return false;
+    }
+
+    out->offset = tok->tokStart;
+    out->length = tok->pos - tok->tokStart;
+    tok->inToken = false;
+    return true;
+}
+
+KR_INLINE size_t kr_tokenize(const char *buf, size_t len, const struct kr_charset_s *delims, struct kr_token_s *toks,
+                             size_t toksLen)
+{
+    struct kr_tokenizer_s tok;
+    size_t count = 0, consumed = 0;
+
+    kr_tokenizer_init(&tok, delims);
+    count = kr_tokenizer_feed(&tok, buf, len, toks, toksLen, &consumed);
+    if (consumed == len && count < toksLen && kr_tokenizer_finish(&tok, &toks[count]))
+    {
+        count += 1;
+    }
+    return count;
+}
+
+/******************************************************************************/
+
+KR_CONSTEXPR char *kr_strtok_r(char *KR_RESTRICT str, const char *KR_RESTRICT delim, char **KR_RESTRICT ptr)
+{
+    char *tok = NULL;
+
+    if (str == NULL)
+    {
+        if (*ptr == NULL)
+        {
+            return NULL;
+        }
+
+        /* Resuming a previous tokenization. */
+        str = *ptr;
+    }
+
+    /* First, munch all delim chars. */
+    str += kr_strspn(str, delim);
+    if (*str == '\0')
+    {
+        /* Could not find another token. */
+        return NULL;
+    }
+
+    /* Munch a token. */
+    tok = str;
+    str += kr_strcspn(str, delim);
+    if (*str == '\0')
+    {
+        /* Found the last token. */
+        *ptr = NULL;
+        return tok;
+    }
+
+    /* Null the end and set our next starting point. */
+    *str = '\0';
+    *ptr = str + 1;
+    return tok;
+}
+
+/******************************************************************************/
+
+KR_INLINE void *kr_memchr(const void *ptr, int ch, size_t len)
+{
+    const unsigned char *p = KR_CASTS(const unsigned char *, ptr);
+    const unsigned char uch = KR_CASTS(unsigned char, ch);
+    size_t i = 0;
+
+#if (KR_AVX2)
+    const __m256i needle = _mm256_set1_epi8(KR_CASTS(char, uch));
+    uint32_t mask = 0;
+
+    /* Four blocks at a time, only working out which one matched at the end. */
+    for (; len - i >= 128; i += 128)
+    {
+        const __m256i a = _mm256_cmpeq_epi8(_mm256_loadu_si256(KR_CASTR(const __m256i *, p + i)), needle);
+        const __m256i b = _mm256_cmpeq_epi8(_mm256_loadu_si256(KR_CASTR(const __m256i *, p + i + 32)), needle);
+        const __m256i c = _mm256_cmpeq_epi8(_mm256_loadu_si256(KR_CASTR(const __m256i *, p + i + 64)), needle);
+        const __m256i d = _mm256_cmpeq_epi8(_mm256_loadu_si256(KR_CASTR(const __m256i *, p + i + 96)), needle);
+        if (_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d))) != 0)
+        {
+            break;
+        }
+    }
+    for (; len - i >= 32; i += 32)
+    {
+        const __m256i v = _mm256_loadu_si256(KR_CASTR(const __m256i *, p + i));
+        mask = KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle)));
+        if (mask != 0)
+        {
+            return KR_CASTC(unsigned char *, p + i + kr_ctz32(mask));
+        }
+    }
+    if (i != len && len >= 32)
+    {
+        /* Overlap the last block with bytes we've already checked. */
+        const __m256i v = _mm256_loadu_si256(KR_CASTR(const __m256i *, p + len - 32));
+        mask = KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle)));
+        mask >>= 32 - (len - i);
+        return mask != 0 ? KR_CASTC(unsigned char *, p + i + kr_ctz32(mask)) : NULL;
+    }
+    else if (len < 32 && len >= 16)
+    {
+        /* Too short for AVX2, but we can still cover it with two SSE2 loads. */
+        const __m128i half = _mm256_castsi256_si128(needle);
+        const __m128i lo = _mm_loadu_si128(KR_CASTR(const __m128i *, p));
+        const __m128i hi = _mm_loadu_si128(KR_CASTR(const __m128i *, p + len - 16));
+        mask = KR_CASTS(uint32_t, _mm_movemask_epi8(_mm_cmpeq_epi8(lo, half)));
+        mask |= KR_CASTS(uint32_t, _mm_movemask_epi8(_mm_cmpeq_epi8(hi, half))) << (len - 16);
+        return mask != 0 ? KR_CASTC(unsigned char *, p + kr_ctz32(mask)) : NULL;
+    }
+#elif (KR_SSE2)
+    const __m128i needle = _mm_set1_epi8(KR_CASTS(char, uch));
+    unsigned mask = 0;
+
+    /* Four blocks at a time, only working out which one matched at the end. */
+    for (; len - i >= 64; i += 64)
+    {
+        const __m128i a = _mm_cmpeq_epi8(_mm_loadu_si128(KR_CASTR(const __m128i *, p + i)), needle);
+        const __m128i b = _mm_cmpeq_epi8(_mm_loadu_si128(KR_CASTR(const __m128i *, p + i + 16)), needle);
+        const __m128i c = _mm_cmpeq_epi8(_mm_loadu_si128(KR_CASTR(const __m128i *, p + i + 32)), needle);
+        const __m128i d = _mm_cmpeq_epi8(_mm_loadu_si128(KR_CASTR(const __m128i *, p + i + 48)), needle);
+        if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))) != 0)
+        {
+            break;
+        }
+    }
+    for (; len - i >= 16; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(KR_CASTR(const __m128i *, p + i));
+        mask = KR_CASTS(unsigned, _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle)));
+        if (mask != 0)
+        {
+            return KR_CASTC(unsigned char *, p + i + kr_ctz32(mask));
+        }
+    }
+    if (i != len && len >= 16)
+    {
+        /* Overlap the last block with bytes we've already checked. */
+        const __m128i v = _mm_loadu_si128(KR_CASTR(const __m128i *, p + len - 16));
+        mask = KR_CASTS(unsigned, _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle)));
+        mask >>= 16 - (len - i);
+        return mask != 0 ? KR_CASTC(unsigned char *, p + i + kr_ctz32(mask)) : NULL;
+    }
+#else
+    const size_t pattern = KR_STRWORD_ONES_ * uch;
+
+    for (; i < len && !KR_STRWORD_ALIGNED_(p + i); i++)
+    {
+        if (p[i] == uch)
+        {
+            return KR_CASTC(unsigned char *, p + i);
+        }
+    }
+
+    /* XOR turns matching bytes into zero bytes. */
+    for (; len - i >= sizeof(size_t); i += sizeof(size_t))
+    {
+        const size_t w = *KR_CASTR(const kr_strword_t_ *, kr_stropaque_(KR_CASTR(const char *, p + i))) ^ pattern;
+        if (KR_STRWORD_HASZERO_(w))
+        {
+            break;
+        }
+    }
+#endif
+
+    for (; i < len; i++)
+    {
+        if (p[i] == uch)
+        {
+            return KR_CASTC(unsigned char *, p + i);
+        }
+    }
+    return NULL;
+}
+
+KR_INLINE void *kr_memrchr(const void *ptr, int ch, size_t len)
+{
+    const unsigned char *p = KR_CASTS(const unsigned char *, ptr);
+    const unsigned char uch = KR_CASTS(unsigned char, ch);
+    size_t i = len;
+
+#if (KR_AVX2)
+    const __m256i needle = _mm256_set1_epi8(KR_CASTS(char, uch));
+    uint32_t mask = 0;
+
+    for (; i >= 32; i -= 32)
+    {
+        const __m256i v = _mm256_loadu_si256(KR_CASTR(const __m256i *, p + i - 32));
+        mask = KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle)));
+        if (mask != 0)
+        {
+            return KR_CASTC(unsigned char *, p + i - 1 - kr_clz32(mask));
+        }
+    }
+    if (i != 0 && len >= 32)
+    {
+        /* Overlap the first block with bytes we've already checked. */
+        const __m256i v = _mm256_loadu_si256(KR_CASTR(const __m256i *, p));
+        mask = KR_CASTS(uint32_t, _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle)));
+        mask <<= 32 - i;
+        return mask != 0 ? KR_CASTC(unsigned char *, p + i - 1 - kr_clz32(mask)) : NULL;
+    }
+#elif (KR_SSE2)
+    const __m128i needle = _mm_set1_epi8(KR_CASTS(char, uch));
+    uint32_t mask = 0;
+
+    for (; i >= 16; i -= 16)
+    {
+        const __m128i v = _mm_loadu_si128(KR_CASTR(const __m128i *, p + i - 16));
+        mask = KR_CASTS(uint32_t, _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle))) << 16;
+        if (mask != 0)
+        {
+            return KR_CASTC(unsigned char *, p + i - 1 - kr_clz32(mask));
+        }
+    }
+    if (i != 0 && len >= 16)
+    {
+        /* Overlap the first block with bytes we've already checked. */
+        const __m128i v = _mm_loadu_si128(KR_CASTR(const __m128i *, p));
+        mask = KR_CASTS(uint32_t, _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle))) << 16;
+        mask <<= 16 - i;
+        return mask != 0 ? KR_CASTC(unsigned char *, p + i - 1 - kr_clz32(mask)) : NULL;
+    }
+#endif
+
+    for (; i != 0; i--)
+    {
+        if (p[i - 1] == uch)
+        {
+            return KR_CASTC(unsigned char *, p + i - 1);
+        }
+    }
+    return NULL;
+}
+
 /******************************************************************************/
 
-KR_CONSTEXPR int kr_strcmp(const char *lhs, const char *rhs)
+KR_INLINE size_t kr_twoway_maxsuffix_(const unsigned char *needle, size_t needleLen, size_t *period, bool reverse)
 {
-    for (;; lhs++, rhs++)
+    size_t maxSuffix = KR_CASTS(size_t, -1); /* Deliberately wraps. */
+    size_t j = 0, k = 1, p = 1;
+
+    while (j + k < needleLen)
     {
-        if (*lhs != *rhs || *lhs == '\0')
+        const unsigned char a = needle[j + k];
+        const unsigned char b = needle[maxSuffix + k];
+        if (reverse ? (b < a) : (a < b))
         {
-            break;
+            /* Suffix is smaller, period is the entire prefix so far. */
+            j += k;
+            k = 1;
+            p = j - maxSuffix;
+        }
+        else if (a == b)
+        {
+            /* Advance through repetition of the current period. */
+            if (k != p)
+            {
+                k++;
+            }
+            else
+            {
+                j += p;
+                k = 1;
+            }
+        }
+        else
+        {
+            /* Suffix is larger, start over from here. */
+            maxSuffix = j++;
+            k = p = 1;
         }
     }
-    return KR_CASTS(unsigned char, *lhs) - KR_CASTS(unsigned char, *rhs);
+
+    *period = p;
+    return maxSuffix + 1;
 }
 
-/******************************************************************************/
+KR_INLINE void kr_twoway_init_(struct kr_twoway_s *tw, const unsigned char *needle, size_t needleLen)
+{
+    size_t period = 0, periodRev = 0;
+    const size_t suffix = kr_twoway_maxsuffix_(needle, needleLen, &period, false);
+    const size_t suffixRev = kr_twoway_maxsuffix_(needle, needleLen, &periodRev, true);
 
-KR_CONSTEXPR ptrdiff_t kr_strscpy(char *KR_RESTRICT dest, const char *KR_RESTRICT src, size_t destLen)
+    /* The critical factorization is the later of the two maximal suffixes. */
+    if (suffix >= suffixRev)
+    {
+        tw->suffix = suffix;
+        tw->period = period;
+    }
+    else
+    {
+        tw->suffix = suffixRev;
+        tw->period = periodRev;
+    }
+
+    tw->periodic = memcmp(needle, needle + tw->period, tw->suffix) == 0;
+    if (!tw->periodic)
+    {
+        /* Any shift that big is safe when the left half doesn't repeat. */
+        const size_t left = tw->suffix, right = needleLen - tw->suffix;
+        tw->period = (left > right ? left : right) + 1;
+    }
+}
+
+/*
+ * Two-Way string matching, the search.  If a bad character table is passed,
+ * it's used to skip ahead before matching, which helps a lot with long
+ * needles since Two-Way on its own often only shifts by one byte.
+ */
+KR_INLINE const unsigned char *kr_twoway_find_(const struct kr_twoway_s *tw, const unsigned char *haystack,
+                                               size_t haystackLen, const unsigned char *needle, size_t needleLen,
+                                               const unsigned char *skip)
 {
-    size_t i = 0;
+    const size_t suffix = tw->suffix;
+    size_t i = 0, j = 0, memory = 0, shift = 0;
 
-    if (destLen == 0)
+    if (needleLen > haystackLen)
     {
-        return 0;
+        return NULL;
     }
 
-    i = 0;
-    for (; i < destLen; i++)
+    while (j <= haystackLen - needleLen)
     {
-        dest[i] = src[i];
-        if (src[i] == '\0')
+        shift = skip != NULL ? skip[haystack[j + needleLen - 1]] : 0;
+        if (shift != 0)
         {
-            return KR_CASTS(ptrdiff_t, i);
+            if (memory != 0 && shift < tw->period)
+            {
+                /* Last period matched except for the final byte, so no
+                   match can start before the mismatch. */
+                shift = needleLen - tw->period;
+            }
+            j += shift;
+            memory = 0;
+            continue;
+        }
+
+        /* Match the right half, skipping what we remember matching. */
+        i = suffix > memory ? suffix : memory;
+        while (i < needleLen && needle[i] == haystack[i + j])
+        {
+            i++;
+        }
+        if (i < needleLen)
+        {
+            j += i - suffix + 1;
+            memory = 0;
+            continue;
+        }
+
+        /* Match the left half, backwards. */
+        i = suffix;
+        while (i > memory && needle[i - 1] == haystack[i - 1 + j])
+        {
+            i--;
+        }
+        if (i <= memory)
+        {
+            return haystack + j;
         }
+
+        j += tw->period;
+        memory = tw->periodic ? needleLen - tw->period : 0;
     }
 
-    dest[i - 1] = '\0';
-    return -1;
+    return NULL;
 }
 
-KR_CONSTEXPR ptrdiff_t kr_strscat(char *KR_RESTRICT dest, const char *KR_RESTRICT src, size_t destLen)
+/*
+ * Check a candidate match a chunk at a time, adding the bytes we looked at to
+ * the work done.  A single memcmp wouldn't tell us how far it got.
+ */
+KR_INLINE bool kr_memmem_match_(const unsigned char *lhs, const unsigned char *rhs, size_t len, size_t *work)
 {
-    ptrdiff_t len = 0;
+    size_t i = 0, chunk = 0;
 
-    size_t tail = kr_strnlen(dest, destLen);
-    if (tail == destLen)
+    for (; i < len; i += chunk)
     {
-        return -1;
+        chunk = len - i < 32 ? len - i : 32;
+        *work += chunk;
+        if (memcmp(lhs + i, rhs + i, chunk) != 0)
+        {
+            return false;
+        }
     }
+    return true;
+}
 
-    len = kr_strscpy(dest + tail, src, destLen - tail);
-    if (len < 0)
+#if (KR_SSE2)
+
+/*
+ * Check the candidate positions in a block, keeping count of the work.
+ */
+KR_INLINE const unsigned char *kr_memmem_verify_(const unsigned char *haystack, const unsigned char *needle,
+                                                 size_t needleLen, size_t base, uint32_t mask, size_t *work)
+{
+    for (; mask != 0; mask &= mask - 1)
     {
-        return -1;
+        const size_t pos = base + KR_CASTS(size_t, kr_ctz32(mask));
+        if (kr_memmem_match_(haystack + pos + 1, needle + 1, needleLen - 2, work))
+        {
+            return haystack + pos;
+        }
     }
-
-    return KR_CASTS(ptrdiff_t, tail) + len;
+    return NULL;
 }
 
-/******************************************************************************/
-
-KR_CONSTEXPR size_t kr_strlcpy(char *KR_RESTRICT dest, const char *KR_RESTRICT src, size_t destLen)
+/*
+ * Find candidates with SIMD, comparing the first and last byte of the needle
+ * against a block of positions at a time, and check them one by one.  Once
+ * checking costs too much compared to how far we've gotten, give up and
+ * return the position we gave up at, so Two-Way can do the rest.
+ */
+KR_INLINE const unsigned char *kr_memmem_simd_(const unsigned char *haystack, size_t haystackLen,
+                                               const unsigned char *needle, size_t needleLen, size_t *giveUp)
 {
-    size_t i = 0;
+    const size_t last = needleLen - 1;
+    const size_t end = haystackLen - last; /* One past the final start position. */
+    const unsigned char *found = NULL;
+    size_t i = 0, work = 0;
+
+#if (KR_AVX2)
+#define KR_MEMMEM_WIDTH_ 32
+    const __m256i first = _mm256_set1_epi8(KR_CASTS(char, needle[0]));
+    const __m256i lastCh = _mm256_set1_epi8(KR_CASTS(char, needle[last]));
+#define KR_MEMMEM_BLOCK_(pos)                                                                                          \
+    _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256(KR_CASTR(const __m256i *, haystack + (pos))), first),       \
+                     _mm256_cmpeq_epi8(_mm256_loadu_si256(KR_CASTR(const __m256i *, haystack + (pos) + last)), lastCh))
+#define KR_MEMMEM_MASK_(v) KR_CASTS(uint32_t, _mm256_movemask_epi8(v))
+#define KR_MEMMEM_OR_(a, b) _mm256_or_si256(a, b)
+    __m256i a, b;
+#else
+#define KR_MEMMEM_WIDTH_ 16
+    const __m128i first = _mm_set1_epi8(KR_CASTS(char, needle[0]));
+    const __m128i lastCh = _mm_set1_epi8(KR_CASTS(char, needle[last]));
+#define KR_MEMMEM_BLOCK_(pos)                                                                                          \
+    _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128(KR_CASTR(const __m128i *, haystack + (pos))), first),                \
+                  _mm_cmpeq_epi8(_mm_loadu_si128(KR_CASTR(const __m128i *, haystack + (pos) + last)), lastCh))
+#define KR_MEMMEM_MASK_(v) KR_CASTS(uint32_t, _mm_movemask_epi8(v))
+#define KR_MEMMEM_OR_(a, b) _mm_or_si128(a, b)
+    __m128i a, b;
+#endif
 
-    if (destLen == 0)
+    for (; end - i >= 2 * KR_MEMMEM_WIDTH_; i += 2 * KR_MEMMEM_WIDTH_)
     {
-        return 0;
+        a = KR_MEMMEM_BLOCK_(i);
+        b = KR_MEMMEM_BLOCK_(i + KR_MEMMEM_WIDTH_);
+        if (KR_MEMMEM_MASK_(KR_MEMMEM_OR_(a, b)) == 0)
+        {
+            continue;
+        }
+
+        found = kr_memmem_verify_(haystack, needle, needleLen, i, KR_MEMMEM_MASK_(a), &work);
+        if (found == NULL)
+        {
+            found = kr_memmem_verify_(haystack, needle, needleLen, i + KR_MEMMEM_WIDTH_, KR_MEMMEM_MASK_(b), &work);
+        }
+        if (found != NULL)
+        {
+            return found;
+        }
+
+        /* Bail out before we go quadratic. */
+        if (work > 8 * i + 4 * needleLen + 256)
+        {
+            *giveUp = i + 2 * KR_MEMMEM_WIDTH_;
+            return NULL;
+        }
     }
 
-    i = 0;
-    for (; i < destLen; i++)
+    if (end - i >= KR_MEMMEM_WIDTH_)
     {
-        dest[i] = src[i];
-        if (src[i] == '\0')
+        a = KR_MEMMEM_BLOCK_(i);
+        found = kr_memmem_verify_(haystack, needle, needleLen, i, KR_MEMMEM_MASK_(a), &work);
+        if (found != NULL)
         {
-            return i;
+            return found;
         }
+        i += KR_MEMMEM_WIDTH_;
     }
 
-    dest[i - 1] = '\0';
-    for (;; i++)
+    if (i != end && end >= KR_MEMMEM_WIDTH_)
     {
-        if (src[i] == '\0')
+        /* Overlap the last block with positions we've already checked. */
+        a = KR_MEMMEM_BLOCK_(end - KR_MEMMEM_WIDTH_);
+        found = kr_memmem_verify_(haystack, needle, needleLen, i,
+                                  KR_MEMMEM_MASK_(a) >> (KR_MEMMEM_WIDTH_ - (end - i)), &work);
+        if (found != NULL)
         {
-            return i;
+            return found;
         }
+        i = end;
     }
-}
 
-KR_CONSTEXPR size_t kr_strlcat(char *KR_RESTRICT dest, const char *KR_RESTRICT src, size_t destLen)
-{
-    size_t tail = kr_strnlen(dest, destLen);
-    if (tail == destLen)
+    /* Haystack too short for a single block. */
+    for (; i < end; i++)
     {
-        return destLen;
+        if (haystack[i] == needle[0] && haystack[i + last] == needle[last])
+        {
+            if (kr_memmem_match_(haystack + i + 1, needle + 1, needleLen - 2, &work))
+            {
+                return haystack + i;
+            }
+
+            if (work > 8 * i + 4 * needleLen + 256)
+            {
+                *giveUp = i + 1;
+                return NULL;
+            }
+        }
     }
 
-    return kr_strlcpy(dest + tail, src, destLen - tail) + tail;
+#undef KR_MEMMEM_WIDTH_
+#undef KR_MEMMEM_BLOCK_
+#undef KR_MEMMEM_MASK_
+#undef KR_MEMMEM_OR_
+
+    *giveUp = i;
+    return NULL;
 }
 
-/******************************************************************************/
+#endif /* (KR_SSE2) */
 
-KR_CONSTEXPR char *kr_stpecpy(char *dest, char *destEnd, const char *KR_RESTRICT src)
+KR_INLINE void *kr_memmem(const void *haystack, size_t haystackLen, const void *needle, size_t needleLen)
 {
-    ptrdiff_t len = 0;
+    const unsigned char *h = KR_CASTS(const unsigned char *, haystack);
+    const unsigned char *n = KR_CASTS(const unsigned char *, needle);
+    struct kr_twoway_s tw;
+    size_t start = 0;
 
-    if (dest == NULL)
+    if (needleLen == 0)
+    {
+        return KR_CASTC(void *, haystack);
+    }
+    else if (needleLen > haystackLen)
     {
         return NULL;
     }
+    else if (needleLen == 1)
+    {
+        return kr_memchr(haystack, n[0], haystackLen);
+    }
 
-    len = kr_strscpy(dest, src, KR_CASTS(size_t, destEnd - dest));
-    if (len == -1)
+#if (KR_SSE2)
     {
-        return NULL;
+        const unsigned char *found = kr_memmem_simd_(h, haystackLen, n, needleLen, &start);
+        if (found != NULL)
+        {
+            return KR_CASTC(unsigned char *, found);
+        }
+        else if (haystackLen - start < needleLen)
+        {
+            return NULL;
+        }
     }
+#endif
 
-    return dest + len;
+    kr_twoway_init_(&tw, n, needleLen);
+    return KR_CASTC(unsigned char *, kr_twoway_find_(&tw, h + start, haystackLen - start, n, needleLen, NULL));
+}
+
+KR_INLINE char *kr_strstr(const char *haystack, const char *needle)
+{
+    return KR_CASTS(char *, kr_memmem(haystack, kr_strlen(haystack), needle, kr_strlen(needle)));
 }
 
 /******************************************************************************/
 
-KR_CONSTEXPR size_t kr_strspn(const char *str, const char *chars)
+/*
+ * The SIMD filter beat Horspool and Two-Way at every needle length we tried,
+ * on both English-like and four letter alphabets.  Without it, Horspool is
+ * used up to the point where its skip table can't hold the shift.
+ */
+#define KR_SEARCHER_HORSPOOL_MAX_ 255
+
+KR_INLINE void kr_searcher_init(struct kr_searcher_s *searcher, const void *needle, size_t needleLen)
 {
-    const char *s = str;
-    const char *ch = NULL;
+    searcher->needle = KR_CASTS(const unsigned char *, needle);
+    searcher->needleLen = needleLen;
+    memset(&searcher->twoway, 0x00, sizeof(searcher->twoway));
+    memset(searcher->skip, 0x00, sizeof(searcher->skip));
 
-    for (; *s != '\0'; s++)
+    if (needleLen <= 1)
     {
-        bool found = false;
-        for (ch = chars; *ch != '\0'; ch++)
+        searcher->algo = KR_SEARCHER_MEMCHR;
+        return;
+    }
+
+    /* Everything else can fall back to Two-Way. */
+    kr_twoway_init_(&searcher->twoway, searcher->needle, needleLen);
+
+#if (KR_SSE2)
+    searcher->algo = KR_SEARCHER_SIMD;
+#else
+    if (needleLen <= KR_SEARCHER_HORSPOOL_MAX_)
+    {
+        size_t i = 0;
+
+        searcher->algo = KR_SEARCHER_HORSPOOL;
+        memset(searcher->skip, KR_CASTS(int, needleLen), sizeof(searcher->skip));
+        for (i = 0; i < needleLen - 1; i++)
         {
-            if (*s == *ch)
-            {
-                found = true;
-                break;
-            }
+            searcher->skip[searcher->needle[i]] = KR_CASTS(unsigned char, needleLen - 1 - i);
         }
-        if (!found)
+    }
+    else
+    {
+        size_t i = 0;
+
+        /* Unlike Horspool, Two-Way wants a zero shift when the last byte
+           matches.  Capping the shift only costs speed, not correctness. */
+        searcher->algo = KR_SEARCHER_TWOWAY;
+        memset(searcher->skip, 0xFF, sizeof(searcher->skip));
+        for (i = needleLen - 255; i < needleLen; i++)
         {
-            return KR_CASTS(size_t, s - str);
+            searcher->skip[searcher->needle[i]] = KR_CASTS(unsigned char, needleLen - 1 - i);
         }
     }
-
-    return KR_CASTS(size_t, s - str);
+#endif
 }
 
-KR_CONSTEXPR size_t kr_strcspn(const char *str, const char *chars)
+/*
+ * Horspool, with the same bail out as the SIMD filter.
+ */
+KR_INLINE const unsigned char *kr_searcher_horspool_(const struct kr_searcher_s *searcher,
+                                                     const unsigned char *haystack, size_t haystackLen,
+                                                     size_t *giveUp)
 {
-    const char *s = str;
-    const char *ch = NULL;
+    const unsigned char *needle = searcher->needle;
+    const size_t needleLen = searcher->needleLen;
+    const size_t last = needleLen - 1;
+    size_t i = 0, work = 0;
 
-    for (; *s != '\0'; s++)
+    while (haystackLen - i >= needleLen)
     {
-        bool found = false;
-        for (ch = chars; *ch != '\0'; ch++)
+        const unsigned char ch = haystack[i + last];
+        if (ch == needle[last])
         {
-            if (*s == *ch)
+            if (kr_memmem_match_(haystack + i, needle, last, &work))
             {
-                found = true;
-                break;
+                return haystack + i;
+            }
+
+            if (work > 8 * i + 4 * needleLen + 256)
+            {
+                *giveUp = i + 1;
+                return NULL;
             }
         }
-        if (found)
-        {
-            return KR_CASTS(size_t, s - str);
-        }
+        i += searcher->skip[ch];
     }
 
-    return KR_CASTS(size_t, s - str);
+    *giveUp = i;
+    return NULL;
 }
 
-/******************************************************************************/
-
-KR_CONSTEXPR char *kr_strtok_r(char *KR_RESTRICT str, const char *KR_RESTRICT delim, char **KR_RESTRICT ptr)
+KR_INLINE void *kr_searcher_find(const struct kr_searcher_s *searcher, const void *haystack, size_t haystackLen)
 {
-    char *tok = NULL;
+    const unsigned char *h = KR_CASTS(const unsigned char *, haystack);
+    const unsigned char *found = NULL;
+    size_t start = 0;
 
-    if (str == NULL)
+    if (searcher->needleLen > haystackLen)
     {
-        if (*ptr == NULL)
+        return NULL;
+    }
+
+    switch (searcher->algo)
+    {
+    case KR_SEARCHER_MEMCHR:
+        if (searcher->needleLen == 0)
         {
-            return NULL;
+            return KR_CASTC(void *, haystack);
         }
-
-        /* Resuming a previous tokenization. */
-        str = *ptr;
+        return kr_memchr(haystack, searcher->needle[0], haystackLen);
+    case KR_SEARCHER_SIMD:
+#if (KR_SSE2)
+        found = kr_memmem_simd_(h, haystackLen, searcher->needle, searcher->needleLen, &start);
+#endif
+        break;
+    case KR_SEARCHER_HORSPOOL:
+        found = kr_searcher_horspool_(searcher, h, haystackLen, &start);
+        break;
+    case KR_SEARCHER_TWOWAY:
+        break;
     }
 
-    /* First, munch all delim chars. */
-    str += kr_strspn(str, delim);
-    if (*str == '\0')
+    if (found != NULL)
+    {
+        return KR_CASTC(unsigned char *, found);
+    }
+    else if (haystackLen - start < searcher->needleLen)
     {
-        /* Could not find another token. */
         return NULL;
     }
 
-    /* Munch a token. */
-    tok = str;
-    str += kr_strcspn(str, delim);
-    if (*str == '\0')
+    found = kr_twoway_find_(&searcher->twoway, h + start, haystackLen - start, searcher->needle, searcher->needleLen,
+                            searcher->algo == KR_SEARCHER_TWOWAY ? searcher->skip : NULL);
+    return KR_CASTC(unsigned char *, found);
+}
+
+KR_INLINE size_t kr_searcher_count(const struct kr_searcher_s *searcher, const void *haystack, size_t haystackLen)
+{
+    const unsigned char *h = KR_CASTS(const unsigned char *, haystack);
+    const unsigned char *found = NULL;
+    size_t pos = 0, count = 0;
+
+    if (searcher->needleLen == 0)
     {
-        /* Found the last token. */
-        *ptr = NULL;
-        return tok;
+        return haystackLen + 1;
     }
 
-    /* Null the end and set our next starting point. */
-    *str = '\0';
-    *ptr = str + 1;
-    return tok;
+    for (;;)
+    {
+        found = KR_CASTS(const unsigned char *, kr_searcher_find(searcher, h + pos, haystackLen - pos));
+        if (found == NULL)
+        {
+            return count;
+        }
+
+        count++;
+        pos = KR_CASTS(size_t, found - h) + searcher->needleLen;
+    }
 }
 
+#undef KR_SEARCHER_HORSPOOL_MAX_
+
 /******************************************************************************/
 
 KR_NODISCARD char *kr_strdup(const char *str)
@@ -467,6 +3255,14 @@ KR_INLINE void *kr_memccpy(void *KR_RESTRICT dest, const void *KR_RESTRICT src,
     return NULL;
 }
 
+#undef KR_STRWORD_ONES_
+#undef KR_STRWORD_HIGHS_
+#undef KR_STRWORD_HASZERO_
+#undef KR_STRWORD_ALIGNED_
+#undef KR_STRWORD_RANGE_
+#undef KR_STRWORD_LOWER_
+#undef KR_STRWORD_UPPER_
+
 #endif /* !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION) */
 
 #endif /* !defined(KRSTR_H) */
@@ -0,0 +1,375 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * Growable string builder
+ *
+ * kr_strscat and kr_strlcat have to find the end of the destination string
+ * every time they're called, so building a long string out of many pieces
+ * with them takes quadratic time.  A string buffer remembers its length and
+ * grows its allocation geometrically, so each append only costs as much as
+ * the bytes being appended.
+ *
+ * The buffer is always null terminated once anything has been allocated, so
+ * the contents can be passed to anything expecting a C string.
+ */
+
+#if !defined(KRSTRBUF_H)
+#define KRSTRBUF_H
+
+#include "./krconfig.h"
+
+#include "./krarg.h"
+#include "./krbool.h"
+#include "./krfmt.h"
+#include "./krlib.h"
+#include "./krstr.h"
+
+#if (!KR_CONFIG_NOINCLUDE)
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+/*
+ * Formatting uses kr_vsnprintf, which is the same everywhere.  Define this
+ * to use a different vsnprintf, it must return the length the string needs
+ * or a negative number on failure.
+ */
+#if !defined(KR_VSNPRINTF)
+#define KR_VSNPRINTF(buf, len, fmt, args) (kr_vsnprintf((buf), (len), (fmt), (args)))
+#endif /* !defined(KR_VSNPRINTF) */
+
+/**
+ * @brief A growable string.
+ *
+ * @details A zero-initialized buffer is a valid empty buffer.
+ */
+struct kr_strbuf_s
+{
+    char *data; /* String data, NULL if nothing has been allocated yet. */
+    size_t len; /* Length of string, not including terminator. */
+    size_t cap; /* Size of allocation, including terminator. */
+};
+
+/**
+ * @brief Initialize an empty string buffer.
+ *
+ * @details Does not allocate.
+ *
+ * @param buf Buffer to initialize.
+ */
+KR_INLINE void kr_strbuf_init(struct kr_strbuf_s *buf);
+
+/**
+ * @brief Free memory owned by a string buffer and reset it to empty.
+ *
+ * @param buf Buffer to destroy.
+ */
+KR_INLINE void kr_strbuf_destroy(struct kr_strbuf_s *buf);
+
+/**
+ * @brief Ensure that a number of bytes can be appended without reallocating.
+ *
+ * @param buf Buffer to grow.
+ * @param extra Number of bytes to make room for, not including terminator.
+ * @return true if there is enough room, false if memory could not be
+ *         allocated or the size would overflow.  The buffer is unchanged on
+ *         failure.
+ */
+KR_NODISCARD KR_INLINE bool kr_strbuf_reserve(struct kr_strbuf_s *buf, size_t extra);
+
+/**
+ * @brief Empty a string buffer without freeing its allocation.
+ *
+ * @param buf Buffer to clear.
+ */
+KR_INLINE void kr_strbuf_clear(struct kr_strbuf_s *buf);
+
+/**
+ * @brief Append a string to a string buffer.
+ *
+ * @param buf Buffer to append to.
+ * @param str String to append.
+ * @return true if the string was appended, false if memory could not be
+ *         allocated.  The buffer is unchanged on failure.
+ */
+KR_INLINE bool kr_strbuf_append(struct kr_strbuf_s *buf, const char *str);
+
+/**
+ * @brief Append a number of bytes to a string buffer.
+ *
+ * @details Bytes are copied as-is, so str does not need to be terminated,
+ *          which makes this useful for slices from kr_tokenize.
+ *
+ * @param buf Buffer to append to.
+ * @param str Bytes to append.
+ * @param len Number of bytes to append.
+ * @return true if the bytes were appended, false if memory could not be
+ *         allocated.  The buffer is unchanged on failure.
+ */
+KR_INLINE bool kr_strbuf_appendn(struct kr_strbuf_s *buf, const char *str, size_t len);
+
+/**
+ * @brief Append a printf-style formatted string to a string buffer.
+ *
+ * @param buf Buffer to append to.
+ * @param fmt Format string.
+ * @param ... Format arguments.
+ * @return true if the string was appended, false if memory could not be
+ *         allocated or formatting failed.  The contents of the buffer are
+ *         unchanged on failure.
+ */
+KR_INLINE bool kr_strbuf_appendf(struct kr_strbuf_s *buf, const char *fmt, ...);
+
+/**
+ * @brief Append a printf-style formatted string to a string buffer, using
+ *        a va_list.
+ *
+ * @param buf Buffer to append to.
+ * @param fmt Format string.
+ * @param args Format arguments.
+ * @return true if the string was appended, false if memory could not be
+ *         allocated or formatting failed.  The contents of the buffer are
+ *         unchanged on failure.
+ */
+KR_INLINE bool kr_strbuf_vappendf(struct kr_strbuf_s *buf, const char *fmt, va_list args);
+
+/**
+ * @brief Get the contents of a string buffer as a C string.
+ *
+ * @param buf Buffer to read.
+ * @return Terminated string, which is "" if nothing has been allocated.
+ *         Invalidated by anything that appends to the buffer.
+ */
+KR_INLINE const char *kr_strbuf_cstr(const struct kr_strbuf_s *buf);
+
+/**
+ * @brief Take ownership of the contents of a string buffer.
+ *
+ * @details The buffer is reset to empty, as if it had been destroyed.
+ *
+ * @param buf Buffer to detach from.
+ * @param outLen Output length of string, not including terminator.  Can be
+ *               NULL.
+ * @return Terminated string, which must be freed with KR_FREE, or NULL if
+ *         an empty buffer with no allocation could not allocate.
+ */
+KR_NODISCARD KR_INLINE char *kr_strbuf_detach(struct kr_strbuf_s *buf, size_t *outLen);
+
+/**
+ * @brief Get the current end of a string buffer for use with kr_stpecpy.
+ *
+ * @details Reserve room first, then chain kr_stpecpy starting from the
+ *          returned pointer, and finally pass the result of the chain to
+ *          kr_strbuf_setend.
+ *
+ * @param buf Buffer to write into.
+ * @param outDestEnd Output end of the allocation, to pass as destEnd.
+ * @return Pointer to the terminator of the current string, or NULL if
+ *         nothing has been allocated.  kr_stpecpy treats a NULL dest as a
+ *         no-op, so the chain will fail cleanly.
+ */
+KR_INLINE char *kr_strbuf_end(struct kr_strbuf_s *buf, char **outDestEnd);
+
+/**
+ * @brief Set the length of a string buffer from a kr_stpecpy chain.
+ *
+ * @param buf Buffer that was written into.
+ * @param end Result of the last kr_stpecpy in the chain.
+ * @return true if the length was updated, false if end is NULL because the
+ *         chain ran out of room.  On failure the buffer is truncated back
+ *         to its previous length.
+ */
+KR_INLINE bool kr_strbuf_setend(struct kr_strbuf_s *buf, const char *end);
+
+/******************************************************************************/
+#if !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION)
+/******************************************************************************/
+
+#define KR_STRBUF_MINCAP_ 16
+
+KR_INLINE void kr_strbuf_init(struct kr_strbuf_s *buf)
+{
+    buf->data = NULL;
+    buf->len = 0;
+    buf->cap = 0;
+}
+
+KR_INLINE void kr_strbuf_destroy(struct kr_strbuf_s *buf)
+{
+    KR_FREE(buf->data);
+    kr_strbuf_init(buf);
+}
+
+KR_NODISCARD KR_INLINE bool kr_strbuf_reserve(struct kr_strbuf_s *buf, size_t extra)
+{
+    size_t need = 0, cap = 0;
+    char *data = NULL;
+
+    if (extra >= KR_CASTS(size_t, -1) - buf->len)
+    {
+        return false;
+    }
+
+    need = buf->len + extra + 1;
+    if (need <= buf->cap)
+    {
+        return true;
+    }
+
+    /* Doubling keeps appends amortized constant time. */
+    cap = buf->cap < KR_STRBUF_MINCAP_ ? KR_STRBUF_MINCAP_ : buf->cap;
+    while (cap < need)
+    {
+        cap = cap > KR_CASTS(size_t, -1) / 2 ? need : cap * 2;
+    }
+
+    data = KR_CASTS(char *, kr_reallocarray(buf->data, cap, sizeof(char)));
+    if (data == NULL)
+    {
+        return false;
+    }
+
+    if (buf->data == NULL)
+    {
+        data[0] = '\0';
+    }
+    buf->data = data;
+    buf->cap = cap;
+    return true;
+}
+
+KR_INLINE void kr_strbuf_clear(struct kr_strbuf_s *buf)
+{
+    buf->len = 0;
+    if (buf->data != NULL)
+    {
+        buf->data[0] = '\0';
+    }
+}
+
+KR_INLINE bool kr_strbuf_append(struct kr_strbuf_s *buf, const char *str)
+{
+    return kr_strbuf_appendn(buf, str, kr_strlen(str));
+}
+
+KR_INLINE bool kr_strbuf_appendn(struct kr_strbuf_s *buf, const char *str, size_t len)
+{
+    if (!kr_strbuf_reserve(buf, len))
+    {
+        return false;
+    }
+
+    memcpy(buf->data + buf->len, str, len);
+    buf->len += len;
+    buf->data[buf->len] = '\0';
+    return true;
+}
+
+KR_INLINE bool kr_strbuf_appendf(struct kr_strbuf_s *buf, const char *fmt, ...)
+{
+    bool ok = false;
+    va_list args;
+
+    va_start(args, fmt);
+    ok = kr_strbuf_vappendf(buf, fmt, args);
+    va_end(args);
+    return ok;
+}
+
+KR_INLINE bool kr_strbuf_vappendf(struct kr_strbuf_s *buf, const char *fmt, va_list args)
+{
+    va_list copy;
+    size_t room = 0;
+    int len = 0;
+
+    /* Most formatted strings aren't much longer than their format. */
+    if (!kr_strbuf_reserve(buf, kr_strlen(fmt)))
+    {
+        return false;
+    }
+
+    for (;;)
+    {
+        room = buf->cap - buf->len;
+
+        va_copy(copy, args);
+        len = KR_VSNPRINTF(buf->data + buf->len, room, fmt, copy);
+        va_end(copy);
+
+        if (len >= 0 && KR_CASTS(size_t, len) < room)
+        {
+            buf->len += KR_CASTS(size_t, len);
+            return true;
+        }
+
+        /* Truncated or failed, put the terminator back. */
+        buf->data[buf->len] = '\0';
+        if (len < 0 || !kr_strbuf_reserve(buf, KR_CASTS(size_t, len)))
+        {
+            return false;
+        }
+    }
+}
+
+KR_INLINE const char *kr_strbuf_cstr(const struct kr_strbuf_s *buf)
+{
+    return buf->data != NULL ? buf->data : "";
+}
+
+KR_NODISCARD KR_INLINE char *kr_strbuf_detach(struct kr_strbuf_s *buf, size_t *outLen)
+{
+    char *data = NULL;
+
+    if (!kr_strbuf_reserve(buf, 0))
+    {
+        return NULL;
+    }
+
+    data = buf->data;
+    if (outLen != NULL)
+    {
+        *outLen = buf->len;
+    }
+    kr_strbuf_init(buf);
+    return data;
+}
+
+KR_INLINE char *kr_strbuf_end(struct kr_strbuf_s *buf, char **outDestEnd)
+{
+    if (buf->data == NULL)
+    {
+        *outDestEnd = NULL;
+        return NULL;
+    }
+
+    *outDestEnd = buf->data + buf->cap;
+    return buf->data + buf->len;
+}
+
+KR_INLINE bool kr_strbuf_setend(struct kr_strbuf_s *buf, const char *end)
+{
+    if (end == NULL)
+    {
+        if (buf->data != NULL)
+        {
+            buf->data[buf->len] = '\0';
+        }
+        return false;
+    }
+
+    buf->len = KR_CASTS(size_t, end - buf->data);
+    return true;
+}
+
+#undef KR_STRBUF_MINCAP_
+
+#endif /* !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION) */
+
+#endif /* !defined(KRSTRBUF_H) */
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * Word-at-a-time bit tricks
+ *
+ * Shared by the scanners that classify 64 bytes at a time, like krcsv.h
+ * and krjson.h.  These are internal helpers, not part of the public
+ * interface.
+ */
+
+#if !defined(KRSWAR_H)
+#define KRSWAR_H
+
+#include "./krconfig.h"
+
+#include "./krint.h"
+
+/******************************************************************************/
+#if !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION)
+/******************************************************************************/
+
+#if defined(UINT64_MAX)
+
+/*
+ * Bit n of the result is set if byte n of word is zero.  The high bit of
+ * every zero byte is found first, then all eight are gathered into the top
+ * byte.
+ */
+KR_INLINE uint64_t kr_swar_zeros_(uint64_t word)
+{
+    const uint64_t lows = UINT64_C(0x7F7F7F7F7F7F7F7F);
+
+    word = ~(((word & lows) + lows) | word | lows);
+    return ((word >> 7) * UINT64_C(0x0102040810204080)) >> 56;
+}
+
+/* Every bit from an odd-numbered set bit up to the next one. */
+KR_INLINE uint64_t kr_swar_prefix_xor_(uint64_t x)
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+#endif /* defined(UINT64_MAX) */
+
+/******************************************************************************/
+#endif /* !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION) */
+/******************************************************************************/
+
+#endif /* !defined(KRSWAR_H) */
@@ -0,0 +1,1170 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+/*
+ * UTF-8 validation and conversion
+ *
+ * Checking input one byte at a time with a state machine costs more than
+ * most of what is done with the string afterwards.  Text is usually mostly
+ * ASCII, so every variant here skips whole blocks of it with a single test
+ * of their high bits, and the SIMD variants check the rest a register at a
+ * time with three nibble lookup tables, which catch every kind of bad
+ * sequence at once.
+ *
+ * Validation follows the Unicode definition of well-formed UTF-8: overlong
+ * encodings, surrogates and anything past U+10FFFF are all rejected.
+ *
+ * Conversion to and from UTF-16 and UTF-32 validates the same way as it
+ * goes, widens or narrows runs of ASCII a block at a time, and comes with
+ * functions that measure the output exactly beforehand, so converting only
+ * ever needs one allocation.  UTF-16 and UTF-32 are read and written as
+ * bytes in either order, so they work with wchar_t and with files.
+ *
+ * @link https://arxiv.org/abs/2010.03090
+ */
+
+#if !defined(KRUTF8_H)
+#define KRUTF8_H
+
+#include "./krconfig.h"
+
+#include "./krbool.h"
+#include "./krint.h"
+#include "./krserial.h"
+
+#if (!KR_CONFIG_NOINCLUDE)
+#include <stddef.h>
+#endif
+
+#if (KR_AVX2)
+#include <immintrin.h>
+#elif (KR_SSSE3)
+#include <tmmintrin.h>
+#elif (KR_SSE2)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief Check that a string is valid UTF-8.
+ *
+ * @details Dispatches to the fastest of the variants below that the compiler
+ *          targets.  NUL bytes are valid, and the string does not need to
+ *          be terminated.
+ *
+ * @param str String to check.
+ * @param len Length of the string.
+ * @return len if the whole string is valid, otherwise the position of the
+ *         first byte of the first invalid or truncated sequence.
+ */
+KR_INLINE size_t kr_utf8_validate(const char *str, size_t len);
+
+/**
+ * @brief Check that a string is valid UTF-8, skipping ASCII 16 bytes at a
+ *        time in a pair of 64-bit words.
+ */
+KR_INLINE size_t kr_utf8_validate_swar(const char *str, size_t len);
+
+#if (KR_SSSE3)
+
+/**
+ * @brief Check that a string is valid UTF-8, 16 bytes at a time with SSSE3.
+ */
+KR_INLINE size_t kr_utf8_validate_ssse3(const char *str, size_t len);
+
+#endif /* (KR_SSSE3) */
+
+#if (KR_AVX2)
+
+/**
+ * @brief Check that a string is valid UTF-8, 32 bytes at a time with AVX2.
+ */
+KR_INLINE size_t kr_utf8_validate_avx2(const char *str, size_t len);
+
+#endif /* (KR_AVX2) */
+
+/**
+ * @brief Read or write UTF-16 and UTF-32 as big-endian instead of
+ *        little-endian.
+ */
+#define KR_UTF_BE 0x1
+
+/**
+ * @brief Byte order flags that match the platform, and so strings of
+ *        wchar_t, char16_t or char32_t.
+ */
+#define KR_UTF_NATIVE ((KR_BYTE_ORDER == KR_ORDER_BIG_ENDIAN) ? KR_UTF_BE : 0)
+
+/**
+ * @brief Count the UTF-16 code units needed to convert a UTF-8 string.
+ *
+ * @details Exact if the string is valid.  If not, it is still enough for
+ *          everything kr_utf8_to_utf16 writes before it stops.
+ *
+ * @param src UTF-8 string.
+ * @param len Length of the string in bytes.
+ * @return Number of UTF-16 code units.
+ */
+KR_INLINE size_t kr_utf8_to_utf16_length(const char *src, size_t len);
+
+/**
+ * @brief Count the UTF-32 code units needed to convert a UTF-8 string.
+ *
+ * @details Exact if the string is valid.  If not, it is still enough for
+ *          everything kr_utf8_to_utf32 writes before it stops.
+ *
+ * @param src UTF-8 string.
+ * @param len Length of the string in bytes.
+ * @return Number of UTF-32 code units.
+ */
+KR_INLINE size_t kr_utf8_to_utf32_length(const char *src, size_t len);
+
+/**
+ * @brief Count the bytes needed to convert a UTF-16 string to UTF-8.
+ *
+ * @details Exact if the string is valid.  If not, it is still enough for
+ *          everything kr_utf16_to_utf8 writes before it stops.
+ *
+ * @param src UTF-16 string.
+ * @param len Length of the string in code units.
+ * @param flags KR_UTF_BE if the string is big-endian.
+ * @return Number of bytes of UTF-8.
+ */
+KR_INLINE size_t kr_utf16_to_utf8_length(const void *src, size_t len, unsigned flags);
+
+/**
+ * @brief Count the bytes needed to convert a UTF-32 string to UTF-8.
+ *
+ * @details Exact if the string is valid.  If not, it is still enough for
+ *          everything kr_utf32_to_utf8 writes before it stops.
+ *
+ * @param src UTF-32 string.
+ * @param len Length of the string in code units.
+ * @param flags KR_UTF_BE if the string is big-endian.
+ * @return Number of bytes of UTF-8.
+ */
+KR_INLINE size_t kr_utf32_to_utf8_length(const void *src, size_t len, unsigned flags);
+
+/**
+ * @brief Convert UTF-8 to UTF-16.
+ *
+ * @details The string is validated as it is converted, and conversion
+ *          stops at the same place kr_utf8_validate would.
+ *
+ * @param dest Destination buffer, with 2 bytes for each of the
+ *             kr_utf8_to_utf16_length code units.
+ * @param outLen Number of code units written.
+ * @param src UTF-8 string.
+ * @param len Length of the string in bytes.
+ * @param flags KR_UTF_BE to write big-endian.
+ * @return len if the whole string was converted, otherwise the position of
+ *         the first byte of the first invalid or truncated sequence.
+ */
+KR_INLINE size_t kr_utf8_to_utf16(void *dest, size_t *outLen, const char *src, size_t len, unsigned flags);
+
+/**
+ * @brief Convert UTF-8 to UTF-32.
+ *
+ * @details The string is validated as it is converted, and conversion
+ *          stops at the same place kr_utf8_validate would.
+ *
+ * @param dest Destination buffer, with 4 bytes for each of the
+ *             kr_utf8_to_utf32_length code units.
+ * @param outLen Number of code units written.
+ * @param src UTF-8 string.
+ * @param len Length of the string in bytes.
+ * @param flags KR_UTF_BE to write big-endian.
+ * @return len if the whole string was converted, otherwise the position of
+ *         the first byte of the first invalid or truncated sequence.
+ */
+KR_INLINE size_t kr_utf8_to_utf32(void *dest, size_t *outLen, const char *src, size_t len, unsigned flags);
+
+/**
+ * @brief Convert UTF-16 to UTF-8.
+ *
+ * @details The string is validated as it is converted, and conversion
+ *          stops at the first surrogate that isn't part of a high-low pair.
+ *
+ * @param dest Destination buffer, at least kr_utf16_to_utf8_length bytes.
+ *             Not terminated.
+ * @param outLen Number of bytes written.
+ * @param src UTF-16 string.
+ * @param len Length of the string in code units.
+ * @param flags KR_UTF_BE if the string is big-endian.
+ * @return len if the whole string was converted, otherwise the position of
+ *         the first unpaired surrogate.
+ */
+KR_INLINE size_t kr_utf16_to_utf8(char *dest, size_t *outLen, const void *src, size_t len, unsigned flags);
+
+/**
+ * @brief Convert UTF-32 to UTF-8.
+ *
+ * @details The string is validated as it is converted, and conversion
+ *          stops at the first surrogate or value past U+10FFFF.
+ *
+ * @param dest Destination buffer, at least kr_utf32_to_utf8_length bytes.
+ *             Not terminated.
+ * @param outLen Number of bytes written.
+ * @param src UTF-32 string.
+ * @param len Length of the string in code units.
+ * @param flags KR_UTF_BE if the string is big-endian.
+ * @return len if the whole string was converted, otherwise the position of
+ *         the first code unit that isn't a valid code point.
+ */
+KR_INLINE size_t kr_utf32_to_utf8(char *dest, size_t *outLen, const void *src, size_t len, unsigned flags);
+
+/******************************************************************************/
+#if !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION)
+/******************************************************************************/
+
+/* Length of the well-formed sequence that starts at s[i], or 0 if it isn't. */
+KR_INLINE size_t kr_utf8_sequence_(const unsigned char *s, size_t i, size_t len)
+{
+    const unsigned lead = s[i];
+    unsigned lo = 0x80, hi = 0xBF;
+    size_t n, j;
+
+    if (lead < 0x80)
+    {
+        return 1;
+    }
+    else if (lead < 0xC2)
+    {
+        return 0;
+    }
+    else if (lead < 0xE0)
+    {
+        n = 2;
+    }
+    else if (lead < 0xF0)
+    {
+        /* No overlongs, and no surrogates. */
+        n = 3;
+        lo = (lead == 0xE0) ? 0xA0 : lo;
+        hi = (lead == 0xED) ? 0x9F : hi;
+    }
+    else if (lead < 0xF5)
+    {
+        /* No overlongs, and nothing past U+10FFFF. */
+        n = 4;
+        lo = (lead == 0xF0) ? 0x90 : lo;
+        hi = (lead == 0xF4) ? 0x8F : hi;
+    }
+    else
+    {
+        return 0;
+    }
+
+    if (len - i < n || s[i + 1] < lo || s[i + 1] > hi)
+    {
+        return 0;
+    }
+    for (j = 2; j < n; j++)
+    {
+        if ((s[i + j] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+    }
+    return n;
+}
+
+/* Validate from byte i to the end, one sequence at a time. */
+KR_INLINE size_t kr_utf8_validate_tail_(const unsigned char *s, size_t i, size_t len)
+{
+    size_t n;
+
+    while (i < len)
+    {
+        n = kr_utf8_sequence_(s, i, len);
+        if (n == 0)
+        {
+            break;
+        }
+        i += n;
+    }
+    return i;
+}
+
+/*
+ * The block variants only know that everything before the block at i is
+ * valid except for a sequence that runs into it.  That sequence starts at
+ * the first byte in the last three that isn't a continuation, or if they
+ * all are, it ended right before i.
+ */
+KR_INLINE size_t kr_utf8_restart_(const unsigned char *s, size_t i)
+{
+    size_t j = (i < 3) ? 0 : i - 3;
+
+    while (j < i && (s[j] & 0xC0) == 0x80)
+    {
+        j++;
+    }
+    return j;
+}
+
+/******************************************************************************/
+
+KR_INLINE size_t kr_utf8_validate(const char *str, size_t len)
+{
+#if (KR_AVX2)
+    return kr_utf8_validate_avx2(str, len);
+#elif (KR_SSSE3)
+    return kr_utf8_validate_ssse3(str, len);
+#else
+    return kr_utf8_validate_swar(str, len);
+#endif
+}
+
+KR_INLINE size_t kr_utf8_validate_swar(const char *str, size_t len)
+{
+    const unsigned char *s = KR_CASTR(const unsigned char *, str);
+    size_t i = 0, n;
+
+#if defined(UINT64_MAX)
+    const uint64_t highs = UINT64_C(0x8080808080808080);
+#endif
+
+    while (i < len)
+    {
+#if defined(UINT64_MAX)
+        for (; len - i >= 16; i += 16)
+        {
+            const uint64_t words = kr_load_u64le(KR_CASTC(unsigned char *, s + i)) |
+                                   kr_load_u64le(KR_CASTC(unsigned char *, s + i + 8));
+            if ((words & highs) != 0)
+            {
+                break;
+            }
+        }
+        if (len - i >= 8)
+        {
+            if ((kr_load_u64le(KR_CASTC(unsigned char *, s + i)) & highs) == 0)
+            {
+                i += 8;
+                continue;
+            }
+
+            /* There's a high bit in this word, so this stops inside it. */
+            while (s[i] < 0x80)
+            {
+                i++;
+            }
+        }
+        else if (i == len)
+        {
+            break;
+        }
+#endif
+
+        if (s[i] < 0x80)
+        {
+            i++;
+            continue;
+        }
+
+        /* Multibyte sequences tend to come in runs. */
+        do
+        {
+            n = kr_utf8_sequence_(s, i, len);
+            if (n == 0)
+            {
+                return i;
+            }
+            i += n;
+        } while (i < len && s[i] >= 0x80);
+    }
+    return i;
+}
+
+/*
+ * The SIMD variants classify every byte by its top nibble, and the byte
+ * before it by both of its nibbles.  Each table sets a bit for every error
+ * that nibble could be part of, so a bit survives all three lookups only if
+ * that error is really there.  Checking that third and fourth bytes are
+ * continuations needs a look further back, and is folded into the same bit
+ * as a continuation following a continuation.
+ */
+#define KR_UTF8_TOO_SHORT_ 0x01      /* Lead followed by a non-continuation. */
+#define KR_UTF8_TOO_LONG_ 0x02       /* ASCII followed by a continuation. */
+#define KR_UTF8_OVERLONG_3_ 0x04     /* E0 followed by 80-9F. */
+#define KR_UTF8_TOO_LARGE_ 0x08      /* F4 followed by 90-BF, or F5-FF. */
+#define KR_UTF8_SURROGATE_ 0x10      /* ED followed by A0-BF. */
+#define KR_UTF8_OVERLONG_2_ 0x20     /* C0 or C1. */
+#define KR_UTF8_TOO_LARGE_1000_ 0x40 /* F5-FF followed by 80-8F. */
+#define KR_UTF8_OVERLONG_4_ 0x40     /* F0 followed by 80-8F. */
+#define KR_UTF8_TWO_CONTS_ 0x80      /* Continuation followed by continuation. */
+#define KR_UTF8_CARRY_ (KR_UTF8_TOO_SHORT_ | KR_UTF8_TOO_LONG_ | KR_UTF8_TWO_CONTS_)
+
+#define KR_UTF8_BYTE_1_HIGH_                                                                                           \
+    KR_UTF8_TOO_LONG_, KR_UTF8_TOO_LONG_, KR_UTF8_TOO_LONG_, KR_UTF8_TOO_LONG_, KR_UTF8_TOO_LONG_, KR_UTF8_TOO_LONG_,  \
+        KR_UTF8_TOO_LONG_, KR_UTF8_TOO_LONG_, KR_CASTS(char, KR_UTF8_TWO_CONTS_), KR_CASTS(char, KR_UTF8_TWO_CONTS_),  \
+        KR_CASTS(char, KR_UTF8_TWO_CONTS_), KR_CASTS(char, KR_UTF8_TWO_CONTS_),                                        \
+        KR_UTF8_TOO_SHORT_ | KR_UTF8_OVERLONG_2_, KR_UTF8_TOO_SHORT_,                                                  \
+        KR_UTF8_TOO_SHORT_ | KR_UTF8_OVERLONG_3_ | KR_UTF8_SURROGATE_,                                                 \
+        KR_UTF8_TOO_SHORT_ | KR_UTF8_TOO_LARGE_ | KR_UTF8_TOO_LARGE_1000_ | KR_UTF8_OVERLONG_4_
+
+#define KR_UTF8_BYTE_1_LOW_                                                                                            \
+    KR_CASTS(char, KR_UTF8_CARRY_ | KR_UTF8_OVERLONG_3_ | KR_UTF8_OVERLONG_2_ | KR_UTF8_OVERLONG_4_),                  \
+        KR_CASTS(char, KR_UTF8_CARRY_ | KR_UTF8_OVERLONG_2_), KR_CASTS(char, KR_UTF8_CARRY_),                          \
+        KR_CASTS(char, KR_UTF8_CARRY_), KR_CASTS(char, KR_UTF8_CARRY_ | KR_UTF8_TOO_LARGE_),                           \
+        KR_CASTS(char, KR_UTF8_CARRY_ | KR_UTF8_TOO_LARGE_ | KR_UTF8_TOO_LARGE_1000_),                                 \
+        KR_CASTS(char, KR_UTF8_CARRY_ | KR_UTF8_TOO_LARGE_ | KR_UTF8_TOO_LARGE_1000_),                                 \
+        KR_CASTS(char, KR_UTF8_CARRY_ | KR_UTF8_TOO_LARGE_ | KR_UTF8_TOO_LARGE_1000_),                                 \
+        KR_CASTS(char, KR_UTF8_CARRY_ | KR_UTF8_TOO_LARGE_ | KR_UTF8_TOO_LARGE_1000_),                                 \
+        KR_CASTS(char, KR_UTF8_CARRY_ | KR_UTF8_TOO_LARGE_ | KR_UTF8_TOO_LARGE_1000_),                                 \
+        KR_CASTS(char, KR_UTF8_CARRY_ | KR_UTF8_TOO_LARGE_ | KR_UTF8_TOO_LARGE_1000_),                                 \
+        KR_CASTS(char, KR_UTF8_CARRY_ | KR_UTF8_TOO_LARGE_ | KR_UTF8_TOO_LARGE_1000_),                                 \
+        KR_CASTS(char, KR_UTF8_CARRY_ | KR_UTF8_TOO_LARGE_ | KR_UTF8_TOO_LARGE_1000_),                                 \
+        KR_CASTS(char, KR_UTF8_CARRY_ | KR_UTF8_TOO_LARGE_ | KR_UTF8_TOO_LARGE_1000_ | KR_UTF8_SURROGATE_),            \
+        KR_CASTS(char, KR_UTF8_CARRY_ | KR_UTF8_TOO_LARGE_ | KR_UTF8_TOO_LARGE_1000_),                                 \
+        KR_CASTS(char, KR_UTF8_CARRY_ | KR_UTF8_TOO_LARGE_ | KR_UTF8_TOO_LARGE_1000_)
+
+#define KR_UTF8_BYTE_2_HIGH_                                                                                           \
+    KR_UTF8_TOO_SHORT_, KR_UTF8_TOO_SHORT_, KR_UTF8_TOO_SHORT_, KR_UTF8_TOO_SHORT_, KR_UTF8_TOO_SHORT_,                \
+        KR_UTF8_TOO_SHORT_, KR_UTF8_TOO_SHORT_, KR_UTF8_TOO_SHORT_,                                                    \
+        KR_CASTS(char, KR_UTF8_TOO_LONG_ | KR_UTF8_OVERLONG_2_ | KR_UTF8_TWO_CONTS_ | KR_UTF8_OVERLONG_3_ |            \
+                           KR_UTF8_TOO_LARGE_1000_ | KR_UTF8_OVERLONG_4_),                                             \
+        KR_CASTS(char, KR_UTF8_TOO_LONG_ | KR_UTF8_OVERLONG_2_ | KR_UTF8_TWO_CONTS_ | KR_UTF8_OVERLONG_3_ |            \
+                           KR_UTF8_TOO_LARGE_),                                                                        \
+        KR_CASTS(char, KR_UTF8_TOO_LONG_ | KR_UTF8_OVERLONG_2_ | KR_UTF8_TWO_CONTS_ | KR_UTF8_SURROGATE_ |             \
+                           KR_UTF8_TOO_LARGE_),                                                                        \
+        KR_CASTS(char, KR_UTF8_TOO_LONG_ | KR_UTF8_OVERLONG_2_ | KR_UTF8_TWO_CONTS_ | KR_UTF8_SURROGATE_ |             \
+                           KR_UTF8_TOO_LARGE_),                                                                        \
+        KR_UTF8_TOO_SHORT_, KR_UTF8_TOO_SHORT_, KR_UTF8_TOO_SHORT_, KR_UTF8_TOO_SHORT_
+
+/* Anything above these in the last three bytes starts a sequence that runs
+   into the next block. */
+#define KR_UTF8_INCOMPLETE_                                                                                            \
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, KR_CASTS(char, 0xF0 - 1), KR_CASTS(char, 0xE0 - 1),            \
+        KR_CASTS(char, 0xC0 - 1)
+
+#if (KR_SSSE3)
+
+/* Bits are set in the result for every error in v, given the block before. */
+KR_INLINE __m128i kr_utf8_errors16_(__m128i v, __m128i prev)
+{
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i prev1 = _mm_alignr_epi8(v, prev, 15);
+    const __m128i prev2 = _mm_alignr_epi8(v, prev, 14);
+    const __m128i prev3 = _mm_alignr_epi8(v, prev, 13);
+    __m128i errors, must23;
+
+    errors = _mm_shuffle_epi8(_mm_setr_epi8(KR_UTF8_BYTE_1_HIGH_), _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble));
+    errors = _mm_and_si128(errors, _mm_shuffle_epi8(_mm_setr_epi8(KR_UTF8_BYTE_1_LOW_), _mm_and_si128(prev1, nibble)));
+    errors = _mm_and_si128(
+        errors, _mm_shuffle_epi8(_mm_setr_epi8(KR_UTF8_BYTE_2_HIGH_), _mm_and_si128(_mm_srli_epi16(v, 4), nibble)));
+
+    /* Only E0-FF two bytes back and F0-FF three bytes back end up >= 0x80. */
+    must23 = _mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80)),
+                          _mm_subs_epu8(prev3, _mm_set1_epi8(KR_CASTS(char, 0xF0 - 0x80))));
+    return _mm_xor_si128(errors, _mm_and_si128(must23, _mm_set1_epi8(KR_CASTS(char, 0x80))));
+}
+
+KR_INLINE size_t kr_utf8_validate_ssse3(const char *str, size_t len)
+{
+    const unsigned char *s = KR_CASTR(const unsigned char *, str);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i prev = zero, incomplete = zero;
+    size_t i = 0;
+
+    for (; len - i >= 16; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(KR_CASTR(const __m128i *, s + i));
+
+        if (_mm_movemask_epi8(v) == 0)
+        {
+            /* ASCII is only wrong if the last block left a sequence open. */
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(incomplete, zero)) != 0xFFFF)
+            {
+                break;
+            }
+        }
+        else
+        {
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(kr_utf8_errors16_(v, prev), zero)) != 0xFFFF)
+            {
+                break;
+            }
+            incomplete = _mm_subs_epu8(v, _mm_setr_epi8(KR_UTF8_INCOMPLETE_));
+        }
+        prev = v;
+    }
+
+    /* Also finds the exact position of an error in a failed block. */
+    return kr_utf8_validate_tail_(s, kr_utf8_restart_(s, i), len);
+}
+
+#endif /* (KR_SSSE3) */
+
+#if (KR_AVX2)
+
+KR_INLINE __m256i kr_utf8_errors32_(__m256i v, __m256i prev)
+{
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    /* Byte shifts work within each 128-bit lane, so line up the lane before
+       each one first. */
+    const __m256i before = _mm256_permute2x128_si256(prev, v, 0x21);
+    const __m256i prev1 = _mm256_alignr_epi8(v, before, 15);
+    const __m256i prev2 = _mm256_alignr_epi8(v, before, 14);
+    const __m256i prev3 = _mm256_alignr_epi8(v, before, 13);
+    __m256i errors, must23;
+
+    errors = _mm256_shuffle_epi8(_mm256_setr_epi8(KR_UTF8_BYTE_1_HIGH_, KR_UTF8_BYTE_1_HIGH_),
+                                 _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+    errors = _mm256_and_si256(errors, _mm256_shuffle_epi8(_mm256_setr_epi8(KR_UTF8_BYTE_1_LOW_, KR_UTF8_BYTE_1_LOW_),
+                                                          _mm256_and_si256(prev1, nibble)));
+    errors = _mm256_and_si256(errors, _mm256_shuffle_epi8(_mm256_setr_epi8(KR_UTF8_BYTE_2_HIGH_, KR_UTF8_BYTE_2_HIGH_),
+                                                          _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble)));
+
+    must23 = _mm256_or_si256(_mm256_subs_epu8(prev2, _mm256_set1_epi8(0xE0 - 0x80)),
+                             _mm256_subs_epu8(prev3, _mm256_set1_epi8(KR_CASTS(char, 0xF0 - 0x80))));
+    return _mm256_xor_si256(errors, _mm256_and_si256(must23, _mm256_set1_epi8(KR_CASTS(char, 0x80))));
+}
+
+KR_INLINE size_t kr_utf8_validate_avx2(const char *str, size_t len)
+{
+    const unsigned char *s = KR_CASTR(const unsigned char *, str);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i prev = zero, incomplete = zero;
+    size_t i = 0;
+
+    for (; len - i >= 32; i += 32)
+    {
+        const __m256i v = _mm256_loadu_si256(KR_CASTR(const __m256i *, s + i));
+
+        if (_mm256_movemask_epi8(v) == 0)
+        {
+            if (!_mm256_testz_si256(incomplete, incomplete))
+            {
+                break;
+            }
+        }
+        else
+        {
+            const __m256i errors = kr_utf8_errors32_(v, prev);
+            if (!_mm256_testz_si256(errors, errors))
+            {
+                break;
+            }
+            incomplete = _mm256_subs_epu8(v, _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                              -1, -1, KR_UTF8_INCOMPLETE_));
+        }
+        prev = v;
+    }
+
+    return kr_utf8_validate_tail_(s, kr_utf8_restart_(s, i), len);
+}
+
+#endif /* (KR_AVX2) */
+
+#undef KR_UTF8_TOO_SHORT_
+#undef KR_UTF8_TOO_LONG_
+#undef KR_UTF8_OVERLONG_3_
+#undef KR_UTF8_TOO_LARGE_
+#undef KR_UTF8_SURROGATE_
+#undef KR_UTF8_OVERLONG_2_
+#undef KR_UTF8_TOO_LARGE_1000_
+#undef KR_UTF8_OVERLONG_4_
+#undef KR_UTF8_TWO_CONTS_
+#undef KR_UTF8_CARRY_
+#undef KR_UTF8_BYTE_1_HIGH_
+#undef KR_UTF8_BYTE_1_LOW_
+#undef KR_UTF8_BYTE_2_HIGH_
+#undef KR_UTF8_INCOMPLETE_
+
+/******************************************************************************/
+
+KR_INLINE uint32_t kr_utf16_load_(const unsigned char *s, unsigned flags)
+{
+    return (flags & KR_UTF_BE) ? kr_load_u16be(KR_CASTC(unsigned char *, s))
+                               : kr_load_u16le(KR_CASTC(unsigned char *, s));
+}
+
+KR_INLINE void kr_utf16_store_(unsigned char *d, uint32_t unit, unsigned flags)
+{
+    if (flags & KR_UTF_BE)
+    {
+        kr_store_u16be(d, KR_CASTS(uint16_t, unit));
+    }
+    else
+    {
+        kr_store_u16le(d, KR_CASTS(uint16_t, unit));
+    }
+}
+
+KR_INLINE uint32_t kr_utf32_load_(const unsigned char *s, unsigned flags)
+{
+    return (flags & KR_UTF_BE) ? kr_load_u32be(KR_CASTC(unsigned char *, s))
+                               : kr_load_u32le(KR_CASTC(unsigned char *, s));
+}
+
+KR_INLINE void kr_utf32_store_(unsigned char *d, uint32_t unit, unsigned flags)
+{
+    if (flags & KR_UTF_BE)
+    {
+        kr_store_u32be(d, unit);
+    }
+    else
+    {
+        kr_store_u32le(d, unit);
+    }
+}
+
+/*
+ * Decode the well-formed sequence at s[i], and return its length, or 0 if it
+ * isn't one.  Checking the decoded value catches the same overlongs,
+ * surrogates and values past U+10FFFF as kr_utf8_sequence_.
+ */
+KR_INLINE size_t kr_utf8_next_(const unsigned char *s, size_t i, size_t len, uint32_t *outCp)
+{
+    const uint32_t lead = s[i];
+    uint32_t cp;
+
+    if (lead < 0x80)
+    {
+        *outCp = lead;
+        return 1;
+    }
+    else if (lead < 0xE0)
+    {
+        if (lead < 0xC2 || len - i < 2 || (s[i + 1] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+        *outCp = ((lead & 0x1F) << 6) | (s[i + 1] & 0x3F);
+        return 2;
+    }
+    else if (lead < 0xF0)
+    {
+        if (len - i < 3 || ((s[i + 1] & 0xC0) | ((s[i + 2] & 0xC0) >> 2)) != 0xA0)
+        {
+            return 0;
+        }
+        cp = ((lead & 0x0F) << 12) | (KR_CASTS(uint32_t, s[i + 1] & 0x3F) << 6) | (s[i + 2] & 0x3F);
+        if (cp < 0x800 || (cp & 0xF800) == 0xD800)
+        {
+            return 0;
+        }
+        *outCp = cp;
+        return 3;
+    }
+    else if (lead < 0xF5 && len - i >= 4 &&
+             ((s[i + 1] & 0xC0) | ((s[i + 2] & 0xC0) >> 2) | ((s[i + 3] & 0xC0) >> 4)) == 0xA8)
+    {
+        cp = ((lead & 0x07) << 18) | (KR_CASTS(uint32_t, s[i + 1] & 0x3F) << 12) |
+             (KR_CASTS(uint32_t, s[i + 2] & 0x3F) << 6) | (s[i + 3] & 0x3F);
+        if (cp < 0x10000 || cp > 0x10FFFF)
+        {
+            return 0;
+        }
+        *outCp = cp;
+        return 4;
+    }
+    return 0;
+}
+
+/* Write a valid code point as UTF-8, and return how many bytes it took. */
+KR_INLINE size_t kr_utf8_encode_(unsigned char *d, uint32_t cp)
+{
+    if (cp < 0x80)
+    {
+        d[0] = KR_CASTS(unsigned char, cp);
+        return 1;
+    }
+    else if (cp < 0x800)
+    {
+        d[0] = KR_CASTS(unsigned char, 0xC0 | (cp >> 6));
+        d[1] = KR_CASTS(unsigned char, 0x80 | (cp & 0x3F));
+        return 2;
+    }
+    else if (cp < 0x10000)
+    {
+        d[0] = KR_CASTS(unsigned char, 0xE0 | (cp >> 12));
+        d[1] = KR_CASTS(unsigned char, 0x80 | ((cp >> 6) & 0x3F));
+        d[2] = KR_CASTS(unsigned char, 0x80 | (cp & 0x3F));
+        return 3;
+    }
+
+    d[0] = KR_CASTS(unsigned char, 0xF0 | (cp >> 18));
+    d[1] = KR_CASTS(unsigned char, 0x80 | ((cp >> 12) & 0x3F));
+    d[2] = KR_CASTS(unsigned char, 0x80 | ((cp >> 6) & 0x3F));
+    d[3] = KR_CASTS(unsigned char, 0x80 | (cp & 0x3F));
+    return 4;
+}
+
+/*
+ * Count the bytes that start a sequence, plus the ones that start a four
+ * byte sequence if those need a pair of code units.  Continuation bytes are
+ * the only ones from 0x80 to 0xBF, which is below -64 signed.
+ */
+KR_INLINE size_t kr_utf8_units_(const unsigned char *s, size_t len, bool pairs)
+{
+    size_t i = 0, count = 0;
+
+#if (KR_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+
+    while (len - i >= 16)
+    {
+        /* Each byte counter goes up by at most 2 a block, so empty them
+           before they can overflow. */
+        __m128i counts = zero;
+        size_t blocks;
+
+        for (blocks = 0; blocks < 127 && len - i >= 16; blocks++, i += 16)
+        {
+            const __m128i v = _mm_loadu_si128(KR_CASTR(const __m128i *, s + i));
+            counts = _mm_sub_epi8(counts, _mm_cmpgt_epi8(v, _mm_set1_epi8(-65)));
+            if (pairs)
+            {
+                const __m128i lead4 = _mm_set1_epi8(KR_CASTS(char, 0xF0));
+                counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(_mm_max_epu8(v, lead4), v));
+            }
+        }
+
+        counts = _mm_sad_epu8(counts, zero);
+        count += KR_CASTS(size_t, _mm_cvtsi128_si32(counts)) +
+                 KR_CASTS(size_t, _mm_cvtsi128_si32(_mm_srli_si128(counts, 8)));
+    }
+#elif defined(UINT64_MAX)
+    const uint64_t ones = UINT64_C(0x0101010101010101);
+
+    for (; len - i >= 8; i += 8)
+    {
+        /* Bit 0 of each byte gets its own top bits, the sum lands in the
+           top byte. */
+        const uint64_t word = kr_load_u64le(KR_CASTC(unsigned char *, s + i));
+        uint64_t units = ((~word >> 7) | (word >> 6)) & ones;
+        if (pairs)
+        {
+            units += (word >> 7) & (word >> 6) & (word >> 5) & (word >> 4) & ones;
+        }
+        count += KR_CASTS(size_t, (units * ones) >> 56);
+    }
+#endif
+
+    for (; i < len; i++)
+    {
+        count += ((s[i] & 0xC0) != 0x80) + (pairs && s[i] >= 0xF0);
+    }
+    return count;
+}
+
+/*
+ * The ASCII fast paths convert whole blocks until one of them has anything
+ * else in it, and return how many code units that was.
+ */
+KR_INLINE size_t kr_utf8_ascii_to_utf16_(unsigned char *d, const unsigned char *s, size_t len, unsigned flags)
+{
+    size_t i = 0;
+
+#if (KR_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; len - i >= 16; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(KR_CASTR(const __m128i *, s + i));
+        if (_mm_movemask_epi8(v) != 0)
+        {
+            break;
+        }
+
+        /* Zero goes in the high byte of each unit, whichever end that is. */
+        if (flags & KR_UTF_BE)
+        {
+            _mm_storeu_si128(KR_CASTR(__m128i *, d + i * 2), _mm_unpacklo_epi8(zero, v));
+            _mm_storeu_si128(KR_CASTR(__m128i *, d + i * 2 + 16), _mm_unpackhi_epi8(zero, v));
+        }
+        else
+        {
+            _mm_storeu_si128(KR_CASTR(__m128i *, d + i * 2), _mm_unpacklo_epi8(v, zero));
+            _mm_storeu_si128(KR_CASTR(__m128i *, d + i * 2 + 16), _mm_unpackhi_epi8(v, zero));
+        }
+    }
+#elif defined(UINT64_MAX)
+    const unsigned shift = (flags & KR_UTF_BE) ? 8 : 0;
+
+    for (; len - i >= 8; i += 8)
+    {
+        const uint64_t word = kr_load_u64le(KR_CASTC(unsigned char *, s + i));
+        uint64_t lo = word & UINT64_C(0xFFFFFFFF), hi = word >> 32;
+        if ((word & UINT64_C(0x8080808080808080)) != 0)
+        {
+            break;
+        }
+
+        /* Spread each group of 4 bytes out to 16-bit lanes. */
+        lo = (lo | (lo << 16)) & UINT64_C(0x0000FFFF0000FFFF);
+        lo = (lo | (lo << 8)) & UINT64_C(0x00FF00FF00FF00FF);
+        hi = (hi | (hi << 16)) & UINT64_C(0x0000FFFF0000FFFF);
+        hi = (hi | (hi << 8)) & UINT64_C(0x00FF00FF00FF00FF);
+        kr_store_u64le(d + i * 2, lo << shift);
+        kr_store_u64le(d + i * 2 + 8, hi << shift);
+    }
+#else
+    (void)d;
+    (void)s;
+    (void)len;
+    (void)flags;
+#endif
+
+    return i;
+}
+
+KR_INLINE size_t kr_utf8_ascii_to_utf32_(unsigned char *d, const unsigned char *s, size_t len, unsigned flags)
+{
+    size_t i = 0;
+
+#if (KR_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; len - i >= 16; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(KR_CASTR(const __m128i *, s + i));
+        __m128i lo, hi;
+        if (_mm_movemask_epi8(v) != 0)
+        {
+            break;
+        }
+
+        if (flags & KR_UTF_BE)
+        {
+            lo = _mm_unpacklo_epi8(zero, v);
+            hi = _mm_unpackhi_epi8(zero, v);
+            _mm_storeu_si128(KR_CASTR(__m128i *, d + i * 4), _mm_unpacklo_epi16(zero, lo));
+            _mm_storeu_si128(KR_CASTR(__m128i *, d + i * 4 + 16), _mm_unpackhi_epi16(zero, lo));
+            _mm_storeu_si128(KR_CASTR(__m128i *, d + i * 4 + 32), _mm_unpacklo_epi16(zero, hi));
+            _mm_storeu_si128(KR_CASTR(__m128i *, d + i * 4 + 48), _mm_unpackhi_epi16(zero, hi));
+        }
+        else
+        {
+            lo = _mm_unpacklo_epi8(v, zero);
+            hi = _mm_unpackhi_epi8(v, zero);
+            _mm_storeu_si128(KR_CASTR(__m128i *, d + i * 4), _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128(KR_CASTR(__m128i *, d + i * 4 + 16), _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128(KR_CASTR(__m128i *, d + i * 4 + 32), _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128(KR_CASTR(__m128i *, d + i * 4 + 48), _mm_unpackhi_epi16(hi, zero));
+        }
+    }
+#elif defined(UINT64_MAX)
+    const unsigned shift = (flags & KR_UTF_BE) ? 24 : 0;
+    size_t j;
+
+    for (; len - i >= 8; i += 8)
+    {
+        const uint64_t word = kr_load_u64le(KR_CASTC(unsigned char *, s + i));
+        if ((word & UINT64_C(0x8080808080808080)) != 0)
+        {
+            break;
+        }
+
+        for (j = 0; j < 8; j += 2)
+        {
+            const uint64_t pair = (word >> (j * 8)) & 0xFFFF;
+            kr_store_u64le(d + (i + j) * 4, ((pair & 0xFF) | ((pair & 0xFF00) << 24)) << shift);
+        }
+    }
+#else
+    (void)d;
+    (void)s;
+    (void)len;
+    (void)flags;
+#endif
+
+    return i;
+}
+
+KR_INLINE size_t kr_utf16_ascii_to_utf8_(unsigned char *d, const unsigned char *s, size_t len, unsigned flags)
+{
+    size_t i = 0;
+
+#if (KR_SSE2)
+    /* Units are loaded little-endian, so big-endian ones are swapped. */
+    const __m128i high = _mm_set1_epi16(KR_CASTS(short, (flags & KR_UTF_BE) ? 0x80FF : 0xFF80));
+
+    for (; len - i >= 16; i += 16)
+    {
+        __m128i a = _mm_loadu_si128(KR_CASTR(const __m128i *, s + i * 2));
+        __m128i b = _mm_loadu_si128(KR_CASTR(const __m128i *, s + i * 2 + 16));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(_mm_or_si128(a, b), high), _mm_setzero_si128())) != 0xFFFF)
+        {
+            break;
+        }
+
+        if (flags & KR_UTF_BE)
+        {
+            a = _mm_srli_epi16(a, 8);
+            b = _mm_srli_epi16(b, 8);
+        }
+        _mm_storeu_si128(KR_CASTR(__m128i *, d + i), _mm_packus_epi16(a, b));
+    }
+#elif defined(UINT64_MAX)
+    const unsigned shift = (flags & KR_UTF_BE) ? 8 : 0;
+    const uint64_t high = (flags & KR_UTF_BE) ? UINT64_C(0x80FF80FF80FF80FF) : UINT64_C(0xFF80FF80FF80FF80);
+
+    for (; len - i >= 4; i += 4)
+    {
+        uint64_t word = kr_load_u64le(KR_CASTC(unsigned char *, s + i * 2));
+        if ((word & high) != 0)
+        {
+            break;
+        }
+
+        /* Gather the low byte of each 16-bit lane. */
+        word >>= shift;
+        word = (word | (word >> 8)) & UINT64_C(0x0000FFFF0000FFFF);
+        word = (word | (word >> 16)) & UINT64_C(0x00000000FFFFFFFF);
+        kr_store_u32le(d + i, KR_CASTS(uint32_t, word));
+    }
+#else
+    (void)d;
+    (void)s;
+    (void)len;
+    (void)flags;
+#endif
+
+    return i;
+}
+
+KR_INLINE size_t kr_utf32_ascii_to_utf8_(unsigned char *d, const unsigned char *s, size_t len, unsigned flags)
+{
+    size_t i = 0;
+
+#if (KR_SSE2)
+    const __m128i high = _mm_set1_epi32(KR_CASTS(int, (flags & KR_UTF_BE) ? 0x80FFFFFFu : 0xFFFFFF80u));
+
+    for (; len - i >= 16; i += 16)
+    {
+        __m128i a = _mm_loadu_si128(KR_CASTR(const __m128i *, s + i * 4));
+        __m128i b = _mm_loadu_si128(KR_CASTR(const __m128i *, s + i * 4 + 16));
+        __m128i c = _mm_loadu_si128(KR_CASTR(const __m128i *, s + i * 4 + 32));
+        __m128i e = _mm_loadu_si128(KR_CASTR(const __m128i *, s + i * 4 + 48));
+        const __m128i all = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, e));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(all, high), _mm_setzero_si128())) != 0xFFFF)
+        {
+            break;
+        }
+
+        if (flags & KR_UTF_BE)
+        {
+            a = _mm_srli_epi32(a, 24);
+            b = _mm_srli_epi32(b, 24);
+            c = _mm_srli_epi32(c, 24);
+            e = _mm_srli_epi32(e, 24);
+        }
+        _mm_storeu_si128(KR_CASTR(__m128i *, d + i), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, e)));
+    }
+#elif defined(UINT64_MAX)
+    const unsigned shift = (flags & KR_UTF_BE) ? 24 : 0;
+    const uint64_t high = (flags & KR_UTF_BE) ? UINT64_C(0x80FFFFFF80FFFFFF) : UINT64_C(0xFFFFFF80FFFFFF80);
+
+    for (; len - i >= 2; i += 2)
+    {
+        uint64_t word = kr_load_u64le(KR_CASTC(unsigned char *, s + i * 4));
+        if ((word & high) != 0)
+        {
+            break;
+        }
+
+        word >>= shift;
+        kr_store_u16le(d + i, KR_CASTS(uint16_t, word | (word >> 24)));
+    }
+#else
+    (void)d;
+    (void)s;
+    (void)len;
+    (void)flags;
+#endif
+
+    return i;
+}
+
+/*
+ * After a block that isn't all ASCII, convert one character at a time for
+ * at least a block, so mixed text doesn't keep retrying the fast path.
+ */
+#define KR_UTF_SLOW_BLOCK_ 16
+
+KR_INLINE size_t kr_utf8_to_utf16_length(const char *src, size_t len)
+{
+    return kr_utf8_units_(KR_CASTR(const unsigned char *, src), len, true);
+}
+
+KR_INLINE size_t kr_utf8_to_utf32_length(const char *src, size_t len)
+{
+    return kr_utf8_units_(KR_CASTR(const unsigned char *, src), len, false);
+}
+
+KR_INLINE size_t kr_utf16_to_utf8_length(const void *src, size_t len, unsigned flags)
+{
+    const unsigned char *s = KR_CASTS(const unsigned char *, src);
+    size_t i, count = 0;
+
+    for (i = 0; i < len; i++)
+    {
+        /* Each half of a surrogate pair is two of the four bytes. */
+        const uint32_t unit = kr_utf16_load_(s + i * 2, flags);
+        count += 1 + (unit >= 0x80) + (unit >= 0x800) - ((unit & 0xF800) == 0xD800);
+    }
+    return count;
+}
+
+KR_INLINE size_t kr_utf32_to_utf8_length(const void *src, size_t len, unsigned flags)
+{
+    const unsigned char *s = KR_CASTS(const unsigned char *, src);
+    size_t i, count = 0;
+
+    for (i = 0; i < len; i++)
+    {
+        const uint32_t unit = kr_utf32_load_(s + i * 4, flags);
+        count += 1 + (unit >= 0x80) + (unit >= 0x800) + (unit >= 0x10000);
+    }
+    return count;
+}
+
+KR_INLINE size_t kr_utf8_to_utf16(void *dest, size_t *outLen, const char *src, size_t len, unsigned flags)
+{
+    unsigned char *d = KR_CASTS(unsigned char *, dest);
+    const unsigned char *s = KR_CASTR(const unsigned char *, src);
+    size_t i = 0, o = 0, n, stop;
+    uint32_t cp;
+
+    while (i < len)
+    {
+        n = kr_utf8_ascii_to_utf16_(d + o * 2, s + i, len - i, flags);
+        i += n;
+        o += n;
+
+        for (stop = i + KR_UTF_SLOW_BLOCK_; i < len && i < stop; i += n)
+        {
+            n = kr_utf8_next_(s, i, len, &cp);
+            if (n == 0)
+            {
+                *outLen = o;
+                return i;
+            }
+
+            if (cp >= 0x10000)
+            {
+                kr_utf16_store_(d + o * 2, 0xD800 | ((cp - 0x10000) >> 10), flags);
+                o++;
+                cp = 0xDC00 | (cp & 0x3FF);
+            }
+            kr_utf16_store_(d + o * 2, cp, flags);
+            o++;
+        }
+    }
+
+    *outLen = o;
+    return i;
+}
+
+KR_INLINE size_t kr_utf8_to_utf32(void *dest, size_t *outLen, const char *src, size_t len, unsigned flags)
+{
+    unsigned char *d = KR_CASTS(unsigned char *, dest);
+    const unsigned char *s = KR_CASTR(const unsigned char *, src);
+    size_t i = 0, o = 0, n, stop;
+    uint32_t cp;
+
+    while (i < len)
+    {
+        n = kr_utf8_ascii_to_utf32_(d + o * 4, s + i, len - i, flags);
+        i += n;
+        o += n;
+
+        for (stop = i + KR_UTF_SLOW_BLOCK_; i < len && i < stop; i += n)
+        {
+            n = kr_utf8_next_(s, i, len, &cp);
+            if (n == 0)
+            {
+                *outLen = o;
+                return i;
+            }
+
+            kr_utf32_store_(d + o * 4, cp, flags);
+            o++;
+        }
+    }
+
+    *outLen = o;
+    return i;
+}
+
+KR_INLINE size_t kr_utf16_to_utf8(char *dest, size_t *outLen, const void *src, size_t len, unsigned flags)
+{
+    unsigned char *d = KR_CASTR(unsigned char *, dest);
+    const unsigned char *s = KR_CASTS(const unsigned char *, src);
+    size_t i = 0, o = 0, n, stop;
+    uint32_t cp, low;
+
+    while (i < len)
+    {
+        n = kr_utf16_ascii_to_utf8_(d + o, s + i * 2, len - i, flags);
+        i += n;
+        o += n;
+
+        for (stop = i + KR_UTF_SLOW_BLOCK_; i < len && i < stop; i += n)
+        {
+            cp = kr_utf16_load_(s + i * 2, flags);
+            n = 1;
+            if ((cp & 0xF800) == 0xD800)
+            {
+                /* Surrogates have to come in high-low pairs. */
+                low = (cp < 0xDC00 && len - i >= 2) ? kr_utf16_load_(s + i * 2 + 2, flags) : 0;
+                if ((low & 0xFC00) != 0xDC00)
+                {
+                    *outLen = o;
+                    return i;
+                }
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                n = 2;
+            }
+            o += kr_utf8_encode_(d + o, cp);
+        }
+    }
+
+    *outLen = o;
+    return i;
+}
+
+KR_INLINE size_t kr_utf32_to_utf8(char *dest, size_t *outLen, const void *src, size_t len, unsigned flags)
+{
+    unsigned char *d = KR_CASTR(unsigned char *, dest);
+    const unsigned char *s = KR_CASTS(const unsigned char *, src);
+    size_t i = 0, o = 0, n, stop;
+    uint32_t cp;
+
+    while (i < len)
+    {
+        n = kr_utf32_ascii_to_utf8_(d + o, s + i * 4, len - i, flags);
+        i += n;
+        o += n;
+
+        for (stop = i + KR_UTF_SLOW_BLOCK_; i < len && i < stop; i++)
+        {
+            cp = kr_utf32_load_(s + i * 4, flags);
+            if (cp > 0x10FFFF || (cp & 0xFFFFF800) == 0xD800)
+            {
+                *outLen = o;
+                return i;
+            }
+            o += kr_utf8_encode_(d + o, cp);
+        }
+    }
+
+    *outLen = o;
+    return i;
+}
+
+#undef KR_UTF_SLOW_BLOCK_
+
+/******************************************************************************/
+#endif /* !(KRUFT_CONFIG_USEIMPLEMENTATION) || defined(KRUFT_IMPLEMENTATION) */
+/******************************************************************************/
+
+#endif /* !defined(KRUTF8_H) */
@@ -37,6 +37,9 @@ int main()
     printf("KR_BYTE_ORDER: %d\n", KR_BYTE_ORDER);
     printf("KR_SIZEOF_POINTER: %d\n", KR_SIZEOF_POINTER);
     printf("KR_SIZEOF_PTRDIFF_T: %d\n", KR_SIZEOF_PTRDIFF_T);
+    printf("KR_SSE2: %d\n", KR_SSE2);
+    printf("KR_SSSE3: %d\n", KR_SSSE3);
+    printf("KR_AVX2: %d\n", KR_AVX2);
     printf("KR_CONSTEXPR: %s\n", XSTR(KR_CONSTEXPR));
     printf("KR_FORCEINLINE: %s\n", XSTR(KR_FORCEINLINE));
     printf("KR_INLINE: %s\n", XSTR(KR_INLINE));
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "zztest.h"
+
+#include "krarena.h"
+
+#include "krlib.h"
+
+TEST(arena, kr_arena_alloc)
+{
+    size_t i;
+    char *bytes;
+    double *d;
+    void *ptrs[64];
+    struct kr_arena_s arena;
+
+    kr_arena_init(&arena, 256);
+
+    /* Aligned allocations stay aligned after unaligned ones. */
+    bytes = (char *)kr_arena_alloc_unaligned(&arena, 3);
+    ASSERT_TRUE(bytes != NULL);
+    d = (double *)kr_arena_alloc(&arena, sizeof(double));
+    ASSERT_TRUE(d != NULL);
+    EXPECT_UINTEQ(0, (uintptr_t)d % sizeof(double));
+    *d = 1.5;
+
+    /* Many chunks, and a big allocation in the middle. */
+    for (i = 0; i < kr_countof(ptrs); i++)
+    {
+        ptrs[i] = kr_arena_alloc(&arena, i == 32 ? 1000 : 24);
+        ASSERT_TRUE(ptrs[i] != NULL);
+        EXPECT_UINTEQ(0, (uintptr_t)ptrs[i] % sizeof(void *));
+        memset(ptrs[i], (int)i, i == 32 ? 1000 : 24);
+    }
+    for (i = 0; i < kr_countof(ptrs); i++)
+    {
+        EXPECT_UINTEQ(i, ((unsigned char *)ptrs[i])[23]);
+    }
+    EXPECT_TRUE(*d == 1.5);
+
+    EXPECT_TRUE(kr_arena_alloc(&arena, (size_t)-1) == NULL);
+    EXPECT_TRUE(kr_arena_alloc_unaligned(&arena, 0) != NULL);
+    kr_arena_destroy(&arena);
+    EXPECT_TRUE(arena.chunks == NULL);
+}
+
+TEST(arena, kr_arena_reset)
+{
+    size_t i;
+    void *first, *again;
+    struct kr_arena_s arena;
+
+    kr_arena_init(&arena, 0);
+    first = kr_arena_alloc(&arena, 16);
+    ASSERT_TRUE(first != NULL);
+    for (i = 0; i < 100; i++)
+    {
+        ASSERT_TRUE(kr_arena_alloc(&arena, 100) != NULL);
+    }
+    ASSERT_TRUE(kr_arena_alloc(&arena, 10000) != NULL);
+
+    /* Reset keeps a single chunk to reuse. */
+    kr_arena_reset(&arena);
+    again = kr_arena_alloc(&arena, 16);
+    ASSERT_TRUE(again != NULL);
+    EXPECT_TRUE(arena.chunks == arena.current);
+    kr_arena_destroy(&arena);
+
+    /* Resetting an empty arena is fine too. */
+    kr_arena_reset(&arena);
+    EXPECT_TRUE(arena.chunks == NULL);
+}
+
+TEST(arena, kr_arena_strdup)
+{
+    char *a, *b, *c;
+    int *ints;
+    static const int src[] = {1, 2, 3, 4};
+    struct kr_arena_s arena;
+
+    kr_arena_init(&arena, 0);
+    a = kr_arena_strdup(&arena, "xyzzy");
+    b = kr_arena_strndup(&arena, "plugh", 3);
+    c = kr_arena_strndup(&arena, "ab", 16);
+    ints = (int *)kr_arena_memdup(&arena, src, sizeof(src));
+    ASSERT_TRUE(a != NULL && b != NULL && c != NULL && ints != NULL);
+    EXPECT_STREQ("xyzzy", a);
+    EXPECT_STREQ("plu", b);
+    EXPECT_STREQ("ab", c);
+    EXPECT_INTEQ(3, ints[2]);
+
+    /* Strings are packed without padding. */
+    EXPECT_TRUE(b == a + 6);
+    EXPECT_TRUE(c == b + 4);
+    kr_arena_destroy(&arena);
+}
+
+SUITE(arena)
+{
+    SUITE_TEST(arena, kr_arena_alloc);
+    SUITE_TEST(arena, kr_arena_reset);
+    SUITE_TEST(arena, kr_arena_strdup);
+}
@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <string.h>
+
+#include "zztest.h"
+
+#include "krbase64.h"
+
+#include "krlib.h"
+#include "krrand.h"
+
+/* One bit at a time, as simple as it gets. */
+static size_t base64_reference(char *dest, const unsigned char *src, size_t len, unsigned flags)
+{
+    const char *alphabet = (flags & KR_BASE64_URL) != 0
+                               ? "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+                               : "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t bit, out = 0;
+    unsigned value = 0;
+
+    for (bit = 0; bit < len * 8; bit += 6)
+    {
+        size_t j;
+        value = 0;
+        for (j = bit; j < bit + 6; j++)
+        {
+            value <<= 1;
+            if (j < len * 8)
+            {
+                value |= (src[j / 8] >> (7 - j % 8)) & 1;
+            }
+        }
+        dest[out++] = alphabet[value];
+    }
+    while ((flags & KR_BASE64_NOPAD) == 0 && out % 4 != 0)
+    {
+        dest[out++] = '=';
+    }
+    return out;
+}
+
+/* Every decoder agrees, and the stream decoder fed one character at a time. */
+static void base64_decode_check(struct zzt_test_state_s *zzt_test_state, const char *src, size_t len, unsigned flags,
+                                bool expected, size_t expectedLen)
+{
+    unsigned char first[128], actual[128];
+    size_t firstLen = 0, actualLen = 0, chunkLen = 0, i;
+    struct kr_base64_decode_ctx_s ctx;
+    bool ok = true;
+
+    EXPECT_TRUE(expected == kr_base64_decode(first, &firstLen, src, len, flags));
+    EXPECT_UINTEQ(expectedLen, firstLen);
+
+    EXPECT_TRUE(expected == kr_base64_decode_scalar(actual, &actualLen, src, len, flags));
+    EXPECT_UINTEQ(expectedLen, actualLen);
+    EXPECT_TRUE(memcmp(first, actual, actualLen) == 0);
+#if (KR_SSSE3)
+    EXPECT_TRUE(expected == kr_base64_decode_ssse3(actual, &actualLen, src, len, flags));
+    EXPECT_UINTEQ(expectedLen, actualLen);
+    EXPECT_TRUE(memcmp(first, actual, actualLen) == 0);
+#endif
+#if (KR_AVX2)
+    EXPECT_TRUE(expected == kr_base64_decode_avx2(actual, &actualLen, src, len, flags));
+    EXPECT_UINTEQ(expectedLen, actualLen);
+    EXPECT_TRUE(memcmp(first, actual, actualLen) == 0);
+#endif
+
+    kr_base64_decode_init(&ctx, flags);
+    actualLen = 0;
+    for (i = 0; i < len && ok; i++)
+    {
+        ok = kr_base64_decode_update(&ctx, actual + actualLen, &chunkLen, src + i, 1);
+        actualLen += chunkLen;
+    }
+    if (ok)
+    {
+        ok = kr_base64_decode_final(&ctx, actual + actualLen, &chunkLen);
+        actualLen += chunkLen;
+    }
+    EXPECT_TRUE(expected == ok);
+    if (expected)
+    {
+        EXPECT_UINTEQ(expectedLen, actualLen);
+        EXPECT_TRUE(memcmp(first, actual, actualLen) == 0);
+    }
+}
+
+TEST(base64, kr_base64_encode)
+{
+    static const char *const plain[] = {"", "f", "fo", "foo", "foob", "fooba", "foobar"};
+    static const char *const padded[] = {"", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==", "Zm9vYmE=", "Zm9vYmFy"};
+    static const char *const unpadded[] = {"", "Zg", "Zm8", "Zm9v", "Zm9vYg", "Zm9vYmE", "Zm9vYmFy"};
+    unsigned char bytes[100];
+    char expected[140], actual[140];
+    size_t i, len, expectedLen;
+    unsigned flags;
+
+    for (i = 0; i < kr_countof(plain); i++)
+    {
+        memset(actual, 0, sizeof(actual));
+        EXPECT_UINTEQ(strlen(padded[i]), kr_base64_encode(actual, plain[i], strlen(plain[i]), 0));
+        EXPECT_STREQ(padded[i], actual);
+
+        memset(actual, 0, sizeof(actual));
+        EXPECT_UINTEQ(strlen(unpadded[i]), kr_base64_encode(actual, plain[i], strlen(plain[i]), KR_BASE64_NOPAD));
+        EXPECT_STREQ(unpadded[i], actual);
+    }
+
+    bytes[0] = 0xFB;
+    bytes[1] = 0xFF;
+    memset(actual, 0, sizeof(actual));
+    EXPECT_UINTEQ(4, kr_base64_encode(actual, bytes, 2, 0));
+    EXPECT_STREQ("+/8=", actual);
+    memset(actual, 0, sizeof(actual));
+    EXPECT_UINTEQ(3, kr_base64_encode(actual, bytes, 2, KR_BASE64_URL | KR_BASE64_NOPAD));
+    EXPECT_STREQ("-_8", actual);
+
+    /* Every length through every tier, with all 64 values showing up. */
+    for (i = 0; i < sizeof(bytes); i++)
+    {
+        bytes[i] = (unsigned char)(i * 167 + 13);
+    }
+    for (flags = 0; flags < 4; flags++)
+    {
+        for (len = 0; len <= sizeof(bytes); len++)
+        {
+            expectedLen = base64_reference(expected, bytes, len, flags);
+            expected[expectedLen] = '\0';
+
+            memset(actual, 0, sizeof(actual));
+            EXPECT_UINTEQ(expectedLen, kr_base64_encode_scalar(actual, bytes, len, flags));
+            EXPECT_STREQ(expected, actual);
+#if (KR_SSSE3)
+            memset(actual, 0, sizeof(actual));
+            EXPECT_UINTEQ(expectedLen, kr_base64_encode_ssse3(actual, bytes, len, flags));
+            EXPECT_STREQ(expected, actual);
+#endif
+#if (KR_AVX2)
+            memset(actual, 0, sizeof(actual));
+            EXPECT_UINTEQ(expectedLen, kr_base64_encode_avx2(actual, bytes, len, flags));
+            EXPECT_STREQ(expected, actual);
+#endif
+        }
+    }
+}
+
+TEST(base64, kr_base64_decode)
+{
+    unsigned char bytes[16];
+    size_t len = 0;
+
+    base64_decode_check(zzt_test_state, "", 0, 0, true, 0);
+    base64_decode_check(zzt_test_state, "Zm9vYmFy", 8, 0, true, 6);
+    base64_decode_check(zzt_test_state, "Zm9vYmE=", 8, 0, true, 5);
+    base64_decode_check(zzt_test_state, "Zm9vYg==", 8, 0, true, 4);
+    base64_decode_check(zzt_test_state, "Zm9vYmE", 7, KR_BASE64_NOPAD, true, 5);
+    base64_decode_check(zzt_test_state, "Zm9vYg", 6, KR_BASE64_NOPAD, true, 4);
+    base64_decode_check(zzt_test_state, "-_8=", 4, KR_BASE64_URL, true, 2);
+
+    EXPECT_TRUE(kr_base64_decode(bytes, &len, "Zm9vYmE=", 8, 0));
+    EXPECT_TRUE(memcmp(bytes, "fooba", 5) == 0);
+
+    /* Padding has to be exactly where it belongs. */
+    base64_decode_check(zzt_test_state, "Zm9vYmE", 7, 0, false, 3);
+    base64_decode_check(zzt_test_state, "Zm9vYg=", 7, 0, false, 3);
+    base64_decode_check(zzt_test_state, "Zm9vYmE=", 8, KR_BASE64_NOPAD, false, 3);
+    base64_decode_check(zzt_test_state, "Zm9v=", 5, 0, false, 3);
+    base64_decode_check(zzt_test_state, "Zg==Zg==", 8, 0, false, 1);
+    base64_decode_check(zzt_test_state, "Zg==", 4, 0, true, 1);
+    base64_decode_check(zzt_test_state, "Z===", 4, 0, false, 0);
+    base64_decode_check(zzt_test_state, "====", 4, 0, false, 0);
+    base64_decode_check(zzt_test_state, "Zm=v", 4, 0, false, 0);
+    base64_decode_check(zzt_test_state, "Z", 1, KR_BASE64_NOPAD, false, 0);
+    base64_decode_check(zzt_test_state, "Zm9vY", 5, KR_BASE64_NOPAD, false, 3);
+
+    /* Unused bits have to be zero. */
+    base64_decode_check(zzt_test_state, "Zh==", 4, 0, false, 0);
+    base64_decode_check(zzt_test_state, "Zm9=", 4, 0, false, 0);
+    base64_decode_check(zzt_test_state, "Zh", 2, KR_BASE64_NOPAD, false, 0);
+
+    /* Characters from the wrong alphabet, and whitespace. */
+    base64_decode_check(zzt_test_state, "-_8=", 4, 0, false, 0);
+    base64_decode_check(zzt_test_state, "+/8=", 4, KR_BASE64_URL, false, 0);
+    base64_decode_check(zzt_test_state, "Zm9v YmFy", 9, 0, false, 3);
+    base64_decode_check(zzt_test_state, "Zm9vYmFy\n", 9, 0, false, 6);
+}
+
+TEST(base64, kr_base64_decode_invalid)
+{
+    static const char bad[] = {'=', '-', '_', '*', '.', ' ', '\0', '@', '[', '`', '{', '\x80', '\xAB', '\xFF'};
+    unsigned char bytes[75];
+    char src[101];
+    size_t len, pos, i;
+
+    for (i = 0; i < sizeof(bytes); i++)
+    {
+        bytes[i] = (unsigned char)(i * 89 + 7);
+    }
+
+    /* Every bad character at every position, in and around each block of
+       every tier. */
+    for (len = 4; len <= 100; len += 4)
+    {
+        kr_base64_encode(src, bytes, len / 4 * 3, 0);
+        base64_decode_check(zzt_test_state, src, len, 0, true, len / 4 * 3);
+
+        for (pos = 0; pos < len; pos++)
+        {
+            for (i = 0; i < kr_countof(bad); i++)
+            {
+                const char saved = src[pos];
+                if (bad[i] == '=' && pos % 4 == 3)
+                {
+                    /* Could be valid padding, tested above. */
+                    continue;
+                }
+                src[pos] = bad[i];
+                base64_decode_check(zzt_test_state, src, len, 0, false, pos / 4 * 3);
+                src[pos] = saved;
+            }
+        }
+    }
+}
+
+TEST(base64, kr_base64_stream)
+{
+    unsigned char bytes[500], decoded[500];
+    char encoded[700], streamed[700];
+    struct kr_jsf32_ctx_s rand;
+    struct kr_base64_encode_ctx_s enc;
+    struct kr_base64_decode_ctx_s dec;
+    size_t i, j, len, encodedLen, chunk, pos, out, chunkLen;
+    unsigned flags;
+
+    kr_jsf32_srand(&rand, 0x423634);
+    for (i = 0; i < 300; i++)
+    {
+        flags = (unsigned)(i % 4);
+        len = kr_jsf32_rand_uniform(&rand, (uint32_t)sizeof(bytes));
+        for (j = 0; j < len; j++)
+        {
+            bytes[j] = (unsigned char)kr_jsf32_rand(&rand);
+        }
+        encodedLen = kr_base64_encode(encoded, bytes, len, flags);
+
+        /* Chunks split at random points. */
+        kr_base64_encode_init(&enc, flags);
+        for (pos = 0, out = 0; pos < len; pos += chunk)
+        {
+            chunk = kr_jsf32_rand_uniform(&rand, 70);
+            chunk = chunk < len - pos ? chunk : len - pos;
+            out += kr_base64_encode_update(&enc, streamed + out, bytes + pos, chunk);
+        }
+        out += kr_base64_encode_final(&enc, streamed + out);
+        EXPECT_UINTEQ(encodedLen, out);
+        EXPECT_TRUE(memcmp(encoded, streamed, encodedLen) == 0);
+
+        kr_base64_decode_init(&dec, flags);
+        for (pos = 0, out = 0; pos < encodedLen; pos += chunk)
+        {
+            chunk = kr_jsf32_rand_uniform(&rand, 90);
+            chunk = chunk < encodedLen - pos ? chunk : encodedLen - pos;
+            EXPECT_TRUE(kr_base64_decode_update(&dec, decoded + out, &chunkLen, encoded + pos, chunk));
+            out += chunkLen;
+        }
+        EXPECT_TRUE(kr_base64_decode_final(&dec, decoded + out, &chunkLen));
+        out += chunkLen;
+        EXPECT_UINTEQ(len, out);
+        EXPECT_TRUE(memcmp(bytes, decoded, len) == 0);
+    }
+
+    /* Anything after padding, even in a later chunk. */
+    kr_base64_decode_init(&dec, 0);
+    EXPECT_TRUE(kr_base64_decode_update(&dec, decoded, &chunkLen, "Zm8=", 4));
+    EXPECT_UINTEQ(2, chunkLen);
+    EXPECT_FALSE(kr_base64_decode_update(&dec, decoded, &chunkLen, "Zm9v", 4));
+
+    /* A group cut short at the end. */
+    kr_base64_decode_init(&dec, 0);
+    EXPECT_TRUE(kr_base64_decode_update(&dec, decoded, &chunkLen, "Zm9vYm", 6));
+    EXPECT_UINTEQ(3, chunkLen);
+    EXPECT_FALSE(kr_base64_decode_final(&dec, decoded, &chunkLen));
+}
+
+SUITE(base64)
+{
+    SUITE_TEST(base64, kr_base64_encode);
+    SUITE_TEST(base64, kr_base64_decode);
+    SUITE_TEST(base64, kr_base64_decode_invalid);
+    SUITE_TEST(base64, kr_base64_stream);
+}
@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "zztest.h"
+
+#include "krconv.h"
+
+#include "krlib.h"
+
+TEST(conv, kr_parse_u32)
+{
+    uint32_t res;
+    bool overflow;
+
+    EXPECT_UINTEQ(3, kr_parse_u32(&res, "123", 3, &overflow));
+    EXPECT_UINTEQ(123, res);
+    EXPECT_FALSE(overflow);
+
+    /* Stops at non-digits and at len. */
+    EXPECT_UINTEQ(2, kr_parse_u32(&res, "42abc", 5, &overflow));
+    EXPECT_UINTEQ(42, res);
+    EXPECT_UINTEQ(4, kr_parse_u32(&res, "123456789", 4, &overflow));
+    EXPECT_UINTEQ(1234, res);
+    EXPECT_UINTEQ(0, kr_parse_u32(&res, "-1", 2, &overflow));
+    EXPECT_UINTEQ(0, res);
+    EXPECT_UINTEQ(0, kr_parse_u32(&res, " 1", 2, NULL));
+    EXPECT_UINTEQ(0, kr_parse_u32(&res, "", 0, NULL));
+
+    EXPECT_UINTEQ(10, kr_parse_u32(&res, "4294967295", 10, &overflow));
+    EXPECT_UINTEQ(UINT32_MAX, res);
+    EXPECT_FALSE(overflow);
+    EXPECT_UINTEQ(10, kr_parse_u32(&res, "4294967296", 10, &overflow));
+    EXPECT_UINTEQ(0, res);
+    EXPECT_TRUE(overflow);
+
+    /* Leading zeroes don't count towards overflow. */
+    EXPECT_UINTEQ(24, kr_parse_u32(&res, "000000000000004294967295", 24, &overflow));
+    EXPECT_UINTEQ(UINT32_MAX, res);
+    EXPECT_FALSE(overflow);
+}
+
+TEST(conv, kr_parse_i32)
+{
+    int32_t res;
+    bool overflow;
+
+    EXPECT_UINTEQ(4, kr_parse_i32(&res, "-123", 4, &overflow));
+    EXPECT_INTEQ(-123, res);
+    EXPECT_FALSE(overflow);
+    EXPECT_UINTEQ(3, kr_parse_i32(&res, "+12", 3, &overflow));
+    EXPECT_INTEQ(12, res);
+
+    /* A sign alone is not a number. */
+    EXPECT_UINTEQ(0, kr_parse_i32(&res, "-x", 2, &overflow));
+    EXPECT_UINTEQ(0, kr_parse_i32(&res, "-", 1, &overflow));
+    EXPECT_UINTEQ(0, kr_parse_i32(&res, "--1", 3, &overflow));
+
+    EXPECT_UINTEQ(11, kr_parse_i32(&res, "-2147483648", 11, &overflow));
+    EXPECT_INTEQ(INT32_MIN, res);
+    EXPECT_FALSE(overflow);
+    EXPECT_UINTEQ(10, kr_parse_i32(&res, "2147483647", 10, &overflow));
+    EXPECT_INTEQ(INT32_MAX, res);
+    EXPECT_FALSE(overflow);
+    EXPECT_UINTEQ(10, kr_parse_i32(&res, "2147483648", 10, &overflow));
+    EXPECT_TRUE(overflow);
+    EXPECT_UINTEQ(11, kr_parse_i32(&res, "-2147483649", 11, &overflow));
+    EXPECT_TRUE(overflow);
+}
+
+TEST(conv, kr_parse_u64)
+{
+#if !defined(UINT64_MAX)
+    SKIP();
+#else
+    static const char digits[] = "98765432109876543210";
+    size_t i, j;
+    uint64_t res, expected;
+    bool overflow;
+    char buf[32];
+
+    /* Every length, with and without something after, to hit every path
+       through the eight digit blocks. */
+    for (i = 0; i < sizeof(digits) - 1; i++)
+    {
+        expected = 0;
+        for (j = 0; j < i; j++)
+        {
+            buf[j] = digits[j];
+            expected = expected * 10 + (uint64_t)(digits[j] - '0');
+        }
+        memset(buf + i, ':', sizeof(buf) - i);
+
+        EXPECT_UINTEQ(i, kr_parse_u64(&res, buf, i, &overflow));
+        EXPECT_UINTEQ(expected, res);
+        EXPECT_FALSE(overflow);
+        EXPECT_UINTEQ(i, kr_parse_u64(&res, buf, sizeof(buf), &overflow));
+        EXPECT_UINTEQ(expected, res);
+        EXPECT_FALSE(overflow);
+    }
+
+    EXPECT_UINTEQ(20, kr_parse_u64(&res, "18446744073709551615", 20, &overflow));
+    EXPECT_UINTEQ(UINT64_MAX, res);
+    EXPECT_FALSE(overflow);
+    EXPECT_UINTEQ(20, kr_parse_u64(&res, "18446744073709551616", 20, &overflow));
+    EXPECT_UINTEQ(0, res);
+    EXPECT_TRUE(overflow);
+    EXPECT_UINTEQ(20, kr_parse_u64(&res, "98765432109876543210", 20, &overflow));
+    EXPECT_TRUE(overflow);
+    EXPECT_UINTEQ(30, kr_parse_u64(&res, "000000000018446744073709551615", 30, &overflow));
+    EXPECT_UINTEQ(UINT64_MAX, res);
+    EXPECT_FALSE(overflow);
+#endif /* !defined(UINT64_MAX) */
+}
+
+TEST(conv, kr_parse_i64)
+{
+#if !defined(UINT64_MAX)
+    SKIP();
+#else
+    int64_t res;
+    bool overflow;
+
+    EXPECT_UINTEQ(20, kr_parse_i64(&res, "-9223372036854775808", 20, &overflow));
+    EXPECT_TRUE(res == INT64_MIN);
+    EXPECT_FALSE(overflow);
+    EXPECT_UINTEQ(20, kr_parse_i64(&res, "+9223372036854775807", 20, &overflow));
+    EXPECT_TRUE(res == INT64_MAX);
+    EXPECT_FALSE(overflow);
+    EXPECT_UINTEQ(19, kr_parse_i64(&res, "9223372036854775808", 19, &overflow));
+    EXPECT_TRUE(overflow);
+    EXPECT_UINTEQ(20, kr_parse_i64(&res, "-9223372036854775809", 20, &overflow));
+    EXPECT_TRUE(overflow);
+    EXPECT_UINTEQ(9, kr_parse_i64(&res, "-12345678.5", 11, &overflow));
+    EXPECT_INTEQ(-12345678, res);
+    EXPECT_FALSE(overflow);
+#endif /* !defined(UINT64_MAX) */
+}
+
+TEST(conv, kr_parse_hex)
+{
+    uint32_t res32;
+    bool overflow;
+
+    EXPECT_UINTEQ(8, kr_parse_hex_u32(&res32, "DEADbeefg", 9, &overflow));
+    EXPECT_UINTEQ(0xDEADBEEF, res32);
+    EXPECT_FALSE(overflow);
+    EXPECT_UINTEQ(0, kr_parse_hex_u32(&res32, "0x10", 0, &overflow));
+    EXPECT_UINTEQ(1, kr_parse_hex_u32(&res32, "0x10", 4, &overflow));
+    EXPECT_UINTEQ(9, kr_parse_hex_u32(&res32, "123456789", 9, &overflow));
+    EXPECT_UINTEQ(0x23456789, res32);
+    EXPECT_TRUE(overflow);
+
+#if defined(UINT64_MAX)
+    {
+        uint64_t res64;
+        EXPECT_UINTEQ(16, kr_parse_hex_u64(&res64, "ffffffffffffffff", 16, &overflow));
+        EXPECT_UINTEQ(UINT64_MAX, res64);
+        EXPECT_FALSE(overflow);
+        EXPECT_UINTEQ(17, kr_parse_hex_u64(&res64, "10000000000000000", 17, &overflow));
+        EXPECT_TRUE(overflow);
+    }
+#endif /* defined(UINT64_MAX) */
+}
+
+TEST(conv, kr_parse_oct)
+{
+    uint32_t res32;
+    bool overflow;
+
+    EXPECT_UINTEQ(3, kr_parse_oct_u32(&res32, "7558", 4, &overflow));
+    EXPECT_UINTEQ(0755, res32);
+    EXPECT_FALSE(overflow);
+    EXPECT_UINTEQ(11, kr_parse_oct_u32(&res32, "37777777777", 11, &overflow));
+    EXPECT_UINTEQ(UINT32_MAX, res32);
+    EXPECT_FALSE(overflow);
+    EXPECT_UINTEQ(11, kr_parse_oct_u32(&res32, "40000000000", 11, &overflow));
+    EXPECT_TRUE(overflow);
+
+#if defined(UINT64_MAX)
+    {
+        uint64_t res64;
+        EXPECT_UINTEQ(22, kr_parse_oct_u64(&res64, "1777777777777777777777", 22, &overflow));
+        EXPECT_UINTEQ(UINT64_MAX, res64);
+        EXPECT_FALSE(overflow);
+        EXPECT_UINTEQ(22, kr_parse_oct_u64(&res64, "2000000000000000000000", 22, &overflow));
+        EXPECT_TRUE(overflow);
+    }
+#endif /* defined(UINT64_MAX) */
+}
+
+TEST(conv, kr_u32toa)
+{
+    char buf[KR_CONV_32_SIZE];
+    uint32_t value, parsed;
+    unsigned i;
+
+    EXPECT_UINTEQ(1, kr_u32toa(buf, 0));
+    EXPECT_STREQ("0", buf);
+    EXPECT_UINTEQ(10, kr_u32toa(buf, UINT32_MAX));
+    EXPECT_STREQ("4294967295", buf);
+
+    /* Either side of every digit count. */
+    for (i = 0, value = 1; i < 10; i++, value *= 10)
+    {
+        EXPECT_UINTEQ(i + 1, kr_u32toa(buf, value));
+        EXPECT_UINTEQ(i + 1, kr_parse_u32(&parsed, buf, sizeof(buf), NULL));
+        EXPECT_UINTEQ(value, parsed);
+        EXPECT_UINTEQ(i == 0 ? 1 : i, kr_u32toa(buf, value - 1));
+        EXPECT_UINTEQ(i == 0 ? 1 : i, kr_parse_u32(&parsed, buf, sizeof(buf), NULL));
+        EXPECT_UINTEQ(value - 1, parsed);
+    }
+
+    EXPECT_UINTEQ(11, kr_i32toa(buf, INT32_MIN));
+    EXPECT_STREQ("-2147483648", buf);
+    EXPECT_UINTEQ(2, kr_i32toa(buf, -7));
+    EXPECT_STREQ("-7", buf);
+    EXPECT_UINTEQ(10, kr_i32toa(buf, INT32_MAX));
+    EXPECT_STREQ("2147483647", buf);
+
+    EXPECT_UINTEQ(1, kr_u32toa_hex(buf, 0));
+    EXPECT_STREQ("0", buf);
+    EXPECT_UINTEQ(8, kr_u32toa_hex(buf, 0xDEADBEEF));
+    EXPECT_STREQ("deadbeef", buf);
+    EXPECT_UINTEQ(3, kr_u32toa_hex(buf, 0x100));
+    EXPECT_STREQ("100", buf);
+
+    EXPECT_UINTEQ(5, kr_u32toa_pad(buf, 42, 5));
+    EXPECT_STREQ("00042", buf);
+    EXPECT_UINTEQ(1, kr_u32toa_pad(buf, 0, 0));
+    EXPECT_STREQ("0", buf);
+    EXPECT_UINTEQ(6, kr_u32toa_pad(buf, 123456, 3));
+    EXPECT_STREQ("123456", buf);
+}
+
+TEST(conv, kr_u64toa)
+{
+#if !defined(UINT64_MAX)
+    SKIP();
+#else
+    char buf[KR_CONV_64_SIZE];
+    uint64_t value, parsed;
+    unsigned i;
+
+    EXPECT_UINTEQ(20, kr_u64toa(buf, UINT64_MAX));
+    EXPECT_STREQ("18446744073709551615", buf);
+
+    for (i = 0, value = 1; i < 20; i++, value *= 10)
+    {
+        EXPECT_UINTEQ(i + 1, kr_u64toa(buf, value));
+        EXPECT_UINTEQ(i + 1, kr_parse_u64(&parsed, buf, sizeof(buf), NULL));
+        EXPECT_UINTEQ(value, parsed);
+        EXPECT_UINTEQ(i == 0 ? 1 : i, kr_u64toa(buf, value - 1));
+        EXPECT_UINTEQ(i == 0 ? 1 : i, kr_parse_u64(&parsed, buf, sizeof(buf), NULL));
+        EXPECT_UINTEQ(value - 1, parsed);
+    }
+
+    EXPECT_UINTEQ(20, kr_i64toa(buf, INT64_MIN));
+    EXPECT_STREQ("-9223372036854775808", buf);
+    EXPECT_UINTEQ(19, kr_i64toa(buf, INT64_MAX));
+    EXPECT_STREQ("9223372036854775807", buf);
+    EXPECT_UINTEQ(1, kr_i64toa(buf, 0));
+    EXPECT_STREQ("0", buf);
+
+    EXPECT_UINTEQ(16, kr_u64toa_hex(buf, UINT64_MAX));
+    EXPECT_STREQ("ffffffffffffffff", buf);
+    EXPECT_UINTEQ(9, kr_u64toa_hex(buf, UINT64_C(0x123456789)));
+    EXPECT_STREQ("123456789", buf);
+
+    EXPECT_UINTEQ(20, kr_u64toa_pad(buf, 1234567890, 20));
+    EXPECT_STREQ("00000000001234567890", buf);
+#endif /* !defined(UINT64_MAX) */
+}
+
+SUITE(conv)
+{
+    SUITE_TEST(conv, kr_parse_u32);
+    SUITE_TEST(conv, kr_parse_i32);
+    SUITE_TEST(conv, kr_parse_u64);
+    SUITE_TEST(conv, kr_parse_i64);
+    SUITE_TEST(conv, kr_parse_hex);
+    SUITE_TEST(conv, kr_parse_oct);
+    SUITE_TEST(conv, kr_u32toa);
+    SUITE_TEST(conv, kr_u64toa);
+}
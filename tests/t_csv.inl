@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <string.h>
+
+#include "zztest.h"
+
+#include "krcsv.h"
+
+#include "krlib.h"
+#include "krrand.h"
+
+/* One byte at a time over the whole buffer. */
+static size_t csv_reference(const char *buf, size_t len, char delim, struct kr_csv_field_s *fields)
+{
+    size_t i, count = 0, start = 0;
+    bool inQuotes = false, quoted = false, atStart = true, atRowStart = true;
+
+    for (i = 0; i < len; i++)
+    {
+        if (atStart)
+        {
+            quoted = buf[i] == '"';
+            atStart = false;
+        }
+        if (buf[i] == '"')
+        {
+            inQuotes = !inQuotes;
+        }
+        else if (!inQuotes && (buf[i] == delim || buf[i] == '\n'))
+        {
+            fields[count].offset = start;
+            fields[count].length = i - start;
+            fields[count].flags = (quoted ? KR_CSV_QUOTED : 0) | (buf[i] == '\n' ? KR_CSV_ROWEND : 0);
+            if (buf[i] == '\n' && i > start && buf[i - 1] == '\r')
+            {
+                fields[count].length -= 1;
+            }
+            count += 1;
+            start = i + 1;
+            quoted = false;
+            atStart = true;
+            atRowStart = buf[i] == '\n';
+        }
+    }
+
+    if (!atRowStart || start != len)
+    {
+        fields[count].offset = start;
+        fields[count].length = len - start;
+        fields[count].flags = (quoted ? KR_CSV_QUOTED : 0) | KR_CSV_ROWEND;
+        count += 1;
+    }
+    return count;
+}
+
+static void csv_compare(struct zzt_test_state_s *zzt_test_state, const struct kr_csv_field_s *expected,
+                        size_t expectedLen, const struct kr_csv_field_s *actual, size_t actualLen)
+{
+    size_t i;
+
+    EXPECT_UINTEQ(expectedLen, actualLen);
+    for (i = 0; i < expectedLen && i < actualLen; i++)
+    {
+        EXPECT_UINTEQ(expected[i].offset, actual[i].offset);
+        EXPECT_UINTEQ(expected[i].length, actual[i].length);
+        EXPECT_UINTEQ(expected[i].flags, actual[i].flags);
+    }
+}
+
+/* The same fields, in a single pass and fed in random chunks to a random
+   number of fields at a time. */
+static void csv_check(struct zzt_test_state_s *zzt_test_state, struct kr_jsf32_ctx_s *ctx, const char *buf,
+                      size_t len, char delim)
+{
+    struct kr_csv_field_s expected[512], actual[512];
+    struct kr_csv_s csv;
+    size_t expectedLen, actualLen, pos = 0;
+
+    memset(expected, 0, sizeof(expected));
+    memset(actual, 0, sizeof(actual));
+    expectedLen = csv_reference(buf, len, delim, expected);
+    actualLen = kr_csv_parse(buf, len, delim, actual, kr_countof(actual));
+    csv_compare(zzt_test_state, expected, expectedLen, actual, actualLen);
+
+    kr_csv_init(&csv, delim);
+    actualLen = 0;
+    while (pos < len)
+    {
+        const size_t chunkLen = kr_jsf32_rand_uniform(ctx, (uint32_t)(len - pos)) + 1;
+        const size_t fieldsLen = kr_jsf32_rand_uniform(ctx, 4) + 1;
+        size_t consumed;
+
+        actualLen += kr_csv_feed(&csv, buf + pos, chunkLen, actual + actualLen, fieldsLen, &consumed);
+        pos += consumed;
+    }
+    if (kr_csv_finish(&csv, actual + actualLen))
+    {
+        actualLen += 1;
+    }
+    csv_compare(zzt_test_state, expected, expectedLen, actual, actualLen);
+}
+
+TEST(csv, kr_csv_parse)
+{
+    static const char csv[] = "a,\"b,c\"\r\n\"d\"\"\ne\",\n\nxyz";
+    struct kr_csv_field_s fields[8];
+    size_t count;
+
+    count = kr_csv_parse(csv, sizeof(csv) - 1, ',', fields, kr_countof(fields));
+    EXPECT_UINTEQ(6, count);
+    EXPECT_UINTEQ(0, fields[0].offset);
+    EXPECT_UINTEQ(1, fields[0].length);
+    EXPECT_UINTEQ(0, fields[0].flags);
+    EXPECT_UINTEQ(2, fields[1].offset);
+    EXPECT_UINTEQ(5, fields[1].length);
+    EXPECT_UINTEQ(KR_CSV_QUOTED | KR_CSV_ROWEND, fields[1].flags);
+    EXPECT_UINTEQ(9, fields[2].offset);
+    EXPECT_UINTEQ(7, fields[2].length);
+    EXPECT_UINTEQ(KR_CSV_QUOTED, fields[2].flags);
+    EXPECT_UINTEQ(17, fields[3].offset);
+    EXPECT_UINTEQ(0, fields[3].length);
+    EXPECT_UINTEQ(KR_CSV_ROWEND, fields[3].flags);
+    EXPECT_UINTEQ(18, fields[4].offset);
+    EXPECT_UINTEQ(0, fields[4].length);
+    EXPECT_UINTEQ(KR_CSV_ROWEND, fields[4].flags);
+    EXPECT_UINTEQ(19, fields[5].offset);
+    EXPECT_UINTEQ(3, fields[5].length);
+    EXPECT_UINTEQ(KR_CSV_ROWEND, fields[5].flags);
+
+    /* A full array stops after the last field that fits. */
+    EXPECT_UINTEQ(2, kr_csv_parse(csv, sizeof(csv) - 1, ',', fields, 2));
+    EXPECT_UINTEQ(5, fields[1].length);
+
+    /* Nothing after the last newline isn't another row. */
+    EXPECT_UINTEQ(0, kr_csv_parse("", 0, ',', fields, kr_countof(fields)));
+    EXPECT_UINTEQ(2, kr_csv_parse("a;b\n", 4, ';', fields, kr_countof(fields)));
+    EXPECT_UINTEQ(3, kr_csv_parse("a;b;", 4, ';', fields, kr_countof(fields)));
+    EXPECT_UINTEQ(KR_CSV_ROWEND, fields[2].flags);
+}
+
+TEST(csv, kr_csv_parse_random)
+{
+    static const char alphabet[] = "abc,,;\"\"\r\n";
+    char buf[400];
+    struct kr_jsf32_ctx_s ctx;
+    size_t i, j, len;
+
+    kr_jsf32_srand(&ctx, 0x43535631);
+    for (i = 0; i < 2000; i++)
+    {
+        /* Long runs without quotes or separators now and then, so that
+           whole blocks are skipped over. */
+        const uint32_t plainOdds = kr_jsf32_rand_uniform(&ctx, 3) * 16;
+        len = kr_jsf32_rand_uniform(&ctx, kr_countof(buf) + 1);
+        for (j = 0; j < len; j++)
+        {
+            const uint32_t pick = kr_jsf32_rand_uniform(&ctx, sizeof(alphabet) - 1 + plainOdds);
+            buf[j] = pick < sizeof(alphabet) - 1 ? alphabet[pick] : 'x';
+        }
+
+        csv_check(zzt_test_state, &ctx, buf, len, ',');
+        csv_check(zzt_test_state, &ctx, buf, len, ';');
+    }
+}
+
+TEST(csv, kr_csv_unquote)
+{
+    char buf[32];
+
+    strcpy(buf, "\"a,\"\"b\"\"\nc\"");
+    EXPECT_UINTEQ(7, kr_csv_unquote(buf, buf, strlen(buf)));
+    EXPECT_TRUE(memcmp(buf, "a,\"b\"\nc", 7) == 0);
+
+    EXPECT_UINTEQ(0, kr_csv_unquote(buf, "\"\"", 2));
+    EXPECT_UINTEQ(1, kr_csv_unquote(buf, "\"\"\"\"", 4));
+    EXPECT_CHAREQ('"', buf[0]);
+
+    /* Unterminated, trailing junk and not quoted at all. */
+    EXPECT_UINTEQ(3, kr_csv_unquote(buf, "\"abc", 4));
+    EXPECT_TRUE(memcmp(buf, "abc", 3) == 0);
+    EXPECT_UINTEQ(4, kr_csv_unquote(buf, "\"ab\"cd", 6));
+    EXPECT_TRUE(memcmp(buf, "abcd", 4) == 0);
+    EXPECT_UINTEQ(4, kr_csv_unquote(buf, "ab\"c", 4));
+    EXPECT_TRUE(memcmp(buf, "ab\"c", 4) == 0);
+    EXPECT_UINTEQ(0, kr_csv_unquote(buf, "", 0));
+}
+
+SUITE(csv)
+{
+    SUITE_TEST(csv, kr_csv_parse);
+    SUITE_TEST(csv, kr_csv_parse_random);
+    SUITE_TEST(csv, kr_csv_unquote);
+}
@@ -0,0 +1,400 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "zztest.h"
+
+#include "krfloat.h"
+
+#include "krctype.h"
+#include "krlib.h"
+#include "krrand.h"
+
+#if defined(UINT64_MAX)
+
+/* Compare bits and length consumed against the host strtod. */
+static void float_check64(struct zzt_test_state_s *zzt_test_state, const char *str)
+{
+    double res, expected;
+    uint64_t resBits, expectedBits;
+    char *end;
+    size_t count;
+
+    count = kr_parse_f64(&res, str, strlen(str));
+    expected = strtod(str, &end);
+    memcpy(&resBits, &res, sizeof(resBits));
+    memcpy(&expectedBits, &expected, sizeof(expectedBits));
+
+    EXPECT_XINTEQ(expectedBits, resBits);
+    EXPECT_UINTEQ((size_t)(end - str), count);
+}
+
+static uint32_t float_bits32(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/* Significant digits in a formatted number. */
+static size_t float_digits(const char *str)
+{
+    size_t digits = 0, zeroes = 0;
+
+    for (; *str != '\0' && *str != 'e'; str++)
+    {
+        if (kr_isdigit(*str) && (digits != 0 || *str != '0'))
+        {
+            digits++;
+            zeroes = *str == '0' ? zeroes + 1 : 0;
+        }
+    }
+    return digits - zeroes;
+}
+
+#endif /* defined(UINT64_MAX) */
+
+TEST(float, kr_parse_f64)
+{
+#if !defined(UINT64_MAX)
+    SKIP();
+#else
+    static const char *const strs[] = {
+        "0",
+        "-0",
+        "+1.5",
+        ".5",
+        "5.",
+        "007",
+        "0.000000000000000000000000000000000000000000001",
+        "1e10",
+        "1E-5",
+        "3.14159",
+        "1e",
+        "1e+",
+        "2e-x",
+        "123.456e-2z",
+        "1.7976931348623157e308",
+        "1.7976931348623158e308",
+        "1.7976931348623159e308",
+        "1e400",
+        "-1e400",
+        "1e-400",
+        "4.9406564584124654e-324",
+        "2.4703282292062327e-324",
+        "2.4703282292062328e-324",
+        "2.2250738585072011e-308",
+        "2.2250738585072014e-308",
+        "9007199254740993",
+        "9007199254740993.0000000000000000000001",
+        "9007199254740992.9999999999999999999999",
+        "123456789012345678901234567890",
+        "0.1000000000000000055511151231257827021181583404541015625",
+        "0.1000000000000000055511151231257827021181583404541015624",
+        "0.1000000000000000055511151231257827021181583404541015626",
+        "7.2057594037927933e16",
+        "1e23",
+        "8.988465674311580536566680e307",
+        "1000000000000000000000000000000000000000000000000000000000000e-61",
+    };
+    size_t i;
+    double res;
+
+    for (i = 0; i < kr_countof(strs); i++)
+    {
+        float_check64(zzt_test_state, strs[i]);
+    }
+
+    /* Nothing to parse. */
+    EXPECT_UINTEQ(0, kr_parse_f64(&res, "", 0));
+    EXPECT_UINTEQ(0, kr_parse_f64(&res, "-", 1));
+    EXPECT_UINTEQ(0, kr_parse_f64(&res, ".", 1));
+    EXPECT_UINTEQ(0, kr_parse_f64(&res, "-.e1", 4));
+    EXPECT_UINTEQ(0, kr_parse_f64(&res, " 1", 2));
+
+    /* Length is respected. */
+    EXPECT_UINTEQ(3, kr_parse_f64(&res, "1.25", 3));
+    EXPECT_TRUE(res == 1.2);
+    EXPECT_UINTEQ(1, kr_parse_f64(&res, "1e5", 2));
+    EXPECT_TRUE(res == 1.0);
+
+    /* No hexadecimal floats, unlike strtod. */
+    EXPECT_UINTEQ(1, kr_parse_f64(&res, "0x10", 4));
+    EXPECT_TRUE(res == 0.0);
+#endif /* !defined(UINT64_MAX) */
+}
+
+TEST(float, kr_parse_f64_special)
+{
+#if !defined(UINT64_MAX)
+    SKIP();
+#else
+    double res;
+
+    EXPECT_UINTEQ(3, kr_parse_f64(&res, "inf", 3));
+    EXPECT_TRUE(res > 1e308);
+    EXPECT_UINTEQ(9, kr_parse_f64(&res, "-Infinity", 9));
+    EXPECT_TRUE(res < -1e308);
+    EXPECT_UINTEQ(4, kr_parse_f64(&res, "+INFin", 6));
+    EXPECT_UINTEQ(3, kr_parse_f64(&res, "NaN", 3));
+    EXPECT_TRUE(res != res);
+    EXPECT_UINTEQ(0, kr_parse_f64(&res, "in", 2));
+#endif /* !defined(UINT64_MAX) */
+}
+
+TEST(float, kr_parse_f64_random)
+{
+#if !defined(UINT64_MAX)
+    SKIP();
+#else
+    size_t i, j;
+    struct kr_jsf64_ctx_s ctx;
+    char buf[128];
+
+    kr_jsf64_srand(&ctx, 0x466C6F6174);
+
+    /* Every kind of double, printed exactly and with fewer digits. */
+    for (i = 0; i < 20000; i++)
+    {
+        const uint64_t bits = kr_jsf64_rand(&ctx);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (value != value || value - value != 0)
+        {
+            continue;
+        }
+
+        sprintf(buf, "%.17g", value);
+        float_check64(zzt_test_state, buf);
+        sprintf(buf, "%.*e", (int)kr_jsf64_rand_uniform(&ctx, 25), value);
+        float_check64(zzt_test_state, buf);
+    }
+
+    /* Long random digit strings land near halfway points often enough to
+       exercise the slow path. */
+    for (i = 0; i < 20000; i++)
+    {
+        const size_t digits = 1 + (size_t)kr_jsf64_rand_uniform(&ctx, 60);
+        const size_t dot = (size_t)kr_jsf64_rand_uniform(&ctx, digits + 1);
+        char *p = buf;
+
+        for (j = 0; j < digits; j++)
+        {
+            if (j == dot)
+            {
+                *p++ = '.';
+            }
+            *p++ = (char)('0' + kr_jsf64_rand_uniform(&ctx, 10));
+        }
+        sprintf(p, "e%d", (int)kr_jsf64_rand_uniform(&ctx, 700) - 350);
+        float_check64(zzt_test_state, buf);
+    }
+#endif /* !defined(UINT64_MAX) */
+}
+
+TEST(float, kr_parse_f32)
+{
+#if !defined(UINT64_MAX)
+    SKIP();
+#else
+    size_t i;
+    float res;
+    struct kr_jsf32_ctx_s ctx;
+    char buf[64];
+
+    EXPECT_UINTEQ(3, kr_parse_f32(&res, "1.5", 3));
+    EXPECT_TRUE(res == 1.5f);
+
+    /* Halfway cases round to even. */
+    EXPECT_UINTEQ(8, kr_parse_f32(&res, "16777217", 8));
+    EXPECT_XINTEQ(float_bits32(16777216.0f), float_bits32(res));
+    EXPECT_UINTEQ(8, kr_parse_f32(&res, "16777219", 8));
+    EXPECT_XINTEQ(float_bits32(16777220.0f), float_bits32(res));
+    EXPECT_UINTEQ(29, kr_parse_f32(&res, "16777217.00000000000000000001", 29));
+    EXPECT_XINTEQ(float_bits32(16777218.0f), float_bits32(res));
+
+    /* Rounding straight to float, not through double. */
+    EXPECT_UINTEQ(19, kr_parse_f32(&res, "1.00000005960464477", 19));
+    EXPECT_XINTEQ(0x3F800000, float_bits32(res));
+    EXPECT_UINTEQ(20, kr_parse_f32(&res, "1.000000059604644776", 20));
+    EXPECT_XINTEQ(0x3F800001, float_bits32(res));
+
+    EXPECT_UINTEQ(14, kr_parse_f32(&res, "3.40282346e+38", 14));
+    EXPECT_XINTEQ(0x7F7FFFFF, float_bits32(res));
+    EXPECT_UINTEQ(12, kr_parse_f32(&res, "3.4028236e38", 12));
+    EXPECT_XINTEQ(0x7F800000, float_bits32(res));
+    EXPECT_UINTEQ(7, kr_parse_f32(&res, "1.4e-45", 7));
+    EXPECT_XINTEQ(0x00000001, float_bits32(res));
+    EXPECT_UINTEQ(5, kr_parse_f32(&res, "7e-46", 5));
+    EXPECT_XINTEQ(0x00000000, float_bits32(res));
+    EXPECT_UINTEQ(4, kr_parse_f32(&res, "-nan", 4));
+    EXPECT_TRUE(res != res);
+
+    /* Nine digits are enough to round trip any float. */
+    kr_jsf32_srand(&ctx, 0x466C74);
+    for (i = 0; i < 20000; i++)
+    {
+        const uint32_t bits = kr_jsf32_rand(&ctx);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        if (value != value || value - value != 0)
+        {
+            continue;
+        }
+
+        sprintf(buf, "%.9g", (double)value);
+        EXPECT_UINTEQ(strlen(buf), kr_parse_f32(&res, buf, strlen(buf)));
+        EXPECT_XINTEQ(bits, float_bits32(res));
+    }
+#endif /* !defined(UINT64_MAX) */
+}
+
+TEST(float, kr_f64toa)
+{
+#if !defined(UINT64_MAX)
+    SKIP();
+#else
+    static const struct
+    {
+        double value;
+        const char *expected;
+    } cases[] = {
+        {0.0, "0"},
+        {-0.0, "-0"},
+        {1.0, "1"},
+        {-2.5, "-2.5"},
+        {0.1, "0.1"},
+        {0.3, "0.3"},
+        {100.0, "100"},
+        {123.456, "123.456"},
+        {1e20, "100000000000000000000"},
+        {1e21, "1e+21"},
+        {123456789012345680000.0, "123456789012345680000"},
+        {1e-6, "0.000001"},
+        {1.5e-7, "1.5e-7"},
+        {-2.5e-5, "-0.000025"},
+        {9007199254740993.0, "9007199254740992"},
+        {1e23, "1e+23"},
+        {5e-324, "5e-324"},
+        {2.2250738585072014e-308, "2.2250738585072014e-308"},
+        {1.7976931348623157e308, "1.7976931348623157e+308"},
+    };
+    size_t i;
+    char buf[KR_FLOAT_64_SIZE];
+
+    for (i = 0; i < kr_countof(cases); i++)
+    {
+        EXPECT_UINTEQ(strlen(cases[i].expected), kr_f64toa(buf, cases[i].value));
+        EXPECT_STREQ(cases[i].expected, buf);
+    }
+
+    EXPECT_UINTEQ(3, kr_f64toa(buf, strtod("inf", NULL)));
+    EXPECT_STREQ("inf", buf);
+    EXPECT_UINTEQ(4, kr_f64toa(buf, strtod("-inf", NULL)));
+    EXPECT_STREQ("-inf", buf);
+    EXPECT_UINTEQ(3, kr_f64toa(buf, strtod("nan", NULL)));
+    EXPECT_STREQ("nan", buf);
+#endif /* !defined(UINT64_MAX) */
+}
+
+TEST(float, kr_f64toa_random)
+{
+#if !defined(UINT64_MAX)
+    SKIP();
+#else
+    size_t i, count, digits;
+    struct kr_jsf64_ctx_s ctx;
+    char buf[KR_FLOAT_64_SIZE], shorter[32];
+
+    kr_jsf64_srand(&ctx, 0x53686F7274);
+
+    for (i = 0; i < 20000; i++)
+    {
+        uint64_t bits = kr_jsf64_rand(&ctx);
+        double value, res;
+
+        /* Subnormals and short mantissas are worth extra attention. */
+        bits = i % 3 == 1 ? bits & UINT64_C(0x800FFFFFFFFFFFFF) : bits;
+        bits = i % 3 == 2 ? bits & UINT64_C(0xFFF00000000000FF) : bits;
+        memcpy(&value, &bits, sizeof(value));
+        if (value != value || value - value != 0)
+        {
+            continue;
+        }
+
+        count = kr_f64toa(buf, value);
+        EXPECT_UINTEQ(strlen(buf), count);
+        EXPECT_UINTEQ(count, kr_parse_f64(&res, buf, count));
+        EXPECT_TRUE(memcmp(&res, &value, sizeof(res)) == 0);
+        EXPECT_TRUE(strtod(buf, NULL) == value);
+
+        /* Shortest means one digit less can't round trip. */
+        digits = float_digits(buf);
+        EXPECT_TRUE(digits <= 17);
+        if (digits > 1)
+        {
+            sprintf(shorter, "%.*e", (int)digits - 2, value);
+            EXPECT_TRUE(strtod(shorter, NULL) != value);
+        }
+    }
+#endif /* !defined(UINT64_MAX) */
+}
+
+TEST(float, kr_f32toa)
+{
+#if !defined(UINT64_MAX)
+    SKIP();
+#else
+    size_t i, count;
+    struct kr_jsf32_ctx_s ctx;
+    char buf[KR_FLOAT_32_SIZE];
+    float res;
+
+    EXPECT_UINTEQ(3, kr_f32toa(buf, 0.1f));
+    EXPECT_STREQ("0.1", buf);
+    EXPECT_UINTEQ(8, kr_f32toa(buf, 16777216.0f));
+    EXPECT_STREQ("16777216", buf);
+    EXPECT_UINTEQ(13, kr_f32toa(buf, 3.4028235e38f));
+    EXPECT_STREQ("3.4028235e+38", buf);
+    EXPECT_UINTEQ(5, kr_f32toa(buf, 1e-45f));
+    EXPECT_STREQ("1e-45", buf);
+    EXPECT_UINTEQ(21, kr_f32toa(buf, 1e20f));
+    EXPECT_STREQ("100000000000000000000", buf);
+
+    kr_jsf32_srand(&ctx, 0x5368);
+    for (i = 0; i < 20000; i++)
+    {
+        const uint32_t bits = kr_jsf32_rand(&ctx);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        if (value != value || value - value != 0)
+        {
+            continue;
+        }
+
+        count = kr_f32toa(buf, value);
+        EXPECT_UINTEQ(strlen(buf), count);
+        EXPECT_UINTEQ(count, kr_parse_f32(&res, buf, count));
+        EXPECT_XINTEQ(bits, float_bits32(res));
+    }
+#endif /* !defined(UINT64_MAX) */
+}
+
+SUITE(float)
+{
+    SUITE_TEST(float, kr_parse_f64);
+    SUITE_TEST(float, kr_parse_f64_special);
+    SUITE_TEST(float, kr_parse_f64_random);
+    SUITE_TEST(float, kr_parse_f32);
+    SUITE_TEST(float, kr_f64toa);
+    SUITE_TEST(float, kr_f64toa_random);
+    SUITE_TEST(float, kr_f32toa);
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "zztest.h"
+
+#include "krfmt.h"
+
+#include "krarg.h"
+#include "krlib.h"
+#include "krrand.h"
+
+/* Compare against the host vsprintf, which is only C89. */
+static void fmt_check(struct zzt_test_state_s *zzt_test_state, const char *fmt, ...)
+{
+    char expected[512], actual[512];
+    int expectedLen, actualLen;
+    va_list args, copy;
+
+    va_start(args, fmt);
+    va_copy(copy, args);
+    expectedLen = vsprintf(expected, fmt, args);
+    actualLen = kr_vsnprintf(actual, sizeof(actual), fmt, copy);
+    va_end(copy);
+    va_end(args);
+
+    EXPECT_INTEQ(expectedLen, actualLen);
+    EXPECT_STREQ(expected, actual);
+}
+
+TEST(fmt, kr_snprintf_int)
+{
+    int dummy = 0;
+
+    fmt_check(zzt_test_state, "%d %d %d", 0, 42, -42);
+    fmt_check(zzt_test_state, "%d %d", INT_MAX, INT_MIN);
+    fmt_check(zzt_test_state, "%i|%5d|%-5d|%05d|%+d|% d|%+05d", 1, 2, 3, -4, 5, 6, -7);
+    fmt_check(zzt_test_state, "%.3d|%.0d|%5.0d|%-8.4d|%08.3d", 7, 0, 0, -12, 12);
+    fmt_check(zzt_test_state, "%u %u %5u %-5u|", 0u, UINT_MAX, 12u, 34u);
+    fmt_check(zzt_test_state, "%x %X %#x %#X %#x %08x %#010x", 0xBEEFu, 0xBEEFu, 0xBEEFu, 0xBEEFu, 0u, 0xABu, 0xABu);
+    fmt_check(zzt_test_state, "%o %#o %#o %#.0o %#5o %.4o", 8u, 8u, 0u, 0u, 9u, 9u);
+    fmt_check(zzt_test_state, "%hhd %hhu %hd %hu", 300, 300, 70000, 70000);
+    fmt_check(zzt_test_state, "%ld %ld %lu %lx", LONG_MAX, LONG_MIN, ULONG_MAX, ULONG_MAX);
+    fmt_check(zzt_test_state, "%zu %zx", (size_t)-1, (size_t)1234);
+    fmt_check(zzt_test_state, "%td %td", (ptrdiff_t)-1234, (ptrdiff_t)1234);
+    fmt_check(zzt_test_state, "%*d|%-*d|%*d|%.*d|%.*d", 6, 1, 6, 2, -6, 3, 4, 4, -1, 5);
+    fmt_check(zzt_test_state, "%p", (void *)&dummy);
+#if defined(LLONG_MAX)
+    fmt_check(zzt_test_state, "%lld %lld %llu %llx", LLONG_MAX, LLONG_MIN, ULLONG_MAX, ULLONG_MAX);
+#endif
+}
+
+TEST(fmt, kr_snprintf_str)
+{
+    char buf[32];
+
+    fmt_check(zzt_test_state, "%s|%10s|%-10s|%.3s|%10.2s|%.10s", "xyzzy", "xyzzy", "xyzzy", "xyzzy", "xyzzy", "xyzzy");
+    fmt_check(zzt_test_state, "%c%c%3c%-3c|", 'o', 'k', 'x', 'y');
+    fmt_check(zzt_test_state, "100%% %s", "");
+    fmt_check(zzt_test_state, "no conversions");
+    fmt_check(zzt_test_state, "");
+
+    EXPECT_INTEQ(6, kr_snprintf(buf, sizeof(buf), "%s", (char *)NULL));
+    EXPECT_STREQ("(null)", buf);
+}
+
+TEST(fmt, kr_snprintf_truncate)
+{
+    char buf[8];
+
+    memset(buf, 'x', sizeof(buf));
+    EXPECT_INTEQ(11, kr_snprintf(buf, sizeof(buf), "hello %s", "world"));
+    EXPECT_STREQ("hello w", buf);
+
+    memset(buf, 'x', sizeof(buf));
+    EXPECT_INTEQ(12, kr_snprintf(buf, sizeof(buf), "%12d", 1));
+    EXPECT_STREQ("       ", buf);
+
+    memset(buf, 'x', sizeof(buf));
+    EXPECT_INTEQ(5, kr_snprintf(buf, 1, "%d", 12345));
+    EXPECT_STREQ("", buf);
+    EXPECT_TRUE(buf[1] == 'x');
+
+    EXPECT_INTEQ(5, kr_snprintf(NULL, 0, "%d", 12345));
+    EXPECT_INTEQ(7, kr_snprintf(buf, sizeof(buf), "%d", 1234567));
+    EXPECT_STREQ("1234567", buf);
+}
+
+TEST(fmt, kr_snprintf_float)
+{
+#if (KR_CONFIG_NOFLOAT) || !defined(UINT64_MAX)
+    SKIP();
+#else
+    static const char *const fmts[] = {
+        "%e",   "%.0e",   "%#.0e", "%.17e", "%+.3E", "%f",    "%.0f", "%#.0f", "%.3f",  "%.20f", "%012.3f", "%-12.2f|",
+        "%F",   "%g",     "%.0g",  "%#.4g", "%.17g", "%G",    "%+g",  "% g",   "%012g", "%#.3g", "%.10g",   "%Le",
+    };
+    static const double values[] = {
+        0.0,  1.0,      0.1,     0.5,      1.5,    2.5,     0.125,    123456.0, 999999.5, 1e-5,
+        1e21, 1e-300,   5e-324,  1.7976931348623157e308, 100.0, 0.0001, 0.00001, 123.456, 9.5, 0.95,
+    };
+    size_t i, j;
+    struct kr_jsf64_ctx_s ctx;
+    char buf[32];
+
+    for (i = 0; i < kr_countof(fmts); i++)
+    {
+        for (j = 0; j < kr_countof(values); j++)
+        {
+            if (fmts[i][1] == 'L')
+            {
+                fmt_check(zzt_test_state, fmts[i], (long double)values[j]);
+                continue;
+            }
+            fmt_check(zzt_test_state, fmts[i], values[j]);
+            fmt_check(zzt_test_state, fmts[i], -values[j]);
+        }
+    }
+
+    fmt_check(zzt_test_state, "%f %F %e %g %5f|%-5e|%05g", 1e308 * 10, -1e308 * 10, 1e308 * 10, -1e308 * 10,
+              1e308 * 10, 1e308 * 10, 1e308 * 10);
+    fmt_check(zzt_test_state, "%f %.3f", 1e300, 1e-300);
+    fmt_check(zzt_test_state, "%#g %#g %#g", 1.0, 0.0001, 123456789.0);
+
+    /* Some versions of glibc lose the zeroes when rounding carries into
+       another digit. */
+    EXPECT_INTEQ(11, kr_snprintf(buf, sizeof(buf), "%#g", 999999.5));
+    EXPECT_STREQ("1.00000e+06", buf);
+    fmt_check(zzt_test_state, "%.*f %.*e", 7, 1.0 / 3.0, -1, 1.0 / 3.0);
+
+    /* Random bits cover every exponent, and random precisions every place
+       the rounding can land. */
+    kr_jsf64_srand(&ctx, 0x466D74);
+    for (i = 0; i < 5000; i++)
+    {
+        const uint64_t bits = kr_jsf64_rand(&ctx);
+        const int precision = (int)kr_jsf64_rand_uniform(&ctx, 20);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (value != value)
+        {
+            continue;
+        }
+
+        fmt_check(zzt_test_state, "%.*e|%.*g", precision, value, precision, value);
+        if (value > -1e100 && value < 1e100)
+        {
+            fmt_check(zzt_test_state, "%.*f", precision, value);
+        }
+    }
+#endif
+}
+
+TEST(fmt, kr_snprintf_unsupported)
+{
+    char buf[16];
+    int count = 0;
+
+    EXPECT_INTEQ(-1, kr_snprintf(buf, sizeof(buf), "%a", 1.0));
+    EXPECT_INTEQ(-1, kr_snprintf(buf, sizeof(buf), "%"));
+    EXPECT_INTEQ(-1, kr_snprintf(buf, sizeof(buf), "x%ny", &count));
+    EXPECT_STREQ("x", buf);
+}
+
+SUITE(fmt)
+{
+    SUITE_TEST(fmt, kr_snprintf_int);
+    SUITE_TEST(fmt, kr_snprintf_str);
+    SUITE_TEST(fmt, kr_snprintf_truncate);
+    SUITE_TEST(fmt, kr_snprintf_float);
+    SUITE_TEST(fmt, kr_snprintf_unsupported);
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "zztest.h"
+
+#include "krhex.h"
+
+#include "krlib.h"
+#include "krrand.h"
+
+/* Run every decoder on the same input, and check they agree on everything. */
+static void hex_decode_check(struct zzt_test_state_s *zzt_test_state, const char *src, size_t len, size_t expected)
+{
+    unsigned char expectedBytes[80], actual[80];
+    size_t i;
+
+    memset(expectedBytes, 0xAA, sizeof(expectedBytes));
+    for (i = 0; i + 1 < expected; i += 2)
+    {
+        unsigned value = 0;
+        sscanf(src + i, "%2x", &value);
+        expectedBytes[i / 2] = (unsigned char)value;
+    }
+
+    memset(actual, 0xAA, sizeof(actual));
+    EXPECT_UINTEQ(expected, kr_hex_decode(actual, src, len));
+    EXPECT_TRUE(memcmp(expectedBytes, actual, sizeof(actual)) == 0);
+
+    memset(actual, 0xAA, sizeof(actual));
+    EXPECT_UINTEQ(expected, kr_hex_decode_swar(actual, src, len));
+    EXPECT_TRUE(memcmp(expectedBytes, actual, sizeof(actual)) == 0);
+#if (KR_SSE2)
+    memset(actual, 0xAA, sizeof(actual));
+    EXPECT_UINTEQ(expected, kr_hex_decode_sse2(actual, src, len));
+    EXPECT_TRUE(memcmp(expectedBytes, actual, sizeof(actual)) == 0);
+#endif
+#if (KR_AVX2)
+    memset(actual, 0xAA, sizeof(actual));
+    EXPECT_UINTEQ(expected, kr_hex_decode_avx2(actual, src, len));
+    EXPECT_TRUE(memcmp(expectedBytes, actual, sizeof(actual)) == 0);
+#endif
+}
+
+TEST(hex, kr_hex_encode)
+{
+    unsigned char bytes[256];
+    char expected[513], actual[513];
+    size_t i, len;
+    int upper;
+
+    for (i = 0; i < sizeof(bytes); i++)
+    {
+        bytes[i] = (unsigned char)(i * 167 + 13);
+    }
+
+    for (upper = 0; upper < 2; upper++)
+    {
+        for (len = 0; len <= 80; len++)
+        {
+            for (i = 0; i < len; i++)
+            {
+                sprintf(expected + i * 2, upper ? "%02X" : "%02x", bytes[i]);
+            }
+            expected[len * 2] = '\0';
+
+            memset(actual, 0, sizeof(actual));
+            EXPECT_UINTEQ(len * 2, kr_hex_encode(actual, bytes, len, upper != 0));
+            EXPECT_STREQ(expected, actual);
+
+            memset(actual, 0, sizeof(actual));
+            EXPECT_UINTEQ(len * 2, kr_hex_encode_swar(actual, bytes, len, upper != 0));
+            EXPECT_STREQ(expected, actual);
+#if (KR_SSE2)
+            memset(actual, 0, sizeof(actual));
+            EXPECT_UINTEQ(len * 2, kr_hex_encode_sse2(actual, bytes, len, upper != 0));
+            EXPECT_STREQ(expected, actual);
+#endif
+#if (KR_AVX2)
+            memset(actual, 0, sizeof(actual));
+            EXPECT_UINTEQ(len * 2, kr_hex_encode_avx2(actual, bytes, len, upper != 0));
+            EXPECT_STREQ(expected, actual);
+#endif
+        }
+    }
+
+    /* Every byte value, through the widest tier. */
+    for (i = 0; i < sizeof(bytes); i++)
+    {
+        bytes[i] = (unsigned char)i;
+        sprintf(expected + i * 2, "%02X", (unsigned)i);
+    }
+    memset(actual, 0, sizeof(actual));
+    EXPECT_UINTEQ(512, kr_hex_encode(actual, bytes, sizeof(bytes), true));
+    EXPECT_STREQ(expected, actual);
+}
+
+TEST(hex, kr_hex_decode)
+{
+    unsigned char bytes[4];
+
+    hex_decode_check(zzt_test_state, "", 0, 0);
+    hex_decode_check(zzt_test_state, "00ff7F80", 8, 8);
+    hex_decode_check(zzt_test_state, "0123456789abcdefABCDEF", 22, 22);
+    hex_decode_check(zzt_test_state, "0123456789abcdefABCDEF0123456789abcdefABCDEF0123456789", 54, 54);
+    hex_decode_check(zzt_test_state, "abc", 3, 2);
+    hex_decode_check(zzt_test_state, "0x12", 4, 1);
+    hex_decode_check(zzt_test_state, "12 34", 5, 2);
+
+    /* Length is respected, even with valid digits past it. */
+    EXPECT_UINTEQ(2, kr_hex_decode(bytes, "dead", 2));
+    EXPECT_UINTEQ(0xDE, bytes[0]);
+}
+
+TEST(hex, kr_hex_decode_invalid)
+{
+    static const char bad[] = {'/', ':', '@', 'G', '`', 'g', ' ', '\0', '\x80', '\xB0', '\xC1', '\xE6', '\xFF'};
+    char src[81];
+    size_t len, pos, i;
+
+    /* Every bad character at every position of every length, which lands in
+       and around each block of every tier. */
+    for (len = 1; len <= 80; len++)
+    {
+        for (i = 0; i < len; i++)
+        {
+            src[i] = "0123456789abcdefABCDEF"[(i * 7) % 22];
+        }
+        hex_decode_check(zzt_test_state, src, len, len & ~(size_t)1);
+
+        for (pos = 0; pos < len; pos++)
+        {
+            for (i = 0; i < kr_countof(bad); i++)
+            {
+                const char saved = src[pos];
+                src[pos] = bad[i];
+                hex_decode_check(zzt_test_state, src, len, pos);
+                src[pos] = saved;
+            }
+        }
+    }
+}
+
+TEST(hex, kr_hex_roundtrip)
+{
+    unsigned char bytes[300], decoded[300];
+    char encoded[600];
+    struct kr_jsf32_ctx_s ctx;
+    size_t i, j, len;
+
+    kr_jsf32_srand(&ctx, 0x486578);
+    for (i = 0; i < 200; i++)
+    {
+        len = kr_jsf32_rand_uniform(&ctx, (uint32_t)sizeof(bytes));
+        for (j = 0; j < len; j++)
+        {
+            bytes[j] = (unsigned char)kr_jsf32_rand(&ctx);
+        }
+
+        EXPECT_UINTEQ(len * 2, kr_hex_encode(encoded, bytes, len, (i & 1) != 0));
+        EXPECT_UINTEQ(len * 2, kr_hex_decode(decoded, encoded, len * 2));
+        EXPECT_TRUE(memcmp(bytes, decoded, len) == 0);
+    }
+}
+
+SUITE(hex)
+{
+    SUITE_TEST(hex, kr_hex_encode);
+    SUITE_TEST(hex, kr_hex_decode);
+    SUITE_TEST(hex, kr_hex_decode_invalid);
+    SUITE_TEST(hex, kr_hex_roundtrip);
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "zztest.h"
+
+#include "krini.h"
+
+#include "krlib.h"
+#include "krrand.h"
+
+static bool ini_value_is(const struct kr_ini_s *ini, const char *section, const char *key, const char *expected)
+{
+    size_t len = 0;
+    const char *value = kr_ini_get(ini, section, key, &len);
+
+    return value != NULL && len == strlen(expected) && memcmp(value, expected, len) == 0;
+}
+
+TEST(ini, kr_ini_parse)
+{
+    static const char src[] = "top = level\n"
+                              "; comment\r\n"
+                              "  # another = comment\n"
+                              "\n"
+                              "[ first ]\r\n"
+                              "a=1\r\n"
+                              "  b  =  two words  \n"
+                              "empty =\n"
+                              "[second]\n"
+                              "a = 2\n"
+                              "a = 3\n"
+                              "url = http://x/?a=b\n"
+                              "[]\n"
+                              "a = 4";
+    struct kr_ini_s ini;
+    const struct kr_ini_entry_s *entry;
+    size_t error = 0;
+
+    kr_ini_init(&ini);
+    EXPECT_TRUE(kr_ini_parse(&ini, src, sizeof(src) - 1, &error));
+    EXPECT_UINTEQ(8, ini.count);
+
+    EXPECT_TRUE(ini_value_is(&ini, "", "top", "level"));
+    EXPECT_TRUE(ini_value_is(&ini, "first", "a", "1"));
+    EXPECT_TRUE(ini_value_is(&ini, "first", "b", "two words"));
+    EXPECT_TRUE(ini_value_is(&ini, "first", "empty", ""));
+    EXPECT_TRUE(ini_value_is(&ini, "second", "a", "3"));
+    EXPECT_TRUE(ini_value_is(&ini, "second", "url", "http://x/?a=b"));
+
+    /* An empty section name is the same as no section. */
+    EXPECT_TRUE(ini_value_is(&ini, "", "a", "4"));
+
+    /* Comments aren't keys, and names are case-sensitive. */
+    EXPECT_TRUE(kr_ini_get(&ini, "", "# another", NULL) == NULL);
+    EXPECT_TRUE(kr_ini_get(&ini, "First", "a", NULL) == NULL);
+    EXPECT_TRUE(kr_ini_get(&ini, "first", "c", NULL) == NULL);
+
+    /* Slices point into the buffer that was parsed. */
+    entry = kr_ini_find(&ini, "first", 5, "b", 1);
+    EXPECT_TRUE(entry != NULL);
+    EXPECT_TRUE(entry->value == src + strlen("top = level\n; comment\r\n  # another = comment\n\n[ first ]\r\na=1\r\n"
+                                             "  b  =  "));
+    EXPECT_UINTEQ(5, entry->sectionLen);
+
+    /* Parsing again replaces the old keys. */
+    EXPECT_TRUE(kr_ini_parse(&ini, "x=y", 3, NULL));
+    EXPECT_UINTEQ(1, ini.count);
+    EXPECT_TRUE(ini_value_is(&ini, "", "x", "y"));
+    EXPECT_TRUE(kr_ini_get(&ini, "", "top", NULL) == NULL);
+
+    EXPECT_TRUE(kr_ini_parse(&ini, "", 0, NULL));
+    EXPECT_UINTEQ(0, ini.count);
+    EXPECT_TRUE(kr_ini_get(&ini, "", "x", NULL) == NULL);
+
+    kr_ini_destroy(&ini);
+    EXPECT_TRUE(kr_ini_get(&ini, "", "x", NULL) == NULL);
+}
+
+TEST(ini, kr_ini_parse_error)
+{
+    struct kr_ini_s ini;
+    size_t error = 0;
+
+    kr_ini_init(&ini);
+
+    /* Keys before the bad line are still there. */
+    EXPECT_FALSE(kr_ini_parse(&ini, "a = 1\n  junk\nb = 2\n", 19, &error));
+    EXPECT_UINTEQ(8, error);
+    EXPECT_UINTEQ(1, ini.count);
+    EXPECT_TRUE(ini_value_is(&ini, "", "a", "1"));
+    EXPECT_TRUE(kr_ini_get(&ini, "", "b", NULL) == NULL);
+
+    EXPECT_FALSE(kr_ini_parse(&ini, "= 1\n", 4, &error));
+    EXPECT_UINTEQ(0, error);
+    EXPECT_FALSE(kr_ini_parse(&ini, "a=1\n[section\n", 13, &error));
+    EXPECT_UINTEQ(4, error);
+    EXPECT_FALSE(kr_ini_parse(&ini, "[a] b\n", 6, &error));
+    EXPECT_UINTEQ(0, error);
+    EXPECT_FALSE(kr_ini_parse(&ini, "\n[", 2, &error));
+    EXPECT_UINTEQ(1, error);
+
+    kr_ini_destroy(&ini);
+}
+
+TEST(ini, kr_ini_parse_random)
+{
+    static const char *const spaces[] = {"", " ", "\t", "  "};
+    char buf[4096], values[8][8][16];
+    bool isSet[8][8];
+    struct kr_jsf32_ctx_s ctx;
+    struct kr_ini_s ini;
+    size_t i, j, k, len;
+
+    kr_jsf32_srand(&ctx, 0x494E4931);
+    kr_ini_init(&ini);
+    for (i = 0; i < 200; i++)
+    {
+        uint32_t section = 0;
+        const uint32_t lines = kr_jsf32_rand_uniform(&ctx, 100);
+
+        memset(isSet, 0, sizeof(isSet));
+        len = 0;
+        for (j = 0; j < lines; j++)
+        {
+            const uint32_t kind = kr_jsf32_rand_uniform(&ctx, 8);
+            const char *space = spaces[kr_jsf32_rand_uniform(&ctx, kr_countof(spaces))];
+            const char *eol = kr_jsf32_rand_uniform(&ctx, 2) ? "\r\n" : "\n";
+
+            if (kind == 0)
+            {
+                /* Section 0 stands for the keys before any section. */
+                section = kr_jsf32_rand_uniform(&ctx, 7) + 1;
+                len += sprintf(buf + len, "%s[%ssection%u%s]%s", space, space, (unsigned)section, space, eol);
+            }
+            else if (kind == 1)
+            {
+                len += sprintf(buf + len, "%s%c key%u = ignored%s", space, kr_jsf32_rand_uniform(&ctx, 2) ? ';' : '#',
+                               (unsigned)kr_jsf32_rand_uniform(&ctx, 8), eol);
+            }
+            else
+            {
+                const uint32_t key = kr_jsf32_rand_uniform(&ctx, 8);
+                sprintf(values[section][key], "v%u", (unsigned)kr_jsf32_rand_uniform(&ctx, 100000));
+                isSet[section][key] = true;
+                len += sprintf(buf + len, "%skey%u%s=%s%s%s", space, (unsigned)key, space, space,
+                               values[section][key], eol);
+            }
+        }
+
+        EXPECT_TRUE(kr_ini_parse(&ini, buf, len, NULL));
+        for (j = 0; j < 8; j++)
+        {
+            for (k = 0; k < 8; k++)
+            {
+                char sectionName[16] = "", keyName[16];
+                if (j != 0)
+                {
+                    sprintf(sectionName, "section%u", (unsigned)j);
+                }
+                sprintf(keyName, "key%u", (unsigned)k);
+
+                if (isSet[j][k])
+                {
+                    EXPECT_TRUE(ini_value_is(&ini, sectionName, keyName, values[j][k]));
+                }
+                else
+                {
+                    EXPECT_TRUE(kr_ini_get(&ini, sectionName, keyName, NULL) == NULL);
+                }
+            }
+        }
+    }
+    kr_ini_destroy(&ini);
+}
+
+SUITE(ini)
+{
+    SUITE_TEST(ini, kr_ini_parse);
+    SUITE_TEST(ini, kr_ini_parse_error);
+    SUITE_TEST(ini, kr_ini_parse_random);
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "zztest.h"
+
+#include "krintern.h"
+
+TEST(intern, kr_intern)
+{
+    char buffer[8];
+    const char *a, *b, *c;
+    struct kr_intern_s intern;
+
+    kr_intern_init(&intern);
+    EXPECT_TRUE(kr_intern_find(&intern, "xyzzy", 5) == NULL);
+
+    a = kr_intern(&intern, "xyzzy");
+    ASSERT_TRUE(a != NULL);
+    EXPECT_STREQ("xyzzy", a);
+
+    /* Same contents from a different pointer gives the same copy. */
+    kr_strscpy(buffer, "xyzzy", sizeof(buffer));
+    b = kr_intern(&intern, buffer);
+    EXPECT_TRUE(a == b);
+    EXPECT_TRUE(a != buffer);
+
+    c = kr_intern(&intern, "plugh");
+    ASSERT_TRUE(c != NULL);
+    EXPECT_TRUE(a != c);
+    EXPECT_UINTEQ(2, intern.count);
+
+    /* Slices are terminated, and the empty string is a string too. */
+    EXPECT_TRUE(kr_internn(&intern, "plugh, xyzzy", 5) == c);
+    EXPECT_TRUE(kr_internn(&intern, "xyzzyx", 5) == a);
+    EXPECT_TRUE(kr_intern_find(&intern, "xyzzy, plugh", 5) == a);
+    EXPECT_TRUE(kr_intern_find(&intern, "xyzz", 4) == NULL);
+    EXPECT_STREQ("", kr_intern(&intern, ""));
+    EXPECT_TRUE(kr_intern(&intern, "") == kr_internn(&intern, "abc", 0));
+    EXPECT_UINTEQ(3, intern.count);
+
+    kr_intern_destroy(&intern);
+    EXPECT_UINTEQ(0, intern.count);
+}
+
+static void intern_key(char *buffer, size_t i)
+{
+    buffer[0] = 'k';
+    buffer[1] = (char)('a' + i % 26);
+    buffer[2] = (char)('a' + i / 26 % 26);
+    buffer[3] = (char)('a' + i / 676 % 26);
+    buffer[4] = '\0';
+}
+
+TEST(intern, kr_intern_many)
+{
+    size_t i;
+    char buffer[6000];
+    const char *big;
+    const char *ptrs[2000];
+    struct kr_intern_s intern;
+
+    /* Enough to grow the table and fill several chunks. */
+    kr_intern_init(&intern);
+    for (i = 0; i < kr_countof(ptrs); i++)
+    {
+        intern_key(buffer, i);
+        ptrs[i] = kr_intern(&intern, buffer);
+        ASSERT_TRUE(ptrs[i] != NULL);
+    }
+
+    /* Big strings get their own chunk without disturbing the others. */
+    memset(buffer, 'x', sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+    big = kr_intern(&intern, buffer);
+    ASSERT_TRUE(big != NULL);
+    EXPECT_UINTEQ(sizeof(buffer) - 1, kr_strlen(big));
+
+    for (i = 0; i < kr_countof(ptrs); i++)
+    {
+        intern_key(buffer, i);
+        EXPECT_TRUE(kr_intern(&intern, buffer) == ptrs[i]);
+        EXPECT_STREQ(buffer, ptrs[i]);
+    }
+    EXPECT_UINTEQ(kr_countof(ptrs) + 1, intern.count);
+    kr_intern_destroy(&intern);
+}
+
+SUITE(intern)
+{
+    SUITE_TEST(intern, kr_intern);
+    SUITE_TEST(intern, kr_intern_many);
+}
@@ -0,0 +1,551 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "zztest.h"
+
+#include "krjson.h"
+
+#include "krlib.h"
+#include "krrand.h"
+
+#if defined(UINT64_MAX)
+
+/* One byte at a time, following the same rules as the bitmasks. */
+static size_t json_index_reference(size_t *dest, size_t *outLen, size_t destLen, const char *src, size_t len)
+{
+    size_t i, count = 0;
+    bool escaped = false, inString = false, prevOther = false;
+
+    for (i = 0; i < len; i++)
+    {
+        const char ch = src[i];
+        const bool quote = ch == '"' && !escaped;
+        const bool op = ch == '[' || ch == ']' || ch == '{' || ch == '}' || ch == ':' || ch == ',';
+        const bool space = ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+        const bool tail = inString;
+        const bool scalar = !op && !space;
+        bool structural;
+
+        escaped = ch == '\\' && !escaped;
+        inString = inString != quote;
+        if (tail && (unsigned char)ch < 0x20)
+        {
+            *outLen = count;
+            return i;
+        }
+
+        structural = ((op || (scalar && !prevOther)) && !tail) || (quote && !inString);
+        prevOther = scalar && !quote;
+        if (structural)
+        {
+            if (count == destLen)
+            {
+                *outLen = count;
+                return i;
+            }
+            dest[count++] = i;
+        }
+    }
+
+    *outLen = count;
+    if (inString)
+    {
+        while (i-- != 0)
+        {
+            size_t j = i;
+            while (j != 0 && src[j - 1] == '\\')
+            {
+                j--;
+            }
+            if (src[i] == '"' && (i - j) % 2 == 0)
+            {
+                break;
+            }
+        }
+        return i;
+    }
+    return len;
+}
+
+/* Compact JSON from a tape, returning the tape index after the value. */
+static size_t json_write(char *dest, size_t *pos, const struct kr_json_token_s *tape, size_t i, const char *src)
+{
+    const struct kr_json_token_s *tok = &tape[i];
+    size_t child;
+
+    if (tok->type != KR_JSON_ARRAY && tok->type != KR_JSON_OBJECT)
+    {
+        memcpy(dest + *pos, src + tok->offset, tok->length);
+        *pos += tok->length;
+        return tok->next;
+    }
+
+    dest[(*pos)++] = tok->type == KR_JSON_ARRAY ? '[' : '{';
+    for (child = i + 1; child < tok->next;)
+    {
+        if (child != i + 1)
+        {
+            dest[(*pos)++] = ',';
+        }
+        if (tok->type == KR_JSON_OBJECT)
+        {
+            child = json_write(dest, pos, tape, child, src);
+            dest[(*pos)++] = ':';
+        }
+        child = json_write(dest, pos, tape, child, src);
+    }
+    dest[(*pos)++] = tok->type == KR_JSON_ARRAY ? ']' : '}';
+    return tok->next;
+}
+
+/* Random whitespace. */
+static void json_space(struct kr_jsf32_ctx_s *ctx, char *dest, size_t *pos)
+{
+    while (kr_jsf32_rand_uniform(ctx, 3) == 0)
+    {
+        dest[(*pos)++] = " \t\r\n"[kr_jsf32_rand_uniform(ctx, 4)];
+    }
+}
+
+/* A random value, both with whitespace and without. */
+static void json_random(struct kr_jsf32_ctx_s *ctx, char *pretty, size_t *prettyLen, char *compact,
+                        size_t *compactLen, unsigned depth)
+{
+    static const char *const scalars[] = {
+        "0",       "-12",         "3.25",         "1e10",      "-0.5E-3", "123456789012", "true", "false",
+        "null",    "\"\"",        "\"abc\"",      "\"a\\\"b\"", "\"\\\\\"", "\"\\n\\u00e9\"", "\"caf\xC3\xA9\"",
+        "\"[1,2]\"", "\"\\ud83d\\ude00\"", "\"{\\\"a\\\":1}\"",
+    };
+    const uint32_t pick = kr_jsf32_rand_uniform(ctx, depth < 4 ? 4 : 2);
+    size_t i, count;
+
+    if (pick >= 2)
+    {
+        const char open = pick == 2 ? '[' : '{';
+        count = kr_jsf32_rand_uniform(ctx, 5);
+        pretty[(*prettyLen)++] = open;
+        compact[(*compactLen)++] = open;
+        for (i = 0; i < count; i++)
+        {
+            if (i != 0)
+            {
+                pretty[(*prettyLen)++] = ',';
+                compact[(*compactLen)++] = ',';
+            }
+            json_space(ctx, pretty, prettyLen);
+            if (open == '{')
+            {
+                const char *key = scalars[9 + kr_jsf32_rand_uniform(ctx, kr_countof(scalars) - 9)];
+                memcpy(pretty + *prettyLen, key, strlen(key));
+                memcpy(compact + *compactLen, key, strlen(key));
+                *prettyLen += strlen(key);
+                *compactLen += strlen(key);
+                json_space(ctx, pretty, prettyLen);
+                pretty[(*prettyLen)++] = ':';
+                compact[(*compactLen)++] = ':';
+                json_space(ctx, pretty, prettyLen);
+            }
+            json_random(ctx, pretty, prettyLen, compact, compactLen, depth + 1);
+            json_space(ctx, pretty, prettyLen);
+        }
+        pretty[(*prettyLen)++] = open == '[' ? ']' : '}';
+        compact[(*compactLen)++] = open == '[' ? ']' : '}';
+    }
+    else
+    {
+        const char *scalar = scalars[kr_jsf32_rand_uniform(ctx, kr_countof(scalars))];
+        memcpy(pretty + *prettyLen, scalar, strlen(scalar));
+        memcpy(compact + *compactLen, scalar, strlen(scalar));
+        *prettyLen += strlen(scalar);
+        *compactLen += strlen(scalar);
+    }
+}
+
+/* Parse a document, expecting it to be valid or an error at an offset. */
+static void json_check(struct zzt_test_state_s *zzt_test_state, const char *src, size_t expected)
+{
+    struct kr_json_token_s tape[64];
+    size_t index[64], count;
+
+    EXPECT_UINTEQ(expected, kr_json_parse(tape, &count, kr_countof(tape), index, kr_countof(index), src, strlen(src)));
+}
+
+TEST(json, kr_json_index)
+{
+    static const char alphabet[] = "\"\"\"\\\\[]{}:,  \n\t\x01tf0-";
+    char src[300];
+    size_t expected[300], actual[300], expectedLen, actualLen, destLen;
+    struct kr_jsf32_ctx_s ctx;
+    size_t i, j, len;
+
+    kr_jsf32_srand(&ctx, 0x4A534F4E);
+    for (i = 0; i < 4000; i++)
+    {
+        /* Control characters only some of the time, so that most strings
+           make it to the end. */
+        const uint32_t alphabetLen = sizeof(alphabet) - (kr_jsf32_rand_uniform(&ctx, 4) == 0 ? 1 : 7);
+        len = kr_jsf32_rand_uniform(&ctx, kr_countof(src) + 1);
+        for (j = 0; j < len; j++)
+        {
+            const uint32_t pick = kr_jsf32_rand_uniform(&ctx, alphabetLen + 8);
+            src[j] = pick < alphabetLen ? alphabet[pick] : 'a';
+        }
+        destLen = kr_jsf32_rand_uniform(&ctx, 8) == 0 ? kr_jsf32_rand_uniform(&ctx, 40) : kr_countof(actual);
+
+        EXPECT_UINTEQ(json_index_reference(expected, &expectedLen, destLen, src, len),
+                      kr_json_index(actual, &actualLen, destLen, src, len));
+        EXPECT_UINTEQ(expectedLen, actualLen);
+        EXPECT_TRUE(memcmp(expected, actual, actualLen * sizeof(actual[0])) == 0);
+    }
+}
+
+TEST(json, kr_json_tape)
+{
+    static const char src[] = "{\"a\": [1, -2.5e3, \"x\\\"y\"],\n \"b\": {}, \"c\": [], \"d\": [true, false, null]}";
+    struct kr_json_token_s tape[32];
+    size_t index[64], count, indexLen;
+    const size_t len = sizeof(src) - 1;
+    int64_t i64;
+    double f64;
+    char str[16];
+    size_t strLen;
+
+    EXPECT_UINTEQ(len, kr_json_index(index, &indexLen, kr_countof(index), src, len));
+    EXPECT_UINTEQ(len, kr_json_tape(tape, &count, kr_countof(tape), src, len, index, indexLen));
+    EXPECT_UINTEQ(15, count);
+
+    EXPECT_INTEQ(KR_JSON_OBJECT, tape[0].type);
+    EXPECT_UINTEQ(0, tape[0].offset);
+    EXPECT_UINTEQ(len, tape[0].length);
+    EXPECT_UINTEQ(15, tape[0].next);
+
+    EXPECT_INTEQ(KR_JSON_STRING, tape[1].type);
+    EXPECT_UINTEQ(3, tape[1].length);
+    EXPECT_INTEQ(KR_JSON_ARRAY, tape[2].type);
+    EXPECT_UINTEQ(6, tape[2].next);
+    EXPECT_INTEQ(KR_JSON_NUMBER, tape[3].type);
+    EXPECT_UINTEQ(1, tape[3].length);
+    EXPECT_INTEQ(KR_JSON_NUMBER, tape[4].type);
+    EXPECT_UINTEQ(6, tape[4].length);
+    EXPECT_INTEQ(KR_JSON_STRING, tape[5].type);
+    EXPECT_UINTEQ(6, tape[5].length);
+    EXPECT_INTEQ(KR_JSON_OBJECT, tape[7].type);
+    EXPECT_UINTEQ(2, tape[7].length);
+    EXPECT_UINTEQ(8, tape[7].next);
+    EXPECT_INTEQ(KR_JSON_ARRAY, tape[9].type);
+    EXPECT_UINTEQ(10, tape[9].next);
+    EXPECT_INTEQ(KR_JSON_TRUE, tape[12].type);
+    EXPECT_INTEQ(KR_JSON_FALSE, tape[13].type);
+    EXPECT_INTEQ(KR_JSON_NULL, tape[14].type);
+
+    EXPECT_TRUE(kr_json_get_i64(&i64, src, &tape[3]));
+    EXPECT_INTEQ(1, i64);
+    EXPECT_FALSE(kr_json_get_i64(&i64, src, &tape[4]));
+    EXPECT_TRUE(kr_json_get_f64(&f64, src, &tape[4]));
+    EXPECT_TRUE(f64 == -2500.0);
+    EXPECT_FALSE(kr_json_get_f64(&f64, src, &tape[5]));
+    EXPECT_TRUE(kr_json_get_string(str, &strLen, src, &tape[5]));
+    EXPECT_UINTEQ(3, strLen);
+    EXPECT_TRUE(memcmp(str, "x\"y", 3) == 0);
+    EXPECT_FALSE(kr_json_get_string(str, &strLen, src, &tape[3]));
+
+    EXPECT_UINTEQ(2, kr_json_find(tape, 0, src, "a", 1));
+    EXPECT_UINTEQ(11, kr_json_find(tape, 0, src, "d", 1));
+    EXPECT_UINTEQ(0, kr_json_find(tape, 0, src, "e", 1));
+    EXPECT_UINTEQ(0, kr_json_find(tape, 2, src, "a", 1));
+    EXPECT_UINTEQ(0, kr_json_find(tape, 7, src, "a", 1));
+
+    /* Running out of room. */
+    EXPECT_UINTEQ(18, kr_json_tape(tape, &count, 5, src, len, index, indexLen));
+    EXPECT_UINTEQ(5, count);
+}
+
+TEST(json, kr_json_parse)
+{
+    json_check(zzt_test_state, "0", 1);
+    json_check(zzt_test_state, " \"\" ", 4);
+    json_check(zzt_test_state, "[[[]]]", 6);
+    json_check(zzt_test_state, "{\"\":{\"\":[null]}}", 16);
+    json_check(zzt_test_state, "-0.0e+0", 7);
+    json_check(zzt_test_state, "\"caf\xC3\xA9\"", 7);
+
+    /* Where the error is. */
+    json_check(zzt_test_state, "", 0);
+    json_check(zzt_test_state, "[1,]", 3);
+    json_check(zzt_test_state, "[1 2]", 3);
+    json_check(zzt_test_state, "{\"a\" 1}", 5);
+    json_check(zzt_test_state, "{\"a\":1,}", 7);
+    json_check(zzt_test_state, "{1:1}", 1);
+    json_check(zzt_test_state, "[1}", 2);
+    json_check(zzt_test_state, "{\"a\":1]", 6);
+    json_check(zzt_test_state, "[[1]", 0);
+    json_check(zzt_test_state, "1 1", 2);
+    json_check(zzt_test_state, "]", 0);
+    json_check(zzt_test_state, "[tru]", 1);
+    json_check(zzt_test_state, "[truex]", 1);
+    json_check(zzt_test_state, "nul", 0);
+    json_check(zzt_test_state, "01", 0);
+    json_check(zzt_test_state, "1.", 0);
+    json_check(zzt_test_state, "1e", 0);
+    json_check(zzt_test_state, "-", 0);
+    json_check(zzt_test_state, "+1", 0);
+    json_check(zzt_test_state, "1\"a\"", 0);
+    json_check(zzt_test_state, "\"a\"\"b\"", 3);
+    json_check(zzt_test_state, "[\"abc", 1);
+    json_check(zzt_test_state, "\"a\\\"", 0);
+    json_check(zzt_test_state, "\"a\tb\"", 2);
+    json_check(zzt_test_state, "\"\xC3\"", 1);
+}
+
+TEST(json, kr_json_parse_random)
+{
+    char pretty[4096], compact[4096], actual[4096];
+    struct kr_json_token_s tape[1024];
+    size_t index[1024];
+    struct kr_jsf32_ctx_s ctx;
+    size_t i, prettyLen, compactLen, actualLen, count;
+
+    kr_jsf32_srand(&ctx, 0x54415045);
+    for (i = 0; i < 500; i++)
+    {
+        prettyLen = 0;
+        compactLen = 0;
+        json_space(&ctx, pretty, &prettyLen);
+        json_random(&ctx, pretty, &prettyLen, compact, &compactLen, 0);
+        json_space(&ctx, pretty, &prettyLen);
+
+        EXPECT_UINTEQ(prettyLen, kr_json_parse(tape, &count, kr_countof(tape), index, kr_countof(index), pretty,
+                                               prettyLen));
+        actualLen = 0;
+        EXPECT_UINTEQ(count, json_write(actual, &actualLen, tape, 0, pretty));
+        EXPECT_UINTEQ(compactLen, actualLen);
+        EXPECT_TRUE(memcmp(compact, actual, compactLen) == 0);
+    }
+}
+
+TEST(json, kr_json_unescape)
+{
+    static const char src[] = "a\\\"\\\\\\/\\b\\f\\n\\r\\t\\u0041\\u00e9\\u20AC\\ud83d\\ude00z";
+    char dest[64];
+    size_t len;
+
+    EXPECT_UINTEQ(sizeof(src) - 1, kr_json_unescape(dest, &len, src, sizeof(src) - 1));
+    EXPECT_UINTEQ(20, len);
+    EXPECT_TRUE(memcmp(dest, "a\"\\/\b\f\n\r\tA\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80z", 20) == 0);
+
+    /* In place. */
+    strcpy(dest, "x\\ny");
+    EXPECT_UINTEQ(4, kr_json_unescape(dest, &len, dest, 4));
+    EXPECT_UINTEQ(3, len);
+    EXPECT_TRUE(memcmp(dest, "x\ny", 3) == 0);
+
+    /* Bad escapes. */
+    EXPECT_UINTEQ(1, kr_json_unescape(dest, &len, "a\\", 2));
+    EXPECT_UINTEQ(1, kr_json_unescape(dest, &len, "a\\x", 3));
+    EXPECT_UINTEQ(1, len);
+    EXPECT_UINTEQ(0, kr_json_unescape(dest, &len, "\\u12", 4));
+    EXPECT_UINTEQ(0, kr_json_unescape(dest, &len, "\\u12g4", 6));
+    EXPECT_UINTEQ(0, kr_json_unescape(dest, &len, "\\ud83d", 6));
+    EXPECT_UINTEQ(0, kr_json_unescape(dest, &len, "\\ud83d\\u0041", 12));
+    EXPECT_UINTEQ(0, kr_json_unescape(dest, &len, "\\ude00", 6));
+}
+
+/* Escape one byte at a time. */
+static size_t json_escape_reference(char *dest, const char *src, size_t len)
+{
+    size_t i, out = 0;
+
+    for (i = 0; i < len; i++)
+    {
+        const unsigned char ch = (unsigned char)src[i];
+        if (ch == '"' || ch == '\\')
+        {
+            dest[out++] = '\\';
+            dest[out++] = (char)ch;
+        }
+        else if (ch == '\n')
+        {
+            memcpy(dest + out, "\\n", 2);
+            out += 2;
+        }
+        else if (ch == '\t')
+        {
+            memcpy(dest + out, "\\t", 2);
+            out += 2;
+        }
+        else if (ch == '\r')
+        {
+            memcpy(dest + out, "\\r", 2);
+            out += 2;
+        }
+        else if (ch == '\b')
+        {
+            memcpy(dest + out, "\\b", 2);
+            out += 2;
+        }
+        else if (ch == '\f')
+        {
+            memcpy(dest + out, "\\f", 2);
+            out += 2;
+        }
+        else if (ch < 0x20)
+        {
+            sprintf(dest + out, "\\u%04x", ch);
+            out += 6;
+        }
+        else
+        {
+            dest[out++] = (char)ch;
+        }
+    }
+    return out;
+}
+
+TEST(json, kr_json_writer)
+{
+    static const char expected[] = "{\"id\":-9223372036854775808,\"max\":18446744073709551615,"
+                                   "\"f\":[0.1,1e+300,-0,null,null],\"ok\":true,\"no\":false,\"none\":null,"
+                                   "\"s\":\"a\\\"b\\\\c\\n\\u0001\xC3\xA9\",\"e\":{},\"\\t\":[]}";
+    struct kr_json_writer_s w;
+    const double zero = 0.0;
+
+    kr_json_writer_init(&w);
+    EXPECT_TRUE(kr_json_write_begin_object(&w));
+    EXPECT_TRUE(kr_json_write_key(&w, "id", 2));
+    EXPECT_TRUE(kr_json_write_i64(&w, INT64_MIN));
+    EXPECT_TRUE(kr_json_write_key(&w, "max", 3));
+    EXPECT_TRUE(kr_json_write_u64(&w, UINT64_MAX));
+    EXPECT_TRUE(kr_json_write_key(&w, "f", 1));
+    EXPECT_TRUE(kr_json_write_begin_array(&w));
+    EXPECT_TRUE(kr_json_write_f64(&w, 0.1));
+    EXPECT_TRUE(kr_json_write_f64(&w, 1e300));
+    EXPECT_TRUE(kr_json_write_f64(&w, -0.0));
+    EXPECT_TRUE(kr_json_write_f64(&w, 1.0 / zero));
+    EXPECT_TRUE(kr_json_write_f64(&w, zero / zero));
+    EXPECT_TRUE(kr_json_write_end_array(&w));
+    EXPECT_TRUE(kr_json_write_key(&w, "ok", 2));
+    EXPECT_TRUE(kr_json_write_bool(&w, true));
+    EXPECT_TRUE(kr_json_write_key(&w, "no", 2));
+    EXPECT_TRUE(kr_json_write_bool(&w, false));
+    EXPECT_TRUE(kr_json_write_key(&w, "none", 4));
+    EXPECT_TRUE(kr_json_write_null(&w));
+    EXPECT_TRUE(kr_json_write_key(&w, "s", 1));
+    EXPECT_TRUE(kr_json_write_string(&w, "a\"b\\c\n\x01\xC3\xA9", 9));
+    EXPECT_TRUE(kr_json_write_key(&w, "e", 1));
+    EXPECT_TRUE(kr_json_write_begin_object(&w));
+    EXPECT_TRUE(kr_json_write_end_object(&w));
+    EXPECT_TRUE(kr_json_write_key(&w, "\t", 1));
+    EXPECT_TRUE(kr_json_write_begin_array(&w));
+    EXPECT_TRUE(kr_json_write_end_array(&w));
+    EXPECT_TRUE(kr_json_write_end_object(&w));
+
+    EXPECT_UINTEQ(sizeof(expected) - 1, w.buf.len);
+    EXPECT_TRUE(memcmp(expected, w.buf.data, w.buf.len) == 0);
+    EXPECT_FALSE(w.failed);
+    kr_json_writer_destroy(&w);
+    EXPECT_TRUE(w.buf.data == NULL);
+}
+
+TEST(json, kr_json_writer_fixed)
+{
+    char buf[16], keyBuf[13];
+    struct kr_json_writer_s w;
+
+    /* Exactly enough room. */
+    kr_json_writer_init_fixed(&w, buf, 14);
+    EXPECT_TRUE(kr_json_write_begin_array(&w));
+    EXPECT_TRUE(kr_json_write_i64(&w, 5));
+    EXPECT_TRUE(kr_json_write_string(&w, "a\nb", 3));
+    EXPECT_TRUE(kr_json_write_f64(&w, 2.5));
+    EXPECT_TRUE(kr_json_write_end_array(&w));
+    EXPECT_UINTEQ(14, w.buf.len);
+    EXPECT_TRUE(memcmp(buf, "[5,\"a\\nb\",2.5]", 14) == 0);
+
+    /* Once something doesn't fit, nothing else does. */
+    EXPECT_FALSE(kr_json_write_null(&w));
+    EXPECT_TRUE(w.failed);
+    EXPECT_UINTEQ(14, w.buf.len);
+
+    kr_json_writer_init_fixed(&w, buf, 8);
+    EXPECT_TRUE(kr_json_write_string(&w, "abc", 3));
+    EXPECT_FALSE(kr_json_write_string(&w, "\x01", 1));
+    EXPECT_FALSE(kr_json_write_null(&w));
+    kr_json_writer_destroy(&w);
+
+    /* An escaped key leaves room for its colon. */
+    kr_json_writer_init_fixed(&w, keyBuf, sizeof(keyBuf));
+    EXPECT_TRUE(kr_json_write_begin_object(&w));
+    EXPECT_TRUE(kr_json_write_key(&w, "x", 1));
+    EXPECT_TRUE(kr_json_write_i64(&w, 1));
+    EXPECT_TRUE(kr_json_write_key(&w, "a\"", 2));
+    EXPECT_UINTEQ(13, w.buf.len);
+    EXPECT_TRUE(memcmp(keyBuf, "{\"x\":1,\"a\\\"\":", 13) == 0);
+
+    /* One byte short, ending where the array ends. */
+    kr_json_writer_init_fixed(&w, keyBuf + 1, sizeof(keyBuf) - 1);
+    EXPECT_TRUE(kr_json_write_begin_object(&w));
+    EXPECT_TRUE(kr_json_write_key(&w, "x", 1));
+    EXPECT_TRUE(kr_json_write_i64(&w, 1));
+    EXPECT_FALSE(kr_json_write_key(&w, "a\"", 2));
+    EXPECT_TRUE(w.buf.len <= sizeof(keyBuf) - 1);
+    kr_json_writer_destroy(&w);
+}
+
+TEST(json, kr_json_write_string)
+{
+    char src[200], expected[1200], actual[200];
+    struct kr_json_writer_s w;
+    struct kr_jsf32_ctx_s ctx;
+    size_t i, j, len, expectedLen, actualLen;
+
+    kr_jsf32_srand(&ctx, 0x45534331);
+    kr_json_writer_init(&w);
+    for (i = 0; i < 2000; i++)
+    {
+        /* Mostly plain, so that there are runs to copy. */
+        const uint32_t odds = kr_jsf32_rand_uniform(&ctx, 64) + 1;
+        len = kr_jsf32_rand_uniform(&ctx, kr_countof(src) + 1);
+        for (j = 0; j < len; j++)
+        {
+            src[j] = kr_jsf32_rand_uniform(&ctx, odds) == 0 ? (char)kr_jsf32_rand_uniform(&ctx, 0x80) : 'x';
+        }
+
+        w.buf.len = 0;
+        w.comma = false;
+        EXPECT_TRUE(kr_json_write_string(&w, src, len));
+        expected[0] = '"';
+        expectedLen = json_escape_reference(expected + 1, src, len) + 1;
+        expected[expectedLen++] = '"';
+        EXPECT_UINTEQ(expectedLen, w.buf.len);
+        EXPECT_TRUE(memcmp(expected, w.buf.data, w.buf.len) == 0);
+
+        EXPECT_UINTEQ(w.buf.len - 2, kr_json_unescape(actual, &actualLen, w.buf.data + 1, w.buf.len - 2));
+        EXPECT_UINTEQ(len, actualLen);
+        EXPECT_TRUE(memcmp(src, actual, len) == 0);
+    }
+    kr_json_writer_destroy(&w);
+}
+
+#endif
+
+SUITE(json)
+{
+#if defined(UINT64_MAX)
+    SUITE_TEST(json, kr_json_index);
+    SUITE_TEST(json, kr_json_tape);
+    SUITE_TEST(json, kr_json_parse);
+    SUITE_TEST(json, kr_json_parse_random);
+    SUITE_TEST(json, kr_json_unescape);
+    SUITE_TEST(json, kr_json_writer);
+    SUITE_TEST(json, kr_json_writer_fixed);
+    SUITE_TEST(json, kr_json_write_string);
+#endif
+}
@@ -12,6 +12,8 @@
 
 #include "krint.h"
 
+#include <string.h>
+
 TEST(lib, kr_reallocarray)
 {
     void *ptr1 = NULL, *ptr2 = NULL, *ptr3 = NULL, *ptr4 = NULL;
@@ -55,7 +57,32 @@ done:
     KR_FREE(ptr4);
 }
 
+TEST(lib, kr_hash)
+{
+    static const char text[] = "The quick brown fox jumps over the lazy dog";
+    char copy[sizeof(text)];
+    size_t i;
+
+    /* Only the bytes matter, not where they are. */
+    memcpy(copy, text, sizeof(text));
+    for (i = 0; i < sizeof(text); i++)
+    {
+        EXPECT_UINTEQ(kr_hash(0, text, i), kr_hash(0, copy, i));
+        EXPECT_UINTEQ(kr_hash(0, text + 1, i / 2), kr_hash(0, copy + 1, i / 2));
+    }
+
+    /* Every length, byte and seed counts. */
+    EXPECT_TRUE(kr_hash(0, text, 10) != kr_hash(0, text, 11));
+    EXPECT_TRUE(kr_hash(0, "ab", 2) != kr_hash(0, "ac", 2));
+    EXPECT_TRUE(kr_hash(0, "a\0", 1) != kr_hash(0, "a\0", 2));
+    EXPECT_TRUE(kr_hash(0, text, 20) != kr_hash(1, text, 20));
+
+    /* Chaining keeps apart splits that concatenate the same. */
+    EXPECT_TRUE(kr_hash(kr_hash(0, "ab", 2), "c", 1) != kr_hash(kr_hash(0, "a", 1), "bc", 2));
+}
+
 SUITE(lib)
 {
     SUITE_TEST(lib, kr_reallocarray);
+    SUITE_TEST(lib, kr_hash);
 }
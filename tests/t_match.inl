@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "zztest.h"
+
+#include "krmatch.h"
+
+#include "krrand.h"
+
+static struct
+{
+    size_t count;
+    size_t stopAfter;
+    size_t patterns[4096];
+    size_t offsets[4096];
+} g_matchRecord;
+
+static bool match_record(void *user, size_t pattern, size_t offset)
+{
+    (void)user;
+    if (g_matchRecord.count < kr_countof(g_matchRecord.patterns))
+    {
+        g_matchRecord.patterns[g_matchRecord.count] = pattern;
+        g_matchRecord.offsets[g_matchRecord.count] = offset;
+    }
+    g_matchRecord.count++;
+    return g_matchRecord.count != g_matchRecord.stopAfter;
+}
+
+static void match_reset(size_t stopAfter)
+{
+    memset(&g_matchRecord, 0x00, sizeof(g_matchRecord));
+    g_matchRecord.stopAfter = stopAfter;
+}
+
+TEST(match, kr_matcher_scan)
+{
+    static const char *const patterns[] = {"he", "she", "his", "hers"};
+    struct kr_matcher_s matcher;
+
+    ASSERT_TRUE(kr_matcher_init(&matcher, patterns, NULL, kr_countof(patterns), 0));
+
+    match_reset(0);
+    EXPECT_UINTEQ(3, kr_matcher_scan(&matcher, "ushers", 6, match_record, NULL));
+    EXPECT_UINTEQ(1, g_matchRecord.patterns[0]);
+    EXPECT_UINTEQ(1, g_matchRecord.offsets[0]);
+    EXPECT_UINTEQ(0, g_matchRecord.patterns[1]);
+    EXPECT_UINTEQ(2, g_matchRecord.offsets[1]);
+    EXPECT_UINTEQ(3, g_matchRecord.patterns[2]);
+    EXPECT_UINTEQ(2, g_matchRecord.offsets[2]);
+
+    /* Stops when the callback says so. */
+    match_reset(2);
+    EXPECT_UINTEQ(2, kr_matcher_scan(&matcher, "ushers his", 10, match_record, NULL));
+
+    match_reset(0);
+    EXPECT_UINTEQ(0, kr_matcher_scan(&matcher, "USHERS", 6, match_record, NULL));
+    kr_matcher_destroy(&matcher);
+
+    ASSERT_TRUE(kr_matcher_init(&matcher, patterns, NULL, kr_countof(patterns), KR_MATCHER_NOCASE));
+    match_reset(0);
+    EXPECT_UINTEQ(3, kr_matcher_scan(&matcher, "uSHeRs", 6, match_record, NULL));
+    kr_matcher_destroy(&matcher);
+
+    /* Empty patterns are rejected. */
+    {
+        static const char *const empty[] = {"xyzzy", ""};
+        EXPECT_BOOLEQ(false, kr_matcher_init(&matcher, empty, NULL, kr_countof(empty), 0));
+    }
+}
+
+TEST(match, kr_matcher_random)
+{
+    size_t i, j, end, len, count;
+    char haystack[256], words[48][8];
+    const char *patterns[48];
+    size_t lens[48];
+    struct kr_matcher_s matcher;
+    struct kr_jsf32_ctx_s ctx;
+
+    /* Compare against checking every pattern at every position, with set
+       sizes on both sides of the Teddy cutoff. */
+    kr_jsf32_srand(&ctx, 1993);
+    for (i = 0; i < 128; i++)
+    {
+        const bool nocase = (i & 1) != 0;
+        const uint32_t alphabet = 2 + kr_jsf32_rand_uniform(&ctx, 3);
+        const size_t patternsLen = 1 + kr_jsf32_rand_uniform(&ctx, kr_countof(patterns));
+        const size_t haystackLen = kr_jsf32_rand_uniform(&ctx, sizeof(haystack));
+
+        for (j = 0; j < patternsLen; j++)
+        {
+            lens[j] = 1 + kr_jsf32_rand_uniform(&ctx, sizeof(words[0]));
+            for (len = 0; len < lens[j]; len++)
+            {
+                words[j][len] = (char)('a' + kr_jsf32_rand_uniform(&ctx, alphabet));
+            }
+            patterns[j] = words[j];
+        }
+        for (j = 0; j < haystackLen; j++)
+        {
+            haystack[j] = (char)((nocase && kr_jsf32_rand_uniform(&ctx, 2) ? 'A' : 'a') +
+                                 kr_jsf32_rand_uniform(&ctx, alphabet));
+        }
+
+        ASSERT_TRUE(kr_matcher_init(&matcher, patterns, lens, patternsLen, nocase ? KR_MATCHER_NOCASE : 0));
+        match_reset(0);
+        kr_matcher_scan(&matcher, haystack, haystackLen, match_record, NULL);
+        kr_matcher_destroy(&matcher);
+
+        /* Same order as the matcher: by end, then longest, then index. */
+        count = 0;
+        for (end = 1; end <= haystackLen; end++)
+        {
+            for (len = sizeof(words[0]); len > 0; len--)
+            {
+                for (j = 0; j < patternsLen && len <= end; j++)
+                {
+                    size_t k = 0;
+                    if (lens[j] != len)
+                    {
+                        continue;
+                    }
+                    while (k < len && kr_tolower(haystack[end - len + k]) == words[j][k])
+                    {
+                        k++;
+                    }
+                    if (k == len && (nocase || memcmp(haystack + end - len, words[j], len) == 0))
+                    {
+                        if (count < kr_countof(g_matchRecord.patterns))
+                        {
+                            EXPECT_UINTEQ(j, g_matchRecord.patterns[count]);
+                            EXPECT_UINTEQ(end - len, g_matchRecord.offsets[count]);
+                        }
+                        count++;
+                    }
+                }
+            }
+        }
+        EXPECT_UINTEQ(count, g_matchRecord.count);
+    }
+}
+
+SUITE(match)
+{
+    SUITE_TEST(match, kr_matcher_scan);
+    SUITE_TEST(match, kr_matcher_random);
+}
@@ -10,6 +10,61 @@
 
 #include "krstr.h"
 
+#include "krlib.h"
+#include "krrand.h"
+
+TEST(str, kr_strlen)
+{
+    size_t offset, len;
+    char buffer[256];
+
+    memset(buffer, 'a', sizeof(buffer));
+    for (offset = 0; offset < 64; offset++)
+    {
+        for (len = 0; len < 128; len++)
+        {
+            buffer[offset + len] = '\0';
+            EXPECT_UINTEQ(len, kr_strlen(buffer + offset));
+            EXPECT_UINTEQ(len, kr_strlen_swar(buffer + offset));
+#if (KR_SSE2)
+            EXPECT_UINTEQ(len, kr_strlen_sse2(buffer + offset));
+#endif
+#if (KR_AVX2)
+            EXPECT_UINTEQ(len, kr_strlen_avx2(buffer + offset));
+#endif
+            buffer[offset + len] = 'a';
+        }
+    }
+}
+
+TEST(str, kr_strnlen)
+{
+    size_t offset, len, max;
+    char buffer[256];
+
+    memset(buffer, 'a', sizeof(buffer));
+    for (offset = 0; offset < 32; offset++)
+    {
+        for (len = 0; len < 80; len++)
+        {
+            buffer[offset + len] = '\0';
+            for (max = 0; max < 96; max++)
+            {
+                size_t expected = len < max ? len : max;
+                EXPECT_UINTEQ(expected, kr_strnlen(buffer + offset, max));
+                EXPECT_UINTEQ(expected, kr_strnlen_swar(buffer + offset, max));
+#if (KR_SSE2)
+                EXPECT_UINTEQ(expected, kr_strnlen_sse2(buffer + offset, max));
+#endif
+#if (KR_AVX2)
+                EXPECT_UINTEQ(expected, kr_strnlen_avx2(buffer + offset, max));
+#endif
+            }
+            buffer[offset + len] = 'a';
+        }
+    }
+}
+
 TEST(str, kr_strcmp)
 {
     EXPECT_INTEQ(0, kr_strcmp("abc", "abc"));
@@ -17,6 +72,231 @@ TEST(str, kr_strcmp)
     EXPECT_INTLT(0, kr_strcmp("def", "abc"));
 }
 
+static int str_refcmp(const char *lhs, const char *rhs, size_t len)
+{
+    for (; len != 0; lhs++, rhs++, len--)
+    {
+        if (*lhs != *rhs || *lhs == '\0')
+        {
+            return (unsigned char)*lhs - (unsigned char)*rhs;
+        }
+    }
+    return 0;
+}
+
+TEST(str, kr_strcmp_random)
+{
+    size_t i;
+    char lhs[160], rhs[160];
+    struct kr_jsf32_ctx_s ctx;
+
+    /* Every tier must return exactly what the byte loop does, including for
+       bytes with the high bit set and at every relative alignment. */
+    kr_jsf32_srand(&ctx, 2024);
+    for (i = 0; i < 4096; i++)
+    {
+        const size_t lOff = kr_jsf32_rand_uniform(&ctx, 16);
+        const size_t rOff = kr_jsf32_rand_uniform(&ctx, 16);
+        const size_t len = kr_jsf32_rand_uniform(&ctx, sizeof(lhs) - 32);
+        const size_t diff = kr_jsf32_rand_uniform(&ctx, (uint32_t)len + 2);
+        const size_t max = kr_jsf32_rand_uniform(&ctx, (uint32_t)len + 4);
+        size_t j;
+        int expected;
+
+        for (j = 0; j < len; j++)
+        {
+            lhs[lOff + j] = rhs[rOff + j] = (char)(1 + kr_jsf32_rand_uniform(&ctx, 255));
+        }
+        lhs[lOff + len] = rhs[rOff + len] = '\0';
+        if (diff < len)
+        {
+            rhs[rOff + diff] = (char)(1 + kr_jsf32_rand_uniform(&ctx, 255));
+        }
+        else if (diff == len)
+        {
+            rhs[rOff + diff] = 'x';
+            rhs[rOff + diff + 1] = '\0';
+        }
+
+        expected = str_refcmp(lhs + lOff, rhs + rOff, (size_t)-1);
+        EXPECT_INTEQ(expected, kr_strcmp(lhs + lOff, rhs + rOff));
+        EXPECT_INTEQ(expected, kr_strcmp_swar(lhs + lOff, rhs + rOff));
+#if (KR_SSE2)
+        EXPECT_INTEQ(expected, kr_strcmp_sse2(lhs + lOff, rhs + rOff));
+#endif
+#if (KR_AVX2)
+        EXPECT_INTEQ(expected, kr_strcmp_avx2(lhs + lOff, rhs + rOff));
+#endif
+
+        expected = str_refcmp(lhs + lOff, rhs + rOff, max);
+        EXPECT_INTEQ(expected, kr_strncmp(lhs + lOff, rhs + rOff, max));
+        EXPECT_INTEQ(expected, kr_strncmp_swar(lhs + lOff, rhs + rOff, max));
+#if (KR_SSE2)
+        EXPECT_INTEQ(expected, kr_strncmp_sse2(lhs + lOff, rhs + rOff, max));
+#endif
+#if (KR_AVX2)
+        EXPECT_INTEQ(expected, kr_strncmp_avx2(lhs + lOff, rhs + rOff, max));
+#endif
+    }
+}
+
+TEST(str, kr_strncmp)
+{
+    EXPECT_INTEQ(0, kr_strncmp("abc", "abd", 2));
+    EXPECT_INTGT(0, kr_strncmp("abc", "abd", 3));
+    EXPECT_INTEQ(0, kr_strncmp("abc", "abc", 16));
+    EXPECT_INTLT(0, kr_strncmp("abcd", "abc", 16));
+    EXPECT_INTEQ(0, kr_strncmp("abc", "def", 0));
+}
+
+TEST(str, kr_memcmp)
+{
+    size_t i, j;
+    unsigned char lhs[128], rhs[128];
+    struct kr_jsf32_ctx_s ctx;
+
+    EXPECT_INTEQ(0, kr_memcmp("a\0b", "a\0b", 3));
+    EXPECT_INTGT(0, kr_memcmp("a\0b", "a\0c", 3));
+    EXPECT_INTEQ(0xFF - 'a', kr_memcmp("\xFF", "a", 1));
+
+    kr_jsf32_srand(&ctx, 1024);
+    for (i = 0; i < 4096; i++)
+    {
+        const size_t lOff = kr_jsf32_rand_uniform(&ctx, 16);
+        const size_t rOff = kr_jsf32_rand_uniform(&ctx, 16);
+        const size_t len = kr_jsf32_rand_uniform(&ctx, sizeof(lhs) - 16);
+        const size_t diff = kr_jsf32_rand_uniform(&ctx, (uint32_t)len + 1);
+        int expected = 0;
+
+        for (j = 0; j < len; j++)
+        {
+            lhs[lOff + j] = rhs[rOff + j] = (unsigned char)kr_jsf32_rand_uniform(&ctx, 256);
+        }
+        if (diff < len)
+        {
+            rhs[rOff + diff] = (unsigned char)kr_jsf32_rand_uniform(&ctx, 256);
+            expected = lhs[lOff + diff] - rhs[rOff + diff];
+        }
+        EXPECT_INTEQ(expected, kr_memcmp(lhs + lOff, rhs + rOff, len));
+    }
+}
+
+static int str_refcasecmp(const char *lhs, const char *rhs, size_t len, bool stopAtNull)
+{
+    for (; len != 0; lhs++, rhs++, len--)
+    {
+        if (kr_tolower(*lhs) != kr_tolower(*rhs) || (stopAtNull && *lhs == '\0'))
+        {
+            return (unsigned char)kr_tolower(*lhs) - (unsigned char)kr_tolower(*rhs);
+        }
+    }
+    return 0;
+}
+
+TEST(str, kr_strcasecmp)
+{
+    int i, j;
+    char lhs[2], rhs[2];
+
+    EXPECT_INTEQ(0, kr_strcasecmp("Content-Type", "content-type"));
+    EXPECT_INTGT(0, kr_strcasecmp("ABC", "abd"));
+    EXPECT_INTLT(0, kr_strcasecmp("abcd", "ABC"));
+    EXPECT_INTEQ(0, kr_strncasecmp("HELLO, world", "hello, WORLD!", 12));
+    EXPECT_INTEQ(0, kr_memcasecmp("A\0b", "a\0B", 3));
+
+    /* Every pair of bytes folds exactly like kr_tolower. */
+    lhs[1] = rhs[1] = '\0';
+    for (i = 1; i < 256; i++)
+    {
+        for (j = 1; j < 256; j++)
+        {
+            lhs[0] = (char)i;
+            rhs[0] = (char)j;
+            if (kr_strcasecmp(lhs, rhs) != str_refcasecmp(lhs, rhs, 2, true))
+            {
+                EXPECT_INTEQ(str_refcasecmp(lhs, rhs, 2, true), kr_strcasecmp(lhs, rhs));
+            }
+        }
+    }
+}
+
+TEST(str, kr_strcasecmp_random)
+{
+    size_t i;
+    char lhs[160], rhs[160];
+    struct kr_jsf32_ctx_s ctx;
+
+    kr_jsf32_srand(&ctx, 1337);
+    for (i = 0; i < 4096; i++)
+    {
+        const size_t lOff = kr_jsf32_rand_uniform(&ctx, 16);
+        const size_t rOff = kr_jsf32_rand_uniform(&ctx, 16);
+        const size_t len = kr_jsf32_rand_uniform(&ctx, sizeof(lhs) - 32);
+        const size_t diff = kr_jsf32_rand_uniform(&ctx, (uint32_t)len + 2);
+        const size_t max = kr_jsf32_rand_uniform(&ctx, (uint32_t)len + 4);
+        size_t j;
+
+        /* Same string with the case of letters randomly flipped. */
+        for (j = 0; j < len; j++)
+        {
+            const char ch = (char)(1 + kr_jsf32_rand_uniform(&ctx, 255));
+            lhs[lOff + j] = ch;
+            rhs[rOff + j] = kr_isalpha(ch) && kr_jsf32_rand_uniform(&ctx, 2) ? (char)(ch ^ 0x20) : ch;
+        }
+        lhs[lOff + len] = rhs[rOff + len] = '\0';
+        if (diff < len)
+        {
+            rhs[rOff + diff] = (char)(1 + kr_jsf32_rand_uniform(&ctx, 255));
+        }
+        else if (diff == len)
+        {
+            rhs[rOff + diff] = 'x';
+            rhs[rOff + diff + 1] = '\0';
+        }
+
+        EXPECT_INTEQ(str_refcasecmp(lhs + lOff, rhs + rOff, (size_t)-1, true), kr_strcasecmp(lhs + lOff, rhs + rOff));
+        EXPECT_INTEQ(str_refcasecmp(lhs + lOff, rhs + rOff, max, true), kr_strncasecmp(lhs + lOff, rhs + rOff, max));
+        EXPECT_INTEQ(str_refcasecmp(lhs + lOff, rhs + rOff, len, false), kr_memcasecmp(lhs + lOff, rhs + rOff, len));
+    }
+}
+
+TEST(str, kr_strlower)
+{
+    size_t off, len, i;
+    char buffer[96], expected[96];
+
+    EXPECT_STREQ("content-type: text/html", kr_strlower(strcpy(buffer, "Content-Type: TEXT/html")));
+    EXPECT_STREQ("CONTENT-TYPE: TEXT/HTML", kr_strupper(strcpy(buffer, "Content-Type: TEXT/html")));
+
+    /* All byte values, every alignment and length around the block sizes. */
+    for (off = 0; off < 8; off++)
+    {
+        for (len = 0; len < 80; len++)
+        {
+            for (i = 0; i < len; i++)
+            {
+                buffer[off + i] = (char)(1 + (i * 37 + off + len) % 255);
+            }
+            buffer[off + len] = '\0';
+            buffer[off + len + 1] = 'A';
+
+            for (i = 0; i <= len + 1; i++)
+            {
+                expected[i] = i < len ? kr_tolower(buffer[off + i]) : buffer[off + i];
+            }
+            kr_strlower(buffer + off);
+            EXPECT_TRUE(memcmp(expected, buffer + off, len + 2) == 0);
+
+            for (i = 0; i <= len + 1; i++)
+            {
+                expected[i] = i < len ? kr_toupper(buffer[off + i]) : buffer[off + i];
+            }
+            kr_strupper(buffer + off);
+            EXPECT_TRUE(memcmp(expected, buffer + off, len + 2) == 0);
+        }
+    }
+}
+
 TEST(str, kr_strscpy)
 {
     ptrdiff_t len;
@@ -48,6 +328,47 @@ TEST(str, kr_strscpy)
     EXPECT_INTEQ(len, 0);
 }
 
+TEST(str, kr_strscpy_sweep)
+{
+    size_t srcLen, destLen, i;
+    char src[80], dest[80];
+
+    /* Lengths on both sides of destLen and of the word/vector widths, making
+       sure nothing past destLen is touched. */
+    for (srcLen = 0; srcLen < 72; srcLen++)
+    {
+        for (i = 0; i < srcLen; i++)
+        {
+            src[i] = (char)('a' + i % 26);
+        }
+        src[srcLen] = '\0';
+
+        for (destLen = 1; destLen < 72; destLen++)
+        {
+            const size_t copied = srcLen < destLen ? srcLen : destLen - 1;
+            ptrdiff_t slen;
+            size_t llen;
+
+            memset(dest, 0xFF, sizeof(dest));
+            slen = kr_strscpy(dest, src, destLen);
+            EXPECT_INTEQ(srcLen < destLen ? (ptrdiff_t)srcLen : -1, slen);
+            EXPECT_TRUE(memcmp(dest, src, copied) == 0 && dest[copied] == '\0');
+            EXPECT_CHAREQ('\xff', dest[destLen]);
+
+            memset(dest, 0xFF, sizeof(dest));
+            llen = kr_strlcpy(dest, src, destLen);
+            EXPECT_UINTEQ(srcLen, llen);
+            EXPECT_TRUE(memcmp(dest, src, copied) == 0 && dest[copied] == '\0');
+            EXPECT_CHAREQ('\xff', dest[destLen]);
+
+            memset(dest, 0xFF, sizeof(dest));
+            EXPECT_TRUE(kr_stpecpy(dest, dest + destLen, src) == (srcLen < destLen ? dest + srcLen : NULL));
+            EXPECT_TRUE(memcmp(dest, src, copied) == 0 && dest[copied] == '\0');
+            EXPECT_CHAREQ('\xff', dest[destLen]);
+        }
+    }
+}
+
 TEST(str, kr_strscat)
 {
     ptrdiff_t len;
@@ -178,6 +499,198 @@ TEST(str, kr_strcspn)
     EXPECT_UINTEQ(0, kr_strcspn("", "xyz"));
 }
 
+TEST(str, kr_charset)
+{
+    int i;
+    struct kr_charset_s set;
+
+    kr_charset_init(&set, "az\x7f\x80\xff");
+    for (i = 0; i < 0x100; i++)
+    {
+        bool expected = i == 'a' || i == 'z' || i == 0x7f || i == 0x80 || i == 0xff;
+        EXPECT_BOOLEQ(expected, kr_charset_has(&set, (char)i));
+    }
+
+    kr_charset_add(&set, '\0');
+    EXPECT_TRUE(kr_charset_has(&set, '\0'));
+}
+
+TEST(str, kr_strspn_set)
+{
+    size_t i, j;
+    char buffer[160], chars[8];
+    struct kr_charset_s set;
+    struct kr_jsf32_ctx_s ctx;
+
+    EXPECT_UINTEQ(3, kr_strspn_set("plugh", (kr_charset_init(&set, "plu"), &set)));
+    EXPECT_UINTEQ(0, kr_strspn_set("plugh", (kr_charset_init(&set, ""), &set)));
+
+    /* Compare against kr_strspn with random sets of non-null bytes. */
+    kr_jsf32_srand(&ctx, 1993);
+    for (i = 0; i < 256; i++)
+    {
+        const size_t offset = kr_jsf32_rand_uniform(&ctx, 32);
+        const uint32_t range = 1 + kr_jsf32_rand_uniform(&ctx, 255);
+
+        for (j = 0; j < sizeof(chars) - 1; j++)
+        {
+            chars[j] = (char)(1 + kr_jsf32_rand_uniform(&ctx, range));
+        }
+        chars[j] = '\0';
+        for (j = 0; j < sizeof(buffer) - 1; j++)
+        {
+            buffer[j] = chars[kr_jsf32_rand_uniform(&ctx, sizeof(chars) - 1)];
+        }
+        buffer[kr_jsf32_rand_uniform(&ctx, sizeof(buffer) - 1)] = (char)(1 + kr_jsf32_rand_uniform(&ctx, 255));
+        buffer[j] = '\0';
+
+        kr_charset_init(&set, chars);
+        EXPECT_UINTEQ(kr_strspn(buffer + offset, chars), kr_strspn_set(buffer + offset, &set));
+#if (KR_SSSE3)
+        EXPECT_UINTEQ(kr_strspn(buffer + offset, chars), kr_strspn_set_ssse3(buffer + offset, &set));
+#endif
+#if (KR_AVX2)
+        EXPECT_UINTEQ(kr_strspn(buffer + offset, chars), kr_strspn_set_avx2(buffer + offset, &set));
+#endif
+    }
+
+    /* The terminator ends the span, even if it's in the set. */
+    kr_charset_init(&set, "a");
+    kr_charset_add(&set, '\0');
+    EXPECT_UINTEQ(3, kr_strspn_set("aaa\0aaa", &set));
+}
+
+TEST(str, kr_strcspn_set)
+{
+    size_t i, j;
+    char buffer[160], chars[8];
+    struct kr_charset_s set;
+    struct kr_jsf32_ctx_s ctx;
+
+    EXPECT_UINTEQ(3, kr_strcspn_set("plugh", (kr_charset_init(&set, "ghxyz"), &set)));
+    EXPECT_UINTEQ(5, kr_strcspn_set("plugh", (kr_charset_init(&set, ""), &set)));
+
+    /* Compare against kr_strcspn with random sets of non-null bytes. */
+    kr_jsf32_srand(&ctx, 1993);
+    for (i = 0; i < 256; i++)
+    {
+        const size_t offset = kr_jsf32_rand_uniform(&ctx, 32);
+        const uint32_t range = 1 + kr_jsf32_rand_uniform(&ctx, 255);
+
+        for (j = 0; j < sizeof(chars) - 1; j++)
+        {
+            chars[j] = (char)(1 + kr_jsf32_rand_uniform(&ctx, 255));
+        }
+        chars[j] = '\0';
+        for (j = 0; j < sizeof(buffer) - 1; j++)
+        {
+            buffer[j] = (char)(1 + kr_jsf32_rand_uniform(&ctx, range));
+        }
+        buffer[j] = '\0';
+
+        kr_charset_init(&set, chars);
+        EXPECT_UINTEQ(kr_strcspn(buffer + offset, chars), kr_strcspn_set(buffer + offset, &set));
+#if (KR_SSSE3)
+        EXPECT_UINTEQ(kr_strcspn(buffer + offset, chars), kr_strcspn_set_ssse3(buffer + offset, &set));
+#endif
+#if (KR_AVX2)
+        EXPECT_UINTEQ(kr_strcspn(buffer + offset, chars), kr_strcspn_set_avx2(buffer + offset, &set));
+#endif
+    }
+}
+
+TEST(str, kr_tokenize)
+{
+    const char str[] = "//foo/bar\\baz//\\plugh/";
+    struct kr_token_s toks[8];
+    struct kr_charset_s delims;
+    size_t count;
+
+    kr_charset_init(&delims, "/\\");
+
+    count = kr_tokenize(str, sizeof(str) - 1, &delims, toks, kr_countof(toks));
+    EXPECT_UINTEQ(4, count);
+    EXPECT_UINTEQ(2, toks[0].offset);
+    EXPECT_UINTEQ(3, toks[0].length);
+    EXPECT_UINTEQ(6, toks[1].offset);
+    EXPECT_UINTEQ(3, toks[1].length);
+    EXPECT_UINTEQ(10, toks[2].offset);
+    EXPECT_UINTEQ(3, toks[2].length);
+    EXPECT_UINTEQ(16, toks[3].offset);
+    EXPECT_UINTEQ(5, toks[3].length);
+
+    /* Last token has no trailing delimiter. */
+    count = kr_tokenize(str, sizeof(str) - 3, &delims, toks, kr_countof(toks));
+    EXPECT_UINTEQ(4, count);
+    EXPECT_UINTEQ(4, toks[3].length);
+
+    /* Not enough room. */
+    count = kr_tokenize(str, sizeof(str) - 1, &delims, toks, 2);
+    EXPECT_UINTEQ(2, count);
+    EXPECT_UINTEQ(6, toks[1].offset);
+
+    count = kr_tokenize("", 0, &delims, toks, kr_countof(toks));
+    EXPECT_UINTEQ(0, count);
+}
+
+TEST(str, kr_tokenizer)
+{
+    size_t i, j;
+    char buffer[300], copy[300];
+    struct kr_token_s toks[4];
+    struct kr_charset_s delims;
+    struct kr_tokenizer_s tok;
+    struct kr_jsf32_ctx_s ctx;
+
+    kr_charset_init(&delims, " ,\xff");
+    kr_jsf32_srand(&ctx, 1993);
+    for (i = 0; i < 64; i++)
+    {
+        const char *expected = NULL;
+        char *ptr = NULL;
+        size_t pos = 0;
+
+        for (j = 0; j < sizeof(buffer) - 1; j++)
+        {
+            static const char alphabet[] = "ab ,\xff\xfe";
+            buffer[j] = alphabet[kr_jsf32_rand_uniform(&ctx, sizeof(alphabet) - 1)];
+        }
+        buffer[j] = '\0';
+        memcpy(copy, buffer, sizeof(buffer));
+
+        /* Feed random chunks with a tiny token array, check with strtok. */
+        kr_tokenizer_init(&tok, &delims);
+        expected = kr_strtok_r(copy, " ,\xff", &ptr);
+        while (pos < sizeof(buffer) - 1)
+        {
+            size_t consumed = 0, count = 0, chunk = 1 + kr_jsf32_rand_uniform(&ctx, 80);
+            if (chunk > sizeof(buffer) - 1 - pos)
+            {
+                chunk = sizeof(buffer) - 1 - pos;
+            }
+
+            count = kr_tokenizer_feed(&tok, buffer + pos, chunk, toks, kr_countof(toks), &consumed);
+            for (j = 0; j < count; j++)
+            {
+                ASSERT_TRUE(expected != NULL);
+                EXPECT_UINTEQ(expected - copy, toks[j].offset);
+                EXPECT_UINTEQ(strlen(expected), toks[j].length);
+                expected = kr_strtok_r(NULL, " ,\xff", &ptr);
+            }
+            pos += consumed;
+        }
+
+        if (kr_tokenizer_finish(&tok, &toks[0]))
+        {
+            ASSERT_TRUE(expected != NULL);
+            EXPECT_UINTEQ(expected - copy, toks[0].offset);
+            EXPECT_UINTEQ(strlen(expected), toks[0].length);
+            expected = kr_strtok_r(NULL, " ,\xff", &ptr);
+        }
+        EXPECT_TRUE(expected == NULL);
+    }
+}
+
 TEST(str, kr_strtok_r)
 {
     char *r = NULL, *ptr = NULL;
@@ -213,6 +726,195 @@ TEST(str, kr_strtok_r)
     }
 }
 
+TEST(str, kr_memchr)
+{
+    size_t offset, len, pos;
+    char buffer[160];
+
+    memset(buffer, 'a', sizeof(buffer));
+    for (offset = 0; offset < 32; offset++)
+    {
+        for (len = 0; len < 96; len++)
+        {
+            EXPECT_TRUE(kr_memchr(buffer + offset, 'b', len) == NULL);
+            for (pos = 0; pos < len; pos++)
+            {
+                buffer[offset + pos] = 'b';
+                buffer[offset + len] = 'b'; /* Just out of reach. */
+                EXPECT_TRUE(kr_memchr(buffer + offset, 'b', len) == buffer + offset + pos);
+                buffer[offset + pos] = 'a';
+                buffer[offset + len] = 'a';
+            }
+        }
+    }
+
+    EXPECT_TRUE(kr_memchr("\xff\x7f", 0xff, 2) != NULL);
+    EXPECT_TRUE(kr_memchr("\xff\x7f", -1, 2) != NULL);
+}
+
+TEST(str, kr_memrchr)
+{
+    size_t offset, len, pos;
+    char buffer[160];
+
+    memset(buffer, 'a', sizeof(buffer));
+    for (offset = 1; offset < 32; offset++)
+    {
+        for (len = 0; len < 96; len++)
+        {
+            EXPECT_TRUE(kr_memrchr(buffer + offset, 'b', len) == NULL);
+            for (pos = 0; pos < len; pos++)
+            {
+                buffer[offset + pos] = 'b';
+                buffer[offset - 1] = 'b'; /* Just out of reach. */
+                EXPECT_TRUE(kr_memrchr(buffer + offset, 'b', len) == buffer + offset + pos);
+                buffer[offset + pos] = 'a';
+                buffer[offset - 1] = 'a';
+            }
+        }
+    }
+
+    EXPECT_STREQ(KR_CASTS(char *, kr_memrchr("a/b/c", '/', 5)), "/c");
+}
+
+TEST(str, kr_memmem)
+{
+    size_t i, j, pos;
+    char haystack[200], needle[24];
+    struct kr_jsf32_ctx_s ctx;
+
+    EXPECT_TRUE(kr_memmem("plugh", 5, "", 0) != NULL);
+    EXPECT_TRUE(kr_memmem("", 0, "", 0) != NULL);
+    EXPECT_TRUE(kr_memmem("plugh", 5, "plughs", 6) == NULL);
+    EXPECT_STREQ(KR_CASTS(char *, kr_memmem("plugh\0xyzzy", 11, "\0xy", 3)) + 1, "xyzzy");
+
+    /* Compare against the obvious search, using small alphabets so we get
+       plenty of partial matches and periodic needles. */
+    kr_jsf32_srand(&ctx, 1993);
+    for (i = 0; i < 2048; i++)
+    {
+        const uint32_t alphabet = 1 + kr_jsf32_rand_uniform(&ctx, 4);
+        const size_t haystackLen = kr_jsf32_rand_uniform(&ctx, sizeof(haystack));
+        const size_t needleLen = 1 + kr_jsf32_rand_uniform(&ctx, sizeof(needle) - 1);
+        const char *expected = NULL;
+
+        for (j = 0; j < haystackLen; j++)
+        {
+            haystack[j] = (char)('a' + kr_jsf32_rand_uniform(&ctx, alphabet));
+        }
+        for (j = 0; j < needleLen; j++)
+        {
+            needle[j] = (char)('a' + kr_jsf32_rand_uniform(&ctx, alphabet));
+        }
+        if (needleLen <= haystackLen && kr_jsf32_rand_uniform(&ctx, 2) == 0)
+        {
+            /* Plant the needle so there's usually a match. */
+            memcpy(haystack + kr_jsf32_rand_uniform(&ctx, (uint32_t)(haystackLen - needleLen + 1)), needle, needleLen);
+        }
+
+        for (pos = 0; pos + needleLen <= haystackLen; pos++)
+        {
+            if (memcmp(haystack + pos, needle, needleLen) == 0)
+            {
+                expected = haystack + pos;
+                break;
+            }
+        }
+        EXPECT_TRUE(kr_memmem(haystack, haystackLen, needle, needleLen) == expected);
+    }
+}
+
+TEST(str, kr_strstr)
+{
+    char buffer[4096];
+
+    EXPECT_STREQ(kr_strstr("xyzzy plugh", "plugh"), "plugh");
+    EXPECT_STREQ(kr_strstr("xyzzy plugh", ""), "xyzzy plugh");
+    EXPECT_STREQ(kr_strstr("xyzzy plugh", "zy"), "zy plugh");
+    EXPECT_TRUE(kr_strstr("xyzzy plugh", "plughs") == NULL);
+    EXPECT_TRUE(kr_strstr("", "x") == NULL);
+
+    /* Worst case for a naive search. */
+    memset(buffer, 'a', sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 2] = 'b';
+    buffer[sizeof(buffer) - 1] = '\0';
+    EXPECT_TRUE(kr_strstr(buffer, "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab") == buffer + sizeof(buffer) - 33);
+    EXPECT_TRUE(kr_strstr(buffer, "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaac") == NULL);
+    EXPECT_TRUE(kr_strstr(buffer, "baaa") == NULL);
+}
+
+TEST(str, kr_searcher)
+{
+    static const size_t needleLens[] = {1, 2, 3, 8, 31, 64, 65, 200, 255, 256, 300};
+    size_t i, j, k, pos;
+    char haystack[1024], needle[300];
+    struct kr_searcher_s searcher;
+    struct kr_jsf32_ctx_s ctx;
+
+    kr_searcher_init(&searcher, "", 0);
+    EXPECT_TRUE(kr_searcher_find(&searcher, "plugh", 5) != NULL);
+    EXPECT_UINTEQ(6, kr_searcher_count(&searcher, "plugh", 5));
+
+    kr_searcher_init(&searcher, "aa", 2);
+    EXPECT_UINTEQ(2, kr_searcher_count(&searcher, "aaaaa", 5));
+    EXPECT_UINTEQ(0, kr_searcher_count(&searcher, "a", 1));
+
+    memset(needle, 'a', sizeof(needle));
+    kr_searcher_init(&searcher, needle, 1);
+    EXPECT_TRUE(searcher.algo == KR_SEARCHER_MEMCHR);
+#if (KR_SSE2)
+    kr_searcher_init(&searcher, needle, 300);
+    EXPECT_TRUE(searcher.algo == KR_SEARCHER_SIMD);
+#else
+    kr_searcher_init(&searcher, needle, 255);
+    EXPECT_TRUE(searcher.algo == KR_SEARCHER_HORSPOOL);
+    kr_searcher_init(&searcher, needle, 256);
+    EXPECT_TRUE(searcher.algo == KR_SEARCHER_TWOWAY);
+#endif
+
+    /* Compare against the obvious search at every algorithm's lengths. */
+    kr_jsf32_srand(&ctx, 1993);
+    for (i = 0; i < 512; i++)
+    {
+        const uint32_t alphabet = 1 + kr_jsf32_rand_uniform(&ctx, 4);
+        const size_t haystackLen = kr_jsf32_rand_uniform(&ctx, sizeof(haystack));
+        const size_t needleLen = needleLens[i % (sizeof(needleLens) / sizeof(needleLens[0]))];
+        const char *expected = NULL;
+        size_t expectedCount = 0;
+
+        for (j = 0; j < haystackLen; j++)
+        {
+            haystack[j] = (char)('a' + kr_jsf32_rand_uniform(&ctx, alphabet));
+        }
+        for (j = 0; j < needleLen; j++)
+        {
+            needle[j] = (char)('a' + kr_jsf32_rand_uniform(&ctx, alphabet));
+        }
+        for (k = kr_jsf32_rand_uniform(&ctx, 4); k > 0 && needleLen <= haystackLen; k--)
+        {
+            /* Plant a few needles so there's usually a match. */
+            memcpy(haystack + kr_jsf32_rand_uniform(&ctx, (uint32_t)(haystackLen - needleLen + 1)), needle, needleLen);
+        }
+
+        for (pos = 0; pos + needleLen <= haystackLen; pos++)
+        {
+            if (memcmp(haystack + pos, needle, needleLen) == 0)
+            {
+                if (expected == NULL)
+                {
+                    expected = haystack + pos;
+                }
+                expectedCount++;
+                pos += needleLen - 1;
+            }
+        }
+
+        kr_searcher_init(&searcher, needle, needleLen);
+        EXPECT_TRUE(kr_searcher_find(&searcher, haystack, haystackLen) == expected);
+        EXPECT_UINTEQ(expectedCount, kr_searcher_count(&searcher, haystack, haystackLen));
+    }
+}
+
 TEST(str, kr_memccpy)
 {
     char *ptr = NULL;
@@ -232,14 +934,33 @@ TEST(str, kr_memccpy)
 
 SUITE(str)
 {
+    SUITE_TEST(str, kr_strlen);
+    SUITE_TEST(str, kr_strnlen);
     SUITE_TEST(str, kr_strcmp);
+    SUITE_TEST(str, kr_strcmp_random);
+    SUITE_TEST(str, kr_strncmp);
+    SUITE_TEST(str, kr_memcmp);
+    SUITE_TEST(str, kr_strcasecmp);
+    SUITE_TEST(str, kr_strcasecmp_random);
+    SUITE_TEST(str, kr_strlower);
     SUITE_TEST(str, kr_strscpy);
+    SUITE_TEST(str, kr_strscpy_sweep);
     SUITE_TEST(str, kr_strscat);
     SUITE_TEST(str, kr_strlcpy);
     SUITE_TEST(str, kr_strlcat);
     SUITE_TEST(str, kr_stpecpy);
     SUITE_TEST(str, kr_strspn);
     SUITE_TEST(str, kr_strcspn);
+    SUITE_TEST(str, kr_charset);
+    SUITE_TEST(str, kr_strspn_set);
+    SUITE_TEST(str, kr_strcspn_set);
+    SUITE_TEST(str, kr_tokenize);
+    SUITE_TEST(str, kr_tokenizer);
     SUITE_TEST(str, kr_strtok_r);
     SUITE_TEST(str, kr_memccpy);
+    SUITE_TEST(str, kr_memchr);
+    SUITE_TEST(str, kr_memrchr);
+    SUITE_TEST(str, kr_memmem);
+    SUITE_TEST(str, kr_strstr);
+    SUITE_TEST(str, kr_searcher);
 }
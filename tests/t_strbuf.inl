@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "zztest.h"
+
+#include "krstrbuf.h"
+
+TEST(strbuf, kr_strbuf_append)
+{
+    size_t i;
+    struct kr_strbuf_s buf;
+
+    kr_strbuf_init(&buf);
+    EXPECT_STREQ("", kr_strbuf_cstr(&buf));
+
+    ASSERT_TRUE(kr_strbuf_append(&buf, "abc"));
+    ASSERT_TRUE(kr_strbuf_appendn(&buf, "defxyz", 3));
+    ASSERT_TRUE(kr_strbuf_append(&buf, ""));
+    EXPECT_STREQ("abcdef", kr_strbuf_cstr(&buf));
+    EXPECT_UINTEQ(6, buf.len);
+
+    /* Enough to grow several times. */
+    for (i = 0; i < 500; i++)
+    {
+        ASSERT_TRUE(kr_strbuf_append(&buf, "0123456789"));
+    }
+    EXPECT_UINTEQ(5006, buf.len);
+    EXPECT_UINTEQ(5006, kr_strlen(kr_strbuf_cstr(&buf)));
+    EXPECT_TRUE(buf.cap > buf.len);
+    EXPECT_STREQ("789", kr_strbuf_cstr(&buf) + 5003);
+
+    kr_strbuf_clear(&buf);
+    EXPECT_STREQ("", kr_strbuf_cstr(&buf));
+    EXPECT_UINTEQ(0, buf.len);
+    kr_strbuf_destroy(&buf);
+    EXPECT_TRUE(buf.data == NULL);
+}
+
+TEST(strbuf, kr_strbuf_reserve)
+{
+    size_t cap;
+    struct kr_strbuf_s buf;
+
+    kr_strbuf_init(&buf);
+    ASSERT_TRUE(kr_strbuf_reserve(&buf, 100));
+    EXPECT_TRUE(buf.cap >= 101);
+    EXPECT_STREQ("", kr_strbuf_cstr(&buf));
+
+    /* No reallocation within the reservation. */
+    cap = buf.cap;
+    ASSERT_TRUE(kr_strbuf_appendn(&buf, "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx", 50));
+    ASSERT_TRUE(kr_strbuf_appendn(&buf, "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx", 50));
+    EXPECT_UINTEQ(cap, buf.cap);
+
+    /* Overflow is refused and leaves the buffer alone. */
+    EXPECT_FALSE(kr_strbuf_reserve(&buf, (size_t)-1 - 50));
+    EXPECT_UINTEQ(100, buf.len);
+    EXPECT_UINTEQ(cap, buf.cap);
+    kr_strbuf_destroy(&buf);
+}
+
+static bool strbuf_vappendf(struct kr_strbuf_s *buf, const char *fmt, ...)
+{
+    bool ok;
+    va_list args;
+
+    va_start(args, fmt);
+    ok = kr_strbuf_vappendf(buf, fmt, args);
+    va_end(args);
+    return ok;
+}
+
+TEST(strbuf, kr_strbuf_appendf)
+{
+    size_t i;
+    struct kr_strbuf_s buf;
+
+    kr_strbuf_init(&buf);
+    ASSERT_TRUE(kr_strbuf_appendf(&buf, "%s=%d", "xyzzy", 42));
+    ASSERT_TRUE(kr_strbuf_appendf(&buf, ""));
+    ASSERT_TRUE(strbuf_vappendf(&buf, ", %c%c", 'o', 'k'));
+    EXPECT_STREQ("xyzzy=42, ok", kr_strbuf_cstr(&buf));
+
+    /* Output much longer than the format has to grow and retry. */
+    for (i = 0; i < 20; i++)
+    {
+        ASSERT_TRUE(kr_strbuf_appendf(&buf, "%64s|", "plugh"));
+    }
+    EXPECT_UINTEQ(12 + 20 * 65, buf.len);
+    EXPECT_UINTEQ(buf.len, kr_strlen(kr_strbuf_cstr(&buf)));
+    EXPECT_STREQ("plugh|", kr_strbuf_cstr(&buf) + buf.len - 6);
+    kr_strbuf_destroy(&buf);
+}
+
+TEST(strbuf, kr_strbuf_detach)
+{
+    char *str;
+    size_t len = 1;
+    struct kr_strbuf_s buf;
+
+    /* An unallocated buffer still gives back a string. */
+    kr_strbuf_init(&buf);
+    str = kr_strbuf_detach(&buf, &len);
+    ASSERT_TRUE(str != NULL);
+    EXPECT_STREQ("", str);
+    EXPECT_UINTEQ(0, len);
+    KR_FREE(str);
+
+    ASSERT_TRUE(kr_strbuf_append(&buf, "plugh"));
+    str = kr_strbuf_detach(&buf, &len);
+    ASSERT_TRUE(str != NULL);
+    EXPECT_STREQ("plugh", str);
+    EXPECT_UINTEQ(5, len);
+    EXPECT_TRUE(buf.data == NULL);
+    EXPECT_UINTEQ(0, buf.len);
+    KR_FREE(str);
+}
+
+TEST(strbuf, kr_strbuf_end)
+{
+    char *end, *destEnd;
+    struct kr_strbuf_s buf;
+
+    kr_strbuf_init(&buf);
+    ASSERT_TRUE(kr_strbuf_append(&buf, "abc"));
+    ASSERT_TRUE(kr_strbuf_reserve(&buf, 6));
+
+    end = kr_strbuf_end(&buf, &destEnd);
+    end = kr_stpecpy(end, destEnd, "def");
+    end = kr_stpecpy(end, destEnd, "ghi");
+    EXPECT_TRUE(kr_strbuf_setend(&buf, end));
+    EXPECT_STREQ("abcdefghi", kr_strbuf_cstr(&buf));
+    EXPECT_UINTEQ(9, buf.len);
+
+    /* Running out of room rolls back to the old contents. */
+    end = kr_strbuf_end(&buf, &destEnd);
+    while (end != NULL)
+    {
+        end = kr_stpecpy(end, destEnd, "jkl");
+    }
+    EXPECT_FALSE(kr_strbuf_setend(&buf, end));
+    EXPECT_STREQ("abcdefghi", kr_strbuf_cstr(&buf));
+    EXPECT_UINTEQ(9, buf.len);
+    kr_strbuf_destroy(&buf);
+
+    /* Nothing allocated means the chain fails cleanly. */
+    end = kr_strbuf_end(&buf, &destEnd);
+    end = kr_stpecpy(end, destEnd, "abc");
+    EXPECT_FALSE(kr_strbuf_setend(&buf, end));
+    EXPECT_STREQ("", kr_strbuf_cstr(&buf));
+}
+
+SUITE(strbuf)
+{
+    SUITE_TEST(strbuf, kr_strbuf_append);
+    SUITE_TEST(strbuf, kr_strbuf_reserve);
+    SUITE_TEST(strbuf, kr_strbuf_appendf);
+    SUITE_TEST(strbuf, kr_strbuf_detach);
+    SUITE_TEST(strbuf, kr_strbuf_end);
+}
@@ -0,0 +1,429 @@
+/*
+ * Copyright (c) 2024 Lexi Mayfield
+ *
+ * Distributed under the Boost Software License, Version 1.0. (See
+ * accompanying file LICENSE.txt or copy at
+ * http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <string.h>
+
+#include "zztest.h"
+
+#include "krutf8.h"
+
+#include "krlib.h"
+#include "krrand.h"
+
+/* Decode each code point the slow way, and check its value afterwards. */
+static size_t utf8_reference(const unsigned char *s, size_t len)
+{
+    static const unsigned long mins[] = {0, 0, 0x80, 0x800, 0x10000};
+    size_t i = 0, n, j;
+    unsigned long cp;
+
+    while (i < len)
+    {
+        if (s[i] < 0x80)
+        {
+            i++;
+            continue;
+        }
+
+        for (n = 0; n < 8 && (s[i] & (0x80 >> n)); n++)
+        {
+        }
+        if (n < 2 || n > 4 || len - i < n)
+        {
+            return i;
+        }
+
+        cp = s[i] & (0x7F >> n);
+        for (j = 1; j < n; j++)
+        {
+            if ((s[i + j] & 0xC0) != 0x80)
+            {
+                return i;
+            }
+            cp = (cp << 6) | (s[i + j] & 0x3F);
+        }
+        if (cp < mins[n] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+        {
+            return i;
+        }
+        i += n;
+    }
+    return len;
+}
+
+/* Run every validator on the same input, and check they agree. */
+static void utf8_check(struct zzt_test_state_s *zzt_test_state, const unsigned char *s, size_t len)
+{
+    const char *str = (const char *)s;
+    const size_t expected = utf8_reference(s, len);
+
+    EXPECT_UINTEQ(expected, kr_utf8_validate(str, len));
+    EXPECT_UINTEQ(expected, kr_utf8_validate_swar(str, len));
+#if (KR_SSSE3)
+    EXPECT_UINTEQ(expected, kr_utf8_validate_ssse3(str, len));
+#endif
+#if (KR_AVX2)
+    EXPECT_UINTEQ(expected, kr_utf8_validate_avx2(str, len));
+#endif
+}
+
+TEST(utf8, kr_utf8_validate)
+{
+    static const char *const valid[] = {
+        "",
+        "plain ASCII text that fills more than one block of every variant",
+        "caf\xC3\xA9 na\xC3\xAFve r\xC3\xA9sum\xC3\xA9",
+        "\xE4\xB8\xAD\xE6\x96\x87\xE6\x96\x87\xE6\x9C\xAC\xE3\x81\xAE\xE4\xBE\x8B\xE3\x81\xA7\xE3\x81\x99",
+        "\xF0\x9F\x98\x80\xF0\x9F\x98\x81\xF0\x9F\x98\x82\xF0\x9F\x98\x83\xF0\x9F\x98\x84",
+        "\xC2\x80\xDF\xBF\xE0\xA0\x80\xEF\xBF\xBF\xED\x9F\xBF\xEE\x80\x80\xF0\x90\x80\x80\xF4\x8F\xBF\xBF",
+    };
+    static const char *const invalid[] = {
+        "\x80",         "\xBF",          "\xC0\x80",         "\xC1\xBF",         "\xC2",
+        "\xC2\x41",     "\xE0\x80\x80",  "\xE0\x9F\xBF",     "\xED\xA0\x80",     "\xED\xBF\xBF",
+        "\xE4\xB8",     "\xE4\x41\xAD",  "\xF0\x80\x80\x80", "\xF0\x8F\xBF\xBF", "\xF4\x90\x80\x80",
+        "\xF5\x80\x80\x80", "\xF8\x88\x80\x80\x80", "\xFE", "\xFF", "\xF0\x9F\x98",
+    };
+    size_t i;
+
+    for (i = 0; i < kr_countof(valid); i++)
+    {
+        const size_t len = strlen(valid[i]);
+        EXPECT_UINTEQ(len, kr_utf8_validate(valid[i], len));
+        utf8_check(zzt_test_state, (const unsigned char *)valid[i], len);
+    }
+    for (i = 0; i < kr_countof(invalid); i++)
+    {
+        EXPECT_UINTEQ(0, kr_utf8_validate(invalid[i], strlen(invalid[i])));
+        utf8_check(zzt_test_state, (const unsigned char *)invalid[i], strlen(invalid[i]));
+    }
+
+    /* NUL is valid, and length is respected. */
+    EXPECT_UINTEQ(3, kr_utf8_validate("a\0b", 3));
+    EXPECT_UINTEQ(1, kr_utf8_validate("a\xC3\xA9", 2));
+}
+
+TEST(utf8, kr_utf8_validate_invalid)
+{
+    static const unsigned char bad[] = {0x00, 0x41, 0x7F, 0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF, 0xC0,
+                                        0xC1, 0xC2, 0xDF, 0xE0, 0xED, 0xEF, 0xF0, 0xF4, 0xF5, 0xFF};
+    static const char *const pieces[] = {"a", "\xC3\xA9", "\xE4\xB8\xAD", "\xF0\x9F\x98\x80"};
+    unsigned char src[100];
+    size_t len, pos, i, j;
+
+    /* Mixed sequences, so each byte of each length lands at every position of
+       every block, and every replacement breaks it differently. */
+    for (j = 0; j < 4; j++)
+    {
+        len = 0;
+        for (i = j; len + 4 <= sizeof(src); i++)
+        {
+            const char *piece = pieces[(i * 5 / 3) % 4];
+            memcpy(src + len, piece, strlen(piece));
+            len += strlen(piece);
+        }
+
+        for (pos = 0; pos <= len; pos++)
+        {
+            utf8_check(zzt_test_state, src, pos);
+        }
+        for (pos = 0; pos < len; pos++)
+        {
+            for (i = 0; i < kr_countof(bad); i++)
+            {
+                const unsigned char saved = src[pos];
+                src[pos] = bad[i];
+                utf8_check(zzt_test_state, src, len);
+                src[pos] = saved;
+            }
+        }
+    }
+}
+
+static size_t utf8_encode(unsigned char *dest, unsigned long cp)
+{
+    if (cp < 0x80)
+    {
+        dest[0] = (unsigned char)cp;
+        return 1;
+    }
+    else if (cp < 0x800)
+    {
+        dest[0] = (unsigned char)(0xC0 | (cp >> 6));
+        dest[1] = (unsigned char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    else if (cp < 0x10000)
+    {
+        dest[0] = (unsigned char)(0xE0 | (cp >> 12));
+        dest[1] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+        dest[2] = (unsigned char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    dest[0] = (unsigned char)(0xF0 | (cp >> 18));
+    dest[1] = (unsigned char)(0x80 | ((cp >> 12) & 0x3F));
+    dest[2] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+    dest[3] = (unsigned char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+TEST(utf8, kr_utf8_validate_random)
+{
+    static const unsigned long ranges[][2] = {
+        {0x00, 0x7F}, {0x80, 0x7FF}, {0x800, 0xD7FF}, {0xE000, 0xFFFF}, {0x10000, 0x10FFFF},
+    };
+    unsigned char src[300];
+    struct kr_jsf32_ctx_s ctx;
+    size_t i, len;
+
+    kr_jsf32_srand(&ctx, 0x55546638);
+    for (i = 0; i < 2000; i++)
+    {
+        /* Long ASCII runs some of the time, to hit the skipping paths. */
+        const uint32_t asciiOdds = kr_jsf32_rand_uniform(&ctx, 4) * 8;
+
+        len = 0;
+        while (len + 4 <= sizeof(src))
+        {
+            const uint32_t pick = kr_jsf32_rand_uniform(&ctx, 5 + asciiOdds);
+            const unsigned long *range = ranges[pick < 5 ? pick : 0];
+            const unsigned long cp = range[0] + kr_jsf32_rand_uniform(&ctx, (uint32_t)(range[1] - range[0] + 1));
+
+            len += utf8_encode(src + len, cp);
+        }
+
+        EXPECT_UINTEQ(len, kr_utf8_validate((const char *)src, len));
+        utf8_check(zzt_test_state, src, len);
+
+        /* Then corrupt a random byte, or truncate. */
+        if (i & 1)
+        {
+            src[kr_jsf32_rand_uniform(&ctx, (uint32_t)len)] = (unsigned char)kr_jsf32_rand(&ctx);
+            utf8_check(zzt_test_state, src, len);
+        }
+        else
+        {
+            utf8_check(zzt_test_state, src, kr_jsf32_rand_uniform(&ctx, (uint32_t)len));
+        }
+    }
+}
+
+/* Random code points, with long runs of ASCII some of the time to hit the
+   skipping paths. */
+static size_t utf8_random(struct kr_jsf32_ctx_s *ctx, unsigned long *cps, size_t max)
+{
+    static const unsigned long ranges[][2] = {
+        {0x00, 0x7F}, {0x80, 0x7FF}, {0x800, 0xD7FF}, {0xE000, 0xFFFF}, {0x10000, 0x10FFFF},
+    };
+    const uint32_t asciiOdds = kr_jsf32_rand_uniform(ctx, 4) * 8;
+    const size_t count = kr_jsf32_rand_uniform(ctx, (uint32_t)max + 1);
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        const uint32_t pick = kr_jsf32_rand_uniform(ctx, 5 + asciiOdds);
+        const unsigned long *range = ranges[pick < 5 ? pick : 0];
+        cps[i] = range[0] + kr_jsf32_rand_uniform(ctx, (uint32_t)(range[1] - range[0] + 1));
+    }
+    return count;
+}
+
+/* Write a code unit of size bytes in either order, one byte at a time. */
+static void utf_put_unit(unsigned char *dest, unsigned long unit, size_t size, int be)
+{
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        dest[be ? size - 1 - i : i] = (unsigned char)(unit >> (i * 8));
+    }
+}
+
+static unsigned long utf_get_unit(const unsigned char *src, size_t size, int be)
+{
+    unsigned long unit = 0;
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        unit |= (unsigned long)src[be ? size - 1 - i : i] << (i * 8);
+    }
+    return unit;
+}
+
+/* Find the first surrogate that isn't part of a high-low pair. */
+static size_t utf16_reference(const unsigned char *src, size_t len, int be)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        const unsigned long unit = utf_get_unit(src + i * 2, 2, be);
+        if (unit >= 0xD800 && unit <= 0xDBFF && i + 1 < len)
+        {
+            const unsigned long low = utf_get_unit(src + i * 2 + 2, 2, be);
+            if (low >= 0xDC00 && low <= 0xDFFF)
+            {
+                i++;
+                continue;
+            }
+        }
+        if (unit >= 0xD800 && unit <= 0xDFFF)
+        {
+            return i;
+        }
+    }
+    return len;
+}
+
+/* Encode code points as UTF-8, UTF-16 and UTF-32, and return the lengths
+   in code units. */
+static void utf_encode_all(const unsigned long *cps, size_t count, int be, unsigned char *u8, size_t *len8,
+                           unsigned char *u16, size_t *len16, unsigned char *u32)
+{
+    size_t i;
+
+    *len8 = 0;
+    *len16 = 0;
+    for (i = 0; i < count; i++)
+    {
+        *len8 += utf8_encode(u8 + *len8, cps[i]);
+        if (cps[i] >= 0x10000)
+        {
+            utf_put_unit(u16 + *len16 * 2, 0xD800 | ((cps[i] - 0x10000) >> 10), 2, be);
+            utf_put_unit(u16 + *len16 * 2 + 2, 0xDC00 | (cps[i] & 0x3FF), 2, be);
+            *len16 += 2;
+        }
+        else
+        {
+            utf_put_unit(u16 + *len16 * 2, cps[i], 2, be);
+            *len16 += 1;
+        }
+        utf_put_unit(u32 + i * 4, cps[i], 4, be);
+    }
+}
+
+TEST(utf8, kr_utf_convert)
+{
+    static const unsigned flagsList[] = {0, KR_UTF_BE, KR_UTF_NATIVE};
+    unsigned long cps[80];
+    unsigned char u8[320], u16[320], u32[320];
+    unsigned char out[330];
+    struct kr_jsf32_ctx_s ctx;
+    size_t i, f, count, len8, len16, outLen;
+
+    kr_jsf32_srand(&ctx, 0x55544643);
+    for (i = 0; i < 1000; i++)
+    {
+        count = utf8_random(&ctx, cps, kr_countof(cps));
+        for (f = 0; f < kr_countof(flagsList); f++)
+        {
+            const unsigned flags = flagsList[f];
+            utf_encode_all(cps, count, (flags & KR_UTF_BE) != 0, u8, &len8, u16, &len16, u32);
+
+            EXPECT_UINTEQ(len16, kr_utf8_to_utf16_length((const char *)u8, len8));
+            EXPECT_UINTEQ(count, kr_utf8_to_utf32_length((const char *)u8, len8));
+            EXPECT_UINTEQ(len8, kr_utf16_to_utf8_length(u16, len16, flags));
+            EXPECT_UINTEQ(len8, kr_utf32_to_utf8_length(u32, count, flags));
+
+            memset(out, 0xAA, sizeof(out));
+            EXPECT_UINTEQ(len8, kr_utf8_to_utf16(out, &outLen, (const char *)u8, len8, flags));
+            EXPECT_UINTEQ(len16, outLen);
+            EXPECT_TRUE(memcmp(u16, out, len16 * 2) == 0);
+            EXPECT_UINTEQ(0xAA, out[len16 * 2]);
+
+            memset(out, 0xAA, sizeof(out));
+            EXPECT_UINTEQ(len8, kr_utf8_to_utf32(out, &outLen, (const char *)u8, len8, flags));
+            EXPECT_UINTEQ(count, outLen);
+            EXPECT_TRUE(memcmp(u32, out, count * 4) == 0);
+            EXPECT_UINTEQ(0xAA, out[count * 4]);
+
+            memset(out, 0xAA, sizeof(out));
+            EXPECT_UINTEQ(len16, kr_utf16_to_utf8((char *)out, &outLen, u16, len16, flags));
+            EXPECT_UINTEQ(len8, outLen);
+            EXPECT_TRUE(memcmp(u8, out, len8) == 0);
+            EXPECT_UINTEQ(0xAA, out[len8]);
+
+            memset(out, 0xAA, sizeof(out));
+            EXPECT_UINTEQ(count, kr_utf32_to_utf8((char *)out, &outLen, u32, count, flags));
+            EXPECT_UINTEQ(len8, outLen);
+            EXPECT_TRUE(memcmp(u8, out, len8) == 0);
+            EXPECT_UINTEQ(0xAA, out[len8]);
+        }
+    }
+}
+
+TEST(utf8, kr_utf_convert_invalid)
+{
+    static const unsigned long badUnits[] = {0xD800, 0xDBFF, 0xDC00, 0xDFFF, 0x110000, 0xFFFFFFFF};
+    unsigned long cps[80];
+    unsigned char u8[320], u16[320], u32[320];
+    unsigned char out[330], expected[330];
+    struct kr_jsf32_ctx_s ctx;
+    size_t i, count, len8, len16, pos, stop, outLen, expectedLen;
+    unsigned flags;
+
+    kr_jsf32_srand(&ctx, 0x42414455);
+    for (i = 0; i < 1000; i++)
+    {
+        count = utf8_random(&ctx, cps, kr_countof(cps));
+        flags = (i & 1) ? KR_UTF_BE : 0;
+        utf_encode_all(cps, count, (flags & KR_UTF_BE) != 0, u8, &len8, u16, &len16, u32);
+        if (count == 0)
+        {
+            continue;
+        }
+
+        /* UTF-8 stops where validation does, having converted everything
+           before it. */
+        u8[kr_jsf32_rand_uniform(&ctx, (uint32_t)len8)] = (unsigned char)kr_jsf32_rand(&ctx);
+        stop = kr_utf8_validate((const char *)u8, len8);
+        EXPECT_UINTEQ(stop, kr_utf8_to_utf16(out, &outLen, (const char *)u8, len8, flags));
+        EXPECT_UINTEQ(kr_utf8_to_utf16_length((const char *)u8, stop), outLen);
+        EXPECT_TRUE(outLen <= kr_utf8_to_utf16_length((const char *)u8, len8));
+        kr_utf8_to_utf16(expected, &expectedLen, (const char *)u8, stop, flags);
+        EXPECT_TRUE(memcmp(expected, out, outLen * 2) == 0);
+
+        EXPECT_UINTEQ(stop, kr_utf8_to_utf32(out, &outLen, (const char *)u8, len8, flags));
+        EXPECT_UINTEQ(kr_utf8_to_utf32_length((const char *)u8, stop), outLen);
+        EXPECT_TRUE(outLen <= kr_utf8_to_utf32_length((const char *)u8, len8));
+
+        /* A surrogate that replaced half of a pair can still pair up with
+           the other half. */
+        pos = kr_jsf32_rand_uniform(&ctx, (uint32_t)len16);
+        utf_put_unit(u16 + pos * 2, badUnits[kr_jsf32_rand_uniform(&ctx, 4)], 2, (flags & KR_UTF_BE) != 0);
+        stop = utf16_reference(u16, len16, (flags & KR_UTF_BE) != 0);
+        EXPECT_UINTEQ(stop, kr_utf16_to_utf8((char *)out, &outLen, u16, len16, flags));
+        EXPECT_UINTEQ(kr_utf16_to_utf8_length(u16, stop, flags), outLen);
+        EXPECT_TRUE(outLen <= kr_utf16_to_utf8_length(u16, len16, flags));
+        kr_utf16_to_utf8((char *)expected, &expectedLen, u16, stop, flags);
+        EXPECT_TRUE(memcmp(expected, out, outLen) == 0);
+
+        pos = kr_jsf32_rand_uniform(&ctx, (uint32_t)count);
+        utf_put_unit(u32 + pos * 4, badUnits[kr_jsf32_rand_uniform(&ctx, kr_countof(badUnits))], 4,
+                     (flags & KR_UTF_BE) != 0);
+        EXPECT_UINTEQ(pos, kr_utf32_to_utf8((char *)out, &outLen, u32, count, flags));
+        EXPECT_UINTEQ(kr_utf32_to_utf8_length(u32, pos, flags), outLen);
+        kr_utf32_to_utf8((char *)expected, &expectedLen, u32, pos, flags);
+        EXPECT_TRUE(memcmp(expected, out, outLen) == 0);
+    }
+
+    /* Each kind of unpaired surrogate, and a pair split by the end. */
+    EXPECT_UINTEQ(1, kr_utf16_to_utf8((char *)out, &outLen, "A\0\0\xDC", 2, 0));
+    EXPECT_UINTEQ(1, outLen);
+    EXPECT_UINTEQ(1, kr_utf16_to_utf8((char *)out, &outLen, "A\0\0\xD8" "B\0", 3, 0));
+    EXPECT_UINTEQ(1, kr_utf16_to_utf8((char *)out, &outLen, "A\0\0\xD8\0\xDC", 2, 0));
+    EXPECT_UINTEQ(3, kr_utf16_to_utf8((char *)out, &outLen, "A\0\0\xD8\0\xDC", 3, 0));
+    EXPECT_UINTEQ(5, outLen);
+}
+
+SUITE(utf8)
+{
+    SUITE_TEST(utf8, kr_utf8_validate);
+    SUITE_TEST(utf8, kr_utf8_validate_invalid);
+    SUITE_TEST(utf8, kr_utf8_validate_random);
+    SUITE_TEST(utf8, kr_utf_convert);
+    SUITE_TEST(utf8, kr_utf_convert_invalid);
+}
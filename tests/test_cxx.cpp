@@ -8,30 +8,56 @@
 
 #include "zztest.h"
 
+#include "t_arena.inl"
+#include "t_base64.inl"
 #include "t_bit.inl"
 #include "t_bltin.inl"
 #include "t_ckdint.inl"
+#include "t_conv.inl"
+#include "t_csv.inl"
 #include "t_ctype.inl"
+#include "t_float.inl"
+#include "t_fmt.inl"
+#include "t_hex.inl"
+#include "t_ini.inl"
 #include "t_int.inl"
+#include "t_intern.inl"
+#include "t_json.inl"
 #include "t_lib.inl"
 #include "t_limits.inl"
+#include "t_match.inl"
 #include "t_math.inl"
 #include "t_rand.inl"
 #include "t_serial.inl"
 #include "t_str.inl"
+#include "t_strbuf.inl"
+#include "t_utf8.inl"
 
 int main()
 {
+    ADD_TEST_SUITE(arena);
+    ADD_TEST_SUITE(base64);
     ADD_TEST_SUITE(bit);
     ADD_TEST_SUITE(bltin);
     ADD_TEST_SUITE(ckdint);
+    ADD_TEST_SUITE(conv);
+    ADD_TEST_SUITE(csv);
     ADD_TEST_SUITE(ctype);
+    ADD_TEST_SUITE(float);
+    ADD_TEST_SUITE(fmt);
+    ADD_TEST_SUITE(hex);
+    ADD_TEST_SUITE(ini);
     ADD_TEST_SUITE(int);
+    ADD_TEST_SUITE(intern);
+    ADD_TEST_SUITE(json);
     ADD_TEST_SUITE(lib);
     ADD_TEST_SUITE(limits);
+    ADD_TEST_SUITE(match);
     ADD_TEST_SUITE(math);
     ADD_TEST_SUITE(rand);
     ADD_TEST_SUITE(serial);
     ADD_TEST_SUITE(str);
+    ADD_TEST_SUITE(strbuf);
+    ADD_TEST_SUITE(utf8);
     return RUN_TESTS();
 }